@@ -6,7 +6,14 @@ set(ROOT_DIR ${CMAKE_SOURCE_DIR})
 
 # PLATFORM_NAME
 
-set(PLATFORM_NAME "WIN") #['WIN', 'IOS', 'ANDROID']
+if (NOT PLATFORM_NAME)
+    if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+        set(PLATFORM_NAME "LINUX")
+    else()
+        set(PLATFORM_NAME "WIN")
+    endif()
+endif()
+set(PLATFORM_NAME ${PLATFORM_NAME} CACHE STRING "The target platform name" FORCE) #['WIN', 'IOS', 'ANDROID', 'LINUX']
 message("Building on '${PLATFORM_NAME}' platform ...")
 
 if (PLATFORM_NAME STREQUAL "WIN")
@@ -15,6 +22,9 @@ elseif (PLATFORM_NAME STREQUAL "IOS")
     add_definitions(-DPLATFORM_IOS)
 elseif (PLATFORM_NAME STREQUAL "ANDROID")
     add_definitions(-DPLATFORM_ANDROID)
+elseif (PLATFORM_NAME STREQUAL "LINUX")
+    add_definitions(-DPLATFORM_LINUX)
+    add_compile_options(-fshort-wchar) # we use UTF-16 as wchar_t, see 'e3d_macros.h'
 else()
     message(FATAL_ERROR "The platform name '${PLATFORM_NAME}' is unknown")
 endif()
@@ -29,4 +39,4 @@ if (THREAD STREQUAL "pthread")
     if (PLATFORM_NAME STREQUAL "WIN")
         add_definitions(-DHAVE_STRUCT_TIMESPEC) # to fix error C2011: “timespec”:“struct” compile error with windows SDK 'time.h'
     endif()
-endif()
\ No newline at end of file
+endif()
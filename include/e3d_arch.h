@@ -78,6 +78,17 @@ NS_EXPORT __attribute__((weak)) void* __dso_handle;
 
 #	include <jni.h>
 
+// Linux Platform
+#elif PLATFORM_LINUX
+
+#	define _TARGET_OS_SIMULATOR_ 0
+
+#	if defined(__aarch64__) || defined(__x86_64__)
+#		define _PLATFORM_ARCH_64 1
+#	else
+#		define _PLATFORM_ARCH_32 1
+#	endif
+
 #endif
 
 #include <assert.h>
@@ -86,4 +97,5 @@ NS_EXPORT __attribute__((weak)) void* __dso_handle;
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include <new>
 #include <typeinfo>
\ No newline at end of file
@@ -104,6 +104,324 @@ enum class SocketType {
 	SeqPacket,
 };
 
+/**
+ * @brief The memory order of atomic operations.
+ * 
+ */
+enum class MemoryOrder {
+	/**
+	 * @brief No ordering, only the atomicity is guaranteed, it's for the statistics counters.
+	 * 
+	 */
+	Relaxed,
+	/**
+	 * @brief The reads and writes after it could not be reordered before it.
+	 * 
+	 */
+	Acquire,
+	/**
+	 * @brief The reads and writes before it could not be reordered after it.
+	 * 
+	 */
+	Release,
+	/**
+	 * @brief Both acquire and release, it's for the read-modify-write operations.
+	 * 
+	 */
+	AcqRel,
+	/**
+	 * @brief The sequentially-consistent ordering, all threads observe the same order.
+	 * 
+	 */
+	SeqCst,
+};
+
+/**
+ * @brief The access pattern hint of virtual memory.
+ * 
+ */
+enum class VirtualMemoryAdvice {
+	/**
+	 * @brief The default access pattern.
+	 * 
+	 */
+	Normal,
+	/**
+	 * @brief The pages are accessed in order, read ahead aggressively and free them soon after accessed.
+	 * 
+	 */
+	Sequential,
+	/**
+	 * @brief The pages are accessed randomly, do not read ahead.
+	 * 
+	 */
+	Random,
+	/**
+	 * @brief The pages will be accessed soon, prefetch them.
+	 * 
+	 */
+	WillNeed,
+	/**
+	 * @brief The pages will not be accessed soon, the physical pages could be reclaimed and the contents are lost.
+	 * 
+	 */
+	DontNeed,
+	/**
+	 * @brief Back the range with the transparent huge pages to reduce the TLB misses.
+	 * 
+	 */
+	HugePage,
+	/**
+	 * @brief Do not back the range with the transparent huge pages.
+	 * 
+	 */
+	NoHugePage,
+};
+
+/**
+ * @brief The memory tag, the allocations are accounted per tag for the budgets.
+ * 
+ */
+enum class MemoryTag {
+	/**
+	 * @brief The allocations which are not tagged.
+	 * 
+	 */
+	Default,
+	/**
+	 * @brief The platform and kernel objects.
+	 * 
+	 */
+	Platform,
+	/**
+	 * @brief The graphic module, such as textures, meshes and command buffers.
+	 * 
+	 */
+	Graphic,
+	/**
+	 * @brief The sound module.
+	 * 
+	 */
+	Sound,
+	/**
+	 * @brief The network module.
+	 * 
+	 */
+	Network,
+	/**
+	 * @brief The script module.
+	 * 
+	 */
+	Script,
+	/**
+	 * @brief The storage module, such as the file caches and archives.
+	 * 
+	 */
+	Storage,
+	/**
+	 * @brief The physics module.
+	 * 
+	 */
+	Physx,
+	/**
+	 * @brief The database module.
+	 * 
+	 */
+	Database,
+	/**
+	 * @brief The number of tags, it's not a tag.
+	 * 
+	 */
+	Count,
+};
+
+/**
+ * @brief The memory budget event.
+ * 
+ */
+enum class MemoryBudgetEvent {
+	/**
+	 * @brief The live bytes exceed the soft budget, it's reported once until they drop below it.
+	 * 
+	 */
+	SoftExceeded,
+	/**
+	 * @brief The allocation would exceed the hard budget, it fails if the callback does not release enough memory.
+	 * 
+	 */
+	HardExceeded,
+};
+
+/**
+ * @brief The memory error found by the guarded heap.
+ * 
+ */
+enum class GuardedHeapError {
+	/**
+	 * @brief The address could not be matched to any block.
+	 * 
+	 */
+	Unknown,
+	/**
+	 * @brief The block is accessed after it's freed.
+	 * 
+	 */
+	UseAfterFree,
+	/**
+	 * @brief The access is after the end of block.
+	 * 
+	 */
+	BufferOverflow,
+	/**
+	 * @brief The access is before the beginning of block.
+	 * 
+	 */
+	BufferUnderflow,
+	/**
+	 * @brief The block is freed twice.
+	 * 
+	 */
+	DoubleFree,
+	/**
+	 * @brief The pointer to free is not the beginning of block.
+	 * 
+	 */
+	InvalidFree,
+};
+
+/**
+ * @brief The lock contention statistics, all counters are accumulated since the lock created (or reset).
+ * 
+ */
+struct LockContentionData {
+	/**
+	 * @brief The number of times the lock has been acquired (not includes the recursive acquisitions).
+	 * 
+	 */
+	_qword mAcquiredNumber;
+	/**
+	 * @brief The number of times the lock was owned by other thread when trying to acquire it.
+	 * 
+	 */
+	_qword mContendedNumber;
+	/**
+	 * @brief The number of times the lock has been acquired in spin phase without sleeping.
+	 * 
+	 */
+	_qword mSpinAcquiredNumber;
+	/**
+	 * @brief The total number of spin iterations.
+	 * 
+	 */
+	_qword mSpinNumber;
+	/**
+	 * @brief The number of times the thread was put to sleep by kernel.
+	 * 
+	 */
+	_qword mSleepNumber;
+	/**
+	 * @brief The total time of sleeping in nanoseconds.
+	 * 
+	 */
+	_qword mSleepTime;
+	/**
+	 * @brief The current adaptive spin count.
+	 * 
+	 */
+	_dword mSpinCount;
+};
+
+/**
+ * @brief The 2D point of integers.
+ * 
+ */
+struct PointI {
+	_int x;
+	_int y;
+};
+
+/**
+ * @brief The file time, it's the number of 100-nanosecond intervals since January 1, 1601 (UTC).
+ * 
+ */
+struct FileTime {
+	/**
+	 * @brief The low-order part of the file time.
+	 * 
+	 */
+	_dword mLowDateTime;
+	/**
+	 * @brief The high-order part of the file time.
+	 * 
+	 */
+	_dword mHighDateTime;
+};
+
+/**
+ * @brief The calendar time, the fields are the same as SYSTEMTIME of win32.
+ * 
+ */
+struct CalendarTime {
+	/**
+	 * @brief The year, e.g. 2021.
+	 * 
+	 */
+	_word mYear;
+	/**
+	 * @brief The month, January is 1.
+	 * 
+	 */
+	_word mMonth;
+	/**
+	 * @brief The day of the week, Sunday is 0.
+	 * 
+	 */
+	_word mDayOfWeek;
+	/**
+	 * @brief The day of the month, it starts from 1.
+	 * 
+	 */
+	_word mDay;
+	/**
+	 * @brief The hour, minute, second and millisecond.
+	 * 
+	 */
+	_word mHour;
+	_word mMinute;
+	_word mSecond;
+	_word mMilliseconds;
+};
+
+/**
+ * @brief The file information which is returned by reading directory.
+ * 
+ */
+struct FileFinderData {
+	/**
+	 * @brief The file attributes, @see FileAttribute.
+	 * 
+	 */
+	_dword mFileAttributes;
+	/**
+	 * @brief The file times.
+	 * 
+	 */
+	FileTime mCreationTime;
+	FileTime mLastAccessTime;
+	FileTime mLastWriteTime;
+	/**
+	 * @brief The file size in bytes.
+	 * 
+	 */
+	_dword mFileSizeHigh;
+	_dword mFileSizeLow;
+	/**
+	 * @brief The file name without path.
+	 * 
+	 */
+	_charw mFileName[260];
+};
+
 /**
  * @brief The file attribute
  * 
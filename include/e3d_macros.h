@@ -43,6 +43,9 @@
 // Here we redefined the default assert macro, because the android NDK is different to IOS SDK
 #	define _DEFAULT_ASSERT(x) ((x) ? (void)0 : __assert(#    x, _LINENUMBER, _FILENAME_A))
 #	define _DEFAULT_ASSERT_WITH_DETAIL(x, linenumber, filename) ((x) ? (void)0 : __assert(#    x, linenumber, filename))
+#elif PLATFORM_LINUX
+#	define _DEFAULT_ASSERT(x) ((x) ? (void)0 : __assert_fail(#    x, _FILENAME_A, _LINENUMBER, _FUNCTION_A))
+#	define _DEFAULT_ASSERT_WITH_DETAIL(x, linenumber, filename) ((x) ? (void)0 : __assert_fail(#    x, filename, linenumber, _FUNCTION_A))
 #endif
 
 // #pragma - output string when compile
@@ -73,11 +76,25 @@
 #ifdef PLATFORM_WIN
 #	define DEBUG_BREAK() __asm {int 3}
 #	define NOP() __asm NOP
+#elif PLATFORM_LINUX
+#	define DEBUG_BREAK() __builtin_trap()
+#	define NOP() __asm__ __volatile__("nop")
 #else
 #	define DEBUG_BREAK() __asm__("trap")
 #	define NOP() __asm {nop}
 #endif
 
+// CPU-Pause, the hint of spin-wait loop to reduce the power and memory order violation
+#if defined(_MSC_VER)
+#	define CPU_PAUSE() YieldProcessor()
+#elif defined(__i386__) || defined(__x86_64__)
+#	define CPU_PAUSE() __builtin_ia32_pause()
+#elif defined(__arm__) || defined(__aarch64__)
+#	define CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#	define CPU_PAUSE() __asm__ __volatile__("" ::: "memory")
+#endif
+
 #if defined(__GNUC__) && !defined(__CC_ARM) && !defined(__ARMCC__)
 #	define HIDDEN __attribute__((visibility("hidden")))
 #else
@@ -216,6 +233,23 @@ extern "C" void __e3d__assert(const wchar_t* error, const wchar_t* filename, uns
 #	endif
 #endif
 
+// The cache line size, use it to pad the shared data to avoid false sharing
+#define E3D_CACHE_LINE_SIZE 64
+
+// Cache-Line aligned
+#if defined(_MSC_VER)
+#	define CACHE_ALIGNED __declspec(align(E3D_CACHE_LINE_SIZE))
+#else
+#	define CACHE_ALIGNED __attribute__((aligned(E3D_CACHE_LINE_SIZE)))
+#endif
+
+// Thread-Local, the variable must be constant-initialized, then it's accessed without the initialization guard
+#if defined(_MSC_VER)
+#	define THREAD_LOCAL __declspec(thread)
+#else
+#	define THREAD_LOCAL __thread
+#endif
+
 // PURE Virtual Interface
 #define PURE = 0
 
@@ -369,24 +403,11 @@ public:                              \
 #define E3D_MS_TO_SEC(ms) (_time_t)((ms) / 1000ul)
 #define E3D_SEC_TO_MS(s) (_time_t)((s)*1000ul)
 
-// Atom Platform Detection
-#if defined(_PLATFORM_WINDOWS_)
-#	define _WINDOWS_ATOM_
-#elif defined(_PLATFORM_ANDROID_) || defined(_PLATFORM_IOS_)
-#	define _GCC_ATOM_
-#endif
-
-// Window Atom
-#if defined(_WINDOWS_ATOM_)
-#	define INTERLOCKED_INC(x) InterlockedIncrement(&x)
-#	define INTERLOCKED_DEC(x) InterlockedDecrement(&x)
-#	define INTERLOCKED_ADD(x, v) InterlockedExchangeAdd(&x, v)
-#	define INTERLOCKED_SUB(x, v) InterlockedExchangeSubtract(&x, v)
+// 128-bit Compare-And-Swap, it requires '-mcx16' on x86-64 with GCC/Clang
+#if (defined(_MSC_VER) && defined(_M_X64)) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#	define E3D_HAS_ATOMIC128 1
 #else
-#	define INTERLOCKED_INC(x) __sync_add_and_fetch(&x, 1)
-#	define INTERLOCKED_DEC(x) __sync_sub_and_fetch(&x, 1)
-#	define INTERLOCKED_ADD(x, v) __sync_add_and_fetch(&x, v)
-#	define INTERLOCKED_SUB(x, v) __sync_sub_and_fetch(&x, v)
+#	define E3D_HAS_ATOMIC128 0
 #endif
 
 //!	Memory operations.
@@ -404,6 +425,15 @@ public:                              \
 E3D_STATIC_ASSERT(sizeof(wchar_t) == 2, "We use UTF-16 as wchar_t, not UTF-32");
 #endif
 
+// The aligned memory operations, the alignment must be power of 2
+#define e3d_aligned_malloc(s, a) _e3d_aligned_malloc(s, a, __FILE__, __LINE__)
+#define e3d_aligned_realloc(p, s, a) _e3d_aligned_realloc(p, s, a, __FILE__, __LINE__)
+#define e3d_aligned_free(p) _e3d_aligned_free(p, __FILE__, __LINE__)
+
+void _e3d_aligned_free(void* pointer, const char* filename, int linenumber);
+void* _e3d_aligned_malloc(size_t size, size_t alignment, const char* filename, int linenumber);
+void* _e3d_aligned_realloc(void* pointer, size_t size, size_t alignment, const char* filename, int linenumber);
+
 // The memory operations
 #ifndef _USE_STANDARD_MEM_OPERATOR_
 
@@ -454,6 +484,18 @@ void operator delete(void* pointer, const char* filename, int linenumber);
 void operator delete[](void* pointer);
 void operator delete[](void* pointer, const char* filename, int linenumber);
 
+// Overload New And Delete Operations of over-aligned types
+#		ifdef __cpp_aligned_new
+void* operator new(size_t size, std::align_val_t alignment);
+void* operator new(size_t size, std::align_val_t alignment, const char* filename, int linenumber);
+void* operator new[](size_t size, std::align_val_t alignment);
+void* operator new[](size_t size, std::align_val_t alignment, const char* filename, int linenumber);
+void operator delete(void* pointer, std::align_val_t alignment);
+void operator delete(void* pointer, std::align_val_t alignment, const char* filename, int linenumber);
+void operator delete[](void* pointer, std::align_val_t alignment);
+void operator delete[](void* pointer, std::align_val_t alignment, const char* filename, int linenumber);
+#		endif
+
 #		define new new (__FILE__, __LINE__)
 #	endif // _DISABLE_OVERLOAD_NEW_DELETE
 
@@ -11,7 +11,7 @@
 
 #pragma once
 
-#ifdef PLATFORM_IOS
+#if defined(PLATFORM_IOS) || defined(PLATFORM_LINUX)
 #	include <sys/types.h>
 #endif
 
@@ -67,7 +67,7 @@ typedef _dword _thread_ret;
 typedef void* _thread_ret;
 #endif
 
-} // namespace EGE
+} // namespace E3D
 
 #define TYPE_CHECKER(x)     \
 	namespace E3D {         \
@@ -79,8 +79,10 @@ typedef void* _thread_ret;
 	}
 
 // We will declare type checker class here
+namespace E3D {
 template <class T>
 struct TypeChecker;
+} // namespace E3D
 
 // Common types
 TYPE_CHECKER(_chara*)
@@ -0,0 +1,153 @@
+/**
+ * @file AllocationSampler.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The sampling allocation profiler.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The allocation site, the numbers are estimated from the samples.
+ * 
+ */
+struct AllocationSiteData {
+	//!	The maximum number of frames.
+	static const _dword cMaxFrameNumber = 16;
+
+	/**
+	 * @brief The return addresses of call stack, the innermost one is the first.
+	 * 
+	 */
+	_void* mFrames[cMaxFrameNumber];
+	/**
+	 * @brief The number of frames.
+	 * 
+	 */
+	_dword mFrameNumber;
+	/**
+	 * @brief The estimated bytes which are not freed yet.
+	 * 
+	 */
+	_qword mLiveBytes;
+	/**
+	 * @brief The estimated number of allocations which are not freed yet.
+	 * 
+	 */
+	_qword mLiveNumber;
+	/**
+	 * @brief The estimated bytes allocated since the sampler started.
+	 * 
+	 */
+	_qword mTotalBytes;
+	/**
+	 * @brief The estimated number of allocations since the sampler started.
+	 * 
+	 */
+	_qword mTotalNumber;
+};
+
+//!	The mean bytes between samples, 0 indicates the sampler is stopped.
+extern Atomic<_dword> gAllocationSampleInterval;
+//!	The number of sampled blocks which are not freed yet.
+extern Atomic<_dword> gAllocationLiveSampleNumber;
+//!	The bytes to allocate before the next sample in current thread.
+extern THREAD_LOCAL _large gAllocationSampleCountdown;
+
+/**
+ * @brief The allocation sampler, it samples 1 in N bytes in average and records the call stack of the sampled allocation.
+ * The sampling is Poisson process on bytes, so the large allocations are more likely sampled and the estimation is unbiased.
+ * The hooks cost a relaxed load and a compare when it's stopped, so it's always compiled in and toggled at runtime.
+ * 
+ */
+class AllocationSampler {
+private:
+	//!	Record the allocation, it's called when the countdown runs out.
+	static _void SampleAlloc(_void* pointer, _qword size);
+	//!	Remove the sampled block.
+	static _void SampleFree(_void* pointer);
+
+public:
+	/**
+	 * @brief Start sampling.
+	 * 
+	 * @param [in] interval The mean bytes between samples.
+	 * @return _void 
+	 */
+	static _void Start(_dword interval = 512 * 1024);
+
+	/**
+	 * @brief Stop sampling, the live samples are still tracked until they're freed.
+	 * 
+	 * @return _void 
+	 */
+	static _void Stop();
+
+	/**
+	 * @brief Check whether it's sampling.
+	 * 
+	 * @return _boolean True indicates it's sampling.
+	 */
+	static _boolean IsStarted();
+
+	/**
+	 * @brief Remove all samples and sites.
+	 * 
+	 * @return _void 
+	 */
+	static _void Reset();
+
+	/**
+	 * @brief Get the sites, they're sorted by the live bytes in descending order.
+	 * 
+	 * @param [out] sites The sites.
+	 * @param [in] number The maximum number of sites.
+	 * @return _dword The number of sites.
+	 */
+	static _dword GetSites(AllocationSiteData* sites, _dword number);
+
+	/**
+	 * @brief Write the sites with symbols to the text file, they're sorted by the live bytes in descending order.
+	 * 
+	 * @param [in] filename The file name.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean Dump(const _charw* filename);
+
+	/**
+	 * @brief The hook of allocation.
+	 * 
+	 * @param [in] pointer The allocated block.
+	 * @param [in] size The size in bytes.
+	 * @return _void 
+	 */
+	static _void OnAlloc(_void* pointer, _qword size) {
+		if (gAllocationSampleInterval.Load(MemoryOrder::Relaxed) == 0 || pointer == _null)
+			return;
+
+		gAllocationSampleCountdown -= (_large)size;
+		if (gAllocationSampleCountdown <= 0)
+			SampleAlloc(pointer, size);
+	}
+
+	/**
+	 * @brief The hook of free.
+	 * 
+	 * @param [in] pointer The block to free.
+	 * @return _void 
+	 */
+	static _void OnFree(_void* pointer) {
+		if (gAllocationLiveSampleNumber.Load(MemoryOrder::Relaxed) == 0 || pointer == _null)
+			return;
+
+		SampleFree(pointer);
+	}
+};
+
+} // namespace E3D
@@ -0,0 +1,338 @@
+/**
+ * @file Atomic.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The typed atomic variables with explicit memory orders.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The atomic variable, every operation takes the memory order, use the weakest one which is enough.
+ * The reference counter increases with Relaxed and decreases with AcqRel, the statistics counter uses Relaxed only.
+ * 
+ */
+template <typename Type>
+class Atomic {
+	NO_COPY_OPERATIONS(Atomic)
+
+private:
+	std::atomic<Type> mValue;
+
+public:
+	//!	It's constant-initialized, so the global atomic is ready before any constructor runs.
+	constexpr Atomic() : mValue(Type()) {
+	}
+	constexpr Atomic(Type value) : mValue(value) {
+	}
+
+public:
+	/**
+	 * @brief Convert to the standard memory order.
+	 * 
+	 * @param [in] order The memory order.
+	 * @return std::memory_order The standard memory order.
+	 */
+	static std::memory_order ToStdOrder(MemoryOrder order) {
+		switch (order) {
+			case MemoryOrder::Relaxed: return std::memory_order_relaxed;
+			case MemoryOrder::Acquire: return std::memory_order_acquire;
+			case MemoryOrder::Release: return std::memory_order_release;
+			case MemoryOrder::AcqRel: return std::memory_order_acq_rel;
+			default: return std::memory_order_seq_cst;
+		}
+	}
+
+	/**
+	 * @brief Get the order of failed CAS, it could not be stronger than the succeeded one and could not release.
+	 * 
+	 * @param [in] order The memory order of succeeded CAS.
+	 * @return std::memory_order The standard memory order of failed CAS.
+	 */
+	static std::memory_order ToStdFailureOrder(MemoryOrder order) {
+		switch (order) {
+			case MemoryOrder::Relaxed:
+			case MemoryOrder::Release: return std::memory_order_relaxed;
+			case MemoryOrder::Acquire:
+			case MemoryOrder::AcqRel: return std::memory_order_acquire;
+			default: return std::memory_order_seq_cst;
+		}
+	}
+
+public:
+	/**
+	 * @brief Load the value.
+	 * 
+	 * @param [in] order The memory order, Relaxed, Acquire or SeqCst.
+	 * @return Type The value.
+	 */
+	Type Load(MemoryOrder order) const {
+		return mValue.load(ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Store the value.
+	 * 
+	 * @param [in] value The value.
+	 * @param [in] order The memory order, Relaxed, Release or SeqCst.
+	 * @return _void 
+	 */
+	_void Store(Type value, MemoryOrder order) {
+		mValue.store(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Replace the value.
+	 * 
+	 * @param [in] value The new value.
+	 * @param [in] order The memory order.
+	 * @return Type The old value.
+	 */
+	Type Exchange(Type value, MemoryOrder order) {
+		return mValue.exchange(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Replace the value if it equals to the expected one.
+	 * 
+	 * @param [in, out] expected The expected value, it's updated to the current value when failed.
+	 * @param [in] desired The new value.
+	 * @param [in] order The memory order when succeeded, the failed one is derived from it.
+	 * @return _boolean True indicates the value has been replaced.
+	 */
+	_boolean CompareExchange(Type& expected, Type desired, MemoryOrder order) {
+		return mValue.compare_exchange_strong(expected, desired, ToStdOrder(order), ToStdFailureOrder(order));
+	}
+
+	/**
+	 * @brief Replace the value if it equals to the expected one, it could fail spuriously, use it in loop.
+	 * 
+	 * @param [in, out] expected The expected value, it's updated to the current value when failed.
+	 * @param [in] desired The new value.
+	 * @param [in] order The memory order when succeeded, the failed one is derived from it.
+	 * @return _boolean True indicates the value has been replaced.
+	 */
+	_boolean CompareExchangeWeak(Type& expected, Type desired, MemoryOrder order) {
+		return mValue.compare_exchange_weak(expected, desired, ToStdOrder(order), ToStdFailureOrder(order));
+	}
+
+	/**
+	 * @brief Add to the value.
+	 * 
+	 * @param [in] value The value to add.
+	 * @param [in] order The memory order.
+	 * @return Type The old value.
+	 */
+	Type FetchAdd(Type value, MemoryOrder order) {
+		return mValue.fetch_add(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Subtract from the value.
+	 * 
+	 * @param [in] value The value to subtract.
+	 * @param [in] order The memory order.
+	 * @return Type The old value.
+	 */
+	Type FetchSub(Type value, MemoryOrder order) {
+		return mValue.fetch_sub(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Bitwise AND the value.
+	 * 
+	 * @param [in] value The mask.
+	 * @param [in] order The memory order.
+	 * @return Type The old value.
+	 */
+	Type FetchAnd(Type value, MemoryOrder order) {
+		return mValue.fetch_and(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Bitwise OR the value.
+	 * 
+	 * @param [in] value The mask.
+	 * @param [in] order The memory order.
+	 * @return Type The old value.
+	 */
+	Type FetchOr(Type value, MemoryOrder order) {
+		return mValue.fetch_or(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Bitwise XOR the value.
+	 * 
+	 * @param [in] value The mask.
+	 * @param [in] order The memory order.
+	 * @return Type The old value.
+	 */
+	Type FetchXor(Type value, MemoryOrder order) {
+		return mValue.fetch_xor(value, ToStdOrder(order));
+	}
+
+	/**
+	 * @brief Increase the value by 1, it replaces the INTERLOCKED_INC() macro.
+	 * 
+	 * @param [in] order The memory order.
+	 * @return Type The new value.
+	 */
+	Type Increase(MemoryOrder order) {
+		return mValue.fetch_add(1, ToStdOrder(order)) + 1;
+	}
+
+	/**
+	 * @brief Decrease the value by 1, it replaces the INTERLOCKED_DEC() macro.
+	 * 
+	 * @param [in] order The memory order.
+	 * @return Type The new value.
+	 */
+	Type Decrease(MemoryOrder order) {
+		return mValue.fetch_sub(1, ToStdOrder(order)) - 1;
+	}
+};
+
+/**
+ * @brief Issue the memory fence.
+ * 
+ * @param [in] order The memory order.
+ * @return _void 
+ */
+inline _void AtomicThreadFence(MemoryOrder order) {
+	std::atomic_thread_fence(Atomic<_dword>::ToStdOrder(order));
+}
+
+/**
+ * @brief The 128-bit atomic variable, it's for the tagged pointer and the pair of counters.
+ * It's lock-free only if E3D_HAS_ATOMIC128 is 1, the platform library builds with '-mcx16' on x86-64 for it.
+ * Otherwise every operation takes the spin lock of the variable, it's correct but it's not lock-free, so it must not be
+ * used in the signal handler and the thread holding the lock could delay the others when it's preempted.
+ * The operations are always sequentially-consistent, the hardware instruction is a full barrier anyway.
+ * 
+ */
+class Atomic128 {
+	NO_COPY_OPERATIONS(Atomic128)
+
+public:
+	/**
+	 * @brief The value.
+	 * 
+	 */
+	struct Value {
+		_qword mLow;
+		_qword mHigh;
+
+		Value() : mLow(0), mHigh(0) {
+		}
+		Value(_qword low, _qword high) : mLow(low), mHigh(high) {
+		}
+
+		_boolean operator==(const Value& value) const {
+			return mLow == value.mLow && mHigh == value.mHigh;
+		}
+		_boolean operator!=(const Value& value) const {
+			return !(*this == value);
+		}
+	};
+
+private:
+#if defined(_MSC_VER)
+	__declspec(align(16)) Value mValue;
+#else
+	Value mValue __attribute__((aligned(16)));
+#endif
+
+#if E3D_HAS_ATOMIC128 == 0
+	Atomic<_dword> mLocker;
+#endif
+
+public:
+	Atomic128() {
+	}
+	Atomic128(const Value& value) : mValue(value) {
+	}
+
+public:
+	/**
+	 * @brief Check whether it's lock-free.
+	 * 
+	 * @return _boolean True indicates it's lock-free.
+	 */
+	static _boolean IsLockFree() {
+		return E3D_HAS_ATOMIC128 != 0;
+	}
+
+	/**
+	 * @brief Replace the value if it equals to the expected one.
+	 * 
+	 * @param [in, out] expected The expected value, it's updated to the current value when failed.
+	 * @param [in] desired The new value.
+	 * @return _boolean True indicates the value has been replaced.
+	 */
+	_boolean CompareExchange(Value& expected, const Value& desired) {
+#if E3D_HAS_ATOMIC128 && defined(_MSC_VER)
+		return _InterlockedCompareExchange128((volatile __int64*)&mValue, (__int64)desired.mHigh, (__int64)desired.mLow, (__int64*)&expected) != 0;
+#elif E3D_HAS_ATOMIC128
+		typedef unsigned __int128 _uint128;
+
+		_uint128 comparand = ((_uint128)expected.mHigh << 64) | expected.mLow;
+		_uint128 exchange = ((_uint128)desired.mHigh << 64) | desired.mLow;
+		_uint128 original = __sync_val_compare_and_swap((_uint128*)&mValue, comparand, exchange);
+		if (original == comparand)
+			return _true;
+
+		expected.mLow = (_qword)original;
+		expected.mHigh = (_qword)(original >> 64);
+		return _false;
+#else
+		_dword unlocked = 0;
+		while (!mLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire)) {
+			unlocked = 0;
+			CPU_PAUSE();
+		}
+
+		_boolean replaced = mValue == expected;
+		if (replaced)
+			mValue = desired;
+		else
+			expected = mValue;
+
+		mLocker.Store(0, MemoryOrder::Release);
+		return replaced;
+#endif
+	}
+
+	/**
+	 * @brief Load the value.
+	 * 
+	 * @return Value The value.
+	 */
+	Value Load() {
+		// The failed CAS returns the current value, the succeeded one writes the same value back
+		Value value;
+		CompareExchange(value, value);
+
+		return value;
+	}
+
+	/**
+	 * @brief Store the value.
+	 * 
+	 * @param [in] value The value.
+	 * @return _void 
+	 */
+	_void Store(const Value& value) {
+		// The plain read could be torn, the failed CAS updates the expected value atomically anyway
+		Value expected = Load();
+		while (!CompareExchange(expected, value))
+			;
+	}
+};
+
+} // namespace E3D
@@ -0,0 +1,209 @@
+/**
+ * @file CPUTopology.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The CPU set and topology.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The set of logical CPUs, it's for the affinity of more than 32 CPUs.
+ * 
+ */
+struct CPUSet {
+	//!	The maximum number of logical CPUs.
+	static const _dword cMaxCPUNumber = 1024;
+	//!	The invalid CPU index.
+	static const _dword cNoCPU = (_dword)-1;
+
+	//!	The bits of CPUs.
+	_qword mBits[cMaxCPUNumber / 64];
+
+	CPUSet() {
+		Clear();
+	}
+
+	/**
+	 * @brief Remove all CPUs.
+	 * 
+	 * @return _void 
+	 */
+	_void Clear() {
+		E3D_INIT_ARRAY(mBits);
+	}
+
+	/**
+	 * @brief Add the CPU.
+	 * 
+	 * @param [in] cpu The CPU index.
+	 * @return _void 
+	 */
+	_void Add(_dword cpu) {
+		if (cpu < cMaxCPUNumber)
+			mBits[cpu / 64] |= 1ull << (cpu % 64);
+	}
+
+	/**
+	 * @brief Remove the CPU.
+	 * 
+	 * @param [in] cpu The CPU index.
+	 * @return _void 
+	 */
+	_void Remove(_dword cpu) {
+		if (cpu < cMaxCPUNumber)
+			mBits[cpu / 64] &= ~(1ull << (cpu % 64));
+	}
+
+	/**
+	 * @brief Check whether contains the CPU.
+	 * 
+	 * @param [in] cpu The CPU index.
+	 * @return _boolean True indicates it contains the CPU.
+	 */
+	_boolean Contains(_dword cpu) const {
+		return cpu < cMaxCPUNumber && (mBits[cpu / 64] & (1ull << (cpu % 64))) != 0;
+	}
+
+	/**
+	 * @brief Get the number of CPUs.
+	 * 
+	 * @return _dword The number of CPUs.
+	 */
+	_dword GetNumber() const {
+		_dword number = 0;
+		for (_dword i = 0; i < E3D_ARRAY_NUMBER(mBits); i++) {
+			for (_qword bits = mBits[i]; bits != 0; bits &= bits - 1)
+				number++;
+		}
+
+		return number;
+	}
+
+	/**
+	 * @brief Get the n-th CPU in set.
+	 * 
+	 * @param [in] n The order of CPU in set.
+	 * @return _dword The CPU index, cNoCPU indicates there are not enough CPUs.
+	 */
+	_dword GetCPU(_dword n) const {
+		for (_dword cpu = 0; cpu < cMaxCPUNumber; cpu++) {
+			if (Contains(cpu) && n-- == 0)
+				return cpu;
+		}
+
+		return cNoCPU;
+	}
+};
+
+/**
+ * @brief The data or unified cache.
+ * 
+ */
+struct CPUCacheData {
+	/**
+	 * @brief The level, starts from 1.
+	 * 
+	 */
+	_dword mLevel;
+	/**
+	 * @brief The size in bytes.
+	 * 
+	 */
+	_dword mSize;
+	/**
+	 * @brief The cache line size in bytes.
+	 * 
+	 */
+	_dword mLineSize;
+	/**
+	 * @brief The number of logical CPUs sharing one cache.
+	 * 
+	 */
+	_dword mSharedCPUNumber;
+};
+
+/**
+ * @brief The logical CPU.
+ * 
+ */
+struct LogicalCPUData {
+	/**
+	 * @brief The physical package (socket) index.
+	 * 
+	 */
+	_dword mSocket;
+	/**
+	 * @brief The physical core index, it's unique among all sockets.
+	 * 
+	 */
+	_dword mCore;
+	/**
+	 * @brief The index of SMT siblings in the core, 0 indicates the first hardware thread.
+	 * 
+	 */
+	_dword mSMTIndex;
+	/**
+	 * @brief The NUMA node index.
+	 * 
+	 */
+	_dword mNode;
+};
+
+/**
+ * @brief The CPU topology, it's discovered once when it's used for the first time.
+ * 
+ */
+struct CPUTopology {
+	//!	The maximum number of cache levels.
+	static const _dword cMaxCacheNumber = 4;
+
+	/**
+	 * @brief The online logical CPUs.
+	 * 
+	 */
+	CPUSet mOnlineCPUs;
+	/**
+	 * @brief The number of online logical CPUs.
+	 * 
+	 */
+	_dword mLogicalCPUNumber;
+	/**
+	 * @brief The number of physical cores.
+	 * 
+	 */
+	_dword mCoreNumber;
+	/**
+	 * @brief The number of physical packages (sockets).
+	 * 
+	 */
+	_dword mSocketNumber;
+	/**
+	 * @brief The number of NUMA nodes.
+	 * 
+	 */
+	_dword mNodeNumber;
+	/**
+	 * @brief The data and unified caches from L1, the instruction caches are not included.
+	 * 
+	 */
+	CPUCacheData mCaches[cMaxCacheNumber];
+	/**
+	 * @brief The number of caches.
+	 * 
+	 */
+	_dword mCacheNumber;
+	/**
+	 * @brief The logical CPUs, it's indexed by CPU index, only the online ones are valid.
+	 * 
+	 */
+	LogicalCPUData mCPUs[CPUSet::cMaxCPUNumber];
+};
+
+} // namespace E3D
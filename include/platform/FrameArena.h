@@ -0,0 +1,301 @@
+/**
+ * @file FrameArena.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The linear arena and the per-frame arenas.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+struct LinearArenaBlock;
+
+/**
+ * @brief The position of linear arena, the arena could be rewound to it.
+ * 
+ */
+struct LinearArenaMarker {
+	LinearArenaBlock* mBlock;
+	_byte* mCursor;
+};
+
+/**
+ * @brief The linear arena, the allocation only moves the cursor and the blocks are released all at once.
+ * The memory blocks are kept after rewinding or resetting, so the heap sees no churn once it's warmed up.
+ * 
+ */
+class LinearArena {
+	NO_COPY_OPERATIONS(LinearArena)
+
+public:
+	//!	The default size of memory block.
+	static const _dword cDefaultBlockSize = 64 * 1024;
+
+private:
+	//!	The first block.
+	LinearArenaBlock* mBlocks;
+	//!	The block in use.
+	LinearArenaBlock* mCurrent;
+	//!	The free range of current block.
+	_byte* mCursor;
+	_byte* mEnd;
+	//!	The size of new block.
+	_dword mBlockSize;
+
+private:
+	//!	Move to the next block or allocate a new one.
+	_void* AllocSlow(_qword size, _dword alignment);
+
+public:
+	//!	It's constant-initialized, so the global arena could be used by the static constructors.
+	constexpr LinearArena(_dword block_size = cDefaultBlockSize) : mBlocks(_null), mCurrent(_null), mCursor(_null), mEnd(_null), mBlockSize(block_size) {
+	}
+	~LinearArena();
+
+public:
+	/**
+	 * @brief Allocate the memory, it's not necessary to free.
+	 * 
+	 * @param [in] size The size in bytes.
+	 * @param [in] alignment The alignment, it must be power of 2.
+	 * @return _void* The memory, null indicates out of memory.
+	 */
+	_void* Alloc(_qword size, _dword alignment = 16) {
+		if (mCursor != _null) {
+			_byte* pointer = (_byte*)(((_uintptr_t)mCursor + alignment - 1) & ~(_uintptr_t)(alignment - 1));
+			if (pointer <= mEnd && (_qword)(mEnd - pointer) >= size) {
+				mCursor = pointer + size;
+				return pointer;
+			}
+		}
+
+		return AllocSlow(size, alignment);
+	}
+
+	/**
+	 * @brief Allocate the objects, they're not constructed.
+	 * 
+	 * @param [in] number The number of objects.
+	 * @return Type* The objects, null indicates out of memory.
+	 */
+	template <typename Type>
+	Type* AllocArray(_qword number) {
+		// The total size must not overflow
+		if (number > (_qword)-1 / sizeof(Type))
+			return _null;
+
+		return (Type*)Alloc(number * sizeof(Type), alignof(Type));
+	}
+
+	/**
+	 * @brief Copy the string.
+	 * 
+	 * @param [in] string The string.
+	 * @return _chara* The copied string.
+	 */
+	_chara* AllocString(const _chara* string);
+
+	/**
+	 * @brief Format the string.
+	 * 
+	 * @param [in] format The string format.
+	 * @return _chara* The formatted string.
+	 */
+	_chara* FormatString(const _chara* format, ...);
+
+	/**
+	 * @brief Get the current position.
+	 * 
+	 * @return LinearArenaMarker The marker.
+	 */
+	LinearArenaMarker GetMarker() const {
+		return {mCurrent, mCursor};
+	}
+
+	/**
+	 * @brief Rewind to the position, the memory allocated after it is released.
+	 * 
+	 * @param [in] marker The marker got before.
+	 * @return _void 
+	 */
+	_void Rewind(const LinearArenaMarker& marker);
+
+	/**
+	 * @brief Release all memory but keep the blocks.
+	 * 
+	 * @return _void 
+	 */
+	_void Reset();
+
+	/**
+	 * @brief Free the blocks.
+	 * 
+	 * @return _void 
+	 */
+	_void Clear();
+
+	/**
+	 * @brief Get the bytes of blocks.
+	 * 
+	 * @return _qword The bytes.
+	 */
+	_qword GetCapacity() const;
+};
+
+/**
+ * @brief Rewind the arena when it's out of scope, so the temporary memory of scope is released.
+ * 
+ */
+class LinearArenaScope {
+	NO_COPY_OPERATIONS(LinearArenaScope)
+
+private:
+	LinearArena& mArena;
+	LinearArenaMarker mMarker;
+
+public:
+	LinearArenaScope(LinearArena& arena) : mArena(arena), mMarker(arena.GetMarker()) {
+	}
+	~LinearArenaScope() {
+		mArena.Rewind(mMarker);
+	}
+};
+
+/**
+ * @brief The per-frame arenas, every thread has two arenas and uses them by turns.
+ * The memory allocated in a frame is valid until the end of next frame, so the results of last frame could be read without copying.
+ * 
+ */
+class FrameArena {
+public:
+	/**
+	 * @brief Start the next frame, it's called once per frame by the main loop.
+	 * The arena of every thread is reset when it's used in the new frame for the first time.
+	 * 
+	 * @return _void 
+	 */
+	static _void NextFrame();
+
+	/**
+	 * @brief Get the frame index.
+	 * 
+	 * @return _dword The frame index.
+	 */
+	static _dword GetFrameIndex();
+
+	/**
+	 * @brief Get the arena of current thread and current frame.
+	 * 
+	 * @return LinearArena& The arena.
+	 */
+	static LinearArena& GetArena();
+
+	/**
+	 * @brief Allocate the memory in the arena of current thread.
+	 * 
+	 * @param [in] size The size in bytes.
+	 * @param [in] alignment The alignment, it must be power of 2.
+	 * @return _void* The memory, it's valid until the end of next frame.
+	 */
+	static _void* Alloc(_qword size, _dword alignment = 16) {
+		return GetArena().Alloc(size, alignment);
+	}
+
+	/**
+	 * @brief Free the arenas of current thread, it's called at thread exit automatically.
+	 * 
+	 * @return _void 
+	 */
+	static _void ReleaseThreadArenas();
+};
+
+/**
+ * @brief The STL allocator of linear arena, the memory is released when the arena is rewound.
+ * 
+ * @tparam Type The element type.
+ */
+template <typename Type>
+class ArenaAllocator {
+	template <typename OtherType>
+	friend class ArenaAllocator;
+
+public:
+	typedef Type value_type;
+
+private:
+	LinearArena* mArena;
+
+public:
+	ArenaAllocator(LinearArena& arena) : mArena(&arena) {
+	}
+	template <typename OtherType>
+	ArenaAllocator(const ArenaAllocator<OtherType>& allocator) : mArena(allocator.mArena) {
+	}
+
+public:
+	//!	It throws std::bad_alloc as the containers expect, the arena itself never throws.
+	Type* allocate(size_t number) {
+		Type* pointer = mArena->AllocArray<Type>(number);
+		if (pointer == _null)
+			throw std::bad_alloc();
+
+		return pointer;
+	}
+	_void deallocate(Type* pointer, size_t number) {
+	}
+
+	template <typename OtherType>
+	_boolean operator==(const ArenaAllocator<OtherType>& allocator) const {
+		return mArena == allocator.mArena;
+	}
+	template <typename OtherType>
+	_boolean operator!=(const ArenaAllocator<OtherType>& allocator) const {
+		return mArena != allocator.mArena;
+	}
+};
+
+/**
+ * @brief The STL allocator of frame arenas, the container must not live longer than the next frame.
+ * 
+ * @tparam Type The element type.
+ */
+template <typename Type>
+class FrameAllocator {
+public:
+	typedef Type value_type;
+
+public:
+	FrameAllocator() {
+	}
+	template <typename OtherType>
+	FrameAllocator(const FrameAllocator<OtherType>& allocator) {
+	}
+
+public:
+	//!	It throws std::bad_alloc as the containers expect, the arena itself never throws.
+	Type* allocate(size_t number) {
+		Type* pointer = FrameArena::GetArena().AllocArray<Type>(number);
+		if (pointer == _null)
+			throw std::bad_alloc();
+
+		return pointer;
+	}
+	_void deallocate(Type* pointer, size_t number) {
+	}
+
+	template <typename OtherType>
+	_boolean operator==(const FrameAllocator<OtherType>& allocator) const {
+		return _true;
+	}
+	template <typename OtherType>
+	_boolean operator!=(const FrameAllocator<OtherType>& allocator) const {
+		return _false;
+	}
+};
+
+} // namespace E3D
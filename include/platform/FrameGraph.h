@@ -0,0 +1,154 @@
+/**
+ * @file FrameGraph.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The per-frame stage graph running on the job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+struct FrameGraphStage;
+struct FrameGraphResource;
+
+/**
+ * @brief The frame graph, the modules add stages with the resources they read and write.
+ * Two stages conflict if they access the same resource and at least one of them writes it, the conflicting stages
+ * run in the order of adding, the others could overlap on workers.
+ * So the result is the same as running all stages in the order of adding, it's deterministic for replay.
+ * 
+ */
+class FrameGraph {
+	NO_COPY_OPERATIONS(FrameGraph)
+
+public:
+	//!	The stage function.
+	typedef _void (*OnStageProc)(_void* parameter);
+
+	//!	The maximum number of stages.
+	static const _dword cMaxStageNumber = 256;
+	//!	The maximum number of resources.
+	static const _dword cMaxResourceNumber = 256;
+
+private:
+	//!	The stages.
+	FrameGraphStage* mStages;
+	_dword mStageNumber;
+	//!	The resources.
+	FrameGraphResource* mResources;
+	_dword mResourceNumber;
+	//!	The successors of all stages, every stage refers to a range of it.
+	_dword* mSuccessors;
+	//!	True indicates the dependencies are up to date.
+	_boolean mCompiled;
+	//!	The counter of running stages, it's valid during execution.
+	JobCounter* mCounter;
+
+private:
+	//!	Run the stage and schedule the successors which are ready.
+	static _void OnStageJob(_void* parameter);
+
+public:
+	FrameGraph();
+	~FrameGraph();
+
+public:
+	/**
+	 * @brief Add a resource.
+	 * 
+	 * @param [in] name The resource name, it's for debugging only.
+	 * @return _dword The resource index, -1 indicates failure.
+	 */
+	_dword AddResource(const _chara* name);
+
+	/**
+	 * @brief Add a stage, it runs after the conflicting stages which are added before.
+	 * 
+	 * @param [in] name The stage name, it's for debugging only.
+	 * @param [in] func The stage function.
+	 * @param [in] parameter The user defined parameter.
+	 * @return _dword The stage index, -1 indicates failure.
+	 */
+	_dword AddStage(const _chara* name, OnStageProc func, _void* parameter);
+
+	/**
+	 * @brief Declare the stage reads the resource.
+	 * 
+	 * @param [in] stage The stage index.
+	 * @param [in] resource The resource index.
+	 * @return _boolean True indicates success, false indicates the index is invalid.
+	 */
+	_boolean Read(_dword stage, _dword resource);
+
+	/**
+	 * @brief Declare the stage writes the resource.
+	 * 
+	 * @param [in] stage The stage index.
+	 * @param [in] resource The resource index.
+	 * @return _boolean True indicates success, false indicates the index is invalid.
+	 */
+	_boolean Write(_dword stage, _dword resource);
+
+	/**
+	 * @brief Remove all stages and resources.
+	 * 
+	 * @return _void 
+	 */
+	_void Clear();
+
+	/**
+	 * @brief Derive the dependencies from the resource declarations, it's called by Execute() if the graph has been changed.
+	 * 
+	 * @return _void 
+	 */
+	_void Compile();
+
+	/**
+	 * @brief Run all stages and wait for them, the caller thread runs the stages as well.
+	 * 
+	 * @param [in] serial True indicates run all stages in the order of adding in the caller thread, it's for verifying the replay.
+	 * @return _void 
+	 */
+	_void Execute(_boolean serial = _false);
+
+	/**
+	 * @brief Get the number of stages.
+	 * 
+	 * @return _dword The number of stages.
+	 */
+	_dword GetStageNumber() const;
+
+	/**
+	 * @brief Get the stage name.
+	 * 
+	 * @param [in] stage The stage index.
+	 * @return const _chara* The stage name, null indicates the index is invalid.
+	 */
+	const _chara* GetStageName(_dword stage) const;
+
+	/**
+	 * @brief Get the stage level, the stages at the same level never depend on each other, they could overlap.
+	 * The graph must have been compiled.
+	 * 
+	 * @param [in] stage The stage index.
+	 * @return _dword The level starts from 0, -1 indicates the index is invalid.
+	 */
+	_dword GetStageLevel(_dword stage) const;
+
+	/**
+	 * @brief Check whether the stage depends on the other one directly.
+	 * The graph must have been compiled.
+	 * 
+	 * @param [in] stage The stage index.
+	 * @param [in] dependency The index of dependency stage.
+	 * @return _boolean True indicates the stage runs after the dependency.
+	 */
+	_boolean IsDependent(_dword stage, _dword dependency) const;
+};
+
+} // namespace E3D
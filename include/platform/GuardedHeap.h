@@ -0,0 +1,193 @@
+/**
+ * @file GuardedHeap.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The sampled guarded heap to catch the memory errors in production.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The memory error report of guarded heap.
+ * 
+ */
+struct GuardedHeapErrorData {
+	//!	The maximum number of frames.
+	static const _dword cMaxFrameNumber = 16;
+
+	/**
+	 * @brief The error type.
+	 * 
+	 */
+	GuardedHeapError mError;
+	/**
+	 * @brief The faulting address, or the pointer to free.
+	 * 
+	 */
+	_void* mAddress;
+	/**
+	 * @brief The block, null indicates it's unknown.
+	 * 
+	 */
+	_void* mBlock;
+	/**
+	 * @brief The size of block in bytes.
+	 * 
+	 */
+	_qword mSize;
+	/**
+	 * @brief The threads which allocate and free the block, 0 indicates it's not freed yet.
+	 * 
+	 */
+	_thread_id mAllocThreadID;
+	_thread_id mFreeThreadID;
+	/**
+	 * @brief The call stacks which allocate and free the block, the innermost frame is the first.
+	 * 
+	 */
+	_void* mAllocFrames[cMaxFrameNumber];
+	_dword mAllocFrameNumber;
+	_void* mFreeFrames[cMaxFrameNumber];
+	_dword mFreeFrameNumber;
+};
+
+//!	The mean number of allocations between samples, 0 indicates the guarded heap is stopped.
+extern Atomic<_dword> gGuardedHeapSampleRate;
+//!	The number of allocations before the next sample in current thread.
+extern THREAD_LOCAL _dword gGuardedHeapSampleCountdown;
+//!	The address range of guarded pages, it's set once when started, the end is stored before the begin.
+extern Atomic<_uintptr_t> gGuardedHeapBegin;
+extern Atomic<_uintptr_t> gGuardedHeapEnd;
+
+/**
+ * @brief The guarded heap, it places the sampled allocations on their own pages between the inaccessible guard pages.
+ * The overflow or underflow faults on the guard page and the freed page is inaccessible until it's reused, so the errors are
+ * caught at the faulting instruction with the call stacks of the allocation and the free.
+ * Only 1 in N allocations is sampled and the pool is fixed, so the overhead is low enough to run in production.
+ * 
+ */
+class GuardedHeap {
+public:
+	//!	The error callback, it's called before the process crashes (for faults) or continues (for frees).
+	typedef _void (*OnErrorProc)(const GuardedHeapErrorData& error, _void* parameter);
+
+private:
+	//!	Check whether to sample when the countdown runs out.
+	static _boolean ShouldSampleSlow();
+
+public:
+	/**
+	 * @brief Start sampling, the pool is reserved at the first time and kept until the process exits.
+	 * 
+	 * @param [in] slot_number The maximum number of live guarded blocks.
+	 * @param [in] sample_rate The mean number of allocations between samples.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean Start(_dword slot_number = 256, _dword sample_rate = 5000);
+
+	/**
+	 * @brief Stop sampling, the live guarded blocks are still checked until they're freed.
+	 * 
+	 * @return _void 
+	 */
+	static _void Stop();
+
+	/**
+	 * @brief Check whether it's sampling.
+	 * 
+	 * @return _boolean True indicates it's sampling.
+	 */
+	static _boolean IsStarted();
+
+	/**
+	 * @brief Set the error callback, the error is written to the debug output by default.
+	 * 
+	 * @param [in] func The callback, null indicates use the default one.
+	 * @param [in] parameter The user defined parameter.
+	 * @return _void 
+	 */
+	static _void SetErrorCallback(OnErrorProc func, _void* parameter);
+
+	/**
+	 * @brief Allocate the guarded block, it's called when ShouldSample() returns true.
+	 * 
+	 * @param [in] size The size in bytes, it must not be greater than the page size.
+	 * @param [in] alignment The alignment, it must be power of 2.
+	 * @return _void* The block, null indicates the pool is full and the caller should allocate it from the heap.
+	 */
+	static _void* Alloc(_qword size, _dword alignment = 16);
+
+	/**
+	 * @brief Free the guarded block, the double free and the invalid free are reported.
+	 * 
+	 * @param [in] pointer The block.
+	 * @return _boolean True indicates it's freed, false indicates it's reported as an error.
+	 */
+	static _boolean Free(_void* pointer);
+
+	/**
+	 * @brief Get the size of guarded block.
+	 * 
+	 * @param [in] pointer The block.
+	 * @return _qword The size in bytes.
+	 */
+	static _qword GetSize(const _void* pointer);
+
+	/**
+	 * @brief Set the memory tag of guarded block, the heap charges the block to it.
+	 * 
+	 * @param [in] pointer The block.
+	 * @param [in] tag The tag.
+	 * @return _void 
+	 */
+	static _void SetTag(const _void* pointer, MemoryTag tag);
+
+	/**
+	 * @brief Get the memory tag of guarded block.
+	 * 
+	 * @param [in] pointer The block.
+	 * @return MemoryTag The tag set by SetTag().
+	 */
+	static MemoryTag GetTag(const _void* pointer);
+
+	/**
+	 * @brief Check whether the allocation should be guarded, it costs a relaxed load and a decrement for most allocations.
+	 * 
+	 * @param [in] size The size in bytes.
+	 * @return _boolean True indicates it should be allocated by Alloc().
+	 */
+	static _boolean ShouldSample(_qword size) {
+		if (gGuardedHeapSampleRate.Load(MemoryOrder::Relaxed) == 0)
+			return _false;
+
+		if (gGuardedHeapSampleCountdown > 1) {
+			gGuardedHeapSampleCountdown--;
+			return _false;
+		}
+
+		return size <= Platform::GetPageSize() && ShouldSampleSlow();
+	}
+
+	/**
+	 * @brief Check whether the pointer is in the guarded pages.
+	 * 
+	 * @param [in] pointer The pointer.
+	 * @return _boolean True indicates it's allocated by Alloc().
+	 */
+	static _boolean IsGuarded(const _void* pointer) {
+		// The end is visible once the begin is, the pool is not reserved yet if the begin is 0
+		_uintptr_t begin = gGuardedHeapBegin.Load(MemoryOrder::Acquire);
+		if (begin == 0)
+			return _false;
+
+		return (_uintptr_t)pointer - begin < gGuardedHeapEnd.Load(MemoryOrder::Relaxed) - begin;
+	}
+};
+
+} // namespace E3D
@@ -0,0 +1,164 @@
+/**
+ * @file JobSystem.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The engine-wide work-stealing job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+struct Job;
+
+/**
+ * @brief The job counter, it's increased when a job is submitted with it and decreased when the job finished.
+ * The jobs depend on it start to run when it reaches zero, it must outlive all jobs which refer to it.
+ * 
+ */
+class JobCounter {
+	NO_COPY_OPERATIONS(JobCounter)
+
+	friend class JobSystem;
+
+private:
+	//!	The number of unfinished jobs.
+	Atomic<_dword> mValue;
+	//!	The manual-reset event, it's signaled when the value is zero.
+	_handle mEvent;
+	//!	The locker of dependent jobs and event.
+	_handle mLocker;
+	//!	The jobs waiting for this counter.
+	Job* mDependentJobs;
+
+private:
+	//!	Increase the value when a job is submitted with it.
+	_void Increase();
+	//!	Decrease the value when a job finished, returns the dependent jobs to schedule if it reaches zero.
+	Job* Decrease();
+	//!	Park the job until the value reaches zero, returns false if it's zero already.
+	_boolean AddDependentJob(Job* job);
+
+public:
+	JobCounter();
+	~JobCounter();
+
+public:
+	/**
+	 * @brief Get the number of unfinished jobs.
+	 * 
+	 * @return _dword The number of unfinished jobs.
+	 */
+	_dword GetValue() const;
+
+	/**
+	 * @brief Check whether all jobs have finished.
+	 * 
+	 * @return _boolean True indicates all jobs have finished.
+	 */
+	_boolean IsDone() const;
+};
+
+/**
+ * @brief The job system, every worker owns a Chase-Lev deque and steals from the others when it runs out of jobs.
+ * The jobs submitted by a worker are pushed to its own deque, the others go to the shared queue.
+ * 
+ */
+class JobSystem {
+private:
+	//!	Run the job and release it.
+	static _void ExecuteJob(Job* job);
+	//!	Push the job to the queue, the job is ready to run.
+	static _void ScheduleJob(Job* job);
+	//!	The worker thread.
+	static _thread_ret OnWorkerThread(_void* parameter);
+
+public:
+	//!	The job function.
+	typedef _void (*OnJobProc)(_void* parameter);
+
+	//!	The affinity hint of no preferred worker.
+	static const _dword cAnyWorker = (_dword)-1;
+
+public:
+	/**
+	 * @brief Initialize the worker threads.
+	 * 
+	 * @param [in] worker_number The number of workers, 0 indicates one less than the available processors (the caller is the last one).
+	 * @param [in] pin_workers True indicates pin every worker to its own processor by Platform::SetThreadAffinity(), the processors
+	 * of process affinity are taken in NUMA node order so the neighbour workers share the node, the first one is left for the caller.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean Initialize(_dword worker_number = 0, _boolean pin_workers = _false);
+
+	/**
+	 * @brief Finish all pending jobs and stop the worker threads.
+	 * 
+	 * @return _void 
+	 */
+	static _void Finalize();
+
+	/**
+	 * @brief Get the number of workers.
+	 * 
+	 * @return _dword The number of workers.
+	 */
+	static _dword GetWorkerNumber();
+
+	/**
+	 * @brief Get the worker index of current thread.
+	 * 
+	 * @return _dword The worker index, -1 indicates current thread is not a worker.
+	 */
+	static _dword GetCurrentWorkerIndex();
+
+	/**
+	 * @brief Submit a job.
+	 * The job runs in the caller thread if the system is not initialized or the deque is full.
+	 * 
+	 * @param [in] func The job function.
+	 * @param [in] parameter The user defined parameter.
+	 * @param [in] counter The counter to decrease when the job finished, it could be null.
+	 * @param [in] dependency The counter to wait before the job starts, it could be null.
+	 * @param [in] affinity The preferred worker index, it's a hint only, the idle workers could still steal it.
+	 * @return _void 
+	 */
+	static _void Run(OnJobProc func, _void* parameter, JobCounter* counter = _null, JobCounter* dependency = _null, _dword affinity = cAnyWorker);
+
+	/**
+	 * @brief Increase the counter for the work which is not submitted as job, such as the suspended task.
+	 * 
+	 * @param [in] counter The counter.
+	 * @return _void 
+	 */
+	static _void IncreaseCounter(JobCounter& counter);
+
+	/**
+	 * @brief Decrease the counter when the work finished, the dependent jobs are scheduled if it reaches zero.
+	 * 
+	 * @param [in] counter The counter.
+	 * @return _void 
+	 */
+	static _void DecreaseCounter(JobCounter& counter);
+
+	/**
+	 * @brief Wait for the counter to reach zero, current thread runs the pending jobs while waiting.
+	 * 
+	 * @param [in] counter The counter.
+	 * @return _void 
+	 */
+	static _void Wait(JobCounter& counter);
+
+	/**
+	 * @brief Run one pending job in current thread.
+	 * 
+	 * @return _boolean True indicates a job has been run, false indicates there is no pending job.
+	 */
+	static _boolean RunPendingJob();
+};
+
+} // namespace E3D
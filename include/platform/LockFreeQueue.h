@@ -0,0 +1,405 @@
+/**
+ * @file LockFreeQueue.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The bounded lock-free queues for inter-thread messaging.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The helper of lock-free queues.
+ * 
+ */
+class LockFreeQueueHelper {
+public:
+	/**
+	 * @brief Round up the capacity to power of 2, so the position could be wrapped by mask.
+	 * 
+	 * @param [in] capacity The capacity.
+	 * @return _dword The capacity in power of 2.
+	 */
+	static _dword RoundUpCapacity(_dword capacity) {
+		_dword size = 2;
+		while (size < capacity && size < 0x80000000)
+			size <<= 1;
+
+		return size;
+	}
+};
+
+/**
+ * @brief The bounded single-producer single-consumer ring buffer.
+ * The producer and consumer keep a cached copy of the other side's position, so they only touch the shared cache line when the cache runs out.
+ * The element type must be default constructible and copy assignable.
+ * 
+ */
+template <typename Type>
+class SPSCQueue {
+	NO_COPY_OPERATIONS(SPSCQueue)
+
+private:
+	//!	The producer side.
+	CACHE_ALIGNED std::atomic<_dword> mWritePos;
+	_dword mCachedReadPos;
+
+	//!	The consumer side.
+	CACHE_ALIGNED std::atomic<_dword> mReadPos;
+	_dword mCachedWritePos;
+
+	//!	The read-only part.
+	CACHE_ALIGNED _dword mMask;
+	Type* mElements;
+
+public:
+	SPSCQueue(_dword capacity);
+	~SPSCQueue();
+
+public:
+	/**
+	 * @brief Get the capacity.
+	 * 
+	 * @return _dword The capacity.
+	 */
+	_dword GetCapacity() const;
+
+	/**
+	 * @brief Get the approximate number of elements, it's exact only in the producer or consumer thread.
+	 * 
+	 * @return _dword The number of elements.
+	 */
+	_dword GetNumber() const;
+
+	/**
+	 * @brief Enqueue an element, it must be called by the producer thread.
+	 * 
+	 * @param [in] element The element.
+	 * @return _boolean True indicates success, false indicates the queue is full.
+	 */
+	_boolean Enqueue(const Type& element);
+
+	/**
+	 * @brief Enqueue elements as many as possible, they are visible to the consumer at once.
+	 * 
+	 * @param [in] elements The elements.
+	 * @param [in] number The number of elements.
+	 * @return _dword The number of elements enqueued.
+	 */
+	_dword EnqueueBatch(const Type* elements, _dword number);
+
+	/**
+	 * @brief Dequeue an element, it must be called by the consumer thread.
+	 * 
+	 * @param [out] element The element.
+	 * @return _boolean True indicates success, false indicates the queue is empty.
+	 */
+	_boolean Dequeue(Type& element);
+
+	/**
+	 * @brief Dequeue elements as many as possible.
+	 * 
+	 * @param [out] elements The buffer to receive elements.
+	 * @param [in] number The max number of elements.
+	 * @return _dword The number of elements dequeued.
+	 */
+	_dword DequeueBatch(Type* elements, _dword number);
+};
+
+#pragma region "SPSCQueue Implementation"
+
+template <typename Type>
+SPSCQueue<Type>::SPSCQueue(_dword capacity) : mWritePos(0), mCachedReadPos(0), mReadPos(0), mCachedWritePos(0) {
+	mMask = LockFreeQueueHelper::RoundUpCapacity(capacity) - 1;
+	mElements = new Type[mMask + 1];
+}
+
+template <typename Type>
+SPSCQueue<Type>::~SPSCQueue() {
+	delete[] mElements;
+}
+
+template <typename Type>
+_dword SPSCQueue<Type>::GetCapacity() const {
+	return mMask + 1;
+}
+
+template <typename Type>
+_dword SPSCQueue<Type>::GetNumber() const {
+	return mWritePos.load(std::memory_order_acquire) - mReadPos.load(std::memory_order_acquire);
+}
+
+template <typename Type>
+_boolean SPSCQueue<Type>::Enqueue(const Type& element) {
+	return EnqueueBatch(&element, 1) == 1;
+}
+
+template <typename Type>
+_dword SPSCQueue<Type>::EnqueueBatch(const Type* elements, _dword number) {
+	_dword write_pos = mWritePos.load(std::memory_order_relaxed);
+
+	// Refresh the consumer position only when the cached one says it's full
+	_dword free_number = mMask + 1 - (write_pos - mCachedReadPos);
+	if (free_number < number) {
+		mCachedReadPos = mReadPos.load(std::memory_order_acquire);
+		free_number = mMask + 1 - (write_pos - mCachedReadPos);
+	}
+
+	number = MIN(number, free_number);
+	for (_dword i = 0; i < number; i++)
+		mElements[(write_pos + i) & mMask] = elements[i];
+
+	mWritePos.store(write_pos + number, std::memory_order_release);
+
+	return number;
+}
+
+template <typename Type>
+_boolean SPSCQueue<Type>::Dequeue(Type& element) {
+	return DequeueBatch(&element, 1) == 1;
+}
+
+template <typename Type>
+_dword SPSCQueue<Type>::DequeueBatch(Type* elements, _dword number) {
+	_dword read_pos = mReadPos.load(std::memory_order_relaxed);
+
+	// Refresh the producer position only when the cached one says it's empty
+	_dword ready_number = mCachedWritePos - read_pos;
+	if (ready_number < number) {
+		mCachedWritePos = mWritePos.load(std::memory_order_acquire);
+		ready_number = mCachedWritePos - read_pos;
+	}
+
+	number = MIN(number, ready_number);
+	for (_dword i = 0; i < number; i++)
+		elements[i] = mElements[(read_pos + i) & mMask];
+
+	mReadPos.store(read_pos + number, std::memory_order_release);
+
+	return number;
+}
+
+#pragma endregion
+
+/**
+ * @brief The bounded multi-producer multi-consumer queue (Dmitry Vyukov's algorithm).
+ * Every cell has a sequence number, the producers and consumers only contend on their own position, not on each other.
+ * The element type must be default constructible and copy assignable.
+ * 
+ */
+template <typename Type>
+class MPMCQueue {
+	NO_COPY_OPERATIONS(MPMCQueue)
+
+private:
+	/**
+	 * @brief The cell, the sequence equals to the position when it's free to write, and the position + 1 when it's ready to read.
+	 * 
+	 */
+	struct Cell {
+		std::atomic<_dword> mSequence;
+		Type mElement;
+	};
+
+private:
+	//!	The read-only part.
+	CACHE_ALIGNED Cell* mCells;
+	_dword mMask;
+
+	//!	The producers position.
+	CACHE_ALIGNED std::atomic<_dword> mEnqueuePos;
+	//!	The consumers position.
+	CACHE_ALIGNED std::atomic<_dword> mDequeuePos;
+
+public:
+	MPMCQueue(_dword capacity);
+	~MPMCQueue();
+
+public:
+	/**
+	 * @brief Get the capacity.
+	 * 
+	 * @return _dword The capacity.
+	 */
+	_dword GetCapacity() const;
+
+	/**
+	 * @brief Get the approximate number of elements.
+	 * 
+	 * @return _dword The number of elements.
+	 */
+	_dword GetNumber() const;
+
+	/**
+	 * @brief Enqueue an element.
+	 * 
+	 * @param [in] element The element.
+	 * @return _boolean True indicates success, false indicates the queue is full.
+	 */
+	_boolean Enqueue(const Type& element);
+
+	/**
+	 * @brief Enqueue elements as many as possible, the cells are claimed by one CAS.
+	 * 
+	 * @param [in] elements The elements.
+	 * @param [in] number The number of elements.
+	 * @return _dword The number of elements enqueued.
+	 */
+	_dword EnqueueBatch(const Type* elements, _dword number);
+
+	/**
+	 * @brief Dequeue an element.
+	 * 
+	 * @param [out] element The element.
+	 * @return _boolean True indicates success, false indicates the queue is empty.
+	 */
+	_boolean Dequeue(Type& element);
+
+	/**
+	 * @brief Dequeue elements as many as possible, the cells are claimed by one CAS.
+	 * 
+	 * @param [out] elements The buffer to receive elements.
+	 * @param [in] number The max number of elements.
+	 * @return _dword The number of elements dequeued.
+	 */
+	_dword DequeueBatch(Type* elements, _dword number);
+};
+
+#pragma region "MPMCQueue Implementation"
+
+template <typename Type>
+MPMCQueue<Type>::MPMCQueue(_dword capacity) : mEnqueuePos(0), mDequeuePos(0) {
+	mMask = LockFreeQueueHelper::RoundUpCapacity(capacity) - 1;
+	mCells = new Cell[mMask + 1];
+
+	for (_dword i = 0; i <= mMask; i++)
+		mCells[i].mSequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename Type>
+MPMCQueue<Type>::~MPMCQueue() {
+	delete[] mCells;
+}
+
+template <typename Type>
+_dword MPMCQueue<Type>::GetCapacity() const {
+	return mMask + 1;
+}
+
+template <typename Type>
+_dword MPMCQueue<Type>::GetNumber() const {
+	_int number = (_int)(mEnqueuePos.load(std::memory_order_relaxed) - mDequeuePos.load(std::memory_order_relaxed));
+
+	return number > 0 ? (_dword)number : 0;
+}
+
+template <typename Type>
+_boolean MPMCQueue<Type>::Enqueue(const Type& element) {
+	return EnqueueBatch(&element, 1) == 1;
+}
+
+template <typename Type>
+_dword MPMCQueue<Type>::EnqueueBatch(const Type* elements, _dword number) {
+	if (number == 0)
+		return 0;
+
+	_dword pos = mEnqueuePos.load(std::memory_order_relaxed);
+	_dword claimed = 0;
+
+	while (_true) {
+		// Count the free cells from the position, they could not be taken by others unless the position moves
+		claimed = 0;
+		while (claimed < number) {
+			_int diff = (_int)(mCells[(pos + claimed) & mMask].mSequence.load(std::memory_order_acquire) - (pos + claimed));
+			if (diff != 0) {
+				// Somebody has moved the position, try again
+				if (claimed == 0 && diff > 0)
+					claimed = (_dword)-1;
+
+				break;
+			}
+
+			claimed++;
+		}
+
+		if (claimed == (_dword)-1) {
+			pos = mEnqueuePos.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// It's full
+		if (claimed == 0)
+			return 0;
+
+		if (mEnqueuePos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+			break;
+	}
+
+	for (_dword i = 0; i < claimed; i++) {
+		Cell& cell = mCells[(pos + i) & mMask];
+		cell.mElement = elements[i];
+		cell.mSequence.store(pos + i + 1, std::memory_order_release);
+	}
+
+	return claimed;
+}
+
+template <typename Type>
+_boolean MPMCQueue<Type>::Dequeue(Type& element) {
+	return DequeueBatch(&element, 1) == 1;
+}
+
+template <typename Type>
+_dword MPMCQueue<Type>::DequeueBatch(Type* elements, _dword number) {
+	if (number == 0)
+		return 0;
+
+	_dword pos = mDequeuePos.load(std::memory_order_relaxed);
+	_dword claimed = 0;
+
+	while (_true) {
+		// Count the ready cells from the position, they could not be taken by others unless the position moves
+		claimed = 0;
+		while (claimed < number) {
+			_int diff = (_int)(mCells[(pos + claimed) & mMask].mSequence.load(std::memory_order_acquire) - (pos + claimed + 1));
+			if (diff != 0) {
+				// Somebody has moved the position, try again
+				if (claimed == 0 && diff > 0)
+					claimed = (_dword)-1;
+
+				break;
+			}
+
+			claimed++;
+		}
+
+		if (claimed == (_dword)-1) {
+			pos = mDequeuePos.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		// It's empty
+		if (claimed == 0)
+			return 0;
+
+		if (mDequeuePos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+			break;
+	}
+
+	for (_dword i = 0; i < claimed; i++) {
+		Cell& cell = mCells[(pos + i) & mMask];
+		elements[i] = cell.mElement;
+		cell.mSequence.store(pos + i + mMask + 1, std::memory_order_release);
+	}
+
+	return claimed;
+}
+
+#pragma endregion
+
+} // namespace E3D
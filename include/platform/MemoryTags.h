@@ -0,0 +1,217 @@
+/**
+ * @file MemoryTags.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The memory accounting per tag with budgets.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The memory data of tag.
+ * 
+ */
+struct MemoryTagData {
+	/**
+	 * @brief The bytes which are not freed yet.
+	 * 
+	 */
+	_qword mLiveBytes;
+	/**
+	 * @brief The maximum live bytes since the process started (or reset).
+	 * 
+	 */
+	_qword mPeakBytes;
+	/**
+	 * @brief The number of allocations which are not freed yet.
+	 * 
+	 */
+	_qword mLiveNumber;
+	/**
+	 * @brief The bytes allocated since the process started.
+	 * 
+	 */
+	_qword mTotalBytes;
+	/**
+	 * @brief The number of allocations since the process started.
+	 * 
+	 */
+	_qword mTotalNumber;
+	/**
+	 * @brief The bytes allocated per second since the last snapshot.
+	 * 
+	 */
+	_qword mAllocRate;
+	/**
+	 * @brief The soft budget in bytes, 0 indicates unlimited.
+	 * 
+	 */
+	_qword mSoftBudget;
+	/**
+	 * @brief The hard budget in bytes, 0 indicates unlimited.
+	 * 
+	 */
+	_qword mHardBudget;
+};
+
+/**
+ * @brief The memory snapshot of all tags.
+ * 
+ */
+struct MemoryTagSnapshot {
+	//!	The tick count in milliseconds when it's taken.
+	_dword mTime;
+	//!	The data of tags.
+	MemoryTagData mTags[(_dword)MemoryTag::Count];
+};
+
+/**
+ * @brief The memory accounting per tag, every heap block (Platform::HeapAlloc() and the global new) is charged to the tag of
+ * current thread when it's allocated, and it keeps the tag until it's freed.
+ * The live bytes exceeding the soft budget are reported by the callback, the allocation exceeding the hard budget fails
+ * unless the callback releases enough memory of the tag.
+ * 
+ */
+class MemoryTags {
+public:
+	//!	The budget callback, the tag is the one exceeds the budget, the size is the bytes to allocate.
+	typedef _void (*OnBudgetProc)(MemoryTag tag, MemoryBudgetEvent event, _qword live_bytes, _qword size, _void* parameter);
+
+public:
+	/**
+	 * @brief Allocate the memory from heap and charge it to the tag.
+	 * 
+	 * @param [in] size The size in bytes.
+	 * @param [in] tag The tag, MemoryTag::Count indicates the tag of current thread.
+	 * @return _void* The memory aligned to 16 bytes, null indicates out of memory or the hard budget.
+	 */
+	static _void* Alloc(_qword size, MemoryTag tag = MemoryTag::Count);
+
+	/**
+	 * @brief Reallocate the memory, the block keeps its tag.
+	 * 
+	 * @param [in] pointer The block allocated by Alloc() or Platform::HeapAlloc(), null indicates allocate a new one.
+	 * @param [in] size The size in bytes, 0 indicates free the block.
+	 * @return _void* The memory, null indicates failure and the old block is kept.
+	 */
+	static _void* ReAlloc(_void* pointer, _qword size);
+
+	/**
+	 * @brief Free the memory allocated by Alloc() or Platform::HeapAlloc().
+	 * 
+	 * @param [in] pointer The block.
+	 * @return _void 
+	 */
+	static _void Free(_void* pointer);
+
+	/**
+	 * @brief Get the tag of block allocated by Alloc() or Platform::HeapAlloc().
+	 * 
+	 * @param [in] pointer The block.
+	 * @return MemoryTag The tag.
+	 */
+	static MemoryTag GetTag(const _void* pointer);
+
+	/**
+	 * @brief Account the allocation, it's for the allocators which keep the tags of blocks by themselves.
+	 * The heap blocks are accounted by the heap already, so it's only for the memory which does not come from the heap.
+	 * 
+	 * @param [in] tag The tag.
+	 * @param [in] size The size in bytes.
+	 * @return _boolean True indicates it's accounted, false indicates it exceeds the hard budget and it's not accounted.
+	 */
+	static _boolean OnAlloc(MemoryTag tag, _qword size);
+
+	/**
+	 * @brief Account the free.
+	 * 
+	 * @param [in] tag The tag.
+	 * @param [in] size The size in bytes, it must be the same as allocated.
+	 * @return _void 
+	 */
+	static _void OnFree(MemoryTag tag, _qword size);
+
+	/**
+	 * @brief Set the tag of current thread.
+	 * 
+	 * @param [in] tag The tag.
+	 * @return MemoryTag The previous tag.
+	 */
+	static MemoryTag SetThreadTag(MemoryTag tag);
+
+	/**
+	 * @brief Get the tag of current thread.
+	 * 
+	 * @return MemoryTag The tag.
+	 */
+	static MemoryTag GetThreadTag();
+
+	/**
+	 * @brief Set the budgets of tag.
+	 * 
+	 * @param [in] tag The tag.
+	 * @param [in] soft_budget The soft budget in bytes, 0 indicates unlimited.
+	 * @param [in] hard_budget The hard budget in bytes, 0 indicates unlimited.
+	 * @return _void 
+	 */
+	static _void SetBudget(MemoryTag tag, _qword soft_budget, _qword hard_budget);
+
+	/**
+	 * @brief Set the budget callback, it's called in the thread which allocates.
+	 * 
+	 * @param [in] func The callback, null indicates remove it.
+	 * @param [in] parameter The user defined parameter.
+	 * @return _void 
+	 */
+	static _void SetBudgetCallback(OnBudgetProc func, _void* parameter);
+
+	/**
+	 * @brief Get the tag name.
+	 * 
+	 * @param [in] tag The tag.
+	 * @return const _chara* The name.
+	 */
+	static const _chara* GetTagName(MemoryTag tag);
+
+	/**
+	 * @brief Take the snapshot, the allocation rates are calculated since the last snapshot.
+	 * It only reads the counters, so it's cheap to call every frame.
+	 * 
+	 * @param [out] snapshot The snapshot.
+	 * @return _void 
+	 */
+	static _void GetSnapshot(MemoryTagSnapshot& snapshot);
+
+	/**
+	 * @brief Reset the peak bytes to the live bytes.
+	 * 
+	 * @return _void 
+	 */
+	static _void ResetPeak();
+};
+
+/**
+ * @brief Set the tag of current thread in the scope.
+ * 
+ */
+class MemoryTagScope {
+	NO_COPY_OPERATIONS(MemoryTagScope)
+
+private:
+	MemoryTag mPreviousTag;
+
+public:
+	MemoryTagScope(MemoryTag tag) : mPreviousTag(MemoryTags::SetThreadTag(tag)) {
+	}
+	~MemoryTagScope() {
+		MemoryTags::SetThreadTag(mPreviousTag);
+	}
+};
+
+} // namespace E3D
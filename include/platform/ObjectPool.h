@@ -0,0 +1,350 @@
+/**
+ * @file ObjectPool.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The typed object pool with generation handles.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The handle layout of object pool, the low bits are the slot index and the high bits are the generation of slot.
+ * The generation of slot is increased when the object is created or destroyed, so it's odd when the slot is alive.
+ * 
+ */
+class ObjectPoolHelper {
+public:
+	//!	The null handle.
+	static const _dword cNullHandle = 0;
+	//!	The bits of slot index.
+	static const _dword cIndexBits = 20;
+	//!	The bits of generation.
+	static const _dword cGenerationBits = 32 - cIndexBits;
+	//!	The maximum number of slots.
+	static const _dword cMaxSlotNumber = 1 << cIndexBits;
+	//!	The mask of slot index.
+	static const _dword cIndexMask = cMaxSlotNumber - 1;
+	//!	The mask of generation.
+	static const _dword cGenerationMask = (1 << cGenerationBits) - 1;
+
+public:
+	/**
+	 * @brief Build the handle.
+	 * 
+	 * @param [in] index The slot index.
+	 * @param [in] generation The generation of slot.
+	 * @return _dword The handle.
+	 */
+	static _dword MakeHandle(_dword index, _dword generation) {
+		return ((generation & cGenerationMask) << cIndexBits) | index;
+	}
+
+	/**
+	 * @brief Get the slot index of handle.
+	 * 
+	 * @param [in] handle The handle.
+	 * @return _dword The slot index.
+	 */
+	static _dword GetIndex(_dword handle) {
+		return handle & cIndexMask;
+	}
+
+	/**
+	 * @brief Get the generation of handle.
+	 * 
+	 * @param [in] handle The handle.
+	 * @return _dword The generation.
+	 */
+	static _dword GetGeneration(_dword handle) {
+		return handle >> cIndexBits;
+	}
+};
+
+/**
+ * @brief The object pool, the objects are stored in the fixed size chunks and the free slots are linked in place.
+ * The objects are referred by 32-bit handles, the handle of destroyed object is rejected by the generation check.
+ * The generation wraps around after 2048 reuses of the same slot, so a very stale handle could be accepted again.
+ * It's not thread safe.
+ * 
+ * @tparam Type The object type.
+ * @tparam ChunkSize The number of objects per chunk.
+ */
+template <typename Type, _dword ChunkSize = 256>
+class ObjectPool {
+	NO_COPY_OPERATIONS(ObjectPool)
+
+	static_assert(alignof(Type) <= 16, "The heap blocks are aligned to 16 bytes only");
+	static_assert(ChunkSize != 0, "The chunk size must not be zero");
+
+private:
+	//!	The slot, the free slot stores the index of next free slot in place.
+	struct Slot {
+		union {
+			_dword mNextFree;
+			alignas(Type) _byte mData[sizeof(Type)];
+		};
+		_dword mGeneration;
+	};
+
+	//!	The chunks.
+	Slot** mChunks;
+	_dword mChunkNumber;
+	//!	The number of slots ever used, the slots after it are not initialized.
+	_dword mSlotNumber;
+	//!	The head of free slots.
+	_dword mFreeHead;
+	//!	The number of alive objects.
+	_dword mNumber;
+
+private:
+	//!	Get the slot.
+	Slot& GetSlot(_dword index) const {
+		return mChunks[index / ChunkSize][index % ChunkSize];
+	}
+	//!	Get the slot of handle, null indicates the handle is stale or invalid.
+	Slot* GetAliveSlot(_dword handle) const;
+	//!	Take a free slot, -1 indicates the pool is full.
+	_dword AllocSlot();
+	//!	Return the slot to the free list.
+	_void FreeSlot(_dword index);
+
+public:
+	ObjectPool();
+	~ObjectPool();
+
+public:
+	/**
+	 * @brief Create an object.
+	 * 
+	 * @param [in] arguments The arguments of constructor.
+	 * @return _dword The handle, cNullHandle indicates the pool is full.
+	 */
+	template <typename... Arguments>
+	_dword Create(Arguments&&... arguments);
+
+	/**
+	 * @brief Destroy the object.
+	 * 
+	 * @param [in] handle The handle.
+	 * @return _boolean True indicates success, false indicates the handle is stale or invalid.
+	 */
+	_boolean Destroy(_dword handle);
+
+	/**
+	 * @brief Get the object.
+	 * 
+	 * @param [in] handle The handle.
+	 * @return Type* The object, null indicates the handle is stale or invalid.
+	 */
+	Type* Get(_dword handle) const;
+
+	/**
+	 * @brief Check whether the object is alive.
+	 * 
+	 * @param [in] handle The handle.
+	 * @return _boolean True indicates the object is alive.
+	 */
+	_boolean IsValid(_dword handle) const;
+
+	/**
+	 * @brief Get the number of alive objects.
+	 * 
+	 * @return _dword The number of objects.
+	 */
+	_dword GetNumber() const;
+
+	/**
+	 * @brief Visit the alive objects in the order of slots.
+	 * 
+	 * @param [in] func The function of (_dword handle, Type& object).
+	 * @return _void 
+	 */
+	template <typename Func>
+	_void ForEach(Func&& func);
+
+	/**
+	 * @brief Destroy all objects, the chunks are kept for reusing and the old handles are stale.
+	 * 
+	 * @return _void 
+	 */
+	_void Clear();
+};
+
+#pragma region "ObjectPool Implementation"
+
+template <typename Type, _dword ChunkSize>
+ObjectPool<Type, ChunkSize>::ObjectPool() {
+	mChunks = _null;
+	mChunkNumber = 0;
+	mSlotNumber = 0;
+	mFreeHead = -1;
+	mNumber = 0;
+}
+
+template <typename Type, _dword ChunkSize>
+ObjectPool<Type, ChunkSize>::~ObjectPool() {
+	Clear();
+
+	for (_dword i = 0; i < mChunkNumber; i++)
+		Platform::HeapFree(mChunks[i]);
+
+	Platform::HeapFree(mChunks);
+}
+
+template <typename Type, _dword ChunkSize>
+typename ObjectPool<Type, ChunkSize>::Slot* ObjectPool<Type, ChunkSize>::GetAliveSlot(_dword handle) const {
+	_dword index = ObjectPoolHelper::GetIndex(handle);
+	_dword generation = ObjectPoolHelper::GetGeneration(handle);
+
+	// The alive generation is odd, so the null handle never matches
+	if (index >= mSlotNumber || (generation & 1) == 0)
+		return _null;
+
+	Slot& slot = GetSlot(index);
+	if ((slot.mGeneration & ObjectPoolHelper::cGenerationMask) != generation)
+		return _null;
+
+	return &slot;
+}
+
+template <typename Type, _dword ChunkSize>
+_dword ObjectPool<Type, ChunkSize>::AllocSlot() {
+	if (mFreeHead != (_dword)-1) {
+		_dword index = mFreeHead;
+		mFreeHead = GetSlot(index).mNextFree;
+		return index;
+	}
+
+	if (mSlotNumber == ObjectPoolHelper::cMaxSlotNumber)
+		return -1;
+
+	// Add a chunk when the last one is used up
+	if (mSlotNumber == mChunkNumber * ChunkSize) {
+		Slot** chunks = (Slot**)Platform::HeapReAlloc(mChunks, (mChunkNumber + 1) * sizeof(Slot*));
+		if (chunks == _null)
+			return -1;
+
+		mChunks = chunks;
+
+		Slot* chunk = (Slot*)Platform::HeapAlloc(ChunkSize * sizeof(Slot));
+		if (chunk == _null)
+			return -1;
+
+		mChunks[mChunkNumber++] = chunk;
+	}
+
+	_dword index = mSlotNumber++;
+	GetSlot(index).mGeneration = 0;
+
+	return index;
+}
+
+template <typename Type, _dword ChunkSize>
+_void ObjectPool<Type, ChunkSize>::FreeSlot(_dword index) {
+	GetSlot(index).mNextFree = mFreeHead;
+	mFreeHead = index;
+}
+
+template <typename Type, _dword ChunkSize>
+template <typename... Arguments>
+_dword ObjectPool<Type, ChunkSize>::Create(Arguments&&... arguments) {
+	_dword index = AllocSlot();
+	if (index == (_dword)-1)
+		return ObjectPoolHelper::cNullHandle;
+
+	Slot& slot = GetSlot(index);
+
+	// The placement new could not go through the tracking 'new' macro, the slot is still dead if the constructor throws
+#pragma push_macro("new")
+#undef new
+	try {
+		::new ((_void*)slot.mData) Type(std::forward<Arguments>(arguments)...);
+	} catch (...) {
+		FreeSlot(index);
+		throw;
+	}
+#pragma pop_macro("new")
+
+	slot.mGeneration++;
+	mNumber++;
+
+	return ObjectPoolHelper::MakeHandle(index, slot.mGeneration);
+}
+
+template <typename Type, _dword ChunkSize>
+_boolean ObjectPool<Type, ChunkSize>::Destroy(_dword handle) {
+	Slot* slot = GetAliveSlot(handle);
+	if (slot == _null)
+		return _false;
+
+	((Type*)slot->mData)->~Type();
+
+	slot->mGeneration++;
+	FreeSlot(ObjectPoolHelper::GetIndex(handle));
+	mNumber--;
+
+	return _true;
+}
+
+template <typename Type, _dword ChunkSize>
+Type* ObjectPool<Type, ChunkSize>::Get(_dword handle) const {
+	Slot* slot = GetAliveSlot(handle);
+	if (slot == _null)
+		return _null;
+
+	return (Type*)slot->mData;
+}
+
+template <typename Type, _dword ChunkSize>
+_boolean ObjectPool<Type, ChunkSize>::IsValid(_dword handle) const {
+	return GetAliveSlot(handle) != _null;
+}
+
+template <typename Type, _dword ChunkSize>
+_dword ObjectPool<Type, ChunkSize>::GetNumber() const {
+	return mNumber;
+}
+
+template <typename Type, _dword ChunkSize>
+template <typename Func>
+_void ObjectPool<Type, ChunkSize>::ForEach(Func&& func) {
+	for (_dword i = 0; i < mChunkNumber; i++) {
+		Slot* chunk = mChunks[i];
+		_dword number = MIN(mSlotNumber - i * ChunkSize, ChunkSize);
+
+		for (_dword j = 0; j < number; j++) {
+			Slot& slot = chunk[j];
+			if ((slot.mGeneration & 1) != 0)
+				func(ObjectPoolHelper::MakeHandle(i * ChunkSize + j, slot.mGeneration), *(Type*)slot.mData);
+		}
+	}
+}
+
+template <typename Type, _dword ChunkSize>
+_void ObjectPool<Type, ChunkSize>::Clear() {
+	// The slots are kept with the increased generations, so the old handles are still rejected
+	mFreeHead = -1;
+
+	for (_dword i = mSlotNumber; i > 0; i--) {
+		Slot& slot = GetSlot(i - 1);
+		if ((slot.mGeneration & 1) != 0) {
+			((Type*)slot.mData)->~Type();
+			slot.mGeneration++;
+		}
+
+		slot.mNextFree = mFreeHead;
+		mFreeHead = i - 1;
+	}
+
+	mNumber = 0;
+}
+
+#pragma endregion
+
+} // namespace E3D
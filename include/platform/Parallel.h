@@ -0,0 +1,241 @@
+/**
+ * @file Parallel.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The parallel algorithms running on the job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The parallel helper, the range is split into chunks and the workers take the chunks one by one.
+ * Only few jobs are submitted, every job keeps taking the next chunk, so the fast workers take more chunks.
+ * 
+ */
+class ParallelHelper {
+public:
+	//!	The number of chunks per worker when the grain size is automatic, the more chunks the better balance.
+	static const _dword cChunkNumberPerWorker = 4;
+	//!	The maximum number of chunks, the grain size is increased for the large range.
+	static const _dword cMaxChunkNumber = 1024;
+	//!	The minimum number of elements to sort in parallel, the small array is sorted in the caller thread.
+	static const _dword cMinParallelSortNumber = 4096;
+	//!	The maximum number of sorted chunks to merge.
+	static const _dword cMaxSortChunkNumber = 64;
+
+private:
+	/**
+	 * @brief The dispatch context, it's on the stack of caller.
+	 * 
+	 */
+	template <typename ChunkFunc>
+	struct DispatchContext {
+		ChunkFunc* mFunc;
+		_dword mChunkNumber;
+		Atomic<_dword> mNextChunk;
+	};
+
+private:
+	//!	Run the chunks until all of them have been taken.
+	template <typename ChunkFunc>
+	static _void RunChunks(DispatchContext<ChunkFunc>* context) {
+		while (_true) {
+			_dword chunk = context->mNextChunk.FetchAdd(1, MemoryOrder::Relaxed);
+			if (chunk >= context->mChunkNumber)
+				break;
+
+			(*context->mFunc)(chunk);
+		}
+	}
+
+	//!	The job to run chunks.
+	template <typename ChunkFunc>
+	static _void OnChunkJob(_void* parameter) {
+		RunChunks((DispatchContext<ChunkFunc>*)parameter);
+	}
+
+public:
+	/**
+	 * @brief Get the grain size.
+	 * 
+	 * @param [in] number The number of elements.
+	 * @param [in] grain The grain size, 0 indicates it's chosen by the number of workers.
+	 * @return _dword The grain size, the number of chunks never exceeds cMaxChunkNumber.
+	 */
+	static _dword GetGrainSize(_dword number, _dword grain) {
+		if (grain == 0) {
+			_dword chunk_number = (JobSystem::GetWorkerNumber() + 1) * cChunkNumberPerWorker;
+			grain = number / chunk_number + (number % chunk_number != 0 ? 1 : 0);
+		}
+
+		_dword min_grain = number / cMaxChunkNumber + (number % cMaxChunkNumber != 0 ? 1 : 0);
+		return MAX(MAX(grain, min_grain), (_dword)1);
+	}
+
+	/**
+	 * @brief Get the number of chunks.
+	 * 
+	 * @param [in] number The number of elements.
+	 * @param [in] grain The grain size returned by GetGrainSize().
+	 * @return _dword The number of chunks.
+	 */
+	static _dword GetChunkNumber(_dword number, _dword grain) {
+		return number / grain + (number % grain != 0 ? 1 : 0);
+	}
+
+	/**
+	 * @brief Run the chunks on workers and wait for them, the caller thread runs the chunks as well.
+	 * It runs in the caller thread only if the job system is not initialized.
+	 * 
+	 * @param [in] chunk_number The number of chunks.
+	 * @param [in] func The chunk function, it's called as func(_dword chunk).
+	 * @return _void 
+	 */
+	template <typename ChunkFunc>
+	static _void Dispatch(_dword chunk_number, ChunkFunc& func) {
+		DispatchContext<ChunkFunc> context;
+		context.mFunc = &func;
+		context.mChunkNumber = chunk_number;
+
+		_dword job_number = MIN(chunk_number, JobSystem::GetWorkerNumber() + 1) - 1;
+		if (chunk_number == 0 || job_number == 0) {
+			RunChunks(&context);
+			return;
+		}
+
+		JobCounter counter;
+		for (_dword i = 0; i < job_number; i++)
+			JobSystem::Run(OnChunkJob<ChunkFunc>, &context, &counter);
+
+		RunChunks(&context);
+
+		// The jobs could still be running the last chunks
+		JobSystem::Wait(counter);
+	}
+};
+
+/**
+ * @brief Run the function over the index range in parallel.
+ * 
+ * @param [in] start_index The start index.
+ * @param [in] end_index The end index, it's excluded.
+ * @param [in] grain The number of indices per chunk, 0 indicates it's chosen by the number of workers.
+ * @param [in] func The function, it's called as func(_dword chunk_start_index, _dword chunk_end_index) for every chunk.
+ * @return _void 
+ */
+template <typename Func>
+_void ParallelFor(_dword start_index, _dword end_index, _dword grain, Func func) {
+	if (start_index >= end_index)
+		return;
+
+	_dword number = end_index - start_index;
+	grain = ParallelHelper::GetGrainSize(number, grain);
+
+	auto chunk_func = [&](_dword chunk) {
+		_dword chunk_start_index = start_index + chunk * grain;
+		func(chunk_start_index, chunk_start_index + MIN(grain, end_index - chunk_start_index));
+	};
+
+	ParallelHelper::Dispatch(ParallelHelper::GetChunkNumber(number, grain), chunk_func);
+}
+
+/**
+ * @brief Reduce the index range in parallel.
+ * The chunk results are reduced in the order of chunks, so the result is deterministic for the same grain size.
+ * 
+ * @param [in] start_index The start index.
+ * @param [in] end_index The end index, it's excluded.
+ * @param [in] grain The number of indices per chunk, 0 indicates it's chosen by the number of workers.
+ * @param [in] identity The identity value of reduction, such as 0 for sum.
+ * @param [in] map_func The function to compute the chunk result, it's called as map_func(_dword chunk_start_index, _dword chunk_end_index).
+ * @param [in] reduce_func The function to combine two results, it's called as reduce_func(const Type& left, const Type& right).
+ * @return Type The result.
+ */
+template <typename Type, typename MapFunc, typename ReduceFunc>
+Type ParallelReduce(_dword start_index, _dword end_index, _dword grain, const Type& identity, MapFunc map_func, ReduceFunc reduce_func) {
+	if (start_index >= end_index)
+		return identity;
+
+	_dword number = end_index - start_index;
+	grain = ParallelHelper::GetGrainSize(number, grain);
+
+	_dword chunk_number = ParallelHelper::GetChunkNumber(number, grain);
+	Type* results = new Type[chunk_number];
+
+	auto chunk_func = [&](_dword chunk) {
+		_dword chunk_start_index = start_index + chunk * grain;
+		results[chunk] = map_func(chunk_start_index, chunk_start_index + MIN(grain, end_index - chunk_start_index));
+	};
+
+	ParallelHelper::Dispatch(chunk_number, chunk_func);
+
+	Type result = identity;
+	for (_dword i = 0; i < chunk_number; i++)
+		result = reduce_func(result, results[i]);
+
+	delete[] results;
+
+	return result;
+}
+
+/**
+ * @brief Sort the elements in parallel, the chunks are sorted by workers and merged pairwise.
+ * It's not stable, the equal elements could be reordered.
+ * 
+ * @param [in] elements The elements.
+ * @param [in] number The number of elements.
+ * @param [in] compare The less-than compare function, it's called as compare(const Type& left, const Type& right).
+ * @return _void 
+ */
+template <typename Type, typename CompareFunc>
+_void ParallelSort(Type* elements, _dword number, CompareFunc compare) {
+	_dword max_chunk_number = MIN(JobSystem::GetWorkerNumber() + 1, ParallelHelper::cMaxSortChunkNumber);
+	if (number < ParallelHelper::cMinParallelSortNumber || max_chunk_number == 1) {
+		std::sort(elements, elements + number, compare);
+		return;
+	}
+
+	// The number of chunks is the power of 2, so they're merged pairwise in rounds
+	_dword chunk_number = 1;
+	while (chunk_number < max_chunk_number)
+		chunk_number <<= 1;
+
+	auto get_bound = [&](_dword chunk) {
+		return elements + (_dword)((_qword)number * chunk / chunk_number);
+	};
+
+	auto sort_func = [&](_dword chunk) {
+		std::sort(get_bound(chunk), get_bound(chunk + 1), compare);
+	};
+
+	ParallelHelper::Dispatch(chunk_number, sort_func);
+
+	for (_dword width = 1; width < chunk_number; width <<= 1) {
+		auto merge_func = [&](_dword merge) {
+			_dword chunk = merge * width * 2;
+			std::inplace_merge(get_bound(chunk), get_bound(chunk + width), get_bound(chunk + width * 2), compare);
+		};
+
+		ParallelHelper::Dispatch(chunk_number / (width * 2), merge_func);
+	}
+}
+
+/**
+ * @brief Sort the elements in ascending order in parallel.
+ * 
+ * @param [in] elements The elements.
+ * @param [in] number The number of elements.
+ * @return _void 
+ */
+template <typename Type>
+_void ParallelSort(Type* elements, _dword number) {
+	ParallelSort(elements, number, [](const Type& left, const Type& right) { return left < right; });
+}
+
+} // namespace E3D
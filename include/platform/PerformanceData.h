@@ -0,0 +1,138 @@
+/**
+ * @file PerformanceData.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The sharded statistics counters and the performance data.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The sharded counter, every thread adds to its own cache line and the shards are aggregated on read.
+ * It's for the statistics which are written frequently by many threads and read rarely.
+ * It's cache-line aligned, declare it as global or member variable, the heap allocation does not honor the alignment.
+ * 
+ */
+class ShardedCounter {
+	NO_COPY_OPERATIONS(ShardedCounter)
+
+public:
+	//!	The number of shards, the threads share the shard when there are more threads than it.
+	static const _dword cShardNumber = 64;
+
+private:
+	/**
+	 * @brief The shard owns a whole cache line.
+	 * 
+	 */
+	struct CACHE_ALIGNED Shard {
+		Atomic<_qword> mValue;
+	};
+
+private:
+	Shard mShards[cShardNumber];
+
+private:
+	//!	Get the shard index of current thread.
+	static _dword GetShardIndex();
+
+public:
+	//!	It's constant-initialized, so the global counter is ready before any constructor runs.
+	constexpr ShardedCounter() {
+	}
+
+public:
+	/**
+	 * @brief Add to the counter.
+	 * 
+	 * @param [in] value The value to add.
+	 * @return _void 
+	 */
+	_void Add(_qword value);
+
+	/**
+	 * @brief Increase the counter by 1.
+	 * 
+	 * @return _void 
+	 */
+	_void Increase();
+
+	/**
+	 * @brief Get the sum of all shards, it's not a snapshot when the others are adding.
+	 * 
+	 * @return _qword The value.
+	 */
+	_qword GetValue() const;
+
+	/**
+	 * @brief Reset the counter to zero, the concurrent adding could be lost.
+	 * 
+	 * @return _void 
+	 */
+	_void Reset();
+};
+
+/**
+ * @brief The performance data of platform, all counters are accumulated since the process started (or reset).
+ * 
+ */
+struct PerformanceData {
+	/**
+	 * @brief The number of jobs executed by the job system.
+	 * 
+	 */
+	ShardedCounter mJobNumber;
+	/**
+	 * @brief The number of jobs stolen from the other workers.
+	 * 
+	 */
+	ShardedCounter mStolenJobNumber;
+	/**
+	 * @brief The number of file read operations.
+	 * 
+	 */
+	ShardedCounter mFileReadNumber;
+	/**
+	 * @brief The total bytes read from files.
+	 * 
+	 */
+	ShardedCounter mFileReadBytes;
+	/**
+	 * @brief The number of file write operations.
+	 * 
+	 */
+	ShardedCounter mFileWriteNumber;
+	/**
+	 * @brief The total bytes written to files.
+	 * 
+	 */
+	ShardedCounter mFileWriteBytes;
+	/**
+	 * @brief The total bytes received from sockets.
+	 * 
+	 */
+	ShardedCounter mSocketReadBytes;
+	/**
+	 * @brief The total bytes sent to sockets.
+	 * 
+	 */
+	ShardedCounter mSocketWriteBytes;
+
+	/**
+	 * @brief Reset all counters.
+	 * 
+	 * @return _void 
+	 */
+	_void Reset();
+};
+
+//!	The global performance data.
+extern PerformanceData gPerformanceData;
+
+} // namespace E3D
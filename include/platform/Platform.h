@@ -71,6 +71,170 @@ public:
 	 */
 	static _void LeaveCriticalSection(_handle object);
 
+	/**
+	 * @brief Set the maximum spin count of a critical section object before it sleeps.
+	 * 
+	 * @param [in] object The critical section object handle.
+	 * @param [in] spincount The maximum spin count, 0 indicates sleep immediately when contended.
+	 * @return _void 
+	 */
+	static _void SetCriticalSectionSpinCount(_handle object, _dword spincount);
+
+	/**
+	 * @brief Get the contention statistics of a critical section object.
+	 * 
+	 * @param [in] object The critical section object handle.
+	 * @param [out] data The contention statistics.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean GetCriticalSectionContention(_handle object, LockContentionData& data);
+
+	/**
+	 * @brief Reset the contention statistics of a critical section object.
+	 * 
+	 * @param [in] object The critical section object handle.
+	 * @return _void 
+	 */
+	static _void ResetCriticalSectionContention(_handle object);
+
+#pragma endregion
+
+#pragma region "Read Write Lock"
+
+	/**
+	 * @brief Create a read-write lock object, the readers are counted on per-thread slots (sized by the processors) to scale on many cores.
+	 * The slot is chosen by the calling thread, so the read lock must be released on the thread which acquired it.
+	 * The pending writer blocks the new readers, so the read lock is not recursive.
+	 * 
+	 * @return _handle The read-write lock object handle.
+	 */
+	static _handle CreateReadWriteLock();
+
+	/**
+	 * @brief Delete a read-write lock object.
+	 * 
+	 * @param [in] object The read-write lock object handle.
+	 * @return _void 
+	 */
+	static _void DeleteReadWriteLock(_handle object);
+
+	/**
+	 * @brief Enter a read-write lock object in shared mode.
+	 * 
+	 * @param [in] object The read-write lock object handle.
+	 * @return _void 
+	 */
+	static _void EnterReadLock(_handle object);
+
+	/**
+	 * @brief Try to enter a read-write lock object in shared mode without blocking.
+	 * 
+	 * @param [in] object The read-write lock object handle.
+	 * @return _boolean True indicates entered, false indicates a writer owns (or waits for) it.
+	 */
+	static _boolean TryEnterReadLock(_handle object);
+
+	/**
+	 * @brief Leave a read-write lock object in shared mode, it must be called on the thread which entered it.
+	 * 
+	 * @param [in] object The read-write lock object handle.
+	 * @return _void 
+	 */
+	static _void LeaveReadLock(_handle object);
+
+	/**
+	 * @brief Enter a read-write lock object in exclusive mode.
+	 * 
+	 * @param [in] object The read-write lock object handle.
+	 * @return _void 
+	 */
+	static _void EnterWriteLock(_handle object);
+
+	/**
+	 * @brief Leave a read-write lock object in exclusive mode.
+	 * 
+	 * @param [in] object The read-write lock object handle.
+	 * @return _void 
+	 */
+	static _void LeaveWriteLock(_handle object);
+
+#pragma endregion
+
+#pragma region "Condition Variable"
+
+	/**
+	 * @brief Create the condition variable, it works with the critical section.
+	 * 
+	 * @return _handle The condition variable handle.
+	 */
+	static _handle CreateConditionVariable();
+
+	/**
+	 * @brief Delete the condition variable, nobody could be sleeping on it.
+	 * 
+	 * @param [in] object The condition variable handle.
+	 * @return _void 
+	 */
+	static _void DeleteConditionVariable(_handle object);
+
+	/**
+	 * @brief Release the critical section and sleep until woken up or time out, then acquire the critical section again.
+	 * It could wake up spuriously, always check the condition in loop.
+	 * 
+	 * @param [in] object The condition variable handle.
+	 * @param [in] critical_section The critical section owned by current thread, it's released even if it's entered recursively.
+	 * @param [in] nanoseconds The time-out interval in nanoseconds, -1 indicates infinite.
+	 * @return _boolean False indicates time out, true indicates woken up.
+	 */
+	static _boolean SleepConditionVariable(_handle object, _handle critical_section, _qword nanoseconds);
+
+	/**
+	 * @brief Wake a thread sleeping on the condition variable.
+	 * 
+	 * @param [in] object The condition variable handle.
+	 * @return _void 
+	 */
+	static _void WakeConditionVariable(_handle object);
+
+	/**
+	 * @brief Wake all threads sleeping on the condition variable.
+	 * 
+	 * @param [in] object The condition variable handle.
+	 * @return _void 
+	 */
+	static _void WakeAllConditionVariable(_handle object);
+
+#pragma endregion
+
+#pragma region "Wait On Address"
+
+	/**
+	 * @brief Sleep while the value at the address equals to the compare value, it's the futex or WaitOnAddress() of OS.
+	 * It could wake up spuriously, always check the value in loop.
+	 * 
+	 * @param [in] address The address to wait, it must be 4 bytes aligned.
+	 * @param [in] compare The value to compare.
+	 * @param [in] nanoseconds The time-out interval in nanoseconds, -1 indicates infinite.
+	 * @return _boolean False indicates time out, true indicates the value has changed or woken up.
+	 */
+	static _boolean WaitOnAddress(_dword* address, _dword compare, _qword nanoseconds);
+
+	/**
+	 * @brief Wake a thread sleeping on the address.
+	 * 
+	 * @param [in] address The address.
+	 * @return _void 
+	 */
+	static _void WakeByAddressSingle(_dword* address);
+
+	/**
+	 * @brief Wake all threads sleeping on the address.
+	 * 
+	 * @param [in] address The address.
+	 * @return _void 
+	 */
+	static _void WakeByAddressAll(_dword* address);
+
 #pragma endregion
 
 #pragma region "Single Object"
@@ -84,6 +248,16 @@ public:
 	 */
 	static _boolean WaitForSingleObject(_handle object, _dword milliseconds);
 
+	/**
+	 * @brief Waits until the specified object is in the signaled state or the time-out interval elapses.
+	 * It's not an overload of WaitForSingleObject(), the integer literals would be ambiguous.
+	 * 
+	 * @param [in] object A handle to the object.
+	 * @param [in] nanoseconds The time-out interval in nanoseconds, -1 indicates infinite.
+	 * @return _boolean True if the object is signaled before time out, false otherwise.
+	 */
+	static _boolean WaitForSingleObjectNanoseconds(_handle object, _qword nanoseconds);
+
 	/**
 	 * @brief Clone event object.
 	 * 
@@ -137,6 +311,67 @@ public:
 	 */
 	static _void Sleep(_dword milliseconds);
 
+	/**
+	 * @brief Get the IDs of all threads in current process.
+	 * 
+	 * @param [out] threadids The thread IDs.
+	 * @param [in] number The maximum number of thread IDs.
+	 * @return _dword The number of thread IDs, the others are ignored if there are more threads.
+	 */
+	static _dword GetProcessThreadIDs(_thread_id* threadids, _dword number);
+
+	/**
+	 * @brief Get the accumulated scheduling data of thread in current process.
+	 * 
+	 * @param [in] threadid The thread ID.
+	 * @param [out] data The scheduling data.
+	 * @return _boolean True indicates success, false indicates the thread has exited.
+	 */
+	static _boolean GetThreadSchedulingData(_thread_id threadid, ThreadSchedulingData& data);
+
+#pragma endregion
+
+#pragma region "Thread Local Storage"
+
+	/**
+	 * @brief The destructor of TLS value, it's called at thread exit for the non-null value, including the value set by the thread_local destructors.
+	 * 
+	 */
+	typedef _void (*OnTLSDestructorProc)(_void* value);
+
+	/**
+	 * @brief Allocate a TLS slot, the value is null in all threads.
+	 * 
+	 * @param [in] destructor The destructor of value, it could be null.
+	 * @return _dword The slot, 0 indicates there is no free slot.
+	 */
+	static _dword AllocTLS(OnTLSDestructorProc destructor);
+
+	/**
+	 * @brief Free the TLS slot, the destructor is not called for the values left in threads.
+	 * 
+	 * @param [in] slot The slot.
+	 * @return _void 
+	 */
+	static _void FreeTLS(_dword slot);
+
+	/**
+	 * @brief Get the value of current thread.
+	 * 
+	 * @param [in] slot The slot.
+	 * @return _void* The value, null indicates it has not been set.
+	 */
+	static _void* GetTLSValue(_dword slot);
+
+	/**
+	 * @brief Set the value of current thread.
+	 * 
+	 * @param [in] slot The slot.
+	 * @param [in] value The value.
+	 * @return _boolean True indicates success, false indicates the slot is invalid.
+	 */
+	static _boolean SetTLSValue(_dword slot, _void* value);
+
 #pragma endregion
 
 #pragma region "Endian"
@@ -173,6 +408,72 @@ public:
 	 */
 	static _float GetCurrentCPUUsage();
 
+	/**
+	 * @brief Get the CPU topology, it's discovered when it's called for the first time.
+	 * 
+	 * @return const CPUTopology& The CPU topology.
+	 */
+	static const CPUTopology& GetCPUTopology();
+
+	/**
+	 * @brief Get the logical CPUs of NUMA node.
+	 * 
+	 * @param [in] node The NUMA node index.
+	 * @param [out] cpuset The logical CPUs.
+	 * @return _boolean True indicates success, false indicates the node does not exist.
+	 */
+	static _boolean GetNodeCPUSet(_dword node, CPUSet& cpuset);
+
+	/**
+	 * @brief Get the logical CPU which current thread is running on.
+	 * 
+	 * @return _dword The CPU index.
+	 */
+	static _dword GetCurrentProcessorIndex();
+
+	/**
+	 * @brief Get the NUMA node which current thread is running on.
+	 * 
+	 * @return _dword The NUMA node index.
+	 */
+	static _dword GetCurrentNode();
+
+	/**
+	 * @brief Set the logical CPUs which the thread could run on.
+	 * 
+	 * @param [in] thread The thread handle, null indicates current thread.
+	 * @param [in] cpuset The logical CPUs.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean SetThreadAffinity(_handle thread, const CPUSet& cpuset);
+
+	/**
+	 * @brief Get the logical CPUs which the thread could run on.
+	 * 
+	 * @param [in] thread The thread handle, null indicates current thread.
+	 * @param [out] cpuset The logical CPUs.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean GetThreadAffinity(_handle thread, CPUSet& cpuset);
+
+	/**
+	 * @brief Set the logical CPUs which the process could run on.
+	 * 
+	 * @param [in] process The process handle, null indicates current process.
+	 * @param [in] cpuset The logical CPUs.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean SetProcessAffinity(_handle process, const CPUSet& cpuset);
+
+	/**
+	 * @brief Get the logical CPUs which the process could run on.
+	 * 
+	 * @param [in] process The process handle, null indicates current process.
+	 * @param [out] cpuset The logical CPUs.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean GetProcessAffinity(_handle process, CPUSet& cpuset);
+
 #pragma endregion
 
 #pragma region "Memory"
@@ -196,13 +497,13 @@ public:
 	static _charw* HeapAllocStr(const _charw* string, _handle heap = _null);
 
 	/**
-	 * @brief Allocate memory from heap.
+	 * @brief Allocate memory from heap, the block is charged to the memory tag of current thread.
 	 * 
 	 * @param [in] size The size of memory will be allocated in number of bytes.
 	 * @param [in] heap The process heap handle, null indicates use the current process heap handle.
-	 * @return _void* The pointer to the allocated memory block.
+	 * @return _void* The pointer to the allocated memory block, null indicates failure or the tag exceeds its hard budget.
 	 */
-	static _void* HeapAlloc(_dword size, _handle heap = _null);
+	static _void* HeapAlloc(_qword size, _handle heap = _null);
 
 	/**
 	 * @brief Reallocate memory from heap.
@@ -212,7 +513,7 @@ public:
 	 * @param [in] heap The process heap handle, null indicates use the current process heap handle.
 	 * @return _void* The pointer to the allocated memory block.
 	 */
-	static _void* HeapReAlloc(_void* pointer, _dword size, _handle heap = _null);
+	static _void* HeapReAlloc(_void* pointer, _qword size, _handle heap = _null);
 
 	/**
 	 * @brief Frees a memory block allocated from heap.
@@ -223,6 +524,44 @@ public:
 	 */
 	static _void HeapFree(_void* pointer, _handle heap = _null);
 
+	/**
+	 * @brief Allocate aligned memory from heap.
+	 * 
+	 * @param [in] size The size of memory will be allocated in number of bytes.
+	 * @param [in] alignment The alignment in bytes, it must be power of 2, such as 16 for SSE, 32 for AVX, 64 for cache line and 4096 for page.
+	 * @param [in] heap The process heap handle, null indicates use the current process heap handle.
+	 * @return _void* The pointer to the allocated memory block, null indicates failure or the alignment is invalid.
+	 */
+	static _void* HeapAllocAligned(_qword size, _dword alignment, _handle heap = _null);
+
+	/**
+	 * @brief Reallocate aligned memory from heap, the new block keeps the alignment.
+	 * 
+	 * @param [in] pointer The pointer to the memory block to be reallocated, null indicates allocate a new one.
+	 * @param [in] size The size of memory will be allocated in number of bytes, 0 indicates free the block.
+	 * @param [in] alignment The alignment in bytes, it must be power of 2.
+	 * @param [in] heap The process heap handle, null indicates use the current process heap handle.
+	 * @return _void* The pointer to the allocated memory block, null indicates failure and the old block is kept.
+	 */
+	static _void* HeapReAllocAligned(_void* pointer, _qword size, _dword alignment, _handle heap = _null);
+
+	/**
+	 * @brief Frees a memory block allocated by HeapAllocAligned() or HeapReAllocAligned().
+	 * 
+	 * @param [in] pointer The pointer to the memory block to be freed.
+	 * @param [in] heap The process heap handle, null indicates use the current process heap handle.
+	 * @return _void 
+	 */
+	static _void HeapFreeAligned(_void* pointer, _handle heap = _null);
+
+	/**
+	 * @brief Get the memory tag which the heap block is charged to, the reallocated block keeps its tag.
+	 * 
+	 * @param [in] pointer The pointer to the memory block allocated from heap.
+	 * @return MemoryTag The tag.
+	 */
+	static MemoryTag GetHeapBlockTag(const _void* pointer);
+
 	/**
 	 * @brief Get the global heap handle.
 	 * 
@@ -237,6 +576,110 @@ public:
 	 */
 	static _handle GetVirtualHeap();
 
+	/**
+	 * @brief Allocate pages on the NUMA node, it falls back to the other nodes when the node runs out of memory.
+	 * 
+	 * @param [in] size The size in bytes, it's rounded up to pages.
+	 * @param [in] node The NUMA node index, -1 indicates the node of current thread.
+	 * @return _void* The pointer to the allocated pages, null indicates failure.
+	 */
+	static _void* AllocOnNode(_qword size, _dword node);
+
+	/**
+	 * @brief Free the pages allocated by AllocOnNode().
+	 * 
+	 * @param [in] pointer The pointer to the pages.
+	 * @param [in] size The size in bytes, it must be the same as allocated.
+	 * @return _void 
+	 */
+	static _void FreeOnNode(_void* pointer, _qword size);
+
+	/**
+	 * @brief Set the preferred NUMA node of the memory allocated by current thread, the pages are placed on it when touched first.
+	 * 
+	 * @param [in] node The NUMA node index, -1 indicates the local allocation (the node the thread is running on).
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean SetPreferredNode(_dword node);
+
+	/**
+	 * @brief Get the page size.
+	 * 
+	 * @return _dword The page size in bytes.
+	 */
+	static _dword GetPageSize();
+
+	/**
+	 * @brief Get the large (huge) page size.
+	 * 
+	 * @return _dword The large page size in bytes, it's 2MB on the most platforms.
+	 */
+	static _dword GetLargePageSize();
+
+	/**
+	 * @brief Reserve the address range, the pages are not accessible until they're committed.
+	 * 
+	 * @param [in] size The size in bytes, it's rounded up to pages.
+	 * @param [in] alignment The alignment of address, it must be power of 2, 0 indicates the page size.
+	 * @return _void* The start address, null indicates failure.
+	 */
+	static _void* ReserveVirtualMemory(_qword size, _qword alignment = 0);
+
+	/**
+	 * @brief Commit the pages in the reserved range, they're zero filled and backed by physical memory when touched first.
+	 * 
+	 * @param [in] pointer The start address, it must be aligned to page.
+	 * @param [in] size The size in bytes, it's rounded up to pages.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean CommitVirtualMemory(_void* pointer, _qword size);
+
+	/**
+	 * @brief Decommit the pages, the physical memory is returned to the system but the address range is kept reserved.
+	 * 
+	 * @param [in] pointer The start address, it must be aligned to page.
+	 * @param [in] size The size in bytes, it's rounded up to pages.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean DecommitVirtualMemory(_void* pointer, _qword size);
+
+	/**
+	 * @brief Release the address range reserved by ReserveVirtualMemory().
+	 * 
+	 * @param [in] pointer The start address.
+	 * @param [in] size The size in bytes, it must be the same as reserved.
+	 * @return _void 
+	 */
+	static _void ReleaseVirtualMemory(_void* pointer, _qword size);
+
+	/**
+	 * @brief Give the access pattern hint of the pages.
+	 * 
+	 * @param [in] pointer The start address, it must be aligned to page.
+	 * @param [in] size The size in bytes.
+	 * @param [in] advice The access pattern.
+	 * @return _boolean True indicates success, false indicates the hint is not supported.
+	 */
+	static _boolean AdviseVirtualMemory(_void* pointer, _qword size, VirtualMemoryAdvice advice);
+
+	/**
+	 * @brief Allocate the committed pages backed by large pages.
+	 * 
+	 * @param [in] size The size in bytes, it's rounded up to large pages.
+	 * @param [in] explicit_pages True indicates try the pages reserved by system first (hugetlbfs), otherwise use the transparent huge pages.
+	 * @return _void* The pointer aligned to large page, null indicates failure.
+	 */
+	static _void* AllocLargePages(_qword size, _boolean explicit_pages = _false);
+
+	/**
+	 * @brief Free the pages allocated by AllocLargePages().
+	 * 
+	 * @param [in] pointer The pointer to the pages.
+	 * @param [in] size The size in bytes, it must be the same as allocated.
+	 * @return _void 
+	 */
+	static _void FreeLargePages(_void* pointer, _qword size);
+
 #pragma endregion
 
 #pragma region "IO"
@@ -513,6 +956,36 @@ public:
 	//! @return The number of bytes write, 0 indicates finished, -1 indicates failure.
 	static _dword WriteSocket(_socket handle, const _void* buffer, _dword size);
 
+	//! Create socket poller, it waits for many sockets in one thread.
+	//! @return The socket poller handle.
+	static _handle CreateSocketPoller();
+	//! Close socket poller.
+	//! @param poller   The socket poller handle.
+	//! @return none.
+	static _void CloseSocketPoller(_handle poller);
+	//! Watch the socket until it's readable (or closed), the socket is reported once and must be watched again to be reported again.
+	//! @param poller   The socket poller handle.
+	//! @param handle   The socket handle.
+	//! @param userdata  The user data to report.
+	//! @return True indicates success false indicates failure.
+	static _boolean WatchSocketReadable(_handle poller, _socket handle, _void* userdata);
+	//! Stop watching the socket.
+	//! @param poller   The socket poller handle.
+	//! @param handle   The socket handle.
+	//! @return none.
+	static _void UnwatchSocket(_handle poller, _socket handle);
+	//! Wait for the watched sockets.
+	//! @param poller   The socket poller handle.
+	//! @param userdatas  The user data of readable sockets.
+	//! @param number   The max number of user data.
+	//! @param milliseconds The time-out interval, -1 indicates infinite.
+	//! @return The number of readable sockets, 0 indicates timed out or woken up.
+	static _dword WaitSocketPoller(_handle poller, _void** userdatas, _dword number, _dword milliseconds);
+	//! Wake up the thread which is waiting for socket poller.
+	//! @param poller   The socket poller handle.
+	//! @return none.
+	static _void WakeSocketPoller(_handle poller);
+
 	//! Device
 public:
 	//! Check whether key is down or not.
@@ -589,18 +1062,18 @@ public:
 	//! @return A handle to the specified module.
 	static _handle GetModuleHandleW(const _charw* modulename);
 
-	//! Set a processor affinity mask for the specified process.
+	//! Set a processor affinity mask for the specified process, it covers the first 32 CPUs only, see SetProcessAffinity().
 	//! @param processhandle The process handle.
 	//! @param mask   The affinity mask.
 	//! @return True indicates success false indicates failure.
 	static _boolean SetProcessAffinityMask(_handle processhandle, _dword mask);
-	//! Set a processor affinity mask for the specified process.
+	//! Set a processor affinity mask for the specified thread, it covers the first 32 CPUs only, see SetThreadAffinity().
 	//! @param threadhandle The thread handle.
 	//! @param mask   The affinity mask.
 	//! @param prevmask  The previous affinity mask.
 	//! @return True indicates success false indicates failure.
 	static _boolean SetThreadAffinityMask(_handle threadhandle, _dword mask, _dword* prevmask = _null);
-	//! Get a processor affinity mask for the specified process.
+	//! Get a processor affinity mask for the specified process, it covers the first 32 CPUs only, see GetProcessAffinity().
 	//! @param processhandle The process handle.
 	//! @param mask   The affinity mask.
 	//! @param systemmask  The system affinity mask.
@@ -640,6 +1113,8 @@ public:
 	//! Get current thread handle.
 	//! @param none.
 	//! @return The current thread handle.
+	//! @remarks The handle of thread which is not created by CreateThread() is a pseudo handle, it's valid only in the thread
+	//!    itself until the thread exits, and it could not be waited.
 	static _handle GetCurrentThreadHandle();
 
 	//! Set the thread name in ANSI mode.
@@ -908,6 +1383,26 @@ public:
 	//! @param time  The time out in milliseconds.
 	//! @return none.
 	static _void WaitForAttach(_dword time);
+	//! Capture the return addresses of current thread.
+	//! @param frames  The buffer of return addresses, the innermost one is the first.
+	//! @param number  The maximum number of frames.
+	//! @param skip   The number of innermost frames to skip, the caller of this function is not skipped by default.
+	//! @return The number of frames.
+	static _dword CaptureCallStack(_void** frames, _dword number, _dword skip = 0);
+	//! Get the symbol name of address, it's "module!function+offset" or "module+offset" if there is no symbol.
+	//! @param address  The code address.
+	//! @param name   The string buffer of name.
+	//! @param length   The max size of buffer in number of characters.
+	//! @return True indicates success false indicates failure.
+	static _boolean GetSymbolName(const _void* address, _chara* name, _dword length);
+	//! The handler of memory access fault.
+	//! @param address  The faulting address.
+	//! @return none.
+	typedef _void (*OnMemoryFaultProc)(_void* address);
+	//! Set the handler of memory access fault, it's called in the signal handler before the previous handler.
+	//! @param func  The handler, null indicates remove it.
+	//! @return True indicates success false indicates failure.
+	static _boolean SetMemoryFaultHandler(OnMemoryFaultProc func);
 
 	//! Environment
 public:
@@ -1329,28 +1824,28 @@ public:
 	//! @param string   The string buffer.
 	//! @param substring  The substring to be searched.
 	//! @param ignorecase  True indicates case insensitive.
-	//! @param endindex  The end index of searching.
+	//! @param endindex  The index after the found substring, it's untouched if not found.
 	//! @return The index of the first occurrence of the substring or -1 indicates cant find.
 	static _dword SearchL2R(const _chara* string, const _chara* substring, _boolean ignorecase = _false, _dword* endindex = _null);
 	//! Search a substring in the UNICODE string from left to right.
 	//! @param string   The string buffer.
 	//! @param substring  The substring to be searched.
 	//! @param ignorecase  True indicates case insensitive.
-	//! @param endindex  The end index of searching.
+	//! @param endindex  The index after the found substring, it's untouched if not found.
 	//! @return The index of the first occurrence of the substring or -1 indicates cant find.
 	static _dword SearchL2R(const _charw* string, const _charw* substring, _boolean ignorecase = _false, _dword* endindex = _null);
 	//! Search a substring in the ANSI string from right to left.
 	//! @param string   The string buffer.
 	//! @param substring  The substring to be searched.
 	//! @param ignorecase  True indicates case insensitive.
-	//! @param startindex  The start index of searching.
+	//! @param startindex  The index of the found substring, it's untouched if not found.
 	//! @return The index of the first occurrence of the substring or -1 indicates cant find.
 	static _dword SearchR2L(const _chara* string, const _chara* substring, _boolean ignorecase = _false, _dword* startindex = _null);
 	//! Search a substring in the UNICODE string from right to left.
 	//! @param string   The string buffer.
 	//! @param substring  The substring to be searched.
 	//! @param ignorecase  True indicates case insensitive.
-	//! @param startindex  The start index of searching.
+	//! @param startindex  The index of the found substring, it's untouched if not found.
 	//! @return The index of the first occurrence of the substring or -1 indicates cant find.
 	static _dword SearchR2L(const _charw* string, const _charw* substring, _boolean ignorecase = _false, _dword* startindex = _null);
 
@@ -1490,6 +1985,7 @@ public:
 	//! @param string   The UTF-8 string.
 	//! @param number   The number of characters to convert.
 	//! @return The number of characters in bytes (not containers '\0' character bytes).
+	//! @remarks The string is truncated if the buffer is too small, and the size of buffer is returned.
 	static _dword Utf8ToUtf16(_charw* buffer, _dword size, const _chara* string, _dword number = -1);
 	//! Convert an UNICODE string to UTF-8.
 	//! @param buffer   The buffer used to copy string.
@@ -1497,6 +1993,7 @@ public:
 	//! @param string   The UNICODE string.
 	//! @param number   The number of characters to convert.
 	//! @return The number of characters in bytes (not containers '\0' character bytes).
+	//! @remarks The string is truncated if the buffer is too small, and the size of buffer is returned.
 	static _dword Utf16ToUtf8(_chara* buffer, _dword size, const _charw* string, _dword number = -1);
 
 	//! Format ANSI string by format.
@@ -0,0 +1,474 @@
+/**
+ * @file SharedString.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The immutable reference-counted string.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The helper of shared strings.
+ * 
+ */
+class SharedStringHelper {
+public:
+	/**
+	 * @brief Get the unsigned value of character, the ANSI character above 0x7F must not be sign-extended.
+	 * 
+	 * @param [in] character The character.
+	 * @return _dword The character value.
+	 */
+	static _dword GetCharValue(_chara character) {
+		return (_byte)character;
+	}
+	static _dword GetCharValue(_charw character) {
+		return (_word)character;
+	}
+
+	/**
+	 * @brief Get the hash of characters, it's FNV-1a of character values so the ANSI and UNICODE strings have the same hash.
+	 * 
+	 * @param [in] string The characters.
+	 * @param [in] length The number of characters.
+	 * @return _dword The hash.
+	 */
+	template <typename CharType>
+	static _dword GetHash(const CharType* string, _dword length) {
+		_dword hash = 2166136261u;
+		for (_dword i = 0; i < length; i++) {
+			hash ^= GetCharValue(string[i]);
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+};
+
+/**
+ * @brief The immutable string, the copies share the same buffer and the short strings are stored inline without heap allocation.
+ * The length and hash are calculated once at construction, so the comparisons and lookups do not scan the string again.
+ * The sub-string refers to the buffer of source string without copying, it's not null-terminated unless it's the tail.
+ * The object is not thread safe, but the copies could be used in different threads since the reference count is atomic.
+ * 
+ * @tparam CharType The character type.
+ */
+template <typename CharType>
+class SharedString {
+private:
+	//!	The shared buffer, the characters are null-terminated.
+	struct Buffer {
+		Atomic<_dword> mRefCount;
+		_dword mLength;
+		CharType mString[1];
+	};
+
+	//!	The reference to shared buffer.
+	struct SharedData {
+		Buffer* mBuffer;
+		const CharType* mString;
+	};
+
+	//!	The bytes of inline storage.
+	static const _dword cInlineSize = 24;
+
+public:
+	//!	The maximum length of string stored inline.
+	static const _dword cMaxInlineLength = cInlineSize / sizeof(CharType) - 1;
+
+private:
+	//!	The string is inline if the length is not greater than cMaxInlineLength.
+	union {
+		SharedData mShared;
+		CharType mInline[cMaxInlineLength + 1];
+	};
+	_dword mLength;
+	_dword mHash;
+
+private:
+	//!	Check whether the string is stored inline.
+	_boolean IsInline() const {
+		return mLength <= cMaxInlineLength;
+	}
+	//!	Build the string from characters.
+	_void Initialize(const CharType* string, _dword length);
+	//!	Refer to the buffer.
+	_void Share(const SharedString& string);
+	//!	Release the buffer.
+	_void Release();
+
+public:
+	SharedString();
+	SharedString(const CharType* string);
+	SharedString(const CharType* string, _dword length);
+	SharedString(const SharedString& string);
+	SharedString(SharedString&& string);
+	~SharedString();
+
+public:
+	SharedString& operator=(const SharedString& string);
+	SharedString& operator=(SharedString&& string);
+
+	_boolean operator==(const SharedString& string) const;
+	_boolean operator!=(const SharedString& string) const;
+	_boolean operator<(const SharedString& string) const;
+
+	CharType operator[](_dword index) const {
+		return GetData()[index];
+	}
+
+public:
+	/**
+	 * @brief Get the number of characters.
+	 * 
+	 * @return _dword The length.
+	 */
+	_dword GetLength() const {
+		return mLength;
+	}
+
+	/**
+	 * @brief Check whether it's empty.
+	 * 
+	 * @return _boolean True indicates it's empty.
+	 */
+	_boolean IsEmpty() const {
+		return mLength == 0;
+	}
+
+	/**
+	 * @brief Get the hash, it's the same as SharedStringHelper::GetHash().
+	 * 
+	 * @return _dword The hash.
+	 */
+	_dword GetHash() const {
+		return mHash;
+	}
+
+	/**
+	 * @brief Get the characters, they're not null-terminated if it's a sub-string.
+	 * 
+	 * @return const CharType* The characters.
+	 */
+	const CharType* GetData() const {
+		return IsInline() ? mInline : mShared.mString;
+	}
+
+	/**
+	 * @brief Check whether the characters are null-terminated.
+	 * 
+	 * @return _boolean True indicates it's null-terminated.
+	 */
+	_boolean IsTerminated() const {
+		return IsInline() || mShared.mString + mLength == mShared.mBuffer->mString + mShared.mBuffer->mLength;
+	}
+
+	/**
+	 * @brief Get the null-terminated string, see IsTerminated() and GetTerminated().
+	 * 
+	 * @return const CharType* The string.
+	 */
+	const CharType* CStr() const {
+		E3D_ASSERT(IsTerminated());
+		return GetData();
+	}
+
+	/**
+	 * @brief Get the null-terminated copy, the buffer is shared if it's null-terminated already.
+	 * 
+	 * @return SharedString The string.
+	 */
+	SharedString GetTerminated() const;
+
+	/**
+	 * @brief Get the sub-string, it refers to the same buffer unless it's short enough to be stored inline.
+	 * 
+	 * @param [in] start The start index, it's clamped to the length.
+	 * @param [in] length The number of characters, -1 indicates to the end.
+	 * @return SharedString The sub-string.
+	 */
+	SharedString SubString(_dword start, _dword length = -1) const;
+
+	/**
+	 * @brief Compare the strings.
+	 * 
+	 * @param [in] string The string to compare.
+	 * @return _int Less than 0 indicates it's less, 0 indicates they're equal, greater than 0 indicates it's greater.
+	 */
+	_int Compare(const SharedString& string) const;
+
+	/**
+	 * @brief Get the index of the first character.
+	 * 
+	 * @param [in] character The character.
+	 * @param [in] start The index to start from.
+	 * @return _dword The index, -1 indicates not found.
+	 */
+	_dword IndexOf(CharType character, _dword start = 0) const;
+
+	/**
+	 * @brief Get the index of the last character.
+	 * 
+	 * @param [in] character The character.
+	 * @return _dword The index, -1 indicates not found.
+	 */
+	_dword LastIndexOf(CharType character) const;
+
+	/**
+	 * @brief Check whether it starts with the string.
+	 * 
+	 * @param [in] string The prefix.
+	 * @return _boolean True indicates it starts with the string.
+	 */
+	_boolean StartsWith(const SharedString& string) const;
+
+	/**
+	 * @brief Check whether it ends with the string.
+	 * 
+	 * @param [in] string The suffix.
+	 * @return _boolean True indicates it ends with the string.
+	 */
+	_boolean EndsWith(const SharedString& string) const;
+};
+
+//!	The ANSI and UNICODE shared strings.
+typedef SharedString<_chara> SharedStringA;
+typedef SharedString<_charw> SharedStringW;
+
+#pragma region "SharedString Implementation"
+
+template <typename CharType>
+_void SharedString<CharType>::Initialize(const CharType* string, _dword length) {
+	mLength = length;
+	mHash = SharedStringHelper::GetHash(string, length);
+
+	if (IsInline()) {
+		E3D_MEM_CPY(mInline, string, length * sizeof(CharType));
+		mInline[length] = 0;
+		return;
+	}
+
+	// It's empty if the buffer could not be allocated
+	Buffer* buffer = (Buffer*)Platform::HeapAlloc(sizeof(Buffer) + (_qword)length * sizeof(CharType));
+	if (buffer == _null) {
+		mInline[0] = 0;
+		mLength = 0;
+		mHash = SharedStringHelper::GetHash(mInline, 0);
+		return;
+	}
+
+	// The placement new could not go through the tracking 'new' macro
+#pragma push_macro("new")
+#undef new
+	::new ((_void*)&buffer->mRefCount) Atomic<_dword>(1);
+#pragma pop_macro("new")
+
+	buffer->mLength = length;
+	E3D_MEM_CPY(buffer->mString, string, length * sizeof(CharType));
+	buffer->mString[length] = 0;
+
+	mShared.mBuffer = buffer;
+	mShared.mString = buffer->mString;
+}
+
+template <typename CharType>
+_void SharedString<CharType>::Share(const SharedString& string) {
+	mLength = string.mLength;
+	mHash = string.mHash;
+
+	if (string.IsInline()) {
+		E3D_MEM_CPY(mInline, string.mInline, sizeof(mInline));
+		return;
+	}
+
+	mShared = string.mShared;
+	mShared.mBuffer->mRefCount.Increase(MemoryOrder::Relaxed);
+}
+
+template <typename CharType>
+_void SharedString<CharType>::Release() {
+	if (IsInline())
+		return;
+
+	// The last owner sees all writes of the other owners before freeing
+	if (mShared.mBuffer->mRefCount.Decrease(MemoryOrder::AcqRel) == 0)
+		Platform::HeapFree(mShared.mBuffer);
+}
+
+template <typename CharType>
+SharedString<CharType>::SharedString() {
+	mInline[0] = 0;
+	mLength = 0;
+	mHash = SharedStringHelper::GetHash(mInline, 0);
+}
+
+template <typename CharType>
+SharedString<CharType>::SharedString(const CharType* string) {
+	Initialize(string, string != _null ? Platform::StringLength(string) : 0);
+}
+
+template <typename CharType>
+SharedString<CharType>::SharedString(const CharType* string, _dword length) {
+	Initialize(string, length);
+}
+
+template <typename CharType>
+SharedString<CharType>::SharedString(const SharedString& string) {
+	Share(string);
+}
+
+template <typename CharType>
+SharedString<CharType>::SharedString(SharedString&& string) {
+	mLength = string.mLength;
+	mHash = string.mHash;
+	E3D_MEM_CPY(mInline, string.mInline, sizeof(mInline));
+
+	// The source is left empty
+	string.mInline[0] = 0;
+	string.mLength = 0;
+	string.mHash = SharedStringHelper::GetHash(string.mInline, 0);
+}
+
+template <typename CharType>
+SharedString<CharType>::~SharedString() {
+	Release();
+}
+
+template <typename CharType>
+SharedString<CharType>& SharedString<CharType>::operator=(const SharedString& string) {
+	if (this != &string) {
+		Release();
+		Share(string);
+	}
+
+	return *this;
+}
+
+template <typename CharType>
+SharedString<CharType>& SharedString<CharType>::operator=(SharedString&& string) {
+	if (this != &string) {
+		Release();
+
+		mLength = string.mLength;
+		mHash = string.mHash;
+		E3D_MEM_CPY(mInline, string.mInline, sizeof(mInline));
+
+		string.mInline[0] = 0;
+		string.mLength = 0;
+		string.mHash = SharedStringHelper::GetHash(string.mInline, 0);
+	}
+
+	return *this;
+}
+
+template <typename CharType>
+_boolean SharedString<CharType>::operator==(const SharedString& string) const {
+	if (mLength != string.mLength || mHash != string.mHash)
+		return _false;
+
+	const CharType* data = GetData();
+	const CharType* other_data = string.GetData();
+
+	return data == other_data || ::memcmp(data, other_data, mLength * sizeof(CharType)) == 0;
+}
+
+template <typename CharType>
+_boolean SharedString<CharType>::operator!=(const SharedString& string) const {
+	return !(*this == string);
+}
+
+template <typename CharType>
+_boolean SharedString<CharType>::operator<(const SharedString& string) const {
+	return Compare(string) < 0;
+}
+
+template <typename CharType>
+SharedString<CharType> SharedString<CharType>::GetTerminated() const {
+	if (IsTerminated())
+		return *this;
+
+	return SharedString(GetData(), mLength);
+}
+
+template <typename CharType>
+SharedString<CharType> SharedString<CharType>::SubString(_dword start, _dword length) const {
+	start = MIN(start, mLength);
+	length = MIN(length, mLength - start);
+
+	if (start == 0 && length == mLength)
+		return *this;
+
+	if (length <= cMaxInlineLength)
+		return SharedString(GetData() + start, length);
+
+	// Refer to the same buffer, only the hash of sub-string is calculated
+	SharedString string;
+	string.mLength = length;
+	string.mHash = SharedStringHelper::GetHash(mShared.mString + start, length);
+	string.mShared.mBuffer = mShared.mBuffer;
+	string.mShared.mString = mShared.mString + start;
+	mShared.mBuffer->mRefCount.Increase(MemoryOrder::Relaxed);
+
+	return string;
+}
+
+template <typename CharType>
+_int SharedString<CharType>::Compare(const SharedString& string) const {
+	const CharType* data = GetData();
+	const CharType* other_data = string.GetData();
+
+	_dword length = MIN(mLength, string.mLength);
+	for (_dword i = 0; i < length; i++) {
+		_dword value = SharedStringHelper::GetCharValue(data[i]);
+		_dword other_value = SharedStringHelper::GetCharValue(other_data[i]);
+		if (value != other_value)
+			return value < other_value ? -1 : 1;
+	}
+
+	if (mLength == string.mLength)
+		return 0;
+
+	return mLength < string.mLength ? -1 : 1;
+}
+
+template <typename CharType>
+_dword SharedString<CharType>::IndexOf(CharType character, _dword start) const {
+	const CharType* data = GetData();
+	for (_dword i = start; i < mLength; i++) {
+		if (data[i] == character)
+			return i;
+	}
+
+	return -1;
+}
+
+template <typename CharType>
+_dword SharedString<CharType>::LastIndexOf(CharType character) const {
+	const CharType* data = GetData();
+	for (_dword i = mLength; i > 0; i--) {
+		if (data[i - 1] == character)
+			return i - 1;
+	}
+
+	return -1;
+}
+
+template <typename CharType>
+_boolean SharedString<CharType>::StartsWith(const SharedString& string) const {
+	return string.mLength <= mLength && ::memcmp(GetData(), string.GetData(), string.mLength * sizeof(CharType)) == 0;
+}
+
+template <typename CharType>
+_boolean SharedString<CharType>::EndsWith(const SharedString& string) const {
+	return string.mLength <= mLength && ::memcmp(GetData() + mLength - string.mLength, string.GetData(), string.mLength * sizeof(CharType)) == 0;
+}
+
+#pragma endregion
+
+} // namespace E3D
@@ -0,0 +1,93 @@
+/**
+ * @file SmallAllocator.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The size-class allocator of small blocks.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The small allocator, the blocks are carved from the spans of one reserved arena, every span serves one size class.
+ * Every thread caches the free blocks of each size class, the allocation and free only touch the cache of current thread.
+ * The cache exchanges the blocks with the central lists in batches, so the blocks freed by the other threads are returned in batches too.
+ * 
+ */
+class SmallAllocator {
+public:
+	//!	The maximum size of small block, the larger ones are allocated by the caller.
+	static const _dword cMaxSmallSize = 256;
+	//!	The granularity of size classes, it's also the alignment of blocks.
+	static const _dword cSizeClassGranularity = 16;
+	//!	The number of size classes.
+	static const _dword cSizeClassNumber = cMaxSmallSize / cSizeClassGranularity;
+	//!	The span size, every span is carved into the blocks of one size class.
+	static const _dword cSpanSize = 64 * 1024;
+	//!	The number of blocks moved between the thread cache and the central lists at one time.
+	static const _dword cBatchNumber = 32;
+
+public:
+	/**
+	 * @brief Allocate a small block.
+	 * 
+	 * @param [in] size The size in bytes.
+	 * @return _void* The block aligned to cSizeClassGranularity, null indicates the size is too large or the arena is full.
+	 */
+	static _void* Alloc(_qword size);
+
+	/**
+	 * @brief Free the block if it's allocated by Alloc().
+	 * 
+	 * @param [in] pointer The block.
+	 * @return _boolean True indicates it's freed, false indicates it's not a small block.
+	 */
+	static _boolean Free(_void* pointer);
+
+	/**
+	 * @brief Check whether the block is allocated by Alloc().
+	 * 
+	 * @param [in] pointer The block.
+	 * @return _boolean True indicates it's a small block.
+	 */
+	static _boolean IsOwned(const _void* pointer);
+
+	/**
+	 * @brief Get the usable size of the block.
+	 * 
+	 * @param [in] pointer The block.
+	 * @return _dword The size of its size class, 0 indicates it's not a small block.
+	 */
+	static _dword GetSize(const _void* pointer);
+
+	/**
+	 * @brief Set the memory tag of the block, the heap charges the block to it.
+	 * 
+	 * @param [in] pointer The block.
+	 * @param [in] tag The tag.
+	 * @return _void 
+	 */
+	static _void SetTag(const _void* pointer, MemoryTag tag);
+
+	/**
+	 * @brief Get the memory tag of the block.
+	 * 
+	 * @param [in] pointer The block.
+	 * @return MemoryTag The tag set by SetTag().
+	 */
+	static MemoryTag GetTag(const _void* pointer);
+
+	/**
+	 * @brief Return all cached blocks of current thread to the central lists, it's called at thread exit automatically.
+	 * 
+	 * @return _void 
+	 */
+	static _void FlushThreadCache();
+};
+
+} // namespace E3D
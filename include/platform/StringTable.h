@@ -0,0 +1,129 @@
+/**
+ * @file StringTable.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The global string interning table.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The global string interning table, it maps the strings to the stable 32-bit IDs so they could be compared as integers.
+ * The ANSI and UTF-8 strings are stored as they are, the UTF-16 strings are stored in UTF-8, so the same text has the same ID.
+ * Every string keeps the ID of its lowercase variant, so the case-insensitive comparison is an integer compare as well
+ * (only the ASCII letters are folded).
+ * The strings are never removed, the table is sharded by hash and it's thread safe.
+ * 
+ */
+class StringTable {
+public:
+	//!	The null ID, it's the ID of no string.
+	static const _dword cNullID = 0;
+
+public:
+	/**
+	 * @brief Get the ID of string, the string is added if it's not in the table.
+	 * 
+	 * @param [in] string The ANSI or UTF-8 string.
+	 * @param [in] length The number of characters, -1 indicates it's null-terminated.
+	 * @return _dword The ID, cNullID indicates out of memory.
+	 */
+	static _dword Intern(const _chara* string, _dword length = -1);
+
+	/**
+	 * @brief Get the ID of string, the string is added if it's not in the table.
+	 * 
+	 * @param [in] string The UTF-16 string.
+	 * @param [in] length The number of characters, -1 indicates it's null-terminated.
+	 * @return _dword The ID, cNullID indicates out of memory.
+	 */
+	static _dword Intern(const _charw* string, _dword length = -1);
+
+	/**
+	 * @brief Get the ID of string with the hash calculated already, the string is added if it's not in the table.
+	 * 
+	 * @param [in] string The ANSI or UTF-8 string.
+	 * @return _dword The ID, cNullID indicates out of memory.
+	 */
+	static _dword Intern(const SharedStringA& string);
+
+	/**
+	 * @brief Find the ID of string, the string is not added.
+	 * 
+	 * @param [in] string The ANSI or UTF-8 string.
+	 * @param [in] length The number of characters, -1 indicates it's null-terminated.
+	 * @return _dword The ID, cNullID indicates it's not in the table.
+	 */
+	static _dword Find(const _chara* string, _dword length = -1);
+
+	/**
+	 * @brief Find the ID of string, the string is not added.
+	 * 
+	 * @param [in] string The UTF-16 string.
+	 * @param [in] length The number of characters, -1 indicates it's null-terminated.
+	 * @return _dword The ID, cNullID indicates it's not in the table.
+	 */
+	static _dword Find(const _charw* string, _dword length = -1);
+
+	/**
+	 * @brief Get the ID of lowercase variant, the strings which are equal ignoring case have the same folded ID.
+	 * 
+	 * @param [in] id The ID.
+	 * @return _dword The folded ID, it's the ID itself if it has no uppercase letter.
+	 */
+	static _dword GetFoldedID(_dword id);
+
+	/**
+	 * @brief Check whether the strings are equal.
+	 * 
+	 * @param [in] id1 The ID of the first string.
+	 * @param [in] id2 The ID of the second string.
+	 * @param [in] ignorecase True indicates case insensitive.
+	 * @return _boolean True indicates they're equal.
+	 */
+	static _boolean IsEqual(_dword id1, _dword id2, _boolean ignorecase = _false) {
+		if (id1 == id2)
+			return _true;
+
+		return ignorecase && GetFoldedID(id1) == GetFoldedID(id2);
+	}
+
+	/**
+	 * @brief Get the string, it's null-terminated and valid until the process exits.
+	 * 
+	 * @param [in] id The ID.
+	 * @return const _chara* The UTF-8 string, it's empty if the ID is invalid.
+	 */
+	static const _chara* GetString(_dword id);
+
+	/**
+	 * @brief Get the length of string.
+	 * 
+	 * @param [in] id The ID.
+	 * @return _dword The number of bytes.
+	 */
+	static _dword GetLength(_dword id);
+
+	/**
+	 * @brief Get the hash of string, it's the same as SharedStringHelper::GetHash().
+	 * 
+	 * @param [in] id The ID.
+	 * @return _dword The hash.
+	 */
+	static _dword GetHash(_dword id);
+
+	/**
+	 * @brief Get the number of strings.
+	 * 
+	 * @return _dword The number of strings.
+	 */
+	static _dword GetNumber();
+};
+
+} // namespace E3D
@@ -0,0 +1,282 @@
+/**
+ * @file Task.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The coroutine task running on the job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The task, it's a C++20 coroutine running on the job system.
+ * It suspends by 'co_await' without blocking the worker, the coroutine frame is destroyed when it finished.
+ * 
+ */
+class Task {
+	NO_COPY_OPERATIONS(Task)
+
+	friend class TaskSystem;
+
+public:
+	/**
+	 * @brief The final awaiter, it destroys the coroutine frame before decreasing the counter.
+	 * So the waiter could release the resources referred by the task safely when the counter reaches zero.
+	 * 
+	 */
+	struct FinalAwaiter {
+		_boolean await_ready() const noexcept {
+			return _false;
+		}
+		template <typename PromiseType>
+		_void await_suspend(std::coroutine_handle<PromiseType> handle) noexcept {
+			JobCounter* counter = handle.promise().mCounter;
+			handle.destroy();
+
+			if (counter != _null)
+				JobSystem::DecreaseCounter(*counter);
+		}
+		_void await_resume() const noexcept {
+		}
+	};
+
+	/**
+	 * @brief The promise.
+	 * 
+	 */
+	struct promise_type {
+		//!	The counter to decrease when the task finished.
+		JobCounter* mCounter = _null;
+
+		Task get_return_object() {
+			return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() const noexcept {
+			return {};
+		}
+		FinalAwaiter final_suspend() const noexcept {
+			return {};
+		}
+		_void return_void() const {
+		}
+		_void unhandled_exception() const {
+			std::terminate();
+		}
+	};
+
+private:
+	//!	The coroutine handle, it's null after the task started.
+	std::coroutine_handle<promise_type> mHandle;
+
+private:
+	explicit Task(std::coroutine_handle<promise_type> handle) : mHandle(handle) {
+	}
+
+public:
+	Task(Task&& task) noexcept : mHandle(task.mHandle) {
+		task.mHandle = _null;
+	}
+	~Task() {
+		// The task has never started
+		if (mHandle)
+			mHandle.destroy();
+	}
+};
+
+/**
+ * @brief The I/O request of task.
+ * 
+ */
+struct TaskIORequest {
+	//!	The file handle.
+	_handle mFile;
+	//!	The socket handle.
+	_socket mSocket;
+	//!	The buffer to receive data.
+	_void* mBuffer;
+	//!	The buffer size in bytes.
+	_dword mSize;
+	//!	The number of bytes read, -1 indicates failure.
+	_dword mResult;
+	//!	The suspended coroutine.
+	std::coroutine_handle<> mCoroutine;
+	//!	The next request in queue.
+	TaskIORequest* mNext;
+};
+
+/**
+ * @brief The task system, the file reads are served by the I/O threads, the socket reads are resumed by the socket poller thread.
+ * The job system must be initialized before it, the tasks are resumed on the workers.
+ * 
+ */
+class TaskSystem {
+public:
+	/**
+	 * @brief The awaiter of job counter, the task resumes when the counter reaches zero.
+	 * 
+	 */
+	class CounterAwaiter {
+	private:
+		JobCounter& mCounter;
+
+	public:
+		CounterAwaiter(JobCounter& counter) : mCounter(counter) {
+		}
+
+	public:
+		_boolean await_ready() const {
+			return mCounter.IsDone();
+		}
+		_void await_suspend(std::coroutine_handle<> handle) {
+			TaskSystem::Resume(handle, &mCounter);
+		}
+		_void await_resume() const {
+		}
+	};
+
+	/**
+	 * @brief The awaiter of file read, the task resumes when the I/O thread finished reading.
+	 * 
+	 */
+	class FileReadAwaiter {
+	private:
+		TaskIORequest mRequest;
+
+	public:
+		FileReadAwaiter(_handle file, _void* buffer, _dword size) {
+			mRequest.mFile = file;
+			mRequest.mSocket = INVALID_SOCKET;
+			mRequest.mBuffer = buffer;
+			mRequest.mSize = size;
+			mRequest.mResult = -1;
+			mRequest.mNext = _null;
+		}
+
+	public:
+		_boolean await_ready() const {
+			return _false;
+		}
+		_void await_suspend(std::coroutine_handle<> handle) {
+			mRequest.mCoroutine = handle;
+			TaskSystem::PostFileRequest(&mRequest);
+		}
+		_dword await_resume() const {
+			return mRequest.mResult;
+		}
+	};
+
+	/**
+	 * @brief The awaiter of socket read, the task resumes when the socket is readable.
+	 * 
+	 */
+	class SocketReadAwaiter {
+	private:
+		TaskIORequest mRequest;
+
+	public:
+		SocketReadAwaiter(_socket socket, _void* buffer, _dword size) {
+			mRequest.mFile = _null;
+			mRequest.mSocket = socket;
+			mRequest.mBuffer = buffer;
+			mRequest.mSize = size;
+			mRequest.mResult = -1;
+			mRequest.mNext = _null;
+		}
+
+	public:
+		_boolean await_ready() const {
+			return _false;
+		}
+		_boolean await_suspend(std::coroutine_handle<> handle) {
+			mRequest.mCoroutine = handle;
+
+			// Resume immediately if we could not watch it
+			return TaskSystem::PostSocketRequest(&mRequest);
+		}
+		_dword await_resume() const {
+			return Platform::ReadSocket(mRequest.mSocket, mRequest.mBuffer, mRequest.mSize);
+		}
+	};
+
+private:
+	//!	Post the file request to the I/O threads.
+	static _void PostFileRequest(TaskIORequest* request);
+	//!	Post the socket request to the socket poller, returns false if the socket could not be watched.
+	static _boolean PostSocketRequest(TaskIORequest* request);
+
+public:
+	/**
+	 * @brief Initialize the I/O threads and the socket poller thread.
+	 * 
+	 * @param [in] file_thread_number The number of I/O threads to read files.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean Initialize(_dword file_thread_number = 2);
+
+	/**
+	 * @brief Stop the I/O threads and the socket poller thread, all pending I/O requests must have finished.
+	 * 
+	 * @return _void 
+	 */
+	static _void Finalize();
+
+	/**
+	 * @brief Start the task on the job system.
+	 * 
+	 * @param [in] task The task.
+	 * @param [in] counter The counter to decrease when the task finished, it could be null.
+	 * @param [in] affinity The preferred worker index to start it.
+	 * @return _void 
+	 */
+	static _void Run(Task&& task, JobCounter* counter = _null, _dword affinity = JobSystem::cAnyWorker);
+
+	/**
+	 * @brief Resume the suspended coroutine on the job system.
+	 * 
+	 * @param [in] handle The coroutine handle.
+	 * @param [in] dependency The counter to wait before resuming, it could be null.
+	 * @param [in] affinity The preferred worker index.
+	 * @return _void 
+	 */
+	static _void Resume(std::coroutine_handle<> handle, JobCounter* dependency = _null, _dword affinity = JobSystem::cAnyWorker);
+
+	/**
+	 * @brief Read the file from current file pointer in the I/O thread, use it as 'co_await TaskSystem::ReadFile(...)'.
+	 * The concurrent reads of the same file handle must not be issued.
+	 * 
+	 * @param [in] file The file handle.
+	 * @param [out] buffer The buffer to receive data.
+	 * @param [in] size The number of bytes to read.
+	 * @return FileReadAwaiter The awaiter, it returns the number of bytes read, -1 indicates failure.
+	 */
+	static FileReadAwaiter ReadFile(_handle file, _void* buffer, _dword size) {
+		return FileReadAwaiter(file, buffer, size);
+	}
+
+	/**
+	 * @brief Read the socket when it's readable, use it as 'co_await TaskSystem::ReadSocket(...)'.
+	 * 
+	 * @param [in] socket The socket handle.
+	 * @param [out] buffer The buffer to receive data.
+	 * @param [in] size The number of bytes to read.
+	 * @return SocketReadAwaiter The awaiter, it returns the same result as Platform::ReadSocket().
+	 */
+	static SocketReadAwaiter ReadSocket(_socket socket, _void* buffer, _dword size) {
+		return SocketReadAwaiter(socket, buffer, size);
+	}
+};
+
+/**
+ * @brief Make the job counter awaitable, use it as 'co_await counter'.
+ * 
+ */
+inline TaskSystem::CounterAwaiter operator co_await(JobCounter& counter) {
+	return TaskSystem::CounterAwaiter(counter);
+}
+
+} // namespace E3D
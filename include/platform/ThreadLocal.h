@@ -0,0 +1,106 @@
+/**
+ * @file ThreadLocal.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The thread local storage.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+//!	The maximum number of TLS slots.
+static const _dword cMaxTLSSlotNumber = 128;
+
+/**
+ * @brief The TLS entry of thread, the value is valid only if the slot matches, so the stale value of freed slot is never returned.
+ * 
+ */
+struct TLSEntry {
+	_dword mSlot;
+	_void* mValue;
+};
+
+//!	The TLS entries of current thread, the slot index is the low 16 bits of slot.
+extern THREAD_LOCAL TLSEntry gTLSEntries[cMaxTLSSlotNumber];
+
+/**
+ * @brief The thread local object, it's created on the first access in every thread and deleted at thread exit.
+ * The access is inlined into a thread-local load and a compare.
+ * 
+ */
+template <typename Type>
+class ThreadLocal {
+	NO_COPY_OPERATIONS(ThreadLocal)
+
+private:
+	//!	The TLS slot.
+	_dword mSlot;
+
+private:
+	//!	Delete the object at thread exit.
+	static _void OnDestructor(_void* value) {
+		delete (Type*)value;
+	}
+
+	//!	Create the object of current thread.
+	NOINLINE Type* Create() {
+		Type* object = new Type();
+		Platform::SetTLSValue(mSlot, object);
+
+		return object;
+	}
+
+public:
+	ThreadLocal() {
+		mSlot = Platform::AllocTLS(OnDestructor);
+		E3D_ASSERT(mSlot != 0);
+	}
+	~ThreadLocal() {
+		// Only the object of current thread could be deleted here
+		Type* object = Peek();
+		if (object != _null) {
+			Platform::SetTLSValue(mSlot, _null);
+			delete object;
+		}
+
+		Platform::FreeTLS(mSlot);
+	}
+
+public:
+	/**
+	 * @brief Get the object of current thread without creating it.
+	 * 
+	 * @return Type* The object, null indicates it has not been created.
+	 */
+	Type* Peek() const {
+		const TLSEntry& entry = gTLSEntries[mSlot & 0xFFFF];
+		return entry.mSlot == mSlot ? (Type*)entry.mValue : _null;
+	}
+
+	/**
+	 * @brief Get the object of current thread, create it if it has not been created.
+	 * 
+	 * @return Type* The object.
+	 */
+	Type* Get() {
+		Type* object = Peek();
+		if (object == _null)
+			object = Create();
+
+		return object;
+	}
+
+	Type* operator->() {
+		return Get();
+	}
+	Type& operator*() {
+		return *Get();
+	}
+};
+
+} // namespace E3D
@@ -0,0 +1,177 @@
+/**
+ * @file ThreadSampler.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The background sampler of per-thread CPU usage.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The scheduling data of thread, all values are accumulated since the thread started.
+ * 
+ */
+struct ThreadSchedulingData {
+	/**
+	 * @brief The thread ID.
+	 * 
+	 */
+	_thread_id mThreadID;
+	/**
+	 * @brief The thread name, it's truncated to 15 characters by OS.
+	 * 
+	 */
+	_chara mName[16];
+	/**
+	 * @brief The time executed in user mode, in nanoseconds.
+	 * 
+	 */
+	_qword mUserTime;
+	/**
+	 * @brief The time executed in kernel mode, in nanoseconds.
+	 * 
+	 */
+	_qword mKernelTime;
+	/**
+	 * @brief The time waiting on the run queue (runnable but not running), in nanoseconds, 0 if the OS does not provide it.
+	 * 
+	 */
+	_qword mRunQueueWaitTime;
+	/**
+	 * @brief The number of voluntary context switches, the thread gave up CPU by waiting.
+	 * 
+	 */
+	_qword mVoluntarySwitchNumber;
+	/**
+	 * @brief The number of involuntary context switches, the thread was preempted.
+	 * 
+	 */
+	_qword mInvoluntarySwitchNumber;
+};
+
+/**
+ * @brief The CPU usage of thread in the last sample interval.
+ * 
+ */
+struct ThreadCPUData {
+	/**
+	 * @brief The accumulated scheduling data when sampled.
+	 * 
+	 */
+	ThreadSchedulingData mTotal;
+	/**
+	 * @brief The user mode usage of one CPU, in [0.0 ~ 100.0].
+	 * 
+	 */
+	_float mUserUsage;
+	/**
+	 * @brief The kernel mode usage of one CPU, in [0.0 ~ 100.0].
+	 * 
+	 */
+	_float mKernelUsage;
+	/**
+	 * @brief The percentage of interval waiting on the run queue, the high value indicates the CPUs are oversubscribed.
+	 * 
+	 */
+	_float mRunQueueWaitRatio;
+	/**
+	 * @brief The number of voluntary context switches in interval.
+	 * 
+	 */
+	_dword mVoluntarySwitchNumber;
+	/**
+	 * @brief The number of involuntary context switches in interval.
+	 * 
+	 */
+	_dword mInvoluntarySwitchNumber;
+};
+
+/**
+ * @brief The snapshot of all threads in process.
+ * 
+ */
+struct ThreadCPUSnapshot {
+	//!	The maximum number of threads, the others are ignored.
+	static const _dword cMaxThreadNumber = 256;
+
+	/**
+	 * @brief The tick count when sampled, in milliseconds.
+	 * 
+	 */
+	_dword mSampleTime;
+	/**
+	 * @brief The interval since the last sample, in milliseconds, the usage is 0 for the first sample.
+	 * 
+	 */
+	_dword mInterval;
+	/**
+	 * @brief The number of threads.
+	 * 
+	 */
+	_dword mThreadNumber;
+	/**
+	 * @brief The threads, they're sorted by thread ID.
+	 * 
+	 */
+	ThreadCPUData mThreads[cMaxThreadNumber];
+};
+
+/**
+ * @brief The thread sampler, a background thread samples all threads of process periodically and computes the deltas.
+ * The snapshot is double buffered and published by sequence, the readers never block the sampler or each other.
+ * 
+ */
+class ThreadSampler {
+private:
+	//!	The sampler thread.
+	static _thread_ret OnSamplerThread(_void* parameter);
+
+public:
+	/**
+	 * @brief Start the sampler thread.
+	 * 
+	 * @param [in] interval The sample interval in milliseconds.
+	 * @return _boolean True indicates success, false indicates failure.
+	 */
+	static _boolean Initialize(_dword interval = 1000);
+
+	/**
+	 * @brief Stop the sampler thread, the last snapshot is still available.
+	 * 
+	 * @return _void 
+	 */
+	static _void Finalize();
+
+	/**
+	 * @brief Sample all threads now, it's called by the sampler thread periodically.
+	 * It could be called without the sampler thread, it's skipped if the others are sampling.
+	 * 
+	 * @return _boolean True indicates a new snapshot is published.
+	 */
+	static _boolean Sample();
+
+	/**
+	 * @brief Copy the latest snapshot.
+	 * 
+	 * @param [out] snapshot The snapshot.
+	 * @return _boolean True indicates success, false indicates there is no sample yet.
+	 */
+	static _boolean GetSnapshot(ThreadCPUSnapshot& snapshot);
+
+	/**
+	 * @brief Get the CPU usage of thread in the latest snapshot.
+	 * 
+	 * @param [in] threadid The thread ID.
+	 * @param [out] data The CPU usage.
+	 * @return _boolean True indicates success, false indicates the thread is not sampled.
+	 */
+	static _boolean GetThreadCPUData(_thread_id threadid, ThreadCPUData& data);
+};
+
+} // namespace E3D
@@ -0,0 +1,411 @@
+/**
+ * @file AllocationSampler.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The sampling allocation profiler.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The maximum number of sites
+static const _dword cMaxSiteNumber = 4096;
+// The maximum number of live samples
+static const _dword cMaxSampleNumber = 64 * 1024;
+// The number of sample buckets, it's large enough to let the most frees find an empty bucket without locking
+static const _dword cSampleBucketNumber = 16 * 1024;
+// The invalid index
+static const _dword cInvalidIndex = -1;
+
+/**
+ * @brief The site, it's identified by the call stack.
+ */
+struct AllocationSite {
+	_qword mHash;
+	AllocationSiteData mData;
+};
+
+/**
+ * @brief The sampled block which is not freed yet.
+ */
+struct AllocationSample {
+	const _void* mPointer;
+	_dword mSiteIndex;
+	_dword mNext;
+	//!	The estimated bytes and number it represents.
+	_qword mBytes;
+	_qword mNumber;
+};
+
+Atomic<_dword> gAllocationSampleInterval;
+Atomic<_dword> gAllocationLiveSampleNumber;
+THREAD_LOCAL _large gAllocationSampleCountdown = 0;
+
+// The locker of sites and samples
+static Atomic<_dword> sLocker;
+// The sites, it's open addressing hash table
+static AllocationSite sSites[cMaxSiteNumber];
+static _dword sSiteNumber = 0;
+// The samples and the free list of them
+static AllocationSample sSamples[cMaxSampleNumber];
+static _dword sSampleNumber = 0;
+static _dword sFreeSample = cInvalidIndex;
+// The heads of sample chains, hashed by pointer, they store the sample index plus 1 so zero indicates empty
+static Atomic<_dword> sSampleBuckets[cSampleBucketNumber];
+// The number of dropped samples since the tables are full
+static Atomic<_dword> sDroppedSampleNumber;
+
+// True indicates current thread is recording, the allocations of sampler itself are not sampled
+static THREAD_LOCAL _boolean sRecording = _false;
+// True indicates the countdown of current thread has been drawn
+static THREAD_LOCAL _boolean sCountdownReady = _false;
+// The random seed of current thread
+static THREAD_LOCAL _qword sRandomSeed = 0;
+
+/**
+ * @brief Lock the tables.
+ */
+static _void LockSampler() {
+	while (_true) {
+		_dword unlocked = 0;
+		if (sLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			return;
+
+		while (sLocker.Load(MemoryOrder::Relaxed) != 0)
+			CPU_PAUSE();
+	}
+}
+
+/**
+ * @brief Unlock the tables.
+ */
+static _void UnlockSampler() {
+	sLocker.Store(0, MemoryOrder::Release);
+}
+
+/**
+ * @brief Get the bucket of pointer.
+ */
+static _dword GetSampleBucket(const _void* pointer) {
+	_qword key = (_qword)(_uintptr_t)pointer;
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+
+	return (_dword)(key % cSampleBucketNumber);
+}
+
+/**
+ * @brief Get the hash of call stack.
+ */
+static _qword GetCallStackHash(_void* const* frames, _dword number) {
+	// FNV-1a
+	_qword hash = 0xcbf29ce484222325ull;
+	for (_dword i = 0; i < number; i++) {
+		hash ^= (_qword)(_uintptr_t)frames[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash != 0 ? hash : 1;
+}
+
+/**
+ * @brief Draw the bytes to the next sample, they're exponential distributed so the samples are Poisson process on bytes.
+ */
+static _large DrawCountdown(_dword interval) {
+	if (sRandomSeed == 0)
+		sRandomSeed = ((_qword)(_uintptr_t)&sRandomSeed) ^ Platform::GetCurrentTickCount() ^ 0x9e3779b97f4a7c15ull;
+
+	// xorshift64
+	sRandomSeed ^= sRandomSeed << 13;
+	sRandomSeed ^= sRandomSeed >> 7;
+	sRandomSeed ^= sRandomSeed << 17;
+
+	// The uniform number in (0, 1]
+	_double u = ((_double)(sRandomSeed >> 11) + 1.0) / 9007199254740992.0;
+
+	return (_large)(-::log(u) * interval) + 1;
+}
+
+/**
+ * @brief Find or add the site of call stack, returns -1 if the table is full.
+ */
+static _dword FindSite(_void* const* frames, _dword number) {
+	_qword hash = GetCallStackHash(frames, number);
+
+	for (_dword i = 0; i < cMaxSiteNumber; i++) {
+		_dword index = (_dword)((hash + i) % cMaxSiteNumber);
+		AllocationSite& site = sSites[index];
+
+		if (site.mHash == 0) {
+			// Keep the table half empty to make the probing short
+			if (sSiteNumber >= cMaxSiteNumber / 2)
+				return cInvalidIndex;
+
+			site.mHash = hash;
+			E3D_INIT(site.mData);
+			E3D_MEM_CPY(site.mData.mFrames, frames, number * sizeof(_void*));
+			site.mData.mFrameNumber = number;
+			sSiteNumber++;
+
+			return index;
+		}
+
+		if (site.mHash == hash && site.mData.mFrameNumber == number && ::memcmp(site.mData.mFrames, frames, number * sizeof(_void*)) == 0)
+			return index;
+	}
+
+	return cInvalidIndex;
+}
+
+/**
+ * @brief Allocate a sample, returns -1 if the pool is full.
+ */
+static _dword AllocSample() {
+	if (sFreeSample != cInvalidIndex) {
+		_dword index = sFreeSample;
+		sFreeSample = sSamples[index].mNext;
+		return index;
+	}
+
+	if (sSampleNumber == cMaxSampleNumber)
+		return cInvalidIndex;
+
+	return sSampleNumber++;
+}
+
+/**
+ * @brief Sort the used sites by the live bytes in descending order, returns the number of sites.
+ */
+static _dword SortSites(_dword* indices) {
+	_dword number = 0;
+	for (_dword i = 0; i < cMaxSiteNumber; i++) {
+		if (sSites[i].mHash != 0)
+			indices[number++] = i;
+	}
+
+	std::sort(indices, indices + number, [](_dword index1, _dword index2) {
+		const AllocationSiteData& site1 = sSites[index1].mData;
+		const AllocationSiteData& site2 = sSites[index2].mData;
+		if (site1.mLiveBytes != site2.mLiveBytes)
+			return site1.mLiveBytes > site2.mLiveBytes;
+
+		return site1.mTotalBytes > site2.mTotalBytes;
+	});
+
+	return number;
+}
+
+/**
+ * @brief Write the formatted text to file.
+ */
+static _boolean WriteText(_handle file, const _chara* format, ...) {
+	_chara buffer[1024];
+
+	va_list args;
+	va_start(args, format);
+	_int length = ::vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if (length < 0)
+		return _false;
+
+	return Platform::WriteFile(file, buffer, MIN((_dword)length, (_dword)sizeof(buffer) - 1));
+}
+
+#pragma endregion
+
+#pragma region "AllocationSampler"
+
+_void AllocationSampler::SampleAlloc(_void* pointer, _qword size) {
+	_dword interval = gAllocationSampleInterval.Load(MemoryOrder::Relaxed);
+	if (interval == 0 || sRecording)
+		return;
+
+	// The countdown starts from zero, draw the first one to avoid sampling the first allocation of every thread
+	if (!sCountdownReady) {
+		sCountdownReady = _true;
+		gAllocationSampleCountdown += DrawCountdown(interval);
+		if (gAllocationSampleCountdown > 0)
+			return;
+	}
+
+	// The block is sampled once no matter how many intervals it covers, the weight below makes up for it
+	gAllocationSampleCountdown = DrawCountdown(interval);
+
+	sRecording = _true;
+
+	_void* frames[AllocationSiteData::cMaxFrameNumber];
+	_dword frame_number = Platform::CaptureCallStack(frames, AllocationSiteData::cMaxFrameNumber, 1);
+
+	// The probability of sampling is 1 - exp(-size / interval), so every sample represents the inverse of it
+	_double probability = 1.0 - ::exp(-(_double)size / interval);
+	_qword number = (_qword)(1.0 / probability + 0.5);
+	_qword bytes = (_qword)((_double)size / probability + 0.5);
+
+	_dword bucket = GetSampleBucket(pointer);
+
+	LockSampler();
+	{
+		_dword site_index = FindSite(frames, frame_number);
+		_dword sample_index = site_index != cInvalidIndex ? AllocSample() : cInvalidIndex;
+
+		if (sample_index != cInvalidIndex) {
+			AllocationSiteData& site = sSites[site_index].mData;
+			site.mLiveBytes += bytes;
+			site.mLiveNumber += number;
+			site.mTotalBytes += bytes;
+			site.mTotalNumber += number;
+
+			AllocationSample& sample = sSamples[sample_index];
+			sample.mPointer = pointer;
+			sample.mSiteIndex = site_index;
+			sample.mBytes = bytes;
+			sample.mNumber = number;
+			sample.mNext = sSampleBuckets[bucket].Load(MemoryOrder::Relaxed) - 1;
+			sSampleBuckets[bucket].Store(sample_index + 1, MemoryOrder::Relaxed);
+
+			gAllocationLiveSampleNumber.Increase(MemoryOrder::Relaxed);
+		} else {
+			sDroppedSampleNumber.Increase(MemoryOrder::Relaxed);
+		}
+	}
+	UnlockSampler();
+
+	sRecording = _false;
+}
+
+_void AllocationSampler::SampleFree(_void* pointer) {
+	_dword bucket = GetSampleBucket(pointer);
+
+	// The bucket is empty, the block is not sampled
+	if (sSampleBuckets[bucket].Load(MemoryOrder::Relaxed) == 0)
+		return;
+
+	LockSampler();
+	{
+		_dword previous = cInvalidIndex;
+		_dword index = sSampleBuckets[bucket].Load(MemoryOrder::Relaxed) - 1;
+		while (index != cInvalidIndex && sSamples[index].mPointer != pointer) {
+			previous = index;
+			index = sSamples[index].mNext;
+		}
+
+		if (index != cInvalidIndex) {
+			AllocationSample& sample = sSamples[index];
+			AllocationSiteData& site = sSites[sample.mSiteIndex].mData;
+			site.mLiveBytes -= sample.mBytes;
+			site.mLiveNumber -= sample.mNumber;
+
+			if (previous != cInvalidIndex)
+				sSamples[previous].mNext = sample.mNext;
+			else
+				sSampleBuckets[bucket].Store(sample.mNext + 1, MemoryOrder::Relaxed);
+
+			sample.mPointer = _null;
+			sample.mNext = sFreeSample;
+			sFreeSample = index;
+
+			gAllocationLiveSampleNumber.Decrease(MemoryOrder::Relaxed);
+		}
+	}
+	UnlockSampler();
+}
+
+_void AllocationSampler::Start(_dword interval) {
+	if (interval == 0)
+		return;
+
+	gAllocationSampleInterval.Store(interval, MemoryOrder::Release);
+}
+
+_void AllocationSampler::Stop() {
+	gAllocationSampleInterval.Store(0, MemoryOrder::Release);
+}
+
+_boolean AllocationSampler::IsStarted() {
+	return gAllocationSampleInterval.Load(MemoryOrder::Acquire) != 0;
+}
+
+_void AllocationSampler::Reset() {
+	LockSampler();
+	{
+		for (_dword i = 0; i < cSampleBucketNumber; i++)
+			sSampleBuckets[i].Store(0, MemoryOrder::Relaxed);
+
+		for (_dword i = 0; i < cMaxSiteNumber; i++)
+			sSites[i].mHash = 0;
+
+		sSiteNumber = 0;
+		sSampleNumber = 0;
+		sFreeSample = cInvalidIndex;
+
+		gAllocationLiveSampleNumber.Store(0, MemoryOrder::Relaxed);
+		sDroppedSampleNumber.Store(0, MemoryOrder::Relaxed);
+	}
+	UnlockSampler();
+}
+
+_dword AllocationSampler::GetSites(AllocationSiteData* sites, _dword number) {
+	if (sites == _null || number == 0)
+		return 0;
+
+	static _dword indices[cMaxSiteNumber];
+
+	LockSampler();
+
+	_dword site_number = MIN(SortSites(indices), number);
+	for (_dword i = 0; i < site_number; i++)
+		sites[i] = sSites[indices[i]].mData;
+
+	UnlockSampler();
+
+	return site_number;
+}
+
+_boolean AllocationSampler::Dump(const _charw* filename) {
+	// Copy the sites first, the symbols are resolved out of the locker
+	AllocationSiteData* sites = new AllocationSiteData[cMaxSiteNumber];
+	_dword site_number = GetSites(sites, cMaxSiteNumber);
+
+	_handle file = Platform::CreateFile(filename);
+	if (file == _null) {
+		delete[] sites;
+		return _false;
+	}
+
+	_qword live_bytes = 0;
+	for (_dword i = 0; i < site_number; i++)
+		live_bytes += sites[i].mLiveBytes;
+
+	_boolean ret = WriteText(file, "# interval: %u, sites: %u, live bytes: %llu, dropped samples: %u\n", gAllocationSampleInterval.Load(MemoryOrder::Relaxed), site_number, (unsigned long long)live_bytes, sDroppedSampleNumber.Load(MemoryOrder::Relaxed));
+
+	for (_dword i = 0; i < site_number && ret; i++) {
+		const AllocationSiteData& site = sites[i];
+		ret = WriteText(file, "\nlive: %llu bytes in %llu blocks, total: %llu bytes in %llu blocks\n", (unsigned long long)site.mLiveBytes, (unsigned long long)site.mLiveNumber, (unsigned long long)site.mTotalBytes, (unsigned long long)site.mTotalNumber);
+
+		for (_dword j = 0; j < site.mFrameNumber && ret; j++) {
+			_chara name[512];
+			if (!Platform::GetSymbolName(site.mFrames[j], name, E3D_ARRAY_NUMBER(name)))
+				::snprintf(name, E3D_ARRAY_NUMBER(name), "%p", site.mFrames[j]);
+
+			ret = WriteText(file, "\t#%u %s\n", j, name);
+		}
+	}
+
+	Platform::CloseFile(file);
+	delete[] sites;
+
+	return ret;
+}
+
+#pragma endregion
+
+} // namespace E3D
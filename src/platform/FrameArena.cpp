@@ -0,0 +1,257 @@
+/**
+ * @file FrameArena.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The linear arena and the per-frame arenas.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+/**
+ * @brief The memory block, the memory follows the header.
+ */
+struct LinearArenaBlock {
+	LinearArenaBlock* mNext;
+	_qword mSize;
+};
+
+/**
+ * @brief The arenas of thread.
+ */
+struct FrameArenaThreadData {
+	LinearArena mArenas[2];
+	//!	The frame index when the arenas are used last time.
+	_dword mFrameIndex;
+};
+
+// The frame index
+static Atomic<_dword> sFrameIndex;
+
+// The arenas of current thread, it's the cache of the TLS value
+static THREAD_LOCAL FrameArenaThreadData* sThreadData = _null;
+
+/**
+ * @brief Release the arenas of exiting thread.
+ */
+static _void OnReleaseThreadData(_void* data) {
+	if (sThreadData == data)
+		sThreadData = _null;
+
+	delete (FrameArenaThreadData*)data;
+}
+
+/**
+ * @brief Get the TLS slot to release the arenas at thread exit, the arenas created again by the later thread_local
+ * destructors are released as well, so they never leak.
+ */
+static _dword GetThreadSlot() {
+	static const _dword sThreadSlot = Platform::AllocTLS(OnReleaseThreadData);
+	return sThreadSlot;
+}
+
+/**
+ * @brief Get the memory of block.
+ */
+static _byte* GetBlockBegin(LinearArenaBlock* block) {
+	return (_byte*)(block + 1);
+}
+
+/**
+ * @brief Get the end of block.
+ */
+static _byte* GetBlockEnd(LinearArenaBlock* block) {
+	return GetBlockBegin(block) + block->mSize;
+}
+
+/**
+ * @brief Align the pointer up.
+ */
+static _byte* AlignPointer(_byte* pointer, _dword alignment) {
+	return (_byte*)(((_uintptr_t)pointer + alignment - 1) & ~(_uintptr_t)(alignment - 1));
+}
+
+/**
+ * @brief Check whether the block could hold the memory.
+ */
+static _boolean IsBlockFit(LinearArenaBlock* block, _qword size, _dword alignment) {
+	_byte* pointer = AlignPointer(GetBlockBegin(block), alignment);
+	return pointer <= GetBlockEnd(block) && (_qword)(GetBlockEnd(block) - pointer) >= size;
+}
+
+#pragma endregion
+
+#pragma region "LinearArena"
+
+LinearArena::~LinearArena() {
+	Clear();
+}
+
+_void* LinearArena::AllocSlow(_qword size, _dword alignment) {
+	// Reuse the blocks after current one, the blocks which are too small are skipped this time
+	LinearArenaBlock* block = mCurrent != _null ? mCurrent->mNext : mBlocks;
+	while (block != _null && !IsBlockFit(block, size, alignment))
+		block = block->mNext;
+
+	if (block == _null) {
+		// The size with the alignment padding and the header must not overflow
+		if (size > ~0ull - alignment - sizeof(LinearArenaBlock))
+			return _null;
+
+		// The block must be larger than its header
+		_qword block_size = MAX((_qword)MAX(mBlockSize, (_dword)sizeof(LinearArenaBlock) * 4) - sizeof(LinearArenaBlock), size + alignment);
+		block = (LinearArenaBlock*)Platform::HeapAlloc(block_size + sizeof(LinearArenaBlock));
+		if (block == _null)
+			return _null;
+
+		block->mSize = block_size;
+
+		if (!IsBlockFit(block, size, alignment)) {
+			Platform::HeapFree(block);
+			return _null;
+		}
+
+		// Insert it after current block, so the rewinding keeps the order of blocks
+		if (mCurrent != _null) {
+			block->mNext = mCurrent->mNext;
+			mCurrent->mNext = block;
+		} else {
+			block->mNext = mBlocks;
+			mBlocks = block;
+		}
+	}
+
+	mCurrent = block;
+	mEnd = GetBlockEnd(block);
+
+	_byte* pointer = AlignPointer(GetBlockBegin(block), alignment);
+	mCursor = pointer + size;
+
+	return pointer;
+}
+
+_chara* LinearArena::AllocString(const _chara* string) {
+	if (string == _null)
+		return _null;
+
+	_dword size = (Platform::StringLength(string) + 1) * sizeof(_chara);
+
+	_chara* buffer = (_chara*)Alloc(size, alignof(_chara));
+	if (buffer != _null)
+		E3D_MEM_CPY(buffer, string, size);
+
+	return buffer;
+}
+
+_chara* LinearArena::FormatString(const _chara* format, ...) {
+	if (format == _null)
+		return _null;
+
+	BEGIN_VA_LIST(args, format);
+
+	_va_list length_args;
+	va_copy(length_args, args);
+	_int length = ::vsnprintf(_null, 0, format, length_args);
+	va_end(length_args);
+
+	_chara* buffer = length >= 0 ? (_chara*)Alloc(length + 1, alignof(_chara)) : _null;
+	if (buffer != _null)
+		::vsnprintf(buffer, length + 1, format, args);
+
+	END_VA_LIST(args);
+
+	return buffer;
+}
+
+_void LinearArena::Rewind(const LinearArenaMarker& marker) {
+	if (marker.mBlock == _null) {
+		Reset();
+		return;
+	}
+
+	mCurrent = marker.mBlock;
+	mCursor = marker.mCursor;
+	mEnd = GetBlockEnd(marker.mBlock);
+}
+
+_void LinearArena::Reset() {
+	mCurrent = _null;
+	mCursor = _null;
+	mEnd = _null;
+}
+
+_void LinearArena::Clear() {
+	while (mBlocks != _null) {
+		LinearArenaBlock* block = mBlocks;
+		mBlocks = block->mNext;
+
+		Platform::HeapFree(block);
+	}
+
+	Reset();
+}
+
+_qword LinearArena::GetCapacity() const {
+	_qword capacity = 0;
+	for (LinearArenaBlock* block = mBlocks; block != _null; block = block->mNext)
+		capacity += block->mSize;
+
+	return capacity;
+}
+
+#pragma endregion
+
+#pragma region "FrameArena"
+
+_void FrameArena::NextFrame() {
+	sFrameIndex.Increase(MemoryOrder::Relaxed);
+}
+
+_dword FrameArena::GetFrameIndex() {
+	return sFrameIndex.Load(MemoryOrder::Relaxed);
+}
+
+LinearArena& FrameArena::GetArena() {
+	_dword frame_index = sFrameIndex.Load(MemoryOrder::Relaxed);
+
+	FrameArenaThreadData* data = sThreadData;
+	if (data == _null) {
+		data = new FrameArenaThreadData;
+		data->mFrameIndex = frame_index;
+		sThreadData = data;
+
+		Platform::SetTLSValue(GetThreadSlot(), data);
+	}
+
+	// The arena of last frame is kept, the older one is reset
+	if (data->mFrameIndex != frame_index) {
+		if (frame_index - data->mFrameIndex != 1)
+			data->mArenas[(frame_index + 1) & 1].Reset();
+
+		data->mArenas[frame_index & 1].Reset();
+		data->mFrameIndex = frame_index;
+	}
+
+	return data->mArenas[frame_index & 1];
+}
+
+_void FrameArena::ReleaseThreadArenas() {
+	if (sThreadData == _null)
+		return;
+
+	delete sThreadData;
+	sThreadData = _null;
+
+	Platform::SetTLSValue(GetThreadSlot(), _null);
+}
+
+#pragma endregion
+
+} // namespace E3D
@@ -0,0 +1,283 @@
+/**
+ * @file FrameGraph.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The per-frame stage graph running on the job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The number of qwords of stage and resource bits
+static const _dword cStageBitsNumber = FrameGraph::cMaxStageNumber / 64;
+static const _dword cResourceBitsNumber = FrameGraph::cMaxResourceNumber / 64;
+
+// The maximum length of name
+static const _dword cMaxNameLength = 64;
+
+/**
+ * @brief The stage.
+ */
+struct FrameGraphStage {
+	_chara mName[cMaxNameLength];
+	FrameGraph::OnStageProc mFunc;
+	_void* mParameter;
+	FrameGraph* mGraph;
+
+	_qword mReadResources[cResourceBitsNumber];
+	_qword mWriteResources[cResourceBitsNumber];
+	_qword mDependencies[cStageBitsNumber];
+
+	_dword mLevel;
+	_dword mDependencyNumber;
+	_dword mSuccessorIndex;
+	_dword mSuccessorNumber;
+	Atomic<_dword> mPendingNumber;
+};
+
+/**
+ * @brief The resource.
+ */
+struct FrameGraphResource {
+	_chara mName[cMaxNameLength];
+};
+
+/**
+ * @brief Set the bit.
+ */
+static _void SetBit(_qword* bits, _dword index) {
+	bits[index / 64] |= 1ull << (index % 64);
+}
+
+/**
+ * @brief Check the bit.
+ */
+static _boolean HasBit(const _qword* bits, _dword index) {
+	return (bits[index / 64] & (1ull << (index % 64))) != 0;
+}
+
+/**
+ * @brief Check whether any bit is in both sets.
+ */
+static _boolean HasCommonBit(const _qword* bits1, const _qword* bits2, _dword number) {
+	for (_dword i = 0; i < number; i++) {
+		if ((bits1[i] & bits2[i]) != 0)
+			return _true;
+	}
+
+	return _false;
+}
+
+/**
+ * @brief Copy the name, it's truncated if it's too long.
+ */
+static _void CopyName(_chara* buffer, const _chara* name) {
+	::snprintf(buffer, cMaxNameLength, "%s", name != _null ? name : "");
+}
+
+#pragma endregion
+
+#pragma region "FrameGraph"
+
+_void FrameGraph::OnStageJob(_void* parameter) {
+	FrameGraphStage* stage = (FrameGraphStage*)parameter;
+	FrameGraph* graph = stage->mGraph;
+
+	stage->mFunc(stage->mParameter);
+
+	// The successors are submitted before this job finished, so the counter never reaches zero early
+	for (_dword i = 0; i < stage->mSuccessorNumber; i++) {
+		FrameGraphStage* successor = &graph->mStages[graph->mSuccessors[stage->mSuccessorIndex + i]];
+		if (successor->mPendingNumber.Decrease(MemoryOrder::AcqRel) == 0)
+			JobSystem::Run(OnStageJob, successor, graph->mCounter);
+	}
+}
+
+FrameGraph::FrameGraph() {
+	mStages = new FrameGraphStage[cMaxStageNumber];
+	mStageNumber = 0;
+	mResources = new FrameGraphResource[cMaxResourceNumber];
+	mResourceNumber = 0;
+	mSuccessors = _null;
+	mCompiled = _false;
+	mCounter = _null;
+}
+
+FrameGraph::~FrameGraph() {
+	delete[] mStages;
+	delete[] mResources;
+	delete[] mSuccessors;
+}
+
+_dword FrameGraph::AddResource(const _chara* name) {
+	if (mResourceNumber == cMaxResourceNumber)
+		return -1;
+
+	CopyName(mResources[mResourceNumber].mName, name);
+
+	return mResourceNumber++;
+}
+
+_dword FrameGraph::AddStage(const _chara* name, OnStageProc func, _void* parameter) {
+	if (mStageNumber == cMaxStageNumber || func == _null)
+		return -1;
+
+	FrameGraphStage& stage = mStages[mStageNumber];
+	CopyName(stage.mName, name);
+	stage.mFunc = func;
+	stage.mParameter = parameter;
+	stage.mGraph = this;
+	E3D_INIT_ARRAY(stage.mReadResources);
+	E3D_INIT_ARRAY(stage.mWriteResources);
+
+	mCompiled = _false;
+
+	return mStageNumber++;
+}
+
+_boolean FrameGraph::Read(_dword stage, _dword resource) {
+	if (stage >= mStageNumber || resource >= mResourceNumber)
+		return _false;
+
+	SetBit(mStages[stage].mReadResources, resource);
+	mCompiled = _false;
+
+	return _true;
+}
+
+_boolean FrameGraph::Write(_dword stage, _dword resource) {
+	if (stage >= mStageNumber || resource >= mResourceNumber)
+		return _false;
+
+	SetBit(mStages[stage].mWriteResources, resource);
+	mCompiled = _false;
+
+	return _true;
+}
+
+_void FrameGraph::Clear() {
+	mStageNumber = 0;
+	mResourceNumber = 0;
+	mCompiled = _false;
+
+	delete[] mSuccessors;
+	mSuccessors = _null;
+}
+
+_void FrameGraph::Compile() {
+	if (mCompiled)
+		return;
+
+	// The stage depends on all conflicting stages added before it, so the graph is always acyclic
+	_dword successor_number = 0;
+	for (_dword i = 0; i < mStageNumber; i++) {
+		FrameGraphStage& stage = mStages[i];
+		E3D_INIT_ARRAY(stage.mDependencies);
+		stage.mLevel = 0;
+		stage.mDependencyNumber = 0;
+		stage.mSuccessorNumber = 0;
+
+		for (_dword j = 0; j < i; j++) {
+			FrameGraphStage& dependency = mStages[j];
+
+			// Read after write, write after read and write after write
+			if (!HasCommonBit(stage.mReadResources, dependency.mWriteResources, cResourceBitsNumber) &&
+				!HasCommonBit(stage.mWriteResources, dependency.mReadResources, cResourceBitsNumber) &&
+				!HasCommonBit(stage.mWriteResources, dependency.mWriteResources, cResourceBitsNumber))
+				continue;
+
+			SetBit(stage.mDependencies, j);
+			stage.mDependencyNumber++;
+			stage.mLevel = MAX(stage.mLevel, dependency.mLevel + 1);
+
+			dependency.mSuccessorNumber++;
+			successor_number++;
+		}
+	}
+
+	// Build the successor lists in the order of stages
+	delete[] mSuccessors;
+	mSuccessors = successor_number != 0 ? new _dword[successor_number] : _null;
+
+	_dword successor_index = 0;
+	for (_dword i = 0; i < mStageNumber; i++) {
+		mStages[i].mSuccessorIndex = successor_index;
+		successor_index += mStages[i].mSuccessorNumber;
+		mStages[i].mSuccessorNumber = 0;
+	}
+
+	for (_dword i = 0; i < mStageNumber; i++) {
+		for (_dword j = 0; j < i; j++) {
+			if (!HasBit(mStages[i].mDependencies, j))
+				continue;
+
+			FrameGraphStage& dependency = mStages[j];
+			mSuccessors[dependency.mSuccessorIndex + dependency.mSuccessorNumber++] = i;
+		}
+	}
+
+	mCompiled = _true;
+}
+
+_void FrameGraph::Execute(_boolean serial) {
+	if (serial || JobSystem::GetWorkerNumber() == 0) {
+		for (_dword i = 0; i < mStageNumber; i++)
+			mStages[i].mFunc(mStages[i].mParameter);
+
+		return;
+	}
+
+	Compile();
+
+	for (_dword i = 0; i < mStageNumber; i++)
+		mStages[i].mPendingNumber.Store(mStages[i].mDependencyNumber, MemoryOrder::Relaxed);
+
+	JobCounter counter;
+	mCounter = &counter;
+
+	// The stages without dependency start first, the others are submitted by their last dependency
+	for (_dword i = 0; i < mStageNumber; i++) {
+		if (mStages[i].mDependencyNumber == 0)
+			JobSystem::Run(OnStageJob, &mStages[i], &counter);
+	}
+
+	JobSystem::Wait(counter);
+
+	mCounter = _null;
+}
+
+_dword FrameGraph::GetStageNumber() const {
+	return mStageNumber;
+}
+
+const _chara* FrameGraph::GetStageName(_dword stage) const {
+	if (stage >= mStageNumber)
+		return _null;
+
+	return mStages[stage].mName;
+}
+
+_dword FrameGraph::GetStageLevel(_dword stage) const {
+	if (stage >= mStageNumber || !mCompiled)
+		return -1;
+
+	return mStages[stage].mLevel;
+}
+
+_boolean FrameGraph::IsDependent(_dword stage, _dword dependency) const {
+	if (stage >= mStageNumber || dependency >= mStageNumber || !mCompiled)
+		return _false;
+
+	return HasBit(mStages[stage].mDependencies, dependency);
+}
+
+#pragma endregion
+
+} // namespace E3D
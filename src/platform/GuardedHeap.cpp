@@ -0,0 +1,454 @@
+/**
+ * @file GuardedHeap.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The sampled guarded heap to catch the memory errors in production.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The maximum number of slots
+static const _dword cMaxSlotNumber = 64 * 1024;
+// The invalid slot index
+static const _dword cInvalidIndex = -1;
+
+/**
+ * @brief The slot of guarded block, every slot owns a page and the pages around it are guard pages.
+ */
+struct GuardedHeapSlot {
+	//!	The block, 0 indicates the slot has never been used.
+	_uintptr_t mAddress;
+	_qword mSize;
+	//!	True indicates the block has been freed.
+	_boolean mFreed;
+	//!	The memory tag which the block is charged to.
+	MemoryTag mTag;
+	_thread_id mAllocThreadID;
+	_thread_id mFreeThreadID;
+	_void* mAllocFrames[GuardedHeapErrorData::cMaxFrameNumber];
+	_dword mAllocFrameNumber;
+	_void* mFreeFrames[GuardedHeapErrorData::cMaxFrameNumber];
+	_dword mFreeFrameNumber;
+};
+
+Atomic<_dword> gGuardedHeapSampleRate;
+THREAD_LOCAL _dword gGuardedHeapSampleCountdown = 0;
+Atomic<_uintptr_t> gGuardedHeapBegin;
+Atomic<_uintptr_t> gGuardedHeapEnd;
+
+// The names of errors
+static const _chara* cErrorNames[] = {
+	"unknown error",
+	"use-after-free",
+	"buffer-overflow",
+	"buffer-underflow",
+	"double-free",
+	"invalid-free",
+};
+
+// The locker of slots
+static Atomic<_dword> sLocker;
+// The slots and the indices of free slots, they're mapped from the virtual memory so the heap is not reentered
+static GuardedHeapSlot* sSlots = _null;
+static _dword* sFreeSlots = _null;
+static _dword sSlotNumber = 0;
+static _dword sUsedSlotNumber = 0;
+static _dword sFreeSlotNumber = 0;
+// The page size
+static _dword sPageSize = 0;
+
+// The error callback
+static GuardedHeap::OnErrorProc sErrorFunc = _null;
+static _void* sErrorParameter = _null;
+
+// True indicates current thread is in the guarded heap, the allocations of itself are not sampled
+static THREAD_LOCAL _boolean sInGuardedHeap = _false;
+// The random seed of current thread
+static THREAD_LOCAL _qword sRandomSeed = 0;
+
+/**
+ * @brief Lock the slots.
+ */
+static _void LockSlots() {
+	while (_true) {
+		_dword unlocked = 0;
+		if (sLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			return;
+
+		while (sLocker.Load(MemoryOrder::Relaxed) != 0)
+			CPU_PAUSE();
+	}
+}
+
+/**
+ * @brief Unlock the slots.
+ */
+static _void UnlockSlots() {
+	sLocker.Store(0, MemoryOrder::Release);
+}
+
+/**
+ * @brief Get the random number of current thread.
+ */
+static _qword GetRandomNumber() {
+	if (sRandomSeed == 0)
+		sRandomSeed = ((_qword)(_uintptr_t)&sRandomSeed) ^ Platform::GetCurrentTickCount() ^ 0x9e3779b97f4a7c15ull;
+
+	// xorshift64
+	sRandomSeed ^= sRandomSeed << 13;
+	sRandomSeed ^= sRandomSeed >> 7;
+	sRandomSeed ^= sRandomSeed << 17;
+
+	return sRandomSeed;
+}
+
+/**
+ * @brief Get the page of slot, the first page of pool is a guard page.
+ */
+static _uintptr_t GetSlotPage(_dword index) {
+	return gGuardedHeapBegin.Load(MemoryOrder::Relaxed) + ((_uintptr_t)index * 2 + 1) * sPageSize;
+}
+
+/**
+ * @brief Get the slot index of address, returns -1 if it's in a guard page.
+ */
+static _dword GetSlotIndex(_uintptr_t address) {
+	_uintptr_t page_index = (address - gGuardedHeapBegin.Load(MemoryOrder::Relaxed)) / sPageSize;
+	if ((page_index & 1) == 0)
+		return cInvalidIndex;
+
+	return (_dword)(page_index / 2);
+}
+
+/**
+ * @brief Write the call stack to the debug output.
+ */
+static _void OutputCallStack(_void* const* frames, _dword number) {
+	for (_dword i = 0; i < number; i++) {
+		_chara name[512];
+		if (!Platform::GetSymbolName(frames[i], name, E3D_ARRAY_NUMBER(name)))
+			::snprintf(name, E3D_ARRAY_NUMBER(name), "%p", frames[i]);
+
+		_chara line[600];
+		::snprintf(line, E3D_ARRAY_NUMBER(line), "    #%u %s", i, name);
+		Platform::OutputDebugStringInLine(line);
+	}
+}
+
+/**
+ * @brief Write the error to the debug output.
+ */
+static _void OutputError(const GuardedHeapErrorData& error) {
+	_chara line[256];
+	::snprintf(line, E3D_ARRAY_NUMBER(line), "GuardedHeap: %s at %p", cErrorNames[(_dword)error.mError], error.mAddress);
+	Platform::OutputDebugStringInLine(line);
+
+	if (error.mBlock == _null)
+		return;
+
+	::snprintf(line, E3D_ARRAY_NUMBER(line), "The block %p (%llu bytes) is allocated by thread %llu:", error.mBlock, (unsigned long long)error.mSize, (unsigned long long)error.mAllocThreadID);
+	Platform::OutputDebugStringInLine(line);
+	OutputCallStack(error.mAllocFrames, error.mAllocFrameNumber);
+
+	if (error.mFreeThreadID == 0)
+		return;
+
+	::snprintf(line, E3D_ARRAY_NUMBER(line), "It's freed by thread %llu:", (unsigned long long)error.mFreeThreadID);
+	Platform::OutputDebugStringInLine(line);
+	OutputCallStack(error.mFreeFrames, error.mFreeFrameNumber);
+}
+
+/**
+ * @brief Report the error of slot, the slot could be null if the address does not match any block.
+ */
+static _void ReportError(GuardedHeapError type, _void* address, const GuardedHeapSlot* slot) {
+	GuardedHeapErrorData error;
+	E3D_INIT(error);
+	error.mError = type;
+	error.mAddress = address;
+
+	if (slot != _null) {
+		error.mBlock = (_void*)slot->mAddress;
+		error.mSize = slot->mSize;
+		error.mAllocThreadID = slot->mAllocThreadID;
+		error.mAllocFrameNumber = slot->mAllocFrameNumber;
+		E3D_MEM_CPY(error.mAllocFrames, slot->mAllocFrames, sizeof(error.mAllocFrames));
+
+		if (slot->mFreed) {
+			error.mFreeThreadID = slot->mFreeThreadID;
+			error.mFreeFrameNumber = slot->mFreeFrameNumber;
+			E3D_MEM_CPY(error.mFreeFrames, slot->mFreeFrames, sizeof(error.mFreeFrames));
+		}
+	}
+
+	if (sErrorFunc != _null)
+		sErrorFunc(error, sErrorParameter);
+	else
+		OutputError(error);
+}
+
+/**
+ * @brief The handler of memory access fault, it finds the block nearest to the faulting address.
+ * The process is crashing, so it does not lock the slots and it's fine to call the functions which are not async-signal-safe.
+ */
+static _void OnMemoryFault(_void* address) {
+	if (!GuardedHeap::IsGuarded(address))
+		return;
+
+	_uintptr_t fault_address = (_uintptr_t)address;
+
+	// The data page is inaccessible only if the block has been freed
+	_dword index = GetSlotIndex(fault_address);
+	if (index != cInvalidIndex) {
+		const GuardedHeapSlot& slot = sSlots[index];
+		if (slot.mAddress != 0 && slot.mFreed)
+			ReportError(GuardedHeapError::UseAfterFree, address, &slot);
+		else
+			ReportError(GuardedHeapError::Unknown, address, _null);
+
+		return;
+	}
+
+	// The guard page is between the block before it (overflow) and the block after it (underflow)
+	_dword page_index = (_dword)((fault_address - gGuardedHeapBegin.Load(MemoryOrder::Relaxed)) / sPageSize);
+	const GuardedHeapSlot* left_slot = page_index > 0 && sSlots[page_index / 2 - 1].mAddress != 0 ? &sSlots[page_index / 2 - 1] : _null;
+	const GuardedHeapSlot* right_slot = page_index / 2 < sSlotNumber && sSlots[page_index / 2].mAddress != 0 ? &sSlots[page_index / 2] : _null;
+
+	_uintptr_t left_distance = left_slot != _null ? fault_address - (left_slot->mAddress + left_slot->mSize) : (_uintptr_t)-1;
+	_uintptr_t right_distance = right_slot != _null ? right_slot->mAddress - fault_address : (_uintptr_t)-1;
+
+	if (left_slot == _null && right_slot == _null)
+		ReportError(GuardedHeapError::Unknown, address, _null);
+	else if (left_distance <= right_distance)
+		ReportError(left_slot->mFreed ? GuardedHeapError::UseAfterFree : GuardedHeapError::BufferOverflow, address, left_slot);
+	else
+		ReportError(right_slot->mFreed ? GuardedHeapError::UseAfterFree : GuardedHeapError::BufferUnderflow, address, right_slot);
+}
+
+/**
+ * @brief Take a slot, the freed slots are taken randomly so the freed pages stay inaccessible for a while.
+ */
+static _dword TakeSlot() {
+	_dword index = cInvalidIndex;
+
+	LockSlots();
+
+	if (sUsedSlotNumber < sSlotNumber) {
+		index = sUsedSlotNumber++;
+	} else if (sFreeSlotNumber != 0) {
+		_dword free_index = (_dword)(GetRandomNumber() % sFreeSlotNumber);
+		index = sFreeSlots[free_index];
+		sFreeSlots[free_index] = sFreeSlots[--sFreeSlotNumber];
+	}
+
+	UnlockSlots();
+
+	return index;
+}
+
+/**
+ * @brief Return the slot.
+ */
+static _void ReturnSlot(_dword index) {
+	LockSlots();
+	sFreeSlots[sFreeSlotNumber++] = index;
+	UnlockSlots();
+}
+
+#pragma endregion
+
+#pragma region "GuardedHeap"
+
+_boolean GuardedHeap::ShouldSampleSlow() {
+	_dword sample_rate = gGuardedHeapSampleRate.Load(MemoryOrder::Relaxed);
+	if (sample_rate == 0 || sInGuardedHeap)
+		return _false;
+
+	// The countdown of new thread is drawn without sampling, the intervals are uniform in [1, 2 * rate] so the mean is the rate
+	_boolean sample = gGuardedHeapSampleCountdown != 0;
+	gGuardedHeapSampleCountdown = (_dword)(GetRandomNumber() % ((_qword)sample_rate * 2)) + 1;
+
+	return sample;
+}
+
+_boolean GuardedHeap::Start(_dword slot_number, _dword sample_rate) {
+	if (slot_number == 0 || sample_rate == 0)
+		return _false;
+
+	LockSlots();
+
+	if (sSlots == _null) {
+		slot_number = MIN(slot_number, cMaxSlotNumber);
+
+		_dword page_size = Platform::GetPageSize();
+		_qword pool_size = ((_qword)slot_number * 2 + 1) * page_size;
+		_qword slots_size = (_qword)slot_number * (sizeof(GuardedHeapSlot) + sizeof(_dword));
+
+		_byte* pool = (_byte*)Platform::ReserveVirtualMemory(pool_size);
+		_byte* slots = (_byte*)Platform::ReserveVirtualMemory(slots_size);
+		if (pool == _null || slots == _null || !Platform::CommitVirtualMemory(slots, slots_size) || !Platform::SetMemoryFaultHandler(OnMemoryFault)) {
+			Platform::ReleaseVirtualMemory(pool, pool_size);
+			Platform::ReleaseVirtualMemory(slots, slots_size);
+
+			UnlockSlots();
+			return _false;
+		}
+
+		sSlots = (GuardedHeapSlot*)slots;
+		sFreeSlots = (_dword*)(sSlots + slot_number);
+		sSlotNumber = slot_number;
+		sPageSize = page_size;
+
+		// The end is published before the begin, so IsGuarded() never sees the begin without the end
+		gGuardedHeapEnd.Store((_uintptr_t)pool + (_uintptr_t)pool_size, MemoryOrder::Relaxed);
+		gGuardedHeapBegin.Store((_uintptr_t)pool, MemoryOrder::Release);
+	}
+
+	UnlockSlots();
+
+	// Enable sampling only after the pool is published
+	gGuardedHeapSampleRate.Store(sample_rate, MemoryOrder::Release);
+
+	return _true;
+}
+
+_void GuardedHeap::Stop() {
+	gGuardedHeapSampleRate.Store(0, MemoryOrder::Relaxed);
+}
+
+_boolean GuardedHeap::IsStarted() {
+	return gGuardedHeapSampleRate.Load(MemoryOrder::Relaxed) != 0;
+}
+
+_void GuardedHeap::SetErrorCallback(OnErrorProc func, _void* parameter) {
+	sErrorParameter = parameter;
+	sErrorFunc = func;
+}
+
+_void* GuardedHeap::Alloc(_qword size, _dword alignment) {
+	if (sSlots == _null || size > sPageSize || alignment == 0 || alignment > sPageSize || (alignment & (alignment - 1)) != 0)
+		return _null;
+
+	_dword index = TakeSlot();
+	if (index == cInvalidIndex)
+		return _null;
+
+	_uintptr_t page = GetSlotPage(index);
+	if (!Platform::CommitVirtualMemory((_void*)page, sPageSize)) {
+		ReturnSlot(index);
+		return _null;
+	}
+
+	// Place the block at the end of page to catch the overflow or at the beginning to catch the underflow,
+	// the overflow within the alignment padding is not caught
+	_uintptr_t address = page;
+	if (GetRandomNumber() & 1)
+		address = (page + sPageSize - MAX(size, (_qword)1)) & ~(_uintptr_t)(alignment - 1);
+
+	// The backtrace could allocate when it's called for the first time
+	sInGuardedHeap = _true;
+
+	GuardedHeapSlot& slot = sSlots[index];
+	slot.mAddress = address;
+	slot.mSize = size;
+	slot.mFreed = _false;
+	slot.mTag = MemoryTag::Default;
+	slot.mAllocThreadID = Platform::GetCurrentThreadID();
+	slot.mFreeThreadID = 0;
+	slot.mAllocFrameNumber = Platform::CaptureCallStack(slot.mAllocFrames, GuardedHeapErrorData::cMaxFrameNumber, 1);
+	slot.mFreeFrameNumber = 0;
+
+	sInGuardedHeap = _false;
+
+	return (_void*)address;
+}
+
+_boolean GuardedHeap::Free(_void* pointer) {
+	if (!IsGuarded(pointer))
+		return _false;
+
+	_dword index = GetSlotIndex((_uintptr_t)pointer);
+	if (index == cInvalidIndex) {
+		ReportError(GuardedHeapError::InvalidFree, pointer, _null);
+		return _false;
+	}
+
+	sInGuardedHeap = _true;
+
+	_void* frames[GuardedHeapErrorData::cMaxFrameNumber];
+	_dword frame_number = Platform::CaptureCallStack(frames, GuardedHeapErrorData::cMaxFrameNumber, 1);
+
+	sInGuardedHeap = _false;
+
+	// The state is changed in lock, so only one of the concurrent frees wins
+	LockSlots();
+
+	GuardedHeapSlot& slot = sSlots[index];
+	GuardedHeapError error = GuardedHeapError::Unknown;
+	if (slot.mAddress == 0 || slot.mAddress != (_uintptr_t)pointer)
+		error = GuardedHeapError::InvalidFree;
+	else if (slot.mFreed)
+		error = GuardedHeapError::DoubleFree;
+	else {
+		slot.mFreed = _true;
+		slot.mFreeThreadID = Platform::GetCurrentThreadID();
+		slot.mFreeFrameNumber = frame_number;
+		E3D_MEM_CPY(slot.mFreeFrames, frames, frame_number * sizeof(_void*));
+	}
+
+	UnlockSlots();
+
+	if (error != GuardedHeapError::Unknown) {
+		ReportError(error, pointer, slot.mAddress != 0 ? &slot : _null);
+		return _false;
+	}
+
+	// The page is inaccessible until the slot is reused, so the use-after-free faults
+	Platform::DecommitVirtualMemory((_void*)GetSlotPage(index), sPageSize);
+	ReturnSlot(index);
+
+	return _true;
+}
+
+_qword GuardedHeap::GetSize(const _void* pointer) {
+	if (!IsGuarded(pointer))
+		return 0;
+
+	_dword index = GetSlotIndex((_uintptr_t)pointer);
+	if (index == cInvalidIndex)
+		return 0;
+
+	return sSlots[index].mSize;
+}
+
+_void GuardedHeap::SetTag(const _void* pointer, MemoryTag tag) {
+	if (!IsGuarded(pointer))
+		return;
+
+	_dword index = GetSlotIndex((_uintptr_t)pointer);
+	if (index != cInvalidIndex)
+		sSlots[index].mTag = tag;
+}
+
+MemoryTag GuardedHeap::GetTag(const _void* pointer) {
+	if (!IsGuarded(pointer))
+		return MemoryTag::Default;
+
+	_dword index = GetSlotIndex((_uintptr_t)pointer);
+	if (index == cInvalidIndex)
+		return MemoryTag::Default;
+
+	return sSlots[index].mTag;
+}
+
+#pragma endregion
+
+} // namespace E3D
@@ -0,0 +1,698 @@
+/**
+ * @file JobSystem.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The engine-wide work-stealing job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+/**
+ * @brief The job.
+ */
+struct Job {
+	JobSystem::OnJobProc mFunc;
+	_void* mParameter;
+	JobCounter* mCounter;
+	_dword mAffinity;
+	Job* mNext;
+};
+
+/**
+ * @brief The FIFO job queue protected by critical section, it's used by the jobs submitted out of workers.
+ */
+class JobQueue {
+private:
+	_handle mLocker;
+	Atomic<Job*> mHead;
+	Job* mTail;
+
+public:
+	JobQueue() : mLocker(Platform::CreateCriticalSection()), mHead(_null), mTail(_null) {
+	}
+	~JobQueue() {
+		Platform::DeleteCriticalSection(mLocker);
+	}
+
+public:
+	_boolean IsEmpty() const {
+		return mHead.Load(MemoryOrder::Relaxed) == _null;
+	}
+
+	_void Push(Job* job) {
+		job->mNext = _null;
+
+		Platform::EnterCriticalSection(mLocker);
+		{
+			if (mTail != _null)
+				mTail->mNext = job;
+			else
+				mHead.Store(job, MemoryOrder::Relaxed);
+
+			mTail = job;
+		}
+		Platform::LeaveCriticalSection(mLocker);
+	}
+
+	Job* Pop() {
+		// Skip the locker if it's empty
+		if (IsEmpty())
+			return _null;
+
+		Platform::EnterCriticalSection(mLocker);
+		Job* job = mHead.Load(MemoryOrder::Relaxed);
+		if (job != _null) {
+			mHead.Store(job->mNext, MemoryOrder::Relaxed);
+			if (job->mNext == _null)
+				mTail = _null;
+		}
+		Platform::LeaveCriticalSection(mLocker);
+
+		return job;
+	}
+};
+
+/**
+ * @brief The Chase-Lev work-stealing deque, the owner pushes and pops at the bottom, the thieves steal from the top.
+ */
+class JobDeque {
+private:
+	static const _dword cCapacity = 4096;
+
+	CACHE_ALIGNED Atomic<_large> mTop;
+	CACHE_ALIGNED Atomic<_large> mBottom;
+	CACHE_ALIGNED Atomic<Job*> mJobs[cCapacity];
+
+public:
+	JobDeque() : mTop(0), mBottom(0) {
+	}
+
+public:
+	_boolean IsEmpty() const {
+		return mBottom.Load(MemoryOrder::Relaxed) <= mTop.Load(MemoryOrder::Relaxed);
+	}
+
+	//!	Only the owner could push.
+	_boolean Push(Job* job) {
+		_large bottom = mBottom.Load(MemoryOrder::Relaxed);
+		_large top = mTop.Load(MemoryOrder::Acquire);
+		if (bottom - top >= (_large)cCapacity)
+			return _false;
+
+		mJobs[bottom & (cCapacity - 1)].Store(job, MemoryOrder::Relaxed);
+		mBottom.Store(bottom + 1, MemoryOrder::Release);
+
+		return _true;
+	}
+
+	//!	Only the owner could pop.
+	Job* Pop() {
+		_large bottom = mBottom.Load(MemoryOrder::Relaxed) - 1;
+		mBottom.Store(bottom, MemoryOrder::Relaxed);
+		AtomicThreadFence(MemoryOrder::SeqCst);
+		_large top = mTop.Load(MemoryOrder::Relaxed);
+
+		if (top > bottom) {
+			mBottom.Store(bottom + 1, MemoryOrder::Relaxed);
+			return _null;
+		}
+
+		Job* job = mJobs[bottom & (cCapacity - 1)].Load(MemoryOrder::Relaxed);
+
+		// It's the last job, race with the thieves
+		if (top == bottom) {
+			if (!mTop.CompareExchange(top, top + 1, MemoryOrder::SeqCst))
+				job = _null;
+
+			mBottom.Store(bottom + 1, MemoryOrder::Relaxed);
+		}
+
+		return job;
+	}
+
+	//!	Any thread could steal.
+	Job* Steal() {
+		_large top = mTop.Load(MemoryOrder::Acquire);
+		AtomicThreadFence(MemoryOrder::SeqCst);
+		_large bottom = mBottom.Load(MemoryOrder::Acquire);
+
+		if (top >= bottom)
+			return _null;
+
+		Job* job = mJobs[top & (cCapacity - 1)].Load(MemoryOrder::Relaxed);
+		if (!mTop.CompareExchange(top, top + 1, MemoryOrder::SeqCst))
+			return _null;
+
+		return job;
+	}
+};
+
+/**
+ * @brief The worker, the mailbox keeps the jobs which prefer this worker.
+ */
+struct JobWorker {
+	_dword mIndex;
+	Atomic<_dword> mSleeping;
+	_handle mThread;
+	_handle mWakeEvent;
+	JobQueue mMailbox;
+	JobDeque mDeque;
+};
+
+// The maximum number of workers
+static const _dword cMaxWorkerNumber = 64;
+// The number of rounds to look for jobs before sleeping
+static const _dword cIdleRoundNumber = 64;
+// The interval in milliseconds to look for jobs when waiting for counter
+static const _dword cWaitInterval = 1;
+// The maximum number of free jobs cached by every worker
+static const _dword cMaxFreeJobNumber = 256;
+
+// The workers
+static JobWorker* sWorkers[cMaxWorkerNumber];
+static _dword sWorkerNumber = 0;
+// The queue of jobs submitted out of workers
+static JobQueue* sSharedQueue = _null;
+// The number of sleeping workers
+static Atomic<_dword> sSleepingNumber;
+// The next worker to wake up
+static Atomic<_dword> sNextWakeIndex;
+// The quit flag of workers
+static Atomic<_dword> sQuit;
+
+// The worker of current thread
+static thread_local JobWorker* sCurrentWorker = _null;
+// The random seed to pick the victim
+static thread_local _dword sRandomSeed = 0;
+// The free jobs of current worker
+static thread_local Job* sFreeJobs = _null;
+static thread_local _dword sFreeJobNumber = 0;
+
+/**
+ * @brief Allocate job, the workers reuse the finished jobs.
+ */
+static Job* AllocJob() {
+	Job* job = sFreeJobs;
+	if (job == _null)
+		return new Job;
+
+	sFreeJobs = job->mNext;
+	sFreeJobNumber--;
+
+	return job;
+}
+
+/**
+ * @brief Free job.
+ */
+static _void FreeJob(Job* job) {
+	if (sCurrentWorker == _null || sFreeJobNumber >= cMaxFreeJobNumber) {
+		delete job;
+		return;
+	}
+
+	job->mNext = sFreeJobs;
+	sFreeJobs = job;
+	sFreeJobNumber++;
+}
+
+/**
+ * @brief Free the cached jobs of current worker.
+ */
+static _void FreeJobCache() {
+	while (sFreeJobs != _null) {
+		Job* job = sFreeJobs;
+		sFreeJobs = job->mNext;
+		delete job;
+	}
+
+	sFreeJobNumber = 0;
+}
+
+/**
+ * @brief Get the next random number by xorshift.
+ */
+static _dword GetRandomNumber() {
+	if (sRandomSeed == 0)
+		sRandomSeed = (_dword)Platform::GetCurrentThreadID() | 1;
+
+	sRandomSeed ^= sRandomSeed << 13;
+	sRandomSeed ^= sRandomSeed >> 17;
+	sRandomSeed ^= sRandomSeed << 5;
+
+	return sRandomSeed;
+}
+
+/**
+ * @brief Check whether any job is pending.
+ */
+static _boolean HasPendingJob() {
+	if (!sSharedQueue->IsEmpty())
+		return _true;
+
+	for (_dword i = 0; i < sWorkerNumber; i++) {
+		if (!sWorkers[i]->mDeque.IsEmpty() || !sWorkers[i]->mMailbox.IsEmpty())
+			return _true;
+	}
+
+	return _false;
+}
+
+/**
+ * @brief Wake the worker if it's sleeping.
+ */
+static _boolean WakeWorker(JobWorker* worker) {
+	_dword sleeping = 1;
+	if (!worker->mSleeping.CompareExchange(sleeping, 0, MemoryOrder::SeqCst))
+		return _false;
+
+	sSleepingNumber.Decrease(MemoryOrder::SeqCst);
+	Platform::SetEvent(worker->mWakeEvent);
+
+	return _true;
+}
+
+/**
+ * @brief Wake a sleeping worker to run the new job.
+ */
+static _void WakeAnyWorker() {
+	// The job must be visible before checking sleepers, the worker publishes itself before checking jobs
+	AtomicThreadFence(MemoryOrder::SeqCst);
+	if (sSleepingNumber.Load(MemoryOrder::Relaxed) == 0)
+		return;
+
+	_dword start = sNextWakeIndex.FetchAdd(1, MemoryOrder::Relaxed);
+	for (_dword i = 0; i < sWorkerNumber; i++) {
+		if (WakeWorker(sWorkers[(start + i) % sWorkerNumber]))
+			return;
+	}
+}
+
+/**
+ * @brief Find a job, the order is own deque, own mailbox, shared queue, the others' deques and the others' mailboxes.
+ */
+static Job* FindJob(JobWorker* worker) {
+	Job* job = _null;
+
+	if (worker != _null) {
+		if ((job = worker->mDeque.Pop()) != _null)
+			return job;
+
+		if ((job = worker->mMailbox.Pop()) != _null)
+			return job;
+	}
+
+	if ((job = sSharedQueue->Pop()) != _null)
+		return job;
+
+	// Start from a random victim to spread the thieves
+	_dword start = GetRandomNumber();
+	for (_dword i = 0; i < sWorkerNumber; i++) {
+		JobWorker* victim = sWorkers[(start + i) % sWorkerNumber];
+		if (victim != worker && (job = victim->mDeque.Steal()) != _null) {
+			gPerformanceData.mStolenJobNumber.Increase();
+			return job;
+		}
+	}
+
+	// The affinity is a hint only, take it if we have nothing to do
+	for (_dword i = 0; i < sWorkerNumber; i++) {
+		JobWorker* victim = sWorkers[(start + i) % sWorkerNumber];
+		if (victim != worker && (job = victim->mMailbox.Pop()) != _null)
+			return job;
+	}
+
+	return _null;
+}
+
+/**
+ * @brief Sort the processors in affinity set node by node, so the adjacent workers share the same NUMA node.
+ */
+static _dword SortProcessorsByNode(const CPUSet& cpuset, _dword* processors) {
+	const CPUTopology& topology = Platform::GetCPUTopology();
+
+	_dword number = 0;
+	for (_dword node = 0; node < MAX(topology.mNodeNumber, (_dword)1); node++) {
+		for (_dword cpu = 0; cpu < CPUSet::cMaxCPUNumber; cpu++) {
+			if (!cpuset.Contains(cpu))
+				continue;
+
+			// The offline processors are put on node 0
+			_dword cpu_node = topology.mOnlineCPUs.Contains(cpu) ? topology.mCPUs[cpu].mNode : 0;
+			if (cpu_node == node || (node == 0 && cpu_node >= topology.mNodeNumber))
+				processors[number++] = cpu;
+		}
+	}
+
+	return number;
+}
+
+#pragma endregion
+
+#pragma region "JobCounter"
+
+JobCounter::JobCounter() {
+	mValue.Store(0, MemoryOrder::Relaxed);
+	mEvent = Platform::CreateEvent(_true, _true);
+	mLocker = Platform::CreateCriticalSection();
+	mDependentJobs = _null;
+}
+
+JobCounter::~JobCounter() {
+	E3D_ASSERT(IsDone());
+	E3D_ASSERT(mDependentJobs == _null);
+
+	// Wait for the last job to leave Decrease()
+	Platform::EnterCriticalSection(mLocker);
+	Platform::LeaveCriticalSection(mLocker);
+
+	Platform::CloseEvent(mEvent);
+	Platform::DeleteCriticalSection(mLocker);
+}
+
+_void JobCounter::Increase() {
+	if (mValue.FetchAdd(1, MemoryOrder::AcqRel) != 0)
+		return;
+
+	// Keep the event consistent with the value, see Decrease()
+	Platform::EnterCriticalSection(mLocker);
+	if (mValue.Load(MemoryOrder::Acquire) != 0)
+		Platform::ResetEvent(mEvent);
+	Platform::LeaveCriticalSection(mLocker);
+}
+
+Job* JobCounter::Decrease() {
+	// Only the last decrement takes the locker, the others must not bring the value to zero
+	_dword value = mValue.Load(MemoryOrder::Relaxed);
+	while (value > 1) {
+		if (mValue.CompareExchangeWeak(value, value - 1, MemoryOrder::AcqRel))
+			return _null;
+	}
+
+	// The value reaches zero in the locker, so the owner who waits for IsDone() and then takes the locker
+	// (see ~JobCounter() and JobSystem::Wait()) never releases the counter before we leave
+	Platform::EnterCriticalSection(mLocker);
+
+	Job* jobs = _null;
+	if (mValue.Decrease(MemoryOrder::AcqRel) == 0) {
+		jobs = mDependentJobs;
+		mDependentJobs = _null;
+		Platform::SetEvent(mEvent);
+	}
+
+	Platform::LeaveCriticalSection(mLocker);
+
+	return jobs;
+}
+
+_boolean JobCounter::AddDependentJob(Job* job) {
+	_boolean parked = _false;
+
+	Platform::EnterCriticalSection(mLocker);
+	if (mValue.Load(MemoryOrder::Acquire) != 0) {
+		job->mNext = mDependentJobs;
+		mDependentJobs = job;
+		parked = _true;
+	}
+	Platform::LeaveCriticalSection(mLocker);
+
+	return parked;
+}
+
+_dword JobCounter::GetValue() const {
+	return mValue.Load(MemoryOrder::Acquire);
+}
+
+_boolean JobCounter::IsDone() const {
+	return GetValue() == 0;
+}
+
+#pragma endregion
+
+#pragma region "JobSystem"
+
+_void JobSystem::ExecuteJob(Job* job) {
+	OnJobProc func = job->mFunc;
+	_void* parameter = job->mParameter;
+	JobCounter* counter = job->mCounter;
+
+	FreeJob(job);
+
+	func(parameter);
+
+	gPerformanceData.mJobNumber.Increase();
+
+	if (counter != _null)
+		DecreaseCounter(*counter);
+}
+
+_void JobSystem::ScheduleJob(Job* job) {
+	JobWorker* worker = sCurrentWorker;
+
+	// Post it to the preferred worker
+	if (job->mAffinity < sWorkerNumber && (worker == _null || worker->mIndex != job->mAffinity)) {
+		JobWorker* target = sWorkers[job->mAffinity];
+		target->mMailbox.Push(job);
+
+		AtomicThreadFence(MemoryOrder::SeqCst);
+		WakeWorker(target);
+		return;
+	}
+
+	if (worker != _null) {
+		// Run it now if the deque is full, it's the same as the depth-first order
+		if (!worker->mDeque.Push(job)) {
+			ExecuteJob(job);
+			return;
+		}
+	} else {
+		sSharedQueue->Push(job);
+	}
+
+	WakeAnyWorker();
+}
+
+_thread_ret JobSystem::OnWorkerThread(_void* parameter) {
+	JobWorker* worker = (JobWorker*)parameter;
+	sCurrentWorker = worker;
+
+	_dword idle_round = 0;
+	while (_true) {
+		Job* job = FindJob(worker);
+		if (job != _null) {
+			ExecuteJob(job);
+			idle_round = 0;
+			continue;
+		}
+
+		// Quit only when all jobs have finished
+		if (sQuit.Load(MemoryOrder::SeqCst) != 0)
+			break;
+
+		if (++idle_round < cIdleRoundNumber) {
+			CPU_PAUSE();
+			continue;
+		}
+
+		idle_round = 0;
+
+		// Publish the sleeping state before the last check, see WakeAnyWorker()
+		worker->mSleeping.Store(1, MemoryOrder::SeqCst);
+		sSleepingNumber.Increase(MemoryOrder::SeqCst);
+
+		if (HasPendingJob() || sQuit.Load(MemoryOrder::SeqCst) != 0) {
+			// Cancel sleeping, or somebody has woken us up already and the event is signaled
+			_dword sleeping = 1;
+			if (worker->mSleeping.CompareExchange(sleeping, 0, MemoryOrder::SeqCst))
+				sSleepingNumber.Decrease(MemoryOrder::SeqCst);
+
+			continue;
+		}
+
+		Platform::WaitForSingleObject(worker->mWakeEvent, -1);
+	}
+
+	FreeJobCache();
+	sCurrentWorker = _null;
+
+	return 0;
+}
+
+_boolean JobSystem::Initialize(_dword worker_number, _boolean pin_workers) {
+	if (sWorkerNumber != 0)
+		return _true;
+
+	CPUSet cpuset;
+	if (!Platform::GetProcessAffinity(_null, cpuset) || cpuset.GetNumber() == 0) {
+		cpuset.Clear();
+		cpuset.Add(0);
+	}
+
+	static _dword processors[CPUSet::cMaxCPUNumber];
+	_dword processor_number = SortProcessorsByNode(cpuset, processors);
+
+	// The caller thread helps to run jobs when waiting, so leave one processor for it
+	if (worker_number == 0)
+		worker_number = MAX(processor_number, (_dword)2) - 1;
+
+	worker_number = MIN(worker_number, cMaxWorkerNumber);
+
+	sSharedQueue = new JobQueue;
+	sQuit.Store(0, MemoryOrder::Relaxed);
+
+	for (_dword i = 0; i < worker_number; i++) {
+		JobWorker* worker = new JobWorker;
+		worker->mIndex = i;
+		worker->mSleeping.Store(0, MemoryOrder::Relaxed);
+		worker->mWakeEvent = Platform::CreateEvent(_false, _false);
+
+		// The workers must be ready before any of them runs
+		_thread_id threadid = 0;
+		worker->mThread = Platform::CreateThread(OnWorkerThread, 0, worker, _true, &threadid);
+		if (worker->mThread == _null) {
+			Platform::CloseEvent(worker->mWakeEvent);
+			delete worker;
+			break;
+		}
+
+		_chara name[32];
+		::snprintf(name, sizeof(name), "JobWorker%u", i);
+		Platform::SetThreadName(threadid, name);
+
+		// Skip the first processor, it's for the caller thread
+		if (pin_workers) {
+			CPUSet worker_cpuset;
+			worker_cpuset.Add(processors[(i + 1) % processor_number]);
+			Platform::SetThreadAffinity(worker->mThread, worker_cpuset);
+		}
+
+		sWorkers[sWorkerNumber++] = worker;
+	}
+
+	for (_dword i = 0; i < sWorkerNumber; i++)
+		Platform::ResumeThread(sWorkers[i]->mThread);
+
+	if (sWorkerNumber != worker_number) {
+		Finalize();
+		return _false;
+	}
+
+	return _true;
+}
+
+_void JobSystem::Finalize() {
+	if (sSharedQueue == _null)
+		return;
+
+	sQuit.Store(1, MemoryOrder::SeqCst);
+
+	for (_dword i = 0; i < sWorkerNumber; i++)
+		WakeWorker(sWorkers[i]);
+
+	for (_dword i = 0; i < sWorkerNumber; i++) {
+		JobWorker* worker = sWorkers[i];
+
+		Platform::WaitThread(worker->mThread, _null);
+		Platform::CloseThread(worker->mThread);
+		Platform::CloseEvent(worker->mWakeEvent);
+	}
+
+	for (_dword i = 0; i < sWorkerNumber; i++) {
+		delete sWorkers[i];
+		sWorkers[i] = _null;
+	}
+
+	sWorkerNumber = 0;
+
+	delete sSharedQueue;
+	sSharedQueue = _null;
+}
+
+_dword JobSystem::GetWorkerNumber() {
+	return sWorkerNumber;
+}
+
+_dword JobSystem::GetCurrentWorkerIndex() {
+	return sCurrentWorker != _null ? sCurrentWorker->mIndex : -1;
+}
+
+_void JobSystem::Run(OnJobProc func, _void* parameter, JobCounter* counter, JobCounter* dependency, _dword affinity) {
+	E3D_ASSERT(func != _null);
+
+	if (counter != _null)
+		counter->Increase();
+
+	Job* job = AllocJob();
+	job->mFunc = func;
+	job->mParameter = parameter;
+	job->mCounter = counter;
+	job->mAffinity = affinity;
+	job->mNext = _null;
+
+	// Run it in the caller thread if there is no worker
+	if (sWorkerNumber == 0) {
+		if (dependency != _null)
+			Wait(*dependency);
+
+		ExecuteJob(job);
+		return;
+	}
+
+	// Park it on the dependency, it will be scheduled when the dependency reaches zero
+	if (dependency != _null && dependency->AddDependentJob(job))
+		return;
+
+	ScheduleJob(job);
+}
+
+_void JobSystem::IncreaseCounter(JobCounter& counter) {
+	counter.Increase();
+}
+
+_void JobSystem::DecreaseCounter(JobCounter& counter) {
+	// Release the jobs depend on this counter
+	Job* jobs = counter.Decrease();
+	while (jobs != _null) {
+		Job* next = jobs->mNext;
+		ScheduleJob(jobs);
+		jobs = next;
+	}
+}
+
+_void JobSystem::Wait(JobCounter& counter) {
+	while (!counter.IsDone()) {
+		if (RunPendingJob())
+			continue;
+
+		// Look for the new jobs from time to time
+		Platform::WaitForSingleObject(counter.mEvent, cWaitInterval);
+	}
+
+	// The last job could still be in JobCounter::Decrease(), wait for it to leave the locker
+	Platform::EnterCriticalSection(counter.mLocker);
+	Platform::LeaveCriticalSection(counter.mLocker);
+}
+
+_boolean JobSystem::RunPendingJob() {
+	if (sWorkerNumber == 0)
+		return _false;
+
+	Job* job = FindJob(sCurrentWorker);
+	if (job == _null)
+		return _false;
+
+	ExecuteJob(job);
+	return _true;
+}
+
+#pragma endregion
+
+} // namespace E3D
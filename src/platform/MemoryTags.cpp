@@ -0,0 +1,308 @@
+/**
+ * @file MemoryTags.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The memory accounting per tag with budgets.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The number of tags
+static const _dword cTagNumber = (_dword)MemoryTag::Count;
+
+/**
+ * @brief The counters of tag, the live bytes are exact for the budgets, the totals are sharded since they're only read.
+ * It's constant-initialized, so the heap blocks allocated by the static constructors are charged before it's "constructed".
+ */
+struct CACHE_ALIGNED MemoryTagCounters {
+	Atomic<_qword> mLiveBytes;
+	Atomic<_qword> mPeakBytes;
+	Atomic<_qword> mLiveNumber;
+	Atomic<_qword> mSoftBudget;
+	Atomic<_qword> mHardBudget;
+	//!	True indicates the soft budget has been reported.
+	Atomic<_dword> mSoftExceeded;
+	ShardedCounter mTotalBytes;
+	ShardedCounter mTotalNumber;
+};
+
+// The tag names
+static const _chara* cTagNames[cTagNumber] = {
+	"Default",
+	"Platform",
+	"Graphic",
+	"Sound",
+	"Network",
+	"Script",
+	"Storage",
+	"Physx",
+	"Database",
+};
+
+// The counters of tags
+static MemoryTagCounters sCounters[cTagNumber];
+
+// The budget callback, it's changed in the locker and read without lock, see GetBudgetCallback()
+static Atomic<_dword> sBudgetLocker;
+static Atomic<MemoryTags::OnBudgetProc> sBudgetFunc;
+static Atomic<_void*> sBudgetParameter;
+
+// The tag of current thread
+static THREAD_LOCAL MemoryTag sThreadTag = MemoryTag::Default;
+
+// The last snapshot to calculate the allocation rates, it's protected by the locker
+static Atomic<_dword> sSnapshotLocker;
+static _dword sLastSnapshotTime = 0;
+static _qword sLastTotalBytes[cTagNumber];
+
+/**
+ * @brief Get the valid tag, the invalid one is the tag of current thread.
+ */
+static MemoryTag GetValidTag(MemoryTag tag) {
+	return (_dword)tag < cTagNumber ? tag : sThreadTag;
+}
+
+/**
+ * @brief Get the budget callback and its parameter as a pair, returns false if there is no callback.
+ */
+static _boolean GetBudgetCallback(MemoryTags::OnBudgetProc& func, _void*& parameter) {
+	// The writer clears the callback before changing the parameter, so the callback read again after the parameter
+	// is the one which the parameter belongs to, unless it's cleared
+	func = sBudgetFunc.Load(MemoryOrder::Acquire);
+	while (func != _null) {
+		parameter = sBudgetParameter.Load(MemoryOrder::Acquire);
+
+		MemoryTags::OnBudgetProc current_func = sBudgetFunc.Load(MemoryOrder::Acquire);
+		if (current_func == func)
+			return _true;
+
+		func = current_func;
+	}
+
+	return _false;
+}
+
+/**
+ * @brief Call the budget callback if any.
+ */
+static _boolean CallBudgetCallback(MemoryTag tag, MemoryBudgetEvent event, _qword live_bytes, _qword size) {
+	MemoryTags::OnBudgetProc func = _null;
+	_void* parameter = _null;
+	if (!GetBudgetCallback(func, parameter))
+		return _false;
+
+	func(tag, event, live_bytes, size, parameter);
+
+	return _true;
+}
+
+/**
+ * @brief Add the live bytes, it fails if the hard budget is exceeded.
+ */
+static _boolean AddLiveBytes(MemoryTag tag, _qword size) {
+	MemoryTagCounters& counters = sCounters[(_dword)tag];
+
+	_qword live_bytes = 0;
+	_qword hard_budget = counters.mHardBudget.Load(MemoryOrder::Relaxed);
+	if (hard_budget == 0) {
+		live_bytes = counters.mLiveBytes.FetchAdd(size, MemoryOrder::Relaxed) + size;
+	} else {
+		// Give the callback a chance to release the memory before failing
+		_boolean reported = _false;
+		live_bytes = counters.mLiveBytes.Load(MemoryOrder::Relaxed);
+		while (_true) {
+			if (live_bytes + size > hard_budget) {
+				if (reported || !CallBudgetCallback(tag, MemoryBudgetEvent::HardExceeded, live_bytes, size))
+					return _false;
+
+				reported = _true;
+
+				live_bytes = counters.mLiveBytes.Load(MemoryOrder::Relaxed);
+				continue;
+			}
+
+			if (counters.mLiveBytes.CompareExchangeWeak(live_bytes, live_bytes + size, MemoryOrder::Relaxed))
+				break;
+		}
+
+		live_bytes += size;
+	}
+
+	_qword peak_bytes = counters.mPeakBytes.Load(MemoryOrder::Relaxed);
+	while (live_bytes > peak_bytes && !counters.mPeakBytes.CompareExchangeWeak(peak_bytes, live_bytes, MemoryOrder::Relaxed))
+		;
+
+	// The soft budget is reported once until the live bytes drop below it
+	_qword soft_budget = counters.mSoftBudget.Load(MemoryOrder::Relaxed);
+	if (soft_budget != 0 && live_bytes > soft_budget && counters.mSoftExceeded.Load(MemoryOrder::Relaxed) == 0) {
+		if (counters.mSoftExceeded.Exchange(1, MemoryOrder::Relaxed) == 0)
+			CallBudgetCallback(tag, MemoryBudgetEvent::SoftExceeded, live_bytes, size);
+	}
+
+	counters.mTotalBytes.Add(size);
+
+	return _true;
+}
+
+/**
+ * @brief Subtract the live bytes.
+ */
+static _void SubLiveBytes(MemoryTag tag, _qword size) {
+	MemoryTagCounters& counters = sCounters[(_dword)tag];
+
+	_qword live_bytes = counters.mLiveBytes.FetchSub(size, MemoryOrder::Relaxed) - size;
+
+	_qword soft_budget = counters.mSoftBudget.Load(MemoryOrder::Relaxed);
+	if (live_bytes <= soft_budget && counters.mSoftExceeded.Load(MemoryOrder::Relaxed) != 0)
+		counters.mSoftExceeded.Store(0, MemoryOrder::Relaxed);
+}
+
+#pragma endregion
+
+#pragma region "MemoryTags"
+
+_void* MemoryTags::Alloc(_qword size, MemoryTag tag) {
+	MemoryTagScope scope(GetValidTag(tag));
+
+	return Platform::HeapAlloc(size);
+}
+
+_void* MemoryTags::ReAlloc(_void* pointer, _qword size) {
+	return Platform::HeapReAlloc(pointer, size);
+}
+
+_void MemoryTags::Free(_void* pointer) {
+	Platform::HeapFree(pointer);
+}
+
+MemoryTag MemoryTags::GetTag(const _void* pointer) {
+	if (pointer == _null)
+		return MemoryTag::Default;
+
+	return Platform::GetHeapBlockTag(pointer);
+}
+
+_boolean MemoryTags::OnAlloc(MemoryTag tag, _qword size) {
+	tag = GetValidTag(tag);
+
+	if (!AddLiveBytes(tag, size))
+		return _false;
+
+	MemoryTagCounters& counters = sCounters[(_dword)tag];
+	counters.mLiveNumber.Increase(MemoryOrder::Relaxed);
+	counters.mTotalNumber.Increase();
+
+	return _true;
+}
+
+_void MemoryTags::OnFree(MemoryTag tag, _qword size) {
+	tag = GetValidTag(tag);
+
+	SubLiveBytes(tag, size);
+	sCounters[(_dword)tag].mLiveNumber.Decrease(MemoryOrder::Relaxed);
+}
+
+MemoryTag MemoryTags::SetThreadTag(MemoryTag tag) {
+	MemoryTag previous_tag = sThreadTag;
+	sThreadTag = (_dword)tag < cTagNumber ? tag : MemoryTag::Default;
+
+	return previous_tag;
+}
+
+MemoryTag MemoryTags::GetThreadTag() {
+	return sThreadTag;
+}
+
+_void MemoryTags::SetBudget(MemoryTag tag, _qword soft_budget, _qword hard_budget) {
+	if ((_dword)tag >= cTagNumber)
+		return;
+
+	MemoryTagCounters& counters = sCounters[(_dword)tag];
+	counters.mSoftBudget.Store(soft_budget, MemoryOrder::Relaxed);
+	counters.mHardBudget.Store(hard_budget, MemoryOrder::Relaxed);
+	counters.mSoftExceeded.Store(0, MemoryOrder::Relaxed);
+}
+
+_void MemoryTags::SetBudgetCallback(OnBudgetProc func, _void* parameter) {
+	while (_true) {
+		_dword unlocked = 0;
+		if (sBudgetLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			break;
+
+		CPU_PAUSE();
+	}
+
+	// See GetBudgetCallback()
+	sBudgetFunc.Store(_null, MemoryOrder::Release);
+	sBudgetParameter.Store(parameter, MemoryOrder::Release);
+	sBudgetFunc.Store(func, MemoryOrder::Release);
+
+	sBudgetLocker.Store(0, MemoryOrder::Release);
+}
+
+const _chara* MemoryTags::GetTagName(MemoryTag tag) {
+	if ((_dword)tag >= cTagNumber)
+		return "";
+
+	return cTagNames[(_dword)tag];
+}
+
+_void MemoryTags::GetSnapshot(MemoryTagSnapshot& snapshot) {
+	snapshot.mTime = Platform::GetCurrentTickCount();
+
+	for (_dword i = 0; i < cTagNumber; i++) {
+		const MemoryTagCounters& counters = sCounters[i];
+		MemoryTagData& data = snapshot.mTags[i];
+
+		data.mLiveBytes = counters.mLiveBytes.Load(MemoryOrder::Relaxed);
+		data.mPeakBytes = counters.mPeakBytes.Load(MemoryOrder::Relaxed);
+		data.mLiveNumber = counters.mLiveNumber.Load(MemoryOrder::Relaxed);
+		data.mTotalBytes = counters.mTotalBytes.GetValue();
+		data.mTotalNumber = counters.mTotalNumber.GetValue();
+		data.mAllocRate = 0;
+		data.mSoftBudget = counters.mSoftBudget.Load(MemoryOrder::Relaxed);
+		data.mHardBudget = counters.mHardBudget.Load(MemoryOrder::Relaxed);
+	}
+
+	while (_true) {
+		_dword unlocked = 0;
+		if (sSnapshotLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			break;
+
+		CPU_PAUSE();
+	}
+
+	// The snapshots taken in the same millisecond share the last one
+	_dword elapse = snapshot.mTime - sLastSnapshotTime;
+	if (sLastSnapshotTime == 0 || elapse != 0) {
+		for (_dword i = 0; i < cTagNumber; i++) {
+			MemoryTagData& data = snapshot.mTags[i];
+
+			if (sLastSnapshotTime != 0 && data.mTotalBytes >= sLastTotalBytes[i])
+				data.mAllocRate = (data.mTotalBytes - sLastTotalBytes[i]) * 1000 / elapse;
+
+			sLastTotalBytes[i] = data.mTotalBytes;
+		}
+
+		sLastSnapshotTime = snapshot.mTime;
+	}
+
+	sSnapshotLocker.Store(0, MemoryOrder::Release);
+}
+
+_void MemoryTags::ResetPeak() {
+	for (_dword i = 0; i < cTagNumber; i++)
+		sCounters[i].mPeakBytes.Store(sCounters[i].mLiveBytes.Load(MemoryOrder::Relaxed), MemoryOrder::Relaxed);
+}
+
+#pragma endregion
+
+} // namespace E3D
@@ -0,0 +1,80 @@
+/**
+ * @file PerformanceData.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The sharded statistics counters and the performance data.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The next shard to assign, the threads are spread over shards in round-robin
+static Atomic<_dword> sNextShardIndex;
+// The shard index of current thread
+static THREAD_LOCAL _dword sShardIndex = -1;
+
+#pragma endregion
+
+#pragma region "ShardedCounter"
+
+_dword ShardedCounter::GetShardIndex() {
+	_dword index = sShardIndex;
+	if (index == (_dword)-1) {
+		index = sNextShardIndex.FetchAdd(1, MemoryOrder::Relaxed) % cShardNumber;
+		sShardIndex = index;
+	}
+
+	return index;
+}
+
+_void ShardedCounter::Add(_qword value) {
+	// The shard is rarely shared, so the atomic add does not bounce the cache line
+	mShards[GetShardIndex()].mValue.FetchAdd(value, MemoryOrder::Relaxed);
+}
+
+_void ShardedCounter::Increase() {
+	Add(1);
+}
+
+_qword ShardedCounter::GetValue() const {
+	_qword value = 0;
+	for (_dword i = 0; i < cShardNumber; i++)
+		value += mShards[i].mValue.Load(MemoryOrder::Relaxed);
+
+	return value;
+}
+
+_void ShardedCounter::Reset() {
+	for (_dword i = 0; i < cShardNumber; i++)
+		mShards[i].mValue.Store(0, MemoryOrder::Relaxed);
+}
+
+#pragma endregion
+
+#pragma region "PerformanceData"
+
+_void PerformanceData::Reset() {
+	mJobNumber.Reset();
+	mStolenJobNumber.Reset();
+	mFileReadNumber.Reset();
+	mFileReadBytes.Reset();
+	mFileWriteNumber.Reset();
+	mFileWriteBytes.Reset();
+	mSocketReadBytes.Reset();
+	mSocketWriteBytes.Reset();
+}
+
+const PerformanceData& Platform::GetPerformanceData() {
+	return gPerformanceData;
+}
+
+#pragma endregion
+
+} // namespace E3D
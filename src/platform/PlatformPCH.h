@@ -1,7 +1,11 @@
 #pragma once
 
 // Standard Files
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
 #include <cstdint>
+#include <exception>
 #include <limits>
 #include <math.h>
 #include <wchar.h>
@@ -161,10 +165,15 @@ int gettimeofday(struct timeval* tp, struct timezone* tzp);
 #	ifndef USE_PTHREAD
 #		define USE_PTHREAD
 #	endif
-#	include <pthread.h>
+
+// System Files
+#	include "os/linux/headers.h"
+
+// Network
+#	include "os/linux/networks.h"
 
 // Enable custom C Function Implementation
-#	define ENABLE_CUSTOM_C_FUNC_IMPL
+#	define ENABLE_CUSTOM_C_FUNC_IMPL 1
 
 #endif
 
@@ -192,7 +201,25 @@ wchar_t* __u64tow__(unsigned long long value, wchar_t* result, int base);
 
 // Platform Modules Headers
 #include "e3d_platform.h"
+#include "platform/Atomic.h"
+#include "platform/PerformanceData.h"
+#include "platform/CPUTopology.h"
+#include "platform/SmallAllocator.h"
+#include "platform/ThreadSampler.h"
+#include "platform/AllocationSampler.h"
+#include "platform/MemoryTags.h"
+#include "platform/FrameArena.h"
 #include "platform/Platform.h"
+#include "platform/GuardedHeap.h"
+#include "platform/SharedString.h"
+#include "platform/StringTable.h"
+#include "platform/ThreadLocal.h"
+#include "platform/JobSystem.h"
+#include "platform/Task.h"
+#include "platform/LockFreeQueue.h"
+#include "platform/Parallel.h"
+#include "platform/FrameGraph.h"
+#include "platform/ObjectPool.h"
 
 // Any-OS Files
 #include "os/anyPlatform.h"
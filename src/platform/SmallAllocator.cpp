@@ -0,0 +1,411 @@
+/**
+ * @file SmallAllocator.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The size-class allocator of small blocks.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The arena size, the pages are touched only when the spans are used
+#if _PLATFORM_ARCH_64
+static const _qword cArenaSize = 256 * 1024 * 1024;
+#else
+static const _qword cArenaSize = 32 * 1024 * 1024;
+#endif
+
+// The number of spans in arena
+static const _dword cSpanNumber = (_dword)(cArenaSize / SmallAllocator::cSpanSize);
+// The maximum number of blocks cached by every thread for each size class
+static const _dword cMaxCacheNumber = SmallAllocator::cBatchNumber * 2;
+
+/**
+ * @brief The arena state.
+ */
+enum class SmallArenaState : _dword {
+	None,
+	Initializing,
+	Ready,
+	Failed,
+};
+
+/**
+ * @brief The free block, the first block of batch links the next batch as well.
+ */
+struct SmallBlock {
+	SmallBlock* mNext;
+	SmallBlock* mNextBatch;
+};
+
+/**
+ * @brief The central lists of size class, they're protected by the spin lock, it's touched once per batch only.
+ */
+struct CACHE_ALIGNED SmallSizeClass {
+	Atomic<_dword> mLocker;
+	//!	The full batches.
+	SmallBlock* mBatches;
+	//!	The blocks which are not enough for a batch.
+	SmallBlock* mLooseBlocks;
+	_dword mLooseNumber;
+	//!	The remaining range of current span to carve.
+	_byte* mCurrent;
+	_byte* mEnd;
+};
+
+/**
+ * @brief The thread cache, it's zero initialized without constructor, so it's safe to use at any time.
+ */
+struct SmallThreadCache {
+	SmallBlock* mBlocks[SmallAllocator::cSizeClassNumber];
+	_dword mNumbers[SmallAllocator::cSizeClassNumber];
+	_boolean mRegistered;
+	_boolean mFinalized;
+};
+
+// The arena
+static Atomic<_byte*> sArena;
+static Atomic<SmallArenaState> sArenaState(SmallArenaState::None);
+// The number of used spans
+static Atomic<_dword> sSpanNumber;
+// The size class of every span
+static _byte sSpanSizeClasses[cSpanNumber];
+// The memory tag of every block, it's indexed by the granularity, the pages are touched only when the blocks are used
+static _byte sBlockTags[cArenaSize / SmallAllocator::cSizeClassGranularity];
+// The size classes
+static SmallSizeClass sSizeClasses[SmallAllocator::cSizeClassNumber];
+
+// The cache of current thread
+static THREAD_LOCAL SmallThreadCache sThreadCache;
+
+/**
+ * @brief Flush the cache at thread exit, the later frees of this thread go to the central lists directly.
+ */
+class SmallThreadCacheFlusher {
+public:
+	~SmallThreadCacheFlusher() {
+		SmallAllocator::FlushThreadCache();
+		sThreadCache.mFinalized = _true;
+	}
+
+public:
+	//!	Register the flusher of current thread.
+	_void Register() {
+		sThreadCache.mRegistered = _true;
+	}
+};
+
+// The flusher of current thread
+static thread_local SmallThreadCacheFlusher sThreadCacheFlusher;
+
+/**
+ * @brief Get the size class by size.
+ */
+static _dword GetSizeClass(_qword size) {
+	return size != 0 ? (_dword)((size - 1) / SmallAllocator::cSizeClassGranularity) : 0;
+}
+
+/**
+ * @brief Get the block size of size class.
+ */
+static _dword GetSizeClassBlockSize(_dword size_class) {
+	return (size_class + 1) * SmallAllocator::cSizeClassGranularity;
+}
+
+/**
+ * @brief Reserve the arena when it's used for the first time.
+ */
+static _byte* GetArena() {
+	_byte* arena = sArena.Load(MemoryOrder::Acquire);
+	if (arena != _null)
+		return arena;
+
+	SmallArenaState state = SmallArenaState::None;
+	if (sArenaState.CompareExchange(state, SmallArenaState::Initializing, MemoryOrder::AcqRel)) {
+		arena = (_byte*)Platform::AllocOnNode(cArenaSize, -1);
+		if (arena != _null)
+			sArena.Store(arena, MemoryOrder::Release);
+
+		sArenaState.Store(arena != _null ? SmallArenaState::Ready : SmallArenaState::Failed, MemoryOrder::Release);
+		return arena;
+	}
+
+	// The other thread is reserving it
+	while (sArenaState.Load(MemoryOrder::Acquire) == SmallArenaState::Initializing)
+		CPU_PAUSE();
+
+	return sArena.Load(MemoryOrder::Acquire);
+}
+
+/**
+ * @brief Lock the size class.
+ */
+static _void LockSizeClass(SmallSizeClass& size_class) {
+	while (_true) {
+		_dword unlocked = 0;
+		if (size_class.mLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			return;
+
+		while (size_class.mLocker.Load(MemoryOrder::Relaxed) != 0)
+			CPU_PAUSE();
+	}
+}
+
+/**
+ * @brief Unlock the size class.
+ */
+static _void UnlockSizeClass(SmallSizeClass& size_class) {
+	size_class.mLocker.Store(0, MemoryOrder::Release);
+}
+
+/**
+ * @brief Take a new span from the arena, returns cSpanNumber if the arena is full.
+ */
+static _dword TakeSpan() {
+	// The counter never goes beyond the capacity, so it does not wrap and hand out the spans in use again
+	_dword span = sSpanNumber.Load(MemoryOrder::Relaxed);
+	while (span < cSpanNumber) {
+		if (sSpanNumber.CompareExchangeWeak(span, span + 1, MemoryOrder::Relaxed))
+			return span;
+	}
+
+	return cSpanNumber;
+}
+
+/**
+ * @brief Fetch the blocks from the central lists, returns the number of blocks.
+ */
+static _dword FetchBlocks(_dword size_class_index, SmallBlock*& blocks) {
+	SmallSizeClass& size_class = sSizeClasses[size_class_index];
+	_dword number = 0;
+
+	LockSizeClass(size_class);
+	{
+		if (size_class.mBatches != _null) {
+			blocks = size_class.mBatches;
+			size_class.mBatches = blocks->mNextBatch;
+			number = SmallAllocator::cBatchNumber;
+		} else if (size_class.mLooseBlocks != _null) {
+			blocks = size_class.mLooseBlocks;
+			number = size_class.mLooseNumber;
+			size_class.mLooseBlocks = _null;
+			size_class.mLooseNumber = 0;
+		} else {
+			_dword block_size = GetSizeClassBlockSize(size_class_index);
+
+			// Take a new span, the tail of old span which is less than a block is wasted
+			if ((_dword)(size_class.mEnd - size_class.mCurrent) < block_size) {
+				_byte* arena = GetArena();
+				_dword span = arena != _null ? TakeSpan() : cSpanNumber;
+				if (span < cSpanNumber) {
+					sSpanSizeClasses[span] = (_byte)size_class_index;
+					size_class.mCurrent = arena + (_qword)span * SmallAllocator::cSpanSize;
+					size_class.mEnd = size_class.mCurrent + SmallAllocator::cSpanSize;
+				}
+			}
+
+			// Carve a batch
+			SmallBlock* tail = _null;
+			while (number < SmallAllocator::cBatchNumber && (_dword)(size_class.mEnd - size_class.mCurrent) >= block_size) {
+				SmallBlock* block = (SmallBlock*)size_class.mCurrent;
+				size_class.mCurrent += block_size;
+
+				block->mNext = _null;
+				if (tail != _null)
+					tail->mNext = block;
+				else
+					blocks = block;
+
+				tail = block;
+				number++;
+			}
+		}
+	}
+	UnlockSizeClass(size_class);
+
+	return number;
+}
+
+/**
+ * @brief Return the blocks to the central lists.
+ */
+static _void ReleaseBlocks(_dword size_class_index, SmallBlock* head, SmallBlock* tail, _dword number) {
+	SmallSizeClass& size_class = sSizeClasses[size_class_index];
+
+	LockSizeClass(size_class);
+	{
+		if (number == SmallAllocator::cBatchNumber) {
+			head->mNextBatch = size_class.mBatches;
+			size_class.mBatches = head;
+		} else {
+			tail->mNext = size_class.mLooseBlocks;
+			size_class.mLooseBlocks = head;
+			size_class.mLooseNumber += number;
+		}
+	}
+	UnlockSizeClass(size_class);
+}
+
+/**
+ * @brief Refill the thread cache and allocate a block.
+ */
+static NOINLINE _void* AllocSlow(_dword size_class_index) {
+	SmallBlock* blocks = _null;
+	_dword number = FetchBlocks(size_class_index, blocks);
+	if (number == 0)
+		return _null;
+
+	SmallBlock* block = blocks;
+	blocks = blocks->mNext;
+	number--;
+
+	// The thread is exiting, do not cache the blocks any more
+	if (sThreadCache.mFinalized) {
+		if (number != 0) {
+			SmallBlock* tail = blocks;
+			while (tail->mNext != _null)
+				tail = tail->mNext;
+
+			ReleaseBlocks(size_class_index, blocks, tail, number);
+		}
+
+		return block;
+	}
+
+	if (!sThreadCache.mRegistered)
+		sThreadCacheFlusher.Register();
+
+	// The cache is empty, otherwise the slow path is not called
+	sThreadCache.mBlocks[size_class_index] = blocks;
+	sThreadCache.mNumbers[size_class_index] = number;
+
+	return block;
+}
+
+/**
+ * @brief Return a batch of cached blocks to the central lists.
+ */
+static NOINLINE _void ReleaseBatch(_dword size_class_index) {
+	SmallBlock* head = sThreadCache.mBlocks[size_class_index];
+	SmallBlock* tail = head;
+	for (_dword i = 1; i < SmallAllocator::cBatchNumber; i++)
+		tail = tail->mNext;
+
+	sThreadCache.mBlocks[size_class_index] = tail->mNext;
+	sThreadCache.mNumbers[size_class_index] -= SmallAllocator::cBatchNumber;
+
+	tail->mNext = _null;
+	ReleaseBlocks(size_class_index, head, tail, SmallAllocator::cBatchNumber);
+}
+
+#pragma endregion
+
+#pragma region "SmallAllocator"
+
+_void* SmallAllocator::Alloc(_qword size) {
+	if (size > cMaxSmallSize)
+		return _null;
+
+	_dword size_class_index = GetSizeClass(size);
+
+	// The fast path, pop from the cache of current thread
+	SmallBlock* block = sThreadCache.mBlocks[size_class_index];
+	if (block != _null) {
+		sThreadCache.mBlocks[size_class_index] = block->mNext;
+		sThreadCache.mNumbers[size_class_index]--;
+		return block;
+	}
+
+	return AllocSlow(size_class_index);
+}
+
+_boolean SmallAllocator::Free(_void* pointer) {
+	if (!IsOwned(pointer))
+		return _false;
+
+	_byte* arena = sArena.Load(MemoryOrder::Relaxed);
+	_dword size_class_index = sSpanSizeClasses[((_byte*)pointer - arena) / cSpanSize];
+
+	SmallBlock* block = (SmallBlock*)pointer;
+
+	if (sThreadCache.mFinalized) {
+		block->mNext = _null;
+		ReleaseBlocks(size_class_index, block, block, 1);
+		return _true;
+	}
+
+	if (!sThreadCache.mRegistered)
+		sThreadCacheFlusher.Register();
+
+	// The fast path, push to the cache of current thread, no matter which thread allocated it
+	block->mNext = sThreadCache.mBlocks[size_class_index];
+	sThreadCache.mBlocks[size_class_index] = block;
+
+	if (++sThreadCache.mNumbers[size_class_index] > cMaxCacheNumber)
+		ReleaseBatch(size_class_index);
+
+	return _true;
+}
+
+_boolean SmallAllocator::IsOwned(const _void* pointer) {
+	const _byte* arena = sArena.Load(MemoryOrder::Relaxed);
+	if (arena == _null)
+		return _false;
+
+	return (const _byte*)pointer >= arena && (const _byte*)pointer < arena + cArenaSize;
+}
+
+_dword SmallAllocator::GetSize(const _void* pointer) {
+	if (!IsOwned(pointer))
+		return 0;
+
+	_byte* arena = sArena.Load(MemoryOrder::Relaxed);
+	return GetSizeClassBlockSize(sSpanSizeClasses[((const _byte*)pointer - arena) / cSpanSize]);
+}
+
+_void SmallAllocator::SetTag(const _void* pointer, MemoryTag tag) {
+	if (!IsOwned(pointer))
+		return;
+
+	_byte* arena = sArena.Load(MemoryOrder::Relaxed);
+	sBlockTags[((const _byte*)pointer - arena) / cSizeClassGranularity] = (_byte)tag;
+}
+
+MemoryTag SmallAllocator::GetTag(const _void* pointer) {
+	if (!IsOwned(pointer))
+		return MemoryTag::Default;
+
+	_byte* arena = sArena.Load(MemoryOrder::Relaxed);
+	return (MemoryTag)sBlockTags[((const _byte*)pointer - arena) / cSizeClassGranularity];
+}
+
+_void SmallAllocator::FlushThreadCache() {
+	for (_dword i = 0; i < cSizeClassNumber; i++) {
+		while (sThreadCache.mNumbers[i] >= cBatchNumber)
+			ReleaseBatch(i);
+
+		SmallBlock* head = sThreadCache.mBlocks[i];
+		if (head == _null)
+			continue;
+
+		SmallBlock* tail = head;
+		while (tail->mNext != _null)
+			tail = tail->mNext;
+
+		ReleaseBlocks(i, head, tail, sThreadCache.mNumbers[i]);
+
+		sThreadCache.mBlocks[i] = _null;
+		sThreadCache.mNumbers[i] = 0;
+	}
+}
+
+#pragma endregion
+
+} // namespace E3D
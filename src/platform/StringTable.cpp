@@ -0,0 +1,402 @@
+/**
+ * @file StringTable.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The global string interning table.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The number of shards, the shard is selected by the high bits of hash
+static const _dword cShardBits = 6;
+static const _dword cShardNumber = 1 << cShardBits;
+// The number of entries per chunk and the maximum number of chunks
+static const _dword cEntryChunkSize = 4096;
+static const _dword cMaxEntryChunkNumber = 4096;
+// The minimum capacity of shard
+static const _dword cMinShardCapacity = 64;
+// The block size of string arena
+static const _dword cArenaBlockSize = 16 * 1024;
+// The size of string buffer on stack
+static const _dword cStackBufferSize = 512;
+
+/**
+ * @brief The string entry, it's never changed after added.
+ */
+struct StringTableEntry {
+	const _chara* mString;
+	_dword mLength;
+	_dword mHash;
+	//!	The ID of lowercase variant, 0 indicates it's the entry itself.
+	_dword mFoldedID;
+};
+
+/**
+ * @brief The shard, it's an open addressing hash table of IDs and the strings are stored in the arena.
+ * It's constant-initialized, so the strings could be interned by the static constructors of any module. The arena is in
+ * the union so it's never destroyed, the strings are valid until the process exits, even in the static destructors.
+ */
+struct CACHE_ALIGNED StringTableShard {
+	Atomic<_dword> mLocker;
+	_dword* mSlots;
+	_dword mCapacity;
+	_dword mNumber;
+	union {
+		LinearArena mArena;
+	};
+
+	constexpr StringTableShard() : mSlots(_null), mCapacity(0), mNumber(0), mArena(cArenaBlockSize) {
+	}
+	~StringTableShard() {
+	}
+};
+
+// The shards
+static StringTableShard sShards[cShardNumber];
+// The chunks of entries, the entry of ID is at (ID - 1)
+static Atomic<StringTableEntry*> sEntryChunks[cMaxEntryChunkNumber];
+static Atomic<_dword> sEntryNumber;
+
+/**
+ * @brief Get the shard of hash.
+ */
+static StringTableShard& GetShard(_dword hash) {
+	return sShards[hash >> (32 - cShardBits)];
+}
+
+/**
+ * @brief Lock the shard.
+ */
+static _void LockShard(StringTableShard& shard) {
+	while (_true) {
+		_dword unlocked = 0;
+		if (shard.mLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			return;
+
+		while (shard.mLocker.Load(MemoryOrder::Relaxed) != 0)
+			CPU_PAUSE();
+	}
+}
+
+/**
+ * @brief Unlock the shard.
+ */
+static _void UnlockShard(StringTableShard& shard) {
+	shard.mLocker.Store(0, MemoryOrder::Release);
+}
+
+/**
+ * @brief Get the entry of ID, returns null if the ID is invalid.
+ */
+static const StringTableEntry* GetEntry(_dword id) {
+	if (id == StringTable::cNullID || id > sEntryNumber.Load(MemoryOrder::Acquire))
+		return _null;
+
+	StringTableEntry* chunk = sEntryChunks[(id - 1) / cEntryChunkSize].Load(MemoryOrder::Acquire);
+	if (chunk == _null)
+		return _null;
+
+	return &chunk[(id - 1) % cEntryChunkSize];
+}
+
+/**
+ * @brief Take a new entry, returns null if the table is full or out of memory, the ID is not taken when it fails.
+ */
+static StringTableEntry* AllocEntry(_dword& id) {
+	_dword number = sEntryNumber.Load(MemoryOrder::Relaxed);
+	while (_true) {
+		_dword chunk_index = number / cEntryChunkSize;
+		if (chunk_index >= cMaxEntryChunkNumber)
+			return _null;
+
+		// The chunk is added before the ID is taken, it's kept for the next ID if the ID is taken by the other thread
+		StringTableEntry* chunk = sEntryChunks[chunk_index].Load(MemoryOrder::Acquire);
+		if (chunk == _null) {
+			StringTableEntry* new_chunk = (StringTableEntry*)Platform::HeapAlloc(cEntryChunkSize * sizeof(StringTableEntry));
+			if (new_chunk == _null)
+				return _null;
+
+			E3D_MEM_SET(new_chunk, 0, cEntryChunkSize * sizeof(StringTableEntry));
+
+			// The other thread could add the chunk at the same time
+			if (sEntryChunks[chunk_index].CompareExchange(chunk, new_chunk, MemoryOrder::AcqRel))
+				chunk = new_chunk;
+			else
+				Platform::HeapFree(new_chunk);
+		}
+
+		if (sEntryNumber.CompareExchangeWeak(number, number + 1, MemoryOrder::AcqRel)) {
+			id = number + 1;
+			return &chunk[number % cEntryChunkSize];
+		}
+	}
+}
+
+/**
+ * @brief Find the string in the shard, it must be called in lock.
+ */
+static _dword FindInShard(const StringTableShard& shard, const _chara* string, _dword length, _dword hash) {
+	if (shard.mCapacity == 0)
+		return StringTable::cNullID;
+
+	_dword mask = shard.mCapacity - 1;
+	for (_dword index = hash & mask;; index = (index + 1) & mask) {
+		_dword id = shard.mSlots[index];
+		if (id == StringTable::cNullID)
+			return StringTable::cNullID;
+
+		const StringTableEntry* entry = GetEntry(id);
+		if (entry->mHash == hash && entry->mLength == length && ::memcmp(entry->mString, string, length) == 0)
+			return id;
+	}
+}
+
+/**
+ * @brief Insert the ID to the shard, the shard must have a free slot.
+ */
+static _void InsertToShard(StringTableShard& shard, _dword id, _dword hash) {
+	_dword mask = shard.mCapacity - 1;
+
+	_dword index = hash & mask;
+	while (shard.mSlots[index] != StringTable::cNullID)
+		index = (index + 1) & mask;
+
+	shard.mSlots[index] = id;
+}
+
+/**
+ * @brief Grow the shard when it's 3/4 full, it must be called in lock.
+ */
+static _boolean GrowShard(StringTableShard& shard) {
+	if ((shard.mNumber + 1) * 4 <= shard.mCapacity * 3)
+		return _true;
+
+	_dword capacity = MAX(shard.mCapacity * 2, cMinShardCapacity);
+	_dword* slots = (_dword*)Platform::HeapAlloc(capacity * sizeof(_dword));
+	if (slots == _null)
+		return _false;
+
+	E3D_MEM_SET(slots, 0, capacity * sizeof(_dword));
+
+	_dword* old_slots = shard.mSlots;
+	_dword old_capacity = shard.mCapacity;
+
+	shard.mSlots = slots;
+	shard.mCapacity = capacity;
+
+	for (_dword i = 0; i < old_capacity; i++) {
+		if (old_slots[i] != StringTable::cNullID)
+			InsertToShard(shard, old_slots[i], GetEntry(old_slots[i])->mHash);
+	}
+
+	Platform::HeapFree(old_slots);
+
+	return _true;
+}
+
+/**
+ * @brief Add the string to the shard, it must be called in lock.
+ */
+static _dword AddToShard(StringTableShard& shard, const _chara* string, _dword length, _dword hash, _dword folded_id) {
+	if (!GrowShard(shard))
+		return StringTable::cNullID;
+
+	_chara* buffer = (_chara*)shard.mArena.Alloc(length + 1, 1);
+	if (buffer == _null)
+		return StringTable::cNullID;
+
+	E3D_MEM_CPY(buffer, string, length);
+	buffer[length] = 0;
+
+	_dword id = StringTable::cNullID;
+	StringTableEntry* entry = AllocEntry(id);
+	if (entry == _null)
+		return StringTable::cNullID;
+
+	entry->mString = buffer;
+	entry->mLength = length;
+	entry->mHash = hash;
+	entry->mFoldedID = folded_id;
+
+	InsertToShard(shard, id, hash);
+	shard.mNumber++;
+
+	return id;
+}
+
+/**
+ * @brief Check whether the string has any ASCII uppercase letter.
+ */
+static _boolean HasUppercase(const _chara* string, _dword length) {
+	for (_dword i = 0; i < length; i++) {
+		if (string[i] >= 'A' && string[i] <= 'Z')
+			return _true;
+	}
+
+	return _false;
+}
+
+/**
+ * @brief Find the string, the string is added if required.
+ */
+static _dword InternString(const _chara* string, _dword length, _dword hash, _boolean add) {
+	StringTableShard& shard = GetShard(hash);
+
+	LockShard(shard);
+	_dword id = FindInShard(shard, string, length, hash);
+	UnlockShard(shard);
+
+	if (id != StringTable::cNullID || !add)
+		return id;
+
+	// The lowercase variant is added before the string, it has no uppercase letter so it never recurses again
+	_dword folded_id = 0;
+	if (HasUppercase(string, length)) {
+		_chara stack_buffer[cStackBufferSize];
+		_chara* folded = length <= cStackBufferSize ? stack_buffer : (_chara*)Platform::HeapAlloc(length);
+		if (folded == _null)
+			return StringTable::cNullID;
+
+		for (_dword i = 0; i < length; i++)
+			folded[i] = string[i] >= 'A' && string[i] <= 'Z' ? string[i] - 'A' + 'a' : string[i];
+
+		folded_id = InternString(folded, length, SharedStringHelper::GetHash(folded, length), _true);
+
+		if (folded != stack_buffer)
+			Platform::HeapFree(folded);
+
+		if (folded_id == StringTable::cNullID)
+			return StringTable::cNullID;
+	}
+
+	// The other thread could add it at the same time
+	LockShard(shard);
+
+	id = FindInShard(shard, string, length, hash);
+	if (id == StringTable::cNullID)
+		id = AddToShard(shard, string, length, hash, folded_id);
+
+	UnlockShard(shard);
+
+	return id;
+}
+
+/**
+ * @brief Find the UTF-16 string, the string is added if required.
+ */
+static _dword InternString(const _charw* string, _dword length, _boolean add) {
+	if (string == _null)
+		return StringTable::cNullID;
+
+	if (length == (_dword)-1)
+		length = Platform::StringLength(string);
+
+	// Every UTF-16 character takes 3 bytes at most in UTF-8, the size must not overflow
+	if (length > ((_dword)-1 - 1) / 3)
+		return StringTable::cNullID;
+
+	_chara stack_buffer[cStackBufferSize];
+	_dword size = length * 3 + 1;
+	_chara* buffer = size <= cStackBufferSize ? stack_buffer : (_chara*)Platform::HeapAlloc(size);
+	if (buffer == _null)
+		return StringTable::cNullID;
+
+	_dword utf8_length = length != 0 ? Platform::Utf16ToUtf8(buffer, size, string, length) : 0;
+	_dword id = InternString(buffer, utf8_length, SharedStringHelper::GetHash(buffer, utf8_length), add);
+
+	if (buffer != stack_buffer)
+		Platform::HeapFree(buffer);
+
+	return id;
+}
+
+#pragma endregion
+
+#pragma region "StringTable"
+
+_dword StringTable::Intern(const _chara* string, _dword length) {
+	if (string == _null)
+		return cNullID;
+
+	if (length == (_dword)-1)
+		length = Platform::StringLength(string);
+
+	return InternString(string, length, SharedStringHelper::GetHash(string, length), _true);
+}
+
+_dword StringTable::Intern(const _charw* string, _dword length) {
+	return InternString(string, length, _true);
+}
+
+_dword StringTable::Intern(const SharedStringA& string) {
+	return InternString(string.GetData(), string.GetLength(), string.GetHash(), _true);
+}
+
+_dword StringTable::Find(const _chara* string, _dword length) {
+	if (string == _null)
+		return cNullID;
+
+	if (length == (_dword)-1)
+		length = Platform::StringLength(string);
+
+	return InternString(string, length, SharedStringHelper::GetHash(string, length), _false);
+}
+
+_dword StringTable::Find(const _charw* string, _dword length) {
+	return InternString(string, length, _false);
+}
+
+_dword StringTable::GetFoldedID(_dword id) {
+	const StringTableEntry* entry = GetEntry(id);
+	if (entry == _null || entry->mFoldedID == 0)
+		return id;
+
+	return entry->mFoldedID;
+}
+
+const _chara* StringTable::GetString(_dword id) {
+	const StringTableEntry* entry = GetEntry(id);
+	if (entry == _null || entry->mString == _null)
+		return "";
+
+	return entry->mString;
+}
+
+_dword StringTable::GetLength(_dword id) {
+	const StringTableEntry* entry = GetEntry(id);
+	if (entry == _null)
+		return 0;
+
+	return entry->mLength;
+}
+
+_dword StringTable::GetHash(_dword id) {
+	const StringTableEntry* entry = GetEntry(id);
+	if (entry == _null)
+		return SharedStringHelper::GetHash("", 0);
+
+	return entry->mHash;
+}
+
+_dword StringTable::GetNumber() {
+	_dword number = 0;
+	for (_dword i = 0; i < cShardNumber; i++) {
+		LockShard(sShards[i]);
+		number += sShards[i].mNumber;
+		UnlockShard(sShards[i]);
+	}
+
+	return number;
+}
+
+#pragma endregion
+
+} // namespace E3D
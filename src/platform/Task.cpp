@@ -0,0 +1,233 @@
+/**
+ * @file Task.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The coroutine task running on the job system.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The maximum number of I/O threads to read files
+static const _dword cMaxFileThreadNumber = 16;
+// The maximum number of sockets reported by poller at once
+static const _dword cMaxSocketEventNumber = 64;
+
+// The I/O threads to read files
+static _handle sFileThreads[cMaxFileThreadNumber];
+static _dword sFileThreadNumber = 0;
+// The file requests queue
+static _handle sFileLocker = _null;
+static _handle sFileEvent = _null;
+static TaskIORequest* sFileRequestHead = _null;
+static TaskIORequest* sFileRequestTail = _null;
+
+// The socket poller and its thread
+static _handle sSocketPoller = _null;
+static _handle sSocketThread = _null;
+
+// The quit flag of threads
+static Atomic<_dword> sQuit;
+
+/**
+ * @brief Resume the coroutine in job.
+ */
+static _void OnResumeJob(_void* parameter) {
+	std::coroutine_handle<>::from_address(parameter).resume();
+}
+
+/**
+ * @brief Pop the file request.
+ */
+static TaskIORequest* PopFileRequest() {
+	Platform::EnterCriticalSection(sFileLocker);
+	TaskIORequest* request = sFileRequestHead;
+	if (request != _null) {
+		sFileRequestHead = request->mNext;
+		if (sFileRequestHead == _null)
+			sFileRequestTail = _null;
+	}
+	_boolean more = sFileRequestHead != _null;
+	Platform::LeaveCriticalSection(sFileLocker);
+
+	// Let the other I/O thread handle the rest
+	if (more)
+		Platform::SetEvent(sFileEvent);
+
+	return request;
+}
+
+/**
+ * @brief The I/O thread to read files.
+ */
+static _thread_ret OnFileThread(_void* parameter) {
+	UNUSED_VAR(parameter);
+
+	while (_true) {
+		TaskIORequest* request = PopFileRequest();
+		if (request == _null) {
+			// Pass the quit signal to the next I/O thread
+			if (sQuit.Load(MemoryOrder::Acquire) != 0) {
+				Platform::SetEvent(sFileEvent);
+				break;
+			}
+
+			Platform::WaitForSingleObject(sFileEvent, -1);
+			continue;
+		}
+
+		_dword bytes = 0;
+		request->mResult = Platform::ReadFile(request->mFile, request->mBuffer, request->mSize, &bytes) ? bytes : -1;
+
+		TaskSystem::Resume(request->mCoroutine);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief The socket poller thread.
+ */
+static _thread_ret OnSocketThread(_void* parameter) {
+	UNUSED_VAR(parameter);
+
+	_void* userdatas[cMaxSocketEventNumber];
+
+	while (sQuit.Load(MemoryOrder::Acquire) == 0) {
+		_dword number = Platform::WaitSocketPoller(sSocketPoller, userdatas, cMaxSocketEventNumber, -1);
+
+		for (_dword i = 0; i < number; i++)
+			TaskSystem::Resume(((TaskIORequest*)userdatas[i])->mCoroutine);
+	}
+
+	return 0;
+}
+
+#pragma endregion
+
+#pragma region "TaskSystem"
+
+_void TaskSystem::PostFileRequest(TaskIORequest* request) {
+	request->mNext = _null;
+
+	Platform::EnterCriticalSection(sFileLocker);
+	{
+		if (sFileRequestTail != _null)
+			sFileRequestTail->mNext = request;
+		else
+			sFileRequestHead = request;
+
+		sFileRequestTail = request;
+	}
+	Platform::LeaveCriticalSection(sFileLocker);
+
+	Platform::SetEvent(sFileEvent);
+}
+
+_boolean TaskSystem::PostSocketRequest(TaskIORequest* request) {
+	return Platform::WatchSocketReadable(sSocketPoller, request->mSocket, request);
+}
+
+_boolean TaskSystem::Initialize(_dword file_thread_number) {
+	if (sFileLocker != _null)
+		return _true;
+
+	sQuit.Store(0, MemoryOrder::Relaxed);
+	sFileLocker = Platform::CreateCriticalSection();
+	sFileEvent = Platform::CreateEvent(_false, _false);
+
+	sSocketPoller = Platform::CreateSocketPoller();
+	if (sSocketPoller == _null) {
+		Finalize();
+		return _false;
+	}
+
+	_thread_id threadid = 0;
+	sSocketThread = Platform::CreateThread(OnSocketThread, 0, _null, _false, &threadid);
+	if (sSocketThread == _null) {
+		Finalize();
+		return _false;
+	}
+
+	Platform::SetThreadName(threadid, "TaskSocket");
+
+	file_thread_number = MIN(MAX(file_thread_number, (_dword)1), cMaxFileThreadNumber);
+	for (_dword i = 0; i < file_thread_number; i++) {
+		_handle thread = Platform::CreateThread(OnFileThread, 0, _null, _false, &threadid);
+		if (thread == _null) {
+			Finalize();
+			return _false;
+		}
+
+		_chara name[32];
+		::snprintf(name, sizeof(name), "TaskFile%u", i);
+		Platform::SetThreadName(threadid, name);
+
+		sFileThreads[sFileThreadNumber++] = thread;
+	}
+
+	return _true;
+}
+
+_void TaskSystem::Finalize() {
+	if (sFileLocker == _null)
+		return;
+
+	sQuit.Store(1, MemoryOrder::Release);
+
+	Platform::SetEvent(sFileEvent);
+
+	for (_dword i = 0; i < sFileThreadNumber; i++) {
+		Platform::WaitThread(sFileThreads[i], _null);
+		Platform::CloseThread(sFileThreads[i]);
+		sFileThreads[i] = _null;
+	}
+
+	sFileThreadNumber = 0;
+
+	if (sSocketThread != _null) {
+		Platform::WakeSocketPoller(sSocketPoller);
+		Platform::WaitThread(sSocketThread, _null);
+		Platform::CloseThread(sSocketThread);
+		sSocketThread = _null;
+	}
+
+	Platform::CloseSocketPoller(sSocketPoller);
+	sSocketPoller = _null;
+
+	Platform::CloseEvent(sFileEvent);
+	sFileEvent = _null;
+
+	Platform::DeleteCriticalSection(sFileLocker);
+	sFileLocker = _null;
+}
+
+_void TaskSystem::Run(Task&& task, JobCounter* counter, _dword affinity) {
+	std::coroutine_handle<Task::promise_type> handle = task.mHandle;
+	E3D_ASSERT(handle);
+
+	// The task owns itself from now on, it's destroyed when it finished
+	task.mHandle = _null;
+
+	if (counter != _null) {
+		handle.promise().mCounter = counter;
+		JobSystem::IncreaseCounter(*counter);
+	}
+
+	Resume(handle, _null, affinity);
+}
+
+_void TaskSystem::Resume(std::coroutine_handle<> handle, JobCounter* dependency, _dword affinity) {
+	JobSystem::Run(OnResumeJob, handle.address(), _null, dependency, affinity);
+}
+
+#pragma endregion
+
+} // namespace E3D
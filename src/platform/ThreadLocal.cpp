@@ -0,0 +1,165 @@
+/**
+ * @file ThreadLocal.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The thread local storage.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+THREAD_LOCAL TLSEntry gTLSEntries[cMaxTLSSlotNumber];
+
+#pragma region "Internal variables and functions"
+
+// The number of rounds to call destructors, the destructor could set the value again
+static const _dword cDestructorRoundNumber = 4;
+
+/**
+ * @brief The TLS slot, the sequence is increased every time it's allocated.
+ */
+struct TLSSlot {
+	Atomic<_dword> mUsed;
+	Atomic<_dword> mSequence;
+	Atomic<Platform::OnTLSDestructorProc> mDestructor;
+};
+
+// The slots
+static TLSSlot sTLSSlots[cMaxTLSSlotNumber];
+
+// True indicates the cleaner of current thread has been destroyed
+static THREAD_LOCAL _boolean sTLSCleanerFinalized = _false;
+
+/**
+ * @brief Call the destructors of current thread at thread exit, it's registered by the first SetTLSValue().
+ */
+class TLSCleaner {
+public:
+	_boolean mRegistered;
+
+public:
+	TLSCleaner() : mRegistered(_false) {
+	}
+	~TLSCleaner() {
+		for (_dword round = 0; round < cDestructorRoundNumber; round++) {
+			_boolean called = _false;
+
+			for (_dword i = 0; i < cMaxTLSSlotNumber; i++) {
+				TLSEntry& entry = gTLSEntries[i];
+				if (entry.mValue == _null)
+					continue;
+
+				_void* value = entry.mValue;
+				entry.mValue = _null;
+
+				// Skip the value of freed slot
+				TLSSlot& slot = sTLSSlots[i];
+				if (slot.mUsed.Load(MemoryOrder::Acquire) == 0 || entry.mSlot != GetSlot(i, slot.mSequence.Load(MemoryOrder::Relaxed)))
+					continue;
+
+				Platform::OnTLSDestructorProc destructor = slot.mDestructor.Load(MemoryOrder::Relaxed);
+				if (destructor != _null) {
+					destructor(value);
+					called = _true;
+				}
+			}
+
+			if (!called)
+				break;
+		}
+
+		sTLSCleanerFinalized = _true;
+	}
+
+public:
+	//!	Build the slot by index and sequence, the sequence starts from 1, so the slot is never 0.
+	static _dword GetSlot(_dword index, _dword sequence) {
+		return index | (sequence << 16);
+	}
+};
+
+// The cleaner of current thread
+static thread_local TLSCleaner sTLSCleaner;
+
+/**
+ * @brief Register the cleaner for the values set by the thread_local destructors which run after the cleaner,
+ * the thread_local destructor registered during thread exit is called as well.
+ */
+static _void RegisterLateTLSCleaner() {
+	static thread_local TLSCleaner sLateTLSCleaner;
+	sLateTLSCleaner.mRegistered = _true;
+}
+
+#pragma endregion
+
+#pragma region "Platform TLS"
+
+_dword Platform::AllocTLS(OnTLSDestructorProc destructor) {
+	for (_dword i = 0; i < cMaxTLSSlotNumber; i++) {
+		TLSSlot& slot = sTLSSlots[i];
+
+		_dword unused = 0;
+		if (!slot.mUsed.CompareExchange(unused, 1, MemoryOrder::AcqRel))
+			continue;
+
+		// Skip 0 when the sequence wraps
+		_dword sequence = (slot.mSequence.Load(MemoryOrder::Relaxed) + 1) & 0xFFFF;
+		if (sequence == 0)
+			sequence = 1;
+
+		slot.mSequence.Store(sequence, MemoryOrder::Relaxed);
+		slot.mDestructor.Store(destructor, MemoryOrder::Relaxed);
+
+		return TLSCleaner::GetSlot(i, sequence);
+	}
+
+	return 0;
+}
+
+_void Platform::FreeTLS(_dword slot) {
+	_dword index = slot & 0xFFFF;
+	if (index >= cMaxTLSSlotNumber)
+		return;
+
+	sTLSSlots[index].mDestructor.Store(_null, MemoryOrder::Relaxed);
+	sTLSSlots[index].mUsed.Store(0, MemoryOrder::Release);
+}
+
+_void* Platform::GetTLSValue(_dword slot) {
+	_dword index = slot & 0xFFFF;
+	if (index >= cMaxTLSSlotNumber)
+		return _null;
+
+	const TLSEntry& entry = gTLSEntries[index];
+
+	return entry.mSlot == slot ? entry.mValue : _null;
+}
+
+_boolean Platform::SetTLSValue(_dword slot, _void* value) {
+	_dword index = slot & 0xFFFF;
+	if (slot == 0 || index >= cMaxTLSSlotNumber)
+		return _false;
+
+	// Register the cleaner of current thread
+	if (value != _null) {
+		if (sTLSCleanerFinalized)
+			RegisterLateTLSCleaner();
+		else if (!sTLSCleaner.mRegistered)
+			sTLSCleaner.mRegistered = _true;
+	}
+
+	TLSEntry& entry = gTLSEntries[index];
+	entry.mSlot = slot;
+	entry.mValue = value;
+
+	return _true;
+}
+
+#pragma endregion
+
+} // namespace E3D
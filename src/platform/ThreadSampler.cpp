@@ -0,0 +1,250 @@
+/**
+ * @file ThreadSampler.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The background sampler of per-thread CPU usage.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The snapshots, the sampler writes the one which is not published
+static ThreadCPUSnapshot sSnapshots[2];
+// The sequences of snapshots, it's odd when the snapshot is being written
+static Atomic<_dword> sSequences[2];
+// The index of published snapshot, -1 indicates there is no sample yet
+static Atomic<_dword> sPublishedIndex(-1);
+// The flag of sampling, only one thread samples at the same time
+static Atomic<_dword> sSampling;
+
+// The thread IDs of current sample, it's only accessed by the sampling thread
+static _thread_id sThreadIDs[ThreadCPUSnapshot::cMaxThreadNumber];
+
+// The sampler thread
+static _handle sSamplerThread = _null;
+// The event to stop the sampler thread
+static _handle sQuitEvent = _null;
+// The sample interval in milliseconds
+static _dword sInterval = 0;
+
+/**
+ * @brief Sort the thread IDs, there are few threads so the insertion sort is fine.
+ */
+static _void SortThreadIDs(_thread_id* threadids, _dword number) {
+	for (_dword i = 1; i < number; i++) {
+		_thread_id threadid = threadids[i];
+
+		_dword j = i;
+		for (; j > 0 && threadids[j - 1] > threadid; j--)
+			threadids[j] = threadids[j - 1];
+
+		threadids[j] = threadid;
+	}
+}
+
+/**
+ * @brief Get the percentage of interval.
+ */
+static _float GetIntervalRatio(_qword current, _qword last, _dword interval) {
+	if (interval == 0 || current < last)
+		return 0.0f;
+
+	// The interval is in milliseconds and the times are in nanoseconds
+	return MIN((_float)E3D_RATIO_D(current - last, (_qword)interval * 10000ull), 100.0f);
+}
+
+/**
+ * @brief Begin to read the published snapshot, returns null if there is no sample yet.
+ */
+static const ThreadCPUSnapshot* BeginReadSnapshot(_dword& index, _dword& sequence) {
+	while (_true) {
+		index = sPublishedIndex.Load(MemoryOrder::Acquire);
+		if (index == (_dword)-1)
+			return _null;
+
+		// The sampler is overwriting it, the next one must have been published
+		sequence = sSequences[index].Load(MemoryOrder::Acquire);
+		if ((sequence & 1) == 0)
+			return &sSnapshots[index];
+
+		CPU_PAUSE();
+	}
+}
+
+/**
+ * @brief End to read the snapshot, returns false if it has been overwritten while reading.
+ */
+static _boolean EndReadSnapshot(_dword index, _dword sequence) {
+	AtomicThreadFence(MemoryOrder::Acquire);
+
+	return sSequences[index].Load(MemoryOrder::Relaxed) == sequence;
+}
+
+#pragma endregion
+
+#pragma region "ThreadSampler"
+
+_thread_ret ThreadSampler::OnSamplerThread(_void* parameter) {
+	UNUSED_VAR(parameter);
+
+	while (!Platform::WaitForSingleObject(sQuitEvent, sInterval))
+		Sample();
+
+	return 0;
+}
+
+_boolean ThreadSampler::Initialize(_dword interval) {
+	if (sSamplerThread != _null)
+		return _true;
+
+	sInterval = MAX(interval, (_dword)1);
+
+	sQuitEvent = Platform::CreateEvent(_true, _false);
+	if (sQuitEvent == _null)
+		return _false;
+
+	_thread_id threadid = 0;
+	sSamplerThread = Platform::CreateThread(OnSamplerThread, 0, _null, _false, &threadid);
+	if (sSamplerThread == _null) {
+		Platform::CloseEvent(sQuitEvent);
+		sQuitEvent = _null;
+		return _false;
+	}
+
+	Platform::SetThreadName(threadid, "ThreadSampler");
+
+	// The first sample is the base of deltas
+	Sample();
+
+	return _true;
+}
+
+_void ThreadSampler::Finalize() {
+	if (sSamplerThread == _null)
+		return;
+
+	Platform::SetEvent(sQuitEvent);
+	Platform::WaitThread(sSamplerThread, _null);
+	Platform::CloseThread(sSamplerThread);
+	Platform::CloseEvent(sQuitEvent);
+
+	sSamplerThread = _null;
+	sQuitEvent = _null;
+}
+
+_boolean ThreadSampler::Sample() {
+	_dword unused = 0;
+	if (!sSampling.CompareExchange(unused, 1, MemoryOrder::Acquire))
+		return _false;
+
+	// The published snapshot is the base of deltas, it's never written until the next one is published
+	_dword published_index = sPublishedIndex.Load(MemoryOrder::Relaxed);
+	const ThreadCPUSnapshot* last = published_index != (_dword)-1 ? &sSnapshots[published_index] : _null;
+
+	_dword index = published_index != (_dword)-1 ? published_index ^ 1 : 0;
+	ThreadCPUSnapshot& snapshot = sSnapshots[index];
+
+	_dword thread_number = Platform::GetProcessThreadIDs(sThreadIDs, ThreadCPUSnapshot::cMaxThreadNumber);
+	SortThreadIDs(sThreadIDs, thread_number);
+
+	// The slow readers of this snapshot retry
+	sSequences[index].Increase(MemoryOrder::Relaxed);
+	AtomicThreadFence(MemoryOrder::Release);
+
+	snapshot.mSampleTime = Platform::GetCurrentTickCount();
+	snapshot.mInterval = last != _null ? snapshot.mSampleTime - last->mSampleTime : 0;
+	snapshot.mThreadNumber = 0;
+
+	// Both thread lists are sorted, so walk them together to find the last data
+	_dword last_thread_index = 0;
+	for (_dword i = 0; i < thread_number; i++) {
+		ThreadCPUData& data = snapshot.mThreads[snapshot.mThreadNumber];
+		E3D_INIT(data);
+
+		// The thread could exit at any time
+		if (!Platform::GetThreadSchedulingData(sThreadIDs[i], data.mTotal))
+			continue;
+
+		snapshot.mThreadNumber++;
+
+		if (last == _null)
+			continue;
+
+		while (last_thread_index < last->mThreadNumber && last->mThreads[last_thread_index].mTotal.mThreadID < sThreadIDs[i])
+			last_thread_index++;
+
+		if (last_thread_index == last->mThreadNumber || last->mThreads[last_thread_index].mTotal.mThreadID != sThreadIDs[i])
+			continue;
+
+		const ThreadSchedulingData& current_total = data.mTotal;
+		const ThreadSchedulingData& last_total = last->mThreads[last_thread_index].mTotal;
+
+		data.mUserUsage = GetIntervalRatio(current_total.mUserTime, last_total.mUserTime, snapshot.mInterval);
+		data.mKernelUsage = GetIntervalRatio(current_total.mKernelTime, last_total.mKernelTime, snapshot.mInterval);
+		data.mRunQueueWaitRatio = GetIntervalRatio(current_total.mRunQueueWaitTime, last_total.mRunQueueWaitTime, snapshot.mInterval);
+		data.mVoluntarySwitchNumber = (_dword)(current_total.mVoluntarySwitchNumber - last_total.mVoluntarySwitchNumber);
+		data.mInvoluntarySwitchNumber = (_dword)(current_total.mInvoluntarySwitchNumber - last_total.mInvoluntarySwitchNumber);
+	}
+
+	sSequences[index].Increase(MemoryOrder::Release);
+	sPublishedIndex.Store(index, MemoryOrder::Release);
+
+	sSampling.Store(0, MemoryOrder::Release);
+
+	return _true;
+}
+
+_boolean ThreadSampler::GetSnapshot(ThreadCPUSnapshot& snapshot) {
+	while (_true) {
+		_dword index = 0, sequence = 0;
+		const ThreadCPUSnapshot* published = BeginReadSnapshot(index, sequence);
+		if (published == _null)
+			return _false;
+
+		// Copy the used threads only
+		snapshot.mSampleTime = published->mSampleTime;
+		snapshot.mInterval = published->mInterval;
+		snapshot.mThreadNumber = MIN(published->mThreadNumber, ThreadCPUSnapshot::cMaxThreadNumber);
+		::memcpy(snapshot.mThreads, published->mThreads, snapshot.mThreadNumber * sizeof(ThreadCPUData));
+
+		if (EndReadSnapshot(index, sequence))
+			return _true;
+	}
+}
+
+_boolean ThreadSampler::GetThreadCPUData(_thread_id threadid, ThreadCPUData& data) {
+	while (_true) {
+		_dword index = 0, sequence = 0;
+		const ThreadCPUSnapshot* published = BeginReadSnapshot(index, sequence);
+		if (published == _null)
+			return _false;
+
+		// Binary search by thread ID
+		_dword low = 0, high = MIN(published->mThreadNumber, ThreadCPUSnapshot::cMaxThreadNumber);
+		while (low < high) {
+			_dword middle = (low + high) / 2;
+			if (published->mThreads[middle].mTotal.mThreadID < threadid)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		_boolean found = low < published->mThreadNumber && published->mThreads[low].mTotal.mThreadID == threadid;
+		if (found)
+			data = published->mThreads[low];
+
+		if (EndReadSnapshot(index, sequence))
+			return found;
+	}
+}
+
+#pragma endregion
+
+} // namespace E3D
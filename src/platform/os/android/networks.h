@@ -42,12 +42,3 @@
 
 //! The socket handle
 typedef SOCKET _socket;
-
-// Linux Platform
-#elif defined(_PLATFORM_LINUX_)
-
-#	include <sys/socket.h>
-#	include <unistd.h>
-
-//! The socket handle
-typedef int _socket;
\ No newline at end of file
@@ -0,0 +1,621 @@
+/**
+ * @file linuxFile.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The file system implementation for linux.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+#include "os/linux/linuxHelper.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+/**
+ * @brief The file, we track the file pointer by ourself and use pread/pwrite to avoid the extra seek system calls.
+ */
+struct linuxFile {
+	_int mFD;
+	_dword mWritable;
+	_qword mOffset;
+};
+
+/**
+ * @brief The file mapping.
+ */
+struct linuxFileMapping {
+	_int mFD;
+	_dword mWritable;
+	_qword mSize;
+};
+
+/**
+ * @brief The mapped view, the 'munmap' needs the size of view.
+ */
+struct linuxMappedView {
+	_void* mPointer;
+	_qword mSize;
+	linuxMappedView* mNext;
+};
+
+/**
+ * @brief The directory finder.
+ */
+struct linuxDir {
+	DIR* mDir;
+	_chara mPath[PATH_MAX];
+};
+
+// The mapped views
+static pthread_mutex_t sMappedViewsLocker = PTHREAD_MUTEX_INITIALIZER;
+static linuxMappedView* sMappedViews = _null;
+
+static _dword BuildFileAttributes(const _chara* filename, const struct stat& status) {
+	_dword attributes = 0;
+
+	if (S_ISDIR(status.st_mode))
+		attributes |= FileAttribute::Directory;
+	else if (S_ISREG(status.st_mode))
+		attributes |= FileAttribute::Normal;
+	else
+		attributes |= FileAttribute::Device;
+
+	if ((status.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) == 0)
+		attributes |= FileAttribute::ReadOnly;
+
+	// The dot files are hidden
+	const _chara* name = ::strrchr(filename, '/');
+	name = name != _null ? name + 1 : filename;
+	if (name[0] == '.' && name[1] != 0 && ::strcmp(name, "..") != 0)
+		attributes |= FileAttribute::Hidden;
+
+	return attributes;
+}
+
+static _void BuildFileTime(const timespec& time, FileTime& filetime) {
+	_qword value = linuxHelper::TimespecToFileTime(time);
+
+	filetime.mLowDateTime = E3D_LODWORD(value);
+	filetime.mHighDateTime = E3D_HIDWORD(value);
+}
+
+static _handle OpenFileByFlags(const _charw* filename, _int flags) {
+	if (filename == _null)
+		return _null;
+
+	linuxPath path(filename);
+
+	_dword writable = _true;
+	_int fd = ::open(path, flags | O_RDWR | O_CLOEXEC, 0644);
+	if (fd == -1 && (errno == EACCES || errno == EROFS) && (flags & O_CREAT) == 0) {
+		fd = ::open(path, flags | O_RDONLY | O_CLOEXEC);
+		writable = _false;
+	}
+
+	if (fd == -1)
+		return _null;
+
+	linuxFile* file = new linuxFile;
+	file->mFD = fd;
+	file->mWritable = writable;
+	file->mOffset = 0;
+
+	return file;
+}
+
+static _boolean GetPathFromEnvironment(const _chara* name, const _chara* subpath, _charw* path, _dword length) {
+	const _chara* root = ::getenv(name);
+	if (root == _null || root[0] == 0)
+		return _false;
+
+	_chara buffer[PATH_MAX];
+	::snprintf(buffer, sizeof(buffer), "%s%s", root, subpath);
+
+	return linuxHelper::CopyPath(path, length, buffer);
+}
+
+#pragma endregion
+
+#pragma region "IO"
+
+_handle Platform::OpenDir(const _charw* directory) {
+	if (directory == _null)
+		return _null;
+
+	linuxPath path(directory);
+
+	DIR* dir = ::opendir(path);
+	if (dir == _null)
+		return _null;
+
+	linuxDir* finder = new linuxDir;
+	finder->mDir = dir;
+	::snprintf(finder->mPath, sizeof(finder->mPath), "%s", (const _chara*)path);
+
+	return finder;
+}
+
+_void Platform::CloseDir(_handle handle) {
+	linuxDir* finder = (linuxDir*)handle;
+	if (finder == _null)
+		return;
+
+	::closedir(finder->mDir);
+	delete finder;
+}
+
+_boolean Platform::ReadDir(_handle handle, FileFinderData& finderdata) {
+	linuxDir* finder = (linuxDir*)handle;
+	if (finder == _null)
+		return _false;
+
+	while (dirent* entry = ::readdir(finder->mDir)) {
+		// Skip the current and parent directories
+		if (::strcmp(entry->d_name, ".") == 0 || ::strcmp(entry->d_name, "..") == 0)
+			continue;
+
+		_chara filename[PATH_MAX];
+		::snprintf(filename, sizeof(filename), "%s/%s", finder->mPath, entry->d_name);
+
+		struct stat status;
+		if (::stat(filename, &status) != 0)
+			continue;
+
+		E3D_INIT(finderdata);
+		finderdata.mFileAttributes = BuildFileAttributes(filename, status);
+		finderdata.mFileSizeHigh = E3D_HIDWORD(status.st_size);
+		finderdata.mFileSizeLow = E3D_LODWORD(status.st_size);
+		BuildFileTime(status.st_ctim, finderdata.mCreationTime);
+		BuildFileTime(status.st_atim, finderdata.mLastAccessTime);
+		BuildFileTime(status.st_mtim, finderdata.mLastWriteTime);
+		linuxHelper::CopyPath(finderdata.mFileName, E3D_ARRAY_NUMBER(finderdata.mFileName), entry->d_name);
+
+		return _true;
+	}
+
+	return _false;
+}
+
+_boolean Platform::GetFileAttributes(const _charw* filename, _dword& attributes) {
+	if (filename == _null)
+		return _false;
+
+	linuxPath path(filename);
+
+	struct stat status;
+	if (::stat(path, &status) != 0)
+		return _false;
+
+	attributes = BuildFileAttributes(path, status);
+
+	return _true;
+}
+
+_boolean Platform::SetFileAttributes(const _charw* filename, _dword attributes) {
+	if (filename == _null)
+		return _false;
+
+	linuxPath path(filename);
+
+	struct stat status;
+	if (::stat(path, &status) != 0)
+		return _false;
+
+	// Only the read-only attribute could be mapped to the permission bits
+	mode_t mode = status.st_mode & 07777;
+	if (attributes & FileAttribute::ReadOnly)
+		mode &= ~(S_IWUSR | S_IWGRP | S_IWOTH);
+	else
+		mode |= S_IWUSR;
+
+	return ::chmod(path, mode) == 0;
+}
+
+_handle Platform::CreateFile(const _charw* filename) {
+	return OpenFileByFlags(filename, O_CREAT | O_TRUNC);
+}
+
+_handle Platform::OpenFile(const _charw* filename) {
+	return OpenFileByFlags(filename, 0);
+}
+
+_void Platform::CloseFile(_handle handle) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return;
+
+	::close(file->mFD);
+	delete file;
+}
+
+_boolean Platform::ReadFile(_handle handle, _void* buffer, _dword size, _dword* bytesread) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null || buffer == _null)
+		return _false;
+
+	_dword total = 0;
+	while (total < size) {
+		ssize_t bytes = ::pread(file->mFD, (_byte*)buffer + total, size - total, (off_t)(file->mOffset + total));
+		if (bytes == -1) {
+			if (errno == EINTR)
+				continue;
+
+			return _false;
+		}
+
+		// Reach the end of file
+		if (bytes == 0)
+			break;
+
+		total += (_dword)bytes;
+	}
+
+	file->mOffset += total;
+
+	gPerformanceData.mFileReadNumber.Increase();
+	gPerformanceData.mFileReadBytes.Add(total);
+
+	if (bytesread != _null)
+		*bytesread = total;
+
+	return _true;
+}
+
+_boolean Platform::WriteFile(_handle handle, const _void* buffer, _dword size, _dword* byteswritten) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null || buffer == _null || !file->mWritable)
+		return _false;
+
+	_dword total = 0;
+	while (total < size) {
+		ssize_t bytes = ::pwrite(file->mFD, (const _byte*)buffer + total, size - total, (off_t)(file->mOffset + total));
+		if (bytes == -1) {
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		total += (_dword)bytes;
+	}
+
+	file->mOffset += total;
+
+	gPerformanceData.mFileWriteNumber.Increase();
+	gPerformanceData.mFileWriteBytes.Add(total);
+
+	if (byteswritten != _null)
+		*byteswritten = total;
+
+	return total == size;
+}
+
+_boolean Platform::FlushFileBuffers(_handle handle) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return _false;
+
+	return ::fdatasync(file->mFD) == 0;
+}
+
+_dword Platform::SeekFilePointer(_handle handle, SeekFlag flag, _int distance) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return -1;
+
+	_large base = 0;
+	switch (flag) {
+		case SeekFlag::Begin:
+			base = 0;
+			break;
+
+		case SeekFlag::Current:
+			base = (_large)file->mOffset;
+			break;
+
+		case SeekFlag::End: {
+			struct stat status;
+			if (::fstat(file->mFD, &status) != 0)
+				return -1;
+
+			base = (_large)status.st_size;
+		} break;
+
+		default:
+			return -1;
+	}
+
+	if (base + distance < 0)
+		return -1;
+
+	file->mOffset = (_qword)(base + distance);
+
+	return (_dword)file->mOffset;
+}
+
+_dword Platform::GetFileSize(_handle handle) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return -1;
+
+	struct stat status;
+	if (::fstat(file->mFD, &status) != 0)
+		return -1;
+
+	return (_dword)status.st_size;
+}
+
+_boolean Platform::SetEndOfFile(_handle handle) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return _false;
+
+	return ::ftruncate(file->mFD, (off_t)file->mOffset) == 0;
+}
+
+_boolean Platform::GetFileTime(_handle handle, FileTime* creation, FileTime* lastaccess, FileTime* lastwrite) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return _false;
+
+	struct stat status;
+	if (::fstat(file->mFD, &status) != 0)
+		return _false;
+
+	// There is no creation time in stat, use the last status change time instead
+	if (creation != _null)
+		BuildFileTime(status.st_ctim, *creation);
+	if (lastaccess != _null)
+		BuildFileTime(status.st_atim, *lastaccess);
+	if (lastwrite != _null)
+		BuildFileTime(status.st_mtim, *lastwrite);
+
+	return _true;
+}
+
+_boolean Platform::SetFileTime(_handle handle, const FileTime* creation, const FileTime* lastaccess, const FileTime* lastwrite) {
+	linuxFile* file = (linuxFile*)handle;
+	if (file == _null)
+		return _false;
+
+	// The creation time could not be changed
+	UNUSED_VAR(creation);
+
+	timespec times[2];
+	times[0].tv_sec = 0;
+	times[0].tv_nsec = UTIME_OMIT;
+	times[1].tv_sec = 0;
+	times[1].tv_nsec = UTIME_OMIT;
+
+	if (lastaccess != _null)
+		times[0] = linuxHelper::FileTimeToTimespec(E3D_MAKEQWORD(lastaccess->mLowDateTime, lastaccess->mHighDateTime));
+	if (lastwrite != _null)
+		times[1] = linuxHelper::FileTimeToTimespec(E3D_MAKEQWORD(lastwrite->mLowDateTime, lastwrite->mHighDateTime));
+
+	return ::futimens(file->mFD, times) == 0;
+}
+
+_boolean Platform::DeleteFile(const _charw* filename) {
+	if (filename == _null)
+		return _false;
+
+	return ::unlink(linuxPath(filename)) == 0;
+}
+
+_boolean Platform::CopyFile(const _charw* desfilename, const _charw* srcfilename) {
+	if (desfilename == _null || srcfilename == _null)
+		return _false;
+
+	_int srcfd = ::open(linuxPath(srcfilename), O_RDONLY | O_CLOEXEC);
+	if (srcfd == -1)
+		return _false;
+
+	struct stat status;
+	if (::fstat(srcfd, &status) != 0) {
+		::close(srcfd);
+		return _false;
+	}
+
+	_int desfd = ::open(linuxPath(desfilename), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, status.st_mode & 07777);
+	if (desfd == -1) {
+		::close(srcfd);
+		return _false;
+	}
+
+	// Copy in kernel without the user space buffer
+	_boolean ret = _true;
+	for (off_t offset = 0; offset < status.st_size;) {
+		ssize_t bytes = ::copy_file_range(srcfd, &offset, desfd, _null, (size_t)(status.st_size - offset), 0);
+		if (bytes <= 0) {
+			if (bytes == -1 && errno == EINTR)
+				continue;
+
+			ret = _false;
+			break;
+		}
+	}
+
+	::close(desfd);
+	::close(srcfd);
+
+	return ret;
+}
+
+_boolean Platform::MoveFile(const _charw* desfilename, const _charw* srcfilename) {
+	if (desfilename == _null || srcfilename == _null)
+		return _false;
+
+	return ::rename(linuxPath(srcfilename), linuxPath(desfilename)) == 0;
+}
+
+_boolean Platform::GetAbsoluteDirectory(const _charw* path, _charw* abs_path, _dword abs_path_length) {
+	if (path == _null)
+		return _false;
+
+	_chara buffer[PATH_MAX];
+	if (::realpath(linuxPath(path), buffer) == _null)
+		return _false;
+
+	return linuxHelper::CopyPath(abs_path, abs_path_length, buffer);
+}
+
+_boolean Platform::GetCurrentDirectory(_charw* path, _dword length) {
+	_chara buffer[PATH_MAX];
+	if (::getcwd(buffer, sizeof(buffer)) == _null)
+		return _false;
+
+	return linuxHelper::CopyPath(path, length, buffer);
+}
+
+_boolean Platform::SetCurrentDirectory(const _charw* path) {
+	if (path == _null)
+		return _false;
+
+	return ::chdir(linuxPath(path)) == 0;
+}
+
+_boolean Platform::CreateDirectory(const _charw* path) {
+	if (path == _null)
+		return _false;
+
+	return ::mkdir(linuxPath(path), 0755) == 0 || errno == EEXIST;
+}
+
+_boolean Platform::RemoveDirectory(const _charw* path) {
+	if (path == _null)
+		return _false;
+
+	return ::rmdir(linuxPath(path)) == 0;
+}
+
+_handle Platform::CreateFileMapping(_handle file, _dword size) {
+	linuxFile* file_object = (linuxFile*)file;
+	if (file_object == _null)
+		return _null;
+
+	struct stat status;
+	if (::fstat(file_object->mFD, &status) != 0)
+		return _null;
+
+	// Grow the file to fit the mapping size
+	if (size == 0) {
+		size = (_dword)status.st_size;
+	} else if ((_qword)size > (_qword)status.st_size) {
+		if (!file_object->mWritable || ::ftruncate(file_object->mFD, (off_t)size) != 0)
+			return _null;
+	}
+
+	if (size == 0)
+		return _null;
+
+	// The mapping keeps its own descriptor, so it could outlive the file handle
+	_int fd = ::dup(file_object->mFD);
+	if (fd == -1)
+		return _null;
+
+	linuxFileMapping* mapping = new linuxFileMapping;
+	mapping->mFD = fd;
+	mapping->mWritable = file_object->mWritable;
+	mapping->mSize = size;
+
+	return mapping;
+}
+
+_void* Platform::MapViewOfFile(_handle handle) {
+	linuxFileMapping* mapping = (linuxFileMapping*)handle;
+	if (mapping == _null)
+		return _null;
+
+	_int protection = PROT_READ | (mapping->mWritable ? PROT_WRITE : 0);
+
+	_void* pointer = ::mmap(_null, (size_t)mapping->mSize, protection, MAP_SHARED, mapping->mFD, 0);
+	if (pointer == MAP_FAILED)
+		return _null;
+
+	linuxMappedView* view = new linuxMappedView;
+	view->mPointer = pointer;
+	view->mSize = mapping->mSize;
+
+	pthread_mutex_lock(&sMappedViewsLocker);
+	view->mNext = sMappedViews;
+	sMappedViews = view;
+	pthread_mutex_unlock(&sMappedViewsLocker);
+
+	return pointer;
+}
+
+_void Platform::UnmapViewOfFile(_void* pointer) {
+	if (pointer == _null)
+		return;
+
+	linuxMappedView* view = _null;
+
+	pthread_mutex_lock(&sMappedViewsLocker);
+	for (linuxMappedView** it = &sMappedViews; *it != _null; it = &(*it)->mNext) {
+		if ((*it)->mPointer == pointer) {
+			view = *it;
+			*it = view->mNext;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&sMappedViewsLocker);
+
+	if (view == _null)
+		return;
+
+	::munmap(view->mPointer, (size_t)view->mSize);
+	delete view;
+}
+
+_boolean Platform::GetInternalPathInDomains(_charw* path, _dword length) {
+	// The directory of executable file
+	_chara buffer[PATH_MAX];
+	ssize_t size = ::readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+	if (size == -1)
+		return _false;
+
+	buffer[size] = 0;
+
+	_chara* separator = ::strrchr(buffer, '/');
+	if (separator != _null)
+		*separator = 0;
+
+	return linuxHelper::CopyPath(path, length, buffer);
+}
+
+_boolean Platform::GetExternalPathInDomains(_charw* path, _dword length) {
+	if (GetPathFromEnvironment("XDG_DATA_HOME", "", path, length))
+		return _true;
+
+	return GetPathFromEnvironment("HOME", "/.local/share", path, length);
+}
+
+_boolean Platform::GetDocumentPathInDomains(_charw* path, _dword length) {
+	return GetPathFromEnvironment("HOME", "", path, length);
+}
+
+_boolean Platform::GetDiskFreeSpace(const _charw* directory, _qword* freebytes, _qword* totalbytes) {
+	if (directory == _null)
+		return _false;
+
+	struct statvfs status;
+	if (::statvfs(linuxPath(directory), &status) != 0)
+		return _false;
+
+	if (freebytes != _null)
+		*freebytes = (_qword)status.f_bavail * (_qword)status.f_frsize;
+	if (totalbytes != _null)
+		*totalbytes = (_qword)status.f_blocks * (_qword)status.f_frsize;
+
+	return _true;
+}
+
+#pragma endregion
+
+} // namespace E3D
@@ -0,0 +1,132 @@
+/**
+ * @file linuxHelper.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The helper functions for linux platform.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The UTF-8 path converted from UTF-16, the linux system calls only accept UTF-8.
+ * 
+ */
+class linuxPath {
+private:
+	_chara mPath[PATH_MAX];
+
+public:
+	linuxPath(const _charw* path) {
+		mPath[0] = 0;
+
+		if (path != _null)
+			Platform::Utf16ToUtf8(mPath, E3D_ARRAY_NUMBER(mPath), path);
+	}
+
+public:
+	operator const _chara*() const {
+		return mPath;
+	}
+};
+
+/**
+ * @brief The helper functions.
+ * 
+ */
+class linuxHelper {
+public:
+	/**
+	 * @brief The 100-nanosecond intervals between 1601/01/01 (file time) and 1970/01/01 (unix time).
+	 * 
+	 */
+	static const _qword cUnixEpochInFileTime = 116444736000000000ull;
+
+public:
+	/**
+	 * @brief Get the monotonic clock in nanoseconds.
+	 * 
+	 * @return _qword The monotonic clock in nanoseconds.
+	 */
+	static _qword GetMonotonicNanoseconds() {
+		timespec time;
+		::clock_gettime(CLOCK_MONOTONIC, &time);
+
+		return (_qword)time.tv_sec * 1000000000ull + (_qword)time.tv_nsec;
+	}
+
+	/**
+	 * @brief Copy UTF-8 string to UTF-16 buffer.
+	 * 
+	 * @param [in] buffer The UTF-16 buffer.
+	 * @param [in] length The max size of buffer in number of characters.
+	 * @param [in] string The UTF-8 string.
+	 * @return _boolean True indicates success, false indicates the buffer is too small.
+	 */
+	static _boolean CopyPath(_charw* buffer, _dword length, const _chara* string) {
+		if (buffer == _null || length == 0)
+			return _false;
+
+		buffer[0] = 0;
+		return Platform::Utf8ToUtf16(buffer, length, string) < length;
+	}
+
+	/**
+	 * @brief Convert timespec to file time ( in 100-nanosecond intervals from 1601/01/01 ).
+	 * 
+	 * @param [in] time The timespec.
+	 * @return _qword The file time.
+	 */
+	static _qword TimespecToFileTime(const timespec& time) {
+		return (_qword)time.tv_sec * 10000000ull + (_qword)time.tv_nsec / 100 + cUnixEpochInFileTime;
+	}
+
+	/**
+	 * @brief Convert file time ( in 100-nanosecond intervals from 1601/01/01 ) to timespec.
+	 * 
+	 * @param [in] filetime The file time.
+	 * @return timespec The timespec.
+	 */
+	static timespec FileTimeToTimespec(_qword filetime) {
+		timespec time;
+		filetime -= cUnixEpochInFileTime;
+		time.tv_sec = (time_t)(filetime / 10000000ull);
+		time.tv_nsec = (long)(filetime % 10000000ull) * 100;
+		return time;
+	}
+
+	/**
+	 * @brief Read the whole small text file, such as files in '/proc'.
+	 * 
+	 * @param [in] filename The file name.
+	 * @param [out] buffer The buffer.
+	 * @param [in] size The buffer size in bytes.
+	 * @return _dword The number of bytes read (not containers '\0' character), -1 indicates failure.
+	 */
+	static _dword ReadTextFile(const _chara* filename, _chara* buffer, _dword size) {
+		_int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+			return -1;
+
+		_dword total = 0;
+		while (total + 1 < size) {
+			ssize_t bytes = ::read(fd, buffer + total, size - total - 1);
+			if (bytes <= 0)
+				break;
+
+			total += (_dword)bytes;
+		}
+
+		::close(fd);
+
+		buffer[total] = 0;
+		return total;
+	}
+};
+
+} // namespace E3D
@@ -0,0 +1,4232 @@
+/**
+ * @file linuxPlatform.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The OS platform implementation for linux.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+#include "os/linux/linuxHelper.h"
+#include "os/linux/linuxSync.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+// The main thread ID
+static _thread_id sMainThreadID = 0;
+// The current thread ID, the 'gettid' system call is too slow to invoke on every lock
+static thread_local _thread_id sCurrentThreadID = 0;
+// The current thread object
+static thread_local linuxThread* sCurrentThread = _null;
+
+// The default maximum spin count of critical section, most of locks are held for few hundred cycles only
+static const _dword cDefaultCriticalSectionSpinCount = 100;
+// The spin count of waiting event before sleeping
+static const _dword cEventSpinCount = 50;
+
+// The maximum number of reader slots of read-write lock
+static const _dword cMaxReadWriteLockSlotNumber = 64;
+// The next reader slot index to assign
+static _dword sNextReaderSlotIndex = 0;
+// The reader slot index of current thread, -1 indicates it's not assigned yet
+static thread_local _dword sReaderSlotIndex = (_dword)-1;
+
+// The heap markers, all heaps are backed by the C runtime heap
+static _byte sGlobalHeap = 0;
+static _byte sVirtualHeap = 0;
+
+// The handler of memory access fault and the signal actions before it's installed
+static Platform::OnMemoryFaultProc sMemoryFaultFunc = _null;
+static struct sigaction sPreviousSegvAction;
+static struct sigaction sPreviousBusAction;
+static _boolean sMemoryFaultHandlerInstalled = _false;
+
+// The CPU usage tracking of the whole system
+static pthread_mutex_t sCPUUsageLocker = PTHREAD_MUTEX_INITIALIZER;
+static _qword sLastCPUBusyTime = 0;
+static _qword sLastCPUTotalTime = 0;
+static _float sLastCPUUsage = 0.0f;
+
+// The CPU topology, it's discovered once
+static CPUTopology sCPUTopology;
+static pthread_once_t sCPUTopologyOnce = PTHREAD_ONCE_INIT;
+
+// The maximum number of NUMA nodes in memory policy
+static const _dword cMaxNodeNumber = 64;
+// The memory policies of 'mbind' and 'set_mempolicy'
+static const _int cMemoryPolicyDefault = 0;
+static const _int cMemoryPolicyPreferred = 1;
+
+// The heap blocks which are not less than it are mapped from the virtual memory directly
+static const _qword cLargeHeapBlockThreshold = 2 * 1024 * 1024;
+// The alignment of large heap block mapping, it's the size of transparent huge page
+static const _qword cLargeHeapBlockAlignment = 2 * 1024 * 1024;
+// The header size of large heap block, the user memory follows it
+static const _qword cLargeHeapBlockHeaderSize = 64;
+// The magic number of large heap block header
+static const _qword cLargeHeapBlockMagic = 0x4b434f4c42454741ull;
+// The magic number of system heap block header
+static const _dword cSystemHeapBlockMagic = 0x50414548;
+// The large page size, it's read once
+static _dword sLargePageSize = 0;
+
+/**
+ * @brief Convert the process handle to process ID, null indicates the current process.
+ */
+static pid_t HandleToProcessID(_handle processhandle) {
+	if (processhandle == _null)
+		return ::getpid();
+
+	return (pid_t)(_uintptr_t)processhandle;
+}
+
+/**
+ * @brief Convert the thread handle to thread object, null indicates the current thread.
+ */
+static linuxThread* HandleToThread(_handle thread) {
+	if (thread == _null)
+		return (linuxThread*)Platform::GetCurrentThreadHandle();
+
+	linuxThread* thread_object = (linuxThread*)thread;
+	E3D_ASSERT(thread_object->mType == linuxObjectType::Thread);
+
+	return thread_object;
+}
+
+/**
+ * @brief Release the thread object reference.
+ */
+static _void ReleaseThread(linuxThread* thread) {
+	if (__atomic_sub_fetch(&thread->mRefCount, 1, __ATOMIC_ACQ_REL) == 0)
+		delete thread;
+}
+
+/**
+ * @brief Get the number of online processors.
+ */
+static _dword GetProcessorNumber() {
+	static const _dword sProcessorNumber = (_dword)MAX(::sysconf(_SC_NPROCESSORS_ONLN), 1L);
+
+	return sProcessorNumber;
+}
+
+/**
+ * @brief Check whether it's worth to spin, the owner could not run while we are spinning on single processor.
+ */
+static _boolean IsSpinEnabled() {
+	return GetProcessorNumber() > 1;
+}
+
+/**
+ * @brief Increase the statistics counter which is only updated by the lock owner.
+ */
+static _void IncreaseCounter(_qword& counter, _qword value) {
+	__atomic_store_n(&counter, __atomic_load_n(&counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Get the reader slot index of current thread, the thread always uses the same slot so it leaves the slot it entered.
+ */
+static _dword GetReaderSlotIndex() {
+	if (sReaderSlotIndex == (_dword)-1)
+		sReaderSlotIndex = __atomic_fetch_add(&sNextReaderSlotIndex, 1, __ATOMIC_RELAXED) & 0x7FFFFFFF;
+
+	return sReaderSlotIndex;
+}
+
+/**
+ * @brief Leave the reader slot of read-write lock.
+ */
+static _void LeaveReadSlot(linuxReadWriteLock* lock, _dword* reader_number) {
+	// The last reader wakes the writer which is waiting for this slot to drain
+	if (__atomic_sub_fetch(reader_number, 1, __ATOMIC_SEQ_CST) == 0 && __atomic_load_n(&lock->mWriterNumber, __ATOMIC_SEQ_CST) != 0)
+		linuxFutex::Wake(reader_number, 1);
+}
+
+/**
+ * @brief Try to enter the reader slot of read-write lock.
+ */
+static _boolean TryEnterReadSlot(linuxReadWriteLock* lock, _dword* reader_number) {
+	// The reader must be visible before checking writers, the writer publishes itself before checking readers
+	__atomic_add_fetch(reader_number, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&lock->mWriterNumber, __ATOMIC_SEQ_CST) == 0)
+		return _true;
+
+	// Back off, the writer has priority
+	LeaveReadSlot(lock, reader_number);
+	return _false;
+}
+
+/**
+ * @brief Parse the CPU list in sysfs, such as "0-3,8,10-11".
+ */
+static _boolean ParseCPUList(const _chara* string, CPUSet& cpuset) {
+	cpuset.Clear();
+
+	while (*string != 0 && *string != '\n') {
+		_chara* end = _null;
+		_dword first = (_dword)::strtoul(string, &end, 10);
+		if (end == string)
+			return _false;
+
+		_dword last = first;
+		if (*end == '-') {
+			string = end + 1;
+			last = (_dword)::strtoul(string, &end, 10);
+			if (end == string)
+				return _false;
+		}
+
+		for (_dword cpu = first; cpu <= last && cpu < CPUSet::cMaxCPUNumber; cpu++)
+			cpuset.Add(cpu);
+
+		string = *end == ',' ? end + 1 : end;
+	}
+
+	return _true;
+}
+
+/**
+ * @brief Read the CPU list file in sysfs.
+ */
+static _boolean ReadCPUListFile(const _chara* filename, CPUSet& cpuset) {
+	_chara buffer[4096];
+	if (linuxHelper::ReadTextFile(filename, buffer, sizeof(buffer)) == (_dword)-1)
+		return _false;
+
+	return ParseCPUList(buffer, cpuset);
+}
+
+/**
+ * @brief Read the number file in sysfs, the size suffix 'K', 'M' and 'G' is accepted.
+ */
+static _dword ReadNumberFile(const _chara* filename, _dword default_value) {
+	_chara buffer[64];
+	if (linuxHelper::ReadTextFile(filename, buffer, sizeof(buffer)) == (_dword)-1)
+		return default_value;
+
+	_chara* end = _null;
+	_qword number = ::strtoull(buffer, &end, 10);
+	if (end == buffer)
+		return default_value;
+
+	switch (*end) {
+		case 'K': number <<= 10; break;
+		case 'M': number <<= 20; break;
+		case 'G': number <<= 30; break;
+		default: break;
+	}
+
+	return (_dword)MIN(number, (_qword)0xFFFFFFFF);
+}
+
+/**
+ * @brief Convert the CPU set to the system one.
+ */
+static _void ToSystemCPUSet(const CPUSet& cpuset, cpu_set_t& system_cpuset) {
+	CPU_ZERO(&system_cpuset);
+	for (_dword cpu = 0; cpu < MIN(CPUSet::cMaxCPUNumber, (_dword)CPU_SETSIZE); cpu++) {
+		if (cpuset.Contains(cpu))
+			CPU_SET(cpu, &system_cpuset);
+	}
+}
+
+/**
+ * @brief Convert the system CPU set.
+ */
+static _void FromSystemCPUSet(const cpu_set_t& system_cpuset, CPUSet& cpuset) {
+	cpuset.Clear();
+	for (_dword cpu = 0; cpu < MIN(CPUSet::cMaxCPUNumber, (_dword)CPU_SETSIZE); cpu++) {
+		if (CPU_ISSET(cpu, &system_cpuset))
+			cpuset.Add(cpu);
+	}
+}
+
+/**
+ * @brief Discover the CPU topology from sysfs.
+ */
+static _void DiscoverCPUTopology() {
+	CPUTopology& topology = sCPUTopology;
+
+	if (!ReadCPUListFile("/sys/devices/system/cpu/online", topology.mOnlineCPUs)) {
+		for (_dword cpu = 0; cpu < GetProcessorNumber(); cpu++)
+			topology.mOnlineCPUs.Add(cpu);
+	}
+
+	topology.mLogicalCPUNumber = topology.mOnlineCPUs.GetNumber();
+
+	// The socket and core IDs are not contiguous, map them to indices
+	static _dword socket_ids[CPUSet::cMaxCPUNumber];
+	static _qword core_ids[CPUSet::cMaxCPUNumber];
+
+	_chara filename[256];
+	for (_dword cpu = 0; cpu < CPUSet::cMaxCPUNumber; cpu++) {
+		if (!topology.mOnlineCPUs.Contains(cpu))
+			continue;
+
+		LogicalCPUData& cpu_data = topology.mCPUs[cpu];
+
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+		_dword socket_id = ReadNumberFile(filename, 0);
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+		_qword core_id = ((_qword)socket_id << 32) | ReadNumberFile(filename, cpu);
+
+		for (cpu_data.mSocket = 0; cpu_data.mSocket < topology.mSocketNumber; cpu_data.mSocket++) {
+			if (socket_ids[cpu_data.mSocket] == socket_id)
+				break;
+		}
+
+		if (cpu_data.mSocket == topology.mSocketNumber)
+			socket_ids[topology.mSocketNumber++] = socket_id;
+
+		for (cpu_data.mCore = 0; cpu_data.mCore < topology.mCoreNumber; cpu_data.mCore++) {
+			if (core_ids[cpu_data.mCore] == core_id)
+				break;
+		}
+
+		if (cpu_data.mCore == topology.mCoreNumber)
+			core_ids[topology.mCoreNumber++] = core_id;
+
+		// The SMT index is the order in siblings
+		CPUSet siblings;
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+		if (ReadCPUListFile(filename, siblings)) {
+			for (_dword sibling = 0; sibling < cpu; sibling++) {
+				if (siblings.Contains(sibling))
+					cpu_data.mSMTIndex++;
+			}
+		}
+	}
+
+	// All CPUs are on node 0 if the kernel has no NUMA support
+	CPUSet nodes;
+	if (!ReadCPUListFile("/sys/devices/system/node/online", nodes))
+		nodes.Add(0);
+
+	for (_dword node = 0; node < CPUSet::cMaxCPUNumber; node++) {
+		if (!nodes.Contains(node))
+			continue;
+
+		topology.mNodeNumber = node + 1;
+
+		CPUSet node_cpus;
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/node/node%u/cpulist", node);
+		if (!ReadCPUListFile(filename, node_cpus))
+			continue;
+
+		for (_dword cpu = 0; cpu < CPUSet::cMaxCPUNumber; cpu++) {
+			if (node_cpus.Contains(cpu))
+				topology.mCPUs[cpu].mNode = node;
+		}
+	}
+
+	// The caches of the first CPU, the others are the same
+	_dword first_cpu = topology.mOnlineCPUs.GetCPU(0);
+	if (first_cpu == CPUSet::cNoCPU)
+		return;
+
+	for (_dword index = 0; topology.mCacheNumber < CPUTopology::cMaxCacheNumber; index++) {
+		_chara type[32];
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/cache/index%u/type", first_cpu, index);
+		if (linuxHelper::ReadTextFile(filename, type, sizeof(type)) == (_dword)-1)
+			break;
+
+		if (::strncmp(type, "Instruction", 11) == 0)
+			continue;
+
+		CPUCacheData& cache = topology.mCaches[topology.mCacheNumber++];
+
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", first_cpu, index);
+		cache.mLevel = ReadNumberFile(filename, 0);
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/cache/index%u/size", first_cpu, index);
+		cache.mSize = ReadNumberFile(filename, 0);
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/cache/index%u/coherency_line_size", first_cpu, index);
+		cache.mLineSize = ReadNumberFile(filename, E3D_CACHE_LINE_SIZE);
+
+		CPUSet shared_cpus;
+		::snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", first_cpu, index);
+		cache.mSharedCPUNumber = ReadCPUListFile(filename, shared_cpus) ? shared_cpus.GetNumber() : 1;
+	}
+}
+
+/**
+ * @brief Build the node mask of memory policy.
+ */
+static _boolean BuildNodeMask(_dword node, _qword& mask) {
+	if (node >= cMaxNodeNumber || node >= Platform::GetCPUTopology().mNodeNumber)
+		return _false;
+
+	mask = 1ull << node;
+	return _true;
+}
+
+/**
+ * @brief The header of large heap block, it's at the start of mapping.
+ */
+struct LargeHeapBlock {
+	_qword mMagic;
+	//!	It points to itself, so a random memory could not be a header by accident.
+	LargeHeapBlock* mSelf;
+	//!	The size of user memory.
+	_qword mSize;
+	//!	The size of mapping, including the header.
+	_qword mMappingSize;
+	//!	The memory tag which the block is charged to.
+	MemoryTag mTag;
+};
+
+/**
+ * @brief The header of system heap block, it's right before the user memory.
+ * The system heap is used when the slabs are full or the small block is over-aligned.
+ */
+struct SystemHeapBlock {
+	//!	The offset from the start of allocation to the user memory, it's the alignment.
+	_dword mOffset;
+	//!	The memory tag which the block is charged to.
+	MemoryTag mTag;
+	_dword mMagic;
+	_dword mReserved;
+};
+
+/**
+ * @brief Round up the size to the alignment which is power of 2.
+ */
+static _qword RoundUpSize(_qword size, _qword alignment) {
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Map the pages with the aligned start address, the unaligned head and tail are unmapped.
+ */
+static _void* MapAlignedPages(_qword size, _qword alignment, _int protection, _int flags) {
+	_qword page_size = Platform::GetPageSize();
+	size = RoundUpSize(size, page_size);
+	alignment = MAX(alignment, page_size);
+
+	_qword mapping_size = size + alignment - page_size;
+	_byte* mapping = (_byte*)::mmap(_null, (size_t)mapping_size, protection, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+	if (mapping == MAP_FAILED)
+		return _null;
+
+	_byte* pointer = (_byte*)RoundUpSize((_qword)(_uintptr_t)mapping, alignment);
+	if (pointer != mapping)
+		::munmap(mapping, (size_t)(pointer - mapping));
+
+	_byte* end = mapping + mapping_size;
+	if (pointer + size != end)
+		::munmap(pointer + size, (size_t)(end - pointer - size));
+
+	return pointer;
+}
+
+/**
+ * @brief Allocate the large heap block.
+ */
+static _void* AllocLargeHeapBlock(_qword size, MemoryTag tag) {
+	_qword mapping_size = RoundUpSize(size + cLargeHeapBlockHeaderSize, Platform::GetPageSize());
+
+	LargeHeapBlock* block = (LargeHeapBlock*)MapAlignedPages(mapping_size, cLargeHeapBlockAlignment, PROT_READ | PROT_WRITE, 0);
+	if (block == _null)
+		return _null;
+
+	if (mapping_size >= cLargeHeapBlockAlignment)
+		Platform::AdviseVirtualMemory(block, mapping_size, VirtualMemoryAdvice::HugePage);
+
+	block->mMagic = cLargeHeapBlockMagic;
+	block->mSelf = block;
+	block->mSize = size;
+	block->mMappingSize = mapping_size;
+	block->mTag = tag;
+
+	return (_byte*)block + cLargeHeapBlockHeaderSize;
+}
+
+/**
+ * @brief Get the header of large heap block, null indicates it's not a large heap block.
+ */
+static LargeHeapBlock* GetLargeHeapBlock(const _void* pointer) {
+	// The header is in the same page as the pointer, so it's safe to read it for any heap block
+	if (((_uintptr_t)pointer & (cLargeHeapBlockAlignment - 1)) != cLargeHeapBlockHeaderSize)
+		return _null;
+
+	LargeHeapBlock* block = (LargeHeapBlock*)((const _byte*)pointer - cLargeHeapBlockHeaderSize);
+	if (block->mMagic != cLargeHeapBlockMagic || block->mSelf != block)
+		return _null;
+
+	return block;
+}
+
+/**
+ * @brief Free the large heap block.
+ */
+static _void FreeLargeHeapBlock(LargeHeapBlock* block) {
+	block->mMagic = 0;
+	::munmap(block, (size_t)block->mMappingSize);
+}
+
+/**
+ * @brief Resize the large heap block, the shrinking returns the tail pages to the system, the growing remaps in place if possible.
+ */
+static _void* ReAllocLargeHeapBlock(LargeHeapBlock* block, _qword size) {
+	_qword mapping_size = RoundUpSize(size + cLargeHeapBlockHeaderSize, Platform::GetPageSize());
+
+	if (mapping_size <= block->mMappingSize) {
+		if (mapping_size != block->mMappingSize)
+			::munmap((_byte*)block + mapping_size, (size_t)(block->mMappingSize - mapping_size));
+
+		block->mSize = size;
+		block->mMappingSize = mapping_size;
+		return (_byte*)block + cLargeHeapBlockHeaderSize;
+	}
+
+	if (::mremap(block, (size_t)block->mMappingSize, (size_t)mapping_size, 0) != MAP_FAILED) {
+		if (mapping_size >= cLargeHeapBlockAlignment)
+			Platform::AdviseVirtualMemory(block, mapping_size, VirtualMemoryAdvice::HugePage);
+
+		block->mSize = size;
+		block->mMappingSize = mapping_size;
+		return (_byte*)block + cLargeHeapBlockHeaderSize;
+	}
+
+	_void* pointer = AllocLargeHeapBlock(size, block->mTag);
+	if (pointer == _null)
+		return _null;
+
+	E3D_MEM_CPY(pointer, (_byte*)block + cLargeHeapBlockHeaderSize, block->mSize);
+	FreeLargeHeapBlock(block);
+
+	return pointer;
+}
+
+/**
+ * @brief Allocate the system heap block, the alignment must be power of 2.
+ */
+static _void* AllocSystemHeapBlock(_qword size, _dword alignment, MemoryTag tag) {
+	_dword offset = MAX(alignment, (_dword)sizeof(SystemHeapBlock));
+	if (size > (_qword)(size_t)-1 - offset)
+		return _null;
+
+	// The malloc() of glibc aligns to 16 bytes, it's the size of header
+	_void* base = _null;
+	if (offset == sizeof(SystemHeapBlock))
+		base = ::malloc((size_t)(size + offset));
+	else if (::posix_memalign(&base, offset, (size_t)(size + offset)) != 0)
+		base = _null;
+
+	if (base == _null)
+		return _null;
+
+	SystemHeapBlock* block = (SystemHeapBlock*)((_byte*)base + offset) - 1;
+	block->mOffset = offset;
+	block->mTag = tag;
+	block->mMagic = cSystemHeapBlockMagic;
+	block->mReserved = 0;
+
+	return block + 1;
+}
+
+/**
+ * @brief Get the header of system heap block, the pointer must not be owned by the other allocators.
+ */
+static SystemHeapBlock* GetSystemHeapBlock(const _void* pointer) {
+	SystemHeapBlock* block = (SystemHeapBlock*)pointer - 1;
+	E3D_ASSERT(block->mMagic == cSystemHeapBlockMagic);
+
+	return block;
+}
+
+/**
+ * @brief Get the usable size of system heap block.
+ */
+static _qword GetSystemHeapBlockSize(const SystemHeapBlock* block) {
+	return ::malloc_usable_size((_byte*)(block + 1) - block->mOffset) - block->mOffset;
+}
+
+/**
+ * @brief Resize the system heap block, the alignment of over-aligned block is not kept beyond 16 bytes.
+ */
+static _void* ReAllocSystemHeapBlock(SystemHeapBlock* block, _qword size) {
+	_dword offset = block->mOffset;
+	if (size > (_qword)(size_t)-1 - offset)
+		return _null;
+
+	_byte* base = (_byte*)::realloc((_byte*)(block + 1) - offset, (size_t)(size + offset));
+	if (base == _null)
+		return _null;
+
+	return base + offset;
+}
+
+/**
+ * @brief Free the system heap block.
+ */
+static _void FreeSystemHeapBlock(SystemHeapBlock* block) {
+	block->mMagic = 0;
+	::free((_byte*)(block + 1) - block->mOffset);
+}
+
+/**
+ * @brief The signal handler of memory access fault, it chains to the previous handler.
+ */
+static _void OnMemoryFaultSignal(_int signal, siginfo_t* info, _void* context) {
+	Platform::OnMemoryFaultProc func = sMemoryFaultFunc;
+	if (func != _null)
+		func(info->si_addr);
+
+	const struct sigaction& previous_action = signal == SIGBUS ? sPreviousBusAction : sPreviousSegvAction;
+	if (previous_action.sa_flags & SA_SIGINFO) {
+		previous_action.sa_sigaction(signal, info, context);
+	} else if (previous_action.sa_handler != SIG_DFL && previous_action.sa_handler != SIG_IGN) {
+		previous_action.sa_handler(signal);
+	} else {
+		// The faulting instruction runs again after returning, and the default action terminates the process then
+		::sigaction(signal, &previous_action, _null);
+	}
+}
+
+/**
+ * @brief Get the usable size and the memory tag of heap block.
+ */
+static _qword GetHeapBlockSize(_void* pointer, MemoryTag* tag = _null) {
+	MemoryTag block_tag = MemoryTag::Default;
+	_qword size = 0;
+
+	if (pointer == _null) {
+		size = 0;
+	} else if (GuardedHeap::IsGuarded(pointer)) {
+		size = GuardedHeap::GetSize(pointer);
+		block_tag = GuardedHeap::GetTag(pointer);
+	} else if ((size = SmallAllocator::GetSize(pointer)) != 0) {
+		block_tag = SmallAllocator::GetTag(pointer);
+	} else if (LargeHeapBlock* block = GetLargeHeapBlock(pointer)) {
+		size = block->mSize;
+		block_tag = block->mTag;
+	} else {
+		SystemHeapBlock* system_block = GetSystemHeapBlock(pointer);
+		size = GetSystemHeapBlockSize(system_block);
+		block_tag = system_block->mTag;
+	}
+
+	if (tag != _null)
+		*tag = block_tag;
+
+	return size;
+}
+
+/**
+ * @brief Release the heap block to its owner, it's not accounted.
+ */
+static _void ReleaseHeapBlock(_void* pointer) {
+	if (GuardedHeap::IsGuarded(pointer)) {
+		GuardedHeap::Free(pointer);
+		return;
+	}
+
+	if (SmallAllocator::Free(pointer))
+		return;
+
+	LargeHeapBlock* block = GetLargeHeapBlock(pointer);
+	if (block != _null)
+		FreeLargeHeapBlock(block);
+	else
+		FreeSystemHeapBlock(GetSystemHeapBlock(pointer));
+}
+
+/**
+ * @brief Charge the new heap block to the tag, the block is released if the tag exceeds its hard budget.
+ */
+static _void* ChargeHeapBlock(_void* pointer, _qword size, MemoryTag tag) {
+	if (pointer == _null)
+		return _null;
+
+	if (!MemoryTags::OnAlloc(tag, GetHeapBlockSize(pointer))) {
+		ReleaseHeapBlock(pointer);
+		return _null;
+	}
+
+	AllocationSampler::OnAlloc(pointer, size);
+
+	return pointer;
+}
+
+/**
+ * @brief Allocate the heap block and charge it to the tag.
+ */
+static _void* AllocHeapBlock(_qword size, _handle heap, MemoryTag tag) {
+	// The size could not be represented on 32-bit platform
+	if (size > (_qword)(size_t)-1)
+		return _null;
+
+	// The sampled blocks are placed on the guarded pages, they come from the heap as usual when the pool is full
+	_void* pointer = _null;
+	if (GuardedHeap::ShouldSample(size) && (pointer = GuardedHeap::Alloc(size)) != _null)
+		GuardedHeap::SetTag(pointer, tag);
+
+	// The large blocks are mapped from the virtual memory, so they're backed by huge pages and returned to the system when freed
+	// The small blocks come from the size-class slabs, it falls back to system heap when the slabs are full
+	if (pointer == _null) {
+		if (size >= cLargeHeapBlockThreshold || heap == &sVirtualHeap)
+			pointer = AllocLargeHeapBlock(size, tag);
+		else if ((pointer = SmallAllocator::Alloc(size)) != _null)
+			SmallAllocator::SetTag(pointer, tag);
+		else
+			pointer = AllocSystemHeapBlock(size, 0, tag);
+	}
+
+	return ChargeHeapBlock(pointer, size, tag);
+}
+
+/**
+ * @brief Move the heap block to a new one of the same tag.
+ */
+static _void* MoveHeapBlock(_void* pointer, _qword old_size, _qword size, _handle heap, MemoryTag tag) {
+	_void* new_pointer = AllocHeapBlock(size, heap, tag);
+	if (new_pointer == _null)
+		return _null;
+
+	E3D_MEM_CPY(new_pointer, pointer, MIN(old_size, size));
+	Platform::HeapFree(pointer, heap);
+
+	return new_pointer;
+}
+
+/**
+ * @brief Convert the time-out interval from milliseconds to nanoseconds, -1 indicates infinite.
+ */
+static _qword MillisecondsToNanoseconds(_dword milliseconds) {
+	return milliseconds != (_dword)-1 ? (_qword)milliseconds * 1000000ull : (_qword)-1;
+}
+
+/**
+ * @brief Get the deadline of the time-out interval in nanoseconds, -1 indicates infinite.
+ */
+static _qword GetDeadline(_qword nanoseconds) {
+	if (nanoseconds == (_qword)-1)
+		return (_qword)-1;
+
+	_qword now = linuxHelper::GetMonotonicNanoseconds();
+
+	// It's infinite practically if it overflows
+	return nanoseconds < (_qword)-1 - now ? now + nanoseconds : (_qword)-1;
+}
+
+/**
+ * @brief Build the relative timeout to the deadline, returns false if the deadline has passed.
+ */
+static _boolean GetRemainingTimeout(_qword deadline, timespec& timeout, timespec*& timeout_pointer) {
+	timeout_pointer = _null;
+	if (deadline == (_qword)-1)
+		return _true;
+
+	_qword now = linuxHelper::GetMonotonicNanoseconds();
+	if (now >= deadline)
+		return _false;
+
+	timeout.tv_sec = (time_t)((deadline - now) / 1000000000ull);
+	timeout.tv_nsec = (long)((deadline - now) % 1000000000ull);
+	timeout_pointer = &timeout;
+
+	return _true;
+}
+
+/**
+ * @brief Wait the futex word until it's not equal to the value or time out.
+ */
+static _boolean WaitWhileEqual(_dword* address, _dword value, _qword nanoseconds) {
+	_qword deadline = GetDeadline(nanoseconds);
+
+	while (__atomic_load_n(address, __ATOMIC_ACQUIRE) == value) {
+		timespec timeout;
+		timespec* timeout_pointer = _null;
+		if (!GetRemainingTimeout(deadline, timeout, timeout_pointer))
+			return _false;
+
+		linuxFutex::Wait(address, value, timeout_pointer);
+	}
+
+	return _true;
+}
+
+/**
+ * @brief Try to wait the event object without blocking.
+ */
+static _boolean TryWaitEvent(linuxEvent* event) {
+	// The manual-reset event keeps signaled, the auto-reset event consumes the signal
+	if (event->mManualReset)
+		return __atomic_load_n(&event->mState, __ATOMIC_ACQUIRE) == 1;
+
+	_dword expected = 1;
+	return __atomic_compare_exchange_n(&event->mState, &expected, 0, _false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Wait the event object.
+ */
+static _boolean WaitEvent(linuxEvent* event, _qword nanoseconds) {
+	if (TryWaitEvent(event))
+		return _true;
+
+	if (nanoseconds == 0)
+		return _false;
+
+	// The event is usually signaled soon by the other worker, so spin for a while before sleeping
+	if (IsSpinEnabled()) {
+		for (_dword i = 0; i < cEventSpinCount; i++) {
+			CPU_PAUSE();
+
+			if (__atomic_load_n(&event->mState, __ATOMIC_RELAXED) == 1 && TryWaitEvent(event))
+				return _true;
+		}
+	}
+
+	_qword deadline = GetDeadline(nanoseconds);
+
+	while (_true) {
+		if (TryWaitEvent(event))
+			return _true;
+
+		timespec timeout;
+		timespec* timeout_pointer = _null;
+		if (!GetRemainingTimeout(deadline, timeout, timeout_pointer))
+			return _false;
+
+		// The waiter number must be visible before the futex checks the state, see SetEvent()
+		__atomic_add_fetch(&event->mWaiterNumber, 1, __ATOMIC_SEQ_CST);
+		linuxFutex::Wait(&event->mState, 0, timeout_pointer);
+		__atomic_sub_fetch(&event->mWaiterNumber, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * @brief Read the user/kernel time and start time ( in clock ticks ) of thread from '/proc'.
+ */
+static _boolean ReadThreadStat(_thread_id threadid, _qword& usertime, _qword& kerneltime, _qword& starttime) {
+	_chara filename[64];
+	::snprintf(filename, sizeof(filename), "/proc/self/task/%llu/stat", (unsigned long long)threadid);
+
+	_chara buffer[1024];
+	if (linuxHelper::ReadTextFile(filename, buffer, sizeof(buffer)) == (_dword)-1)
+		return _false;
+
+	// The thread name could contain spaces, so skip it by the last ')'
+	const _chara* fields = ::strrchr(buffer, ')');
+	if (fields == _null)
+		return _false;
+
+	unsigned long long utime = 0, stime = 0, start = 0;
+	if (::sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %llu", &utime, &stime, &start) != 3)
+		return _false;
+
+	usertime = utime;
+	kerneltime = stime;
+	starttime = start;
+	return _true;
+}
+
+/**
+ * @brief Read the run queue wait time ( in nanoseconds ) of thread from '/proc', it's available if the kernel enables schedstats.
+ */
+static _boolean ReadThreadSchedStat(_thread_id threadid, _qword& waittime) {
+	_chara filename[64];
+	::snprintf(filename, sizeof(filename), "/proc/self/task/%llu/schedstat", (unsigned long long)threadid);
+
+	_chara buffer[128];
+	if (linuxHelper::ReadTextFile(filename, buffer, sizeof(buffer)) == (_dword)-1)
+		return _false;
+
+	// The fields are the run time, the wait time and the number of time slices
+	unsigned long long runtime = 0, wait = 0;
+	if (::sscanf(buffer, "%llu %llu", &runtime, &wait) != 2)
+		return _false;
+
+	waittime = wait;
+	return _true;
+}
+
+/**
+ * @brief Read the number of context switches of thread from '/proc'.
+ */
+static _boolean ReadThreadContextSwitches(_thread_id threadid, _qword& voluntary, _qword& involuntary) {
+	_chara filename[64];
+	::snprintf(filename, sizeof(filename), "/proc/self/task/%llu/status", (unsigned long long)threadid);
+
+	_chara buffer[4096];
+	if (linuxHelper::ReadTextFile(filename, buffer, sizeof(buffer)) == (_dword)-1)
+		return _false;
+
+	// They're the last lines of status
+	const _chara* field = ::strstr(buffer, "voluntary_ctxt_switches:");
+	if (field == _null || field == buffer || field[-1] != '\n')
+		return _false;
+
+	unsigned long long voluntary_number = 0, involuntary_number = 0;
+	if (::sscanf(field, "voluntary_ctxt_switches: %llu nonvoluntary_ctxt_switches: %llu", &voluntary_number, &involuntary_number) != 2)
+		return _false;
+
+	voluntary = voluntary_number;
+	involuntary = involuntary_number;
+	return _true;
+}
+
+/**
+ * @brief The thread start routine wrapper.
+ */
+static _void OnThreadCleanup(_void* parameter) {
+	linuxThread* thread = (linuxThread*)parameter;
+
+	__atomic_store_n(&thread->mFinished, 1, __ATOMIC_RELEASE);
+	linuxFutex::Wake(&thread->mFinished, -1);
+
+	sCurrentThread = _null;
+	ReleaseThread(thread);
+}
+
+/**
+ * @brief Release the adopted thread at thread exit.
+ */
+static _void OnReleaseAdoptedThread(_void* parameter) {
+	linuxThread* thread = (linuxThread*)parameter;
+	if (sCurrentThread == thread)
+		sCurrentThread = _null;
+
+	ReleaseThread(thread);
+}
+
+/**
+ * @brief Get the TLS slot to release the adopted threads, the thread adopted again by the later thread_local destructors
+ * is released as well.
+ */
+static _dword GetAdoptedThreadSlot() {
+	static const _dword sAdoptedThreadSlot = Platform::AllocTLS(OnReleaseAdoptedThread);
+	return sAdoptedThreadSlot;
+}
+
+static _void* OnThreadStart(_void* parameter) {
+	linuxThread* thread = (linuxThread*)parameter;
+	sCurrentThread = thread;
+
+	// Feedback the thread ID to creator
+	thread->mThreadID = Platform::GetCurrentThreadID();
+	__atomic_store_n(&thread->mStarted, 1, __ATOMIC_RELEASE);
+	linuxFutex::Wake(&thread->mStarted, -1);
+
+	// Wait for resuming
+	_dword suspended;
+	while ((suspended = __atomic_load_n(&thread->mSuspended, __ATOMIC_ACQUIRE)) != 0)
+		linuxFutex::Wait(&thread->mSuspended, suspended, _null);
+
+	pthread_cleanup_push(OnThreadCleanup, thread);
+	thread->mRetCode = thread->mFuncPointer(thread->mParameter);
+	pthread_cleanup_pop(1);
+
+	return _null;
+}
+
+/**
+ * @brief Split the command line into the arguments in place, it follows the win32 rules: the arguments are separated by
+ * whitespaces, the double quotes group the whitespaces and the backslash escapes the double quote.
+ * @return _dword The number of arguments.
+ */
+static _dword SplitCommandLine(_chara* cmdline, _chara** argv, _dword max_number) {
+	_dword number = 0;
+
+	_chara* read = cmdline;
+	_chara* write = cmdline;
+	while (number < max_number) {
+		while (*read == ' ' || *read == '\t' || *read == '\n' || *read == '\r')
+			read++;
+
+		if (*read == 0)
+			break;
+
+		argv[number++] = write;
+
+		_boolean quoted = _false;
+		for (; *read != 0; read++) {
+			if (!quoted && (*read == ' ' || *read == '\t' || *read == '\n' || *read == '\r'))
+				break;
+
+			if (*read == '\\' && (read[1] == '"' || read[1] == '\\')) {
+				*write++ = *++read;
+			} else if (*read == '"') {
+				quoted = !quoted;
+			} else {
+				*write++ = *read;
+			}
+		}
+
+		// The writing is never ahead of reading, so the terminator does not overwrite the next argument
+		if (*read != 0)
+			read++;
+
+		*write++ = 0;
+	}
+
+	return number;
+}
+
+/**
+ * @brief Decode the UTF-8 sequence.
+ * @return _dword The number of bytes, the code is -1 if the sequence is invalid.
+ */
+static _dword DecodeUtf8(const _byte* source, _dword number, _dword& code) {
+	code = source[0];
+
+	_dword bytes = 0;
+	if (code < 0x80) {
+		return 1;
+	} else if (code >= 0xC2 && code <= 0xDF) {
+		bytes = 2;
+		code &= 0x1F;
+	} else if (code >= 0xE0 && code <= 0xEF) {
+		bytes = 3;
+		code &= 0x0F;
+	} else if (code >= 0xF0 && code <= 0xF4) {
+		bytes = 4;
+		code &= 0x07;
+	}
+
+	if (bytes == 0 || bytes > number) {
+		code = (_dword)-1;
+		return 1;
+	}
+
+	for (_dword i = 1; i < bytes; i++) {
+		if ((source[i] & 0xC0) != 0x80) {
+			code = (_dword)-1;
+			return i;
+		}
+
+		code = (code << 6) | (source[i] & 0x3F);
+	}
+
+	// The overlong sequence, surrogate and out of range code point are invalid
+	if ((bytes == 3 && (code < 0x800 || (code >= 0xD800 && code <= 0xDFFF))) || (bytes == 4 && (code < 0x10000 || code > 0x10FFFF)))
+		code = (_dword)-1;
+
+	return bytes;
+}
+
+/**
+ * @brief Convert the string between UTF-8 and UTF-16.
+ */
+static _dword ConvertString(_chara* buffer, _dword size, const _charw* string, _dword number) {
+	return Platform::Utf16ToUtf8(buffer, size, string, number);
+}
+static _dword ConvertString(_charw* buffer, _dword size, const _chara* string, _dword number) {
+	return Platform::Utf8ToUtf16(buffer, size, string, number);
+}
+
+/**
+ * @brief The string functions of both ANSI and UNICODE. The wchar_t is 16-bits by -fshort-wchar so the wide functions
+ * of libc could not be used, and the ANSI string is UTF-8 (the locale of linux), so only the ASCII letters are cased in it.
+ */
+template <typename CharType>
+class linuxString {
+public:
+	//!	Get the code of character, the ANSI character is not sign extended.
+	static _dword GetCode(CharType character) {
+		return sizeof(CharType) == 1 ? (_dword)(_byte)character : (_dword)(_word)character;
+	}
+
+	//!	Get the lowercase code, the Latin-1 letters are converted only in the UNICODE string.
+	static _dword GetLowercase(_dword code) {
+		if (code >= 'A' && code <= 'Z')
+			return code + ('a' - 'A');
+
+		if (sizeof(CharType) == 2 && code >= 0xC0 && code <= 0xDE && code != 0xD7)
+			return code + 0x20;
+
+		return code;
+	}
+
+	//!	Get the uppercase code, the Latin-1 letters are converted only in the UNICODE string.
+	static _dword GetUppercase(_dword code) {
+		if (code >= 'a' && code <= 'z')
+			return code - ('a' - 'A');
+
+		if (sizeof(CharType) == 2 && code >= 0xE0 && code <= 0xFE && code != 0xF7)
+			return code - 0x20;
+
+		return code;
+	}
+
+	//!	Get the code to compare.
+	static _dword GetCompareCode(CharType character, _boolean ignorecase) {
+		_dword code = GetCode(character);
+		return ignorecase ? GetLowercase(code) : code;
+	}
+
+	//!	Check whether the character is whitespace.
+	static _boolean IsSpace(CharType character) {
+		return character == ' ' || (character >= '\t' && character <= '\r');
+	}
+
+	//!	Check whether the character is in the charset.
+	static _boolean IsInCharset(CharType character, const CharType* charset, _dword number, _boolean ignorecase) {
+		_dword code = GetCompareCode(character, ignorecase);
+		for (_dword i = 0; i < number; i++) {
+			if (GetCompareCode(charset[i], ignorecase) == code)
+				return _true;
+		}
+
+		return _false;
+	}
+
+	static _boolean IsBlank(const CharType* string) {
+		if (string == _null)
+			return _true;
+
+		for (; *string != 0; string++) {
+			if (!IsSpace(*string))
+				return _false;
+		}
+
+		return _true;
+	}
+
+	static _boolean IsFullpath(const CharType* path) {
+		if (path == _null)
+			return _false;
+
+		if (path[0] == '/' || path[0] == '\\')
+			return _true;
+
+		return ((path[0] >= 'a' && path[0] <= 'z') || (path[0] >= 'A' && path[0] <= 'Z')) && path[1] == ':';
+	}
+
+	static CharType* TrimLeft(CharType* string, _dword& length, const CharType* charset, _dword number, _boolean ignorecase) {
+		if (string == _null)
+			return _null;
+
+		if (length == (_dword)-1)
+			length = Platform::StringLength(string);
+
+		_dword skip = 0;
+		while (skip < length && IsInCharset(string[skip], charset, number, ignorecase))
+			skip++;
+
+		length -= skip;
+
+		return string + skip;
+	}
+
+	static CharType* TrimRight(CharType* string, _dword& length, const CharType* charset, _dword number, _boolean ignorecase) {
+		if (string == _null)
+			return _null;
+
+		if (length == (_dword)-1)
+			length = Platform::StringLength(string);
+
+		_dword trimmed_length = length;
+		while (trimmed_length > 0 && IsInCharset(string[trimmed_length - 1], charset, number, ignorecase))
+			trimmed_length--;
+
+		if (trimmed_length != length) {
+			string[trimmed_length] = 0;
+			length = trimmed_length;
+		}
+
+		return string;
+	}
+
+	static CharType* TrimBoth(CharType* string, _dword& length, const CharType* charset, _dword number, _boolean ignorecase) {
+		string = TrimRight(string, length, charset, number, ignorecase);
+
+		return TrimLeft(string, length, charset, number, ignorecase);
+	}
+
+	static _dword SearchL2R(const CharType* string, CharType character, _boolean ignorecase) {
+		if (string == _null)
+			return -1;
+
+		_dword code = GetCompareCode(character, ignorecase);
+		for (_dword i = 0; string[i] != 0; i++) {
+			if (GetCompareCode(string[i], ignorecase) == code)
+				return i;
+		}
+
+		return -1;
+	}
+
+	static _dword SearchR2L(const CharType* string, CharType character, _boolean ignorecase) {
+		if (string == _null)
+			return -1;
+
+		_dword code = GetCompareCode(character, ignorecase);
+		for (_dword i = Platform::StringLength(string); i > 0; i--) {
+			if (GetCompareCode(string[i - 1], ignorecase) == code)
+				return i - 1;
+		}
+
+		return -1;
+	}
+
+	//!	Check whether the substring is at the string.
+	static _boolean IsMatched(const CharType* string, const CharType* substring, _dword number, _boolean ignorecase) {
+		for (_dword i = 0; i < number; i++) {
+			if (GetCompareCode(string[i], ignorecase) != GetCompareCode(substring[i], ignorecase))
+				return _false;
+		}
+
+		return _true;
+	}
+
+	static _dword SearchL2R(const CharType* string, const CharType* substring, _boolean ignorecase, _dword* endindex) {
+		if (string == _null || substring == _null)
+			return -1;
+
+		_dword length = Platform::StringLength(string);
+		_dword sublength = Platform::StringLength(substring);
+		if (sublength == 0 || sublength > length)
+			return -1;
+
+		for (_dword i = 0; i <= length - sublength; i++) {
+			if (!IsMatched(string + i, substring, sublength, ignorecase))
+				continue;
+
+			if (endindex != _null)
+				*endindex = i + sublength;
+
+			return i;
+		}
+
+		return -1;
+	}
+
+	static _dword SearchR2L(const CharType* string, const CharType* substring, _boolean ignorecase, _dword* startindex) {
+		if (string == _null || substring == _null)
+			return -1;
+
+		_dword length = Platform::StringLength(string);
+		_dword sublength = Platform::StringLength(substring);
+		if (sublength == 0 || sublength > length)
+			return -1;
+
+		for (_dword i = length - sublength + 1; i > 0; i--) {
+			if (!IsMatched(string + i - 1, substring, sublength, ignorecase))
+				continue;
+
+			if (startindex != _null)
+				*startindex = i - 1;
+
+			return i - 1;
+		}
+
+		return -1;
+	}
+
+	static CharType* Copy(CharType* desbuffer, const CharType* srcbuffer, _dword number) {
+		if (desbuffer == _null)
+			return _null;
+
+		_dword length = 0;
+		if (srcbuffer != _null) {
+			for (; length < number && srcbuffer[length] != 0; length++)
+				desbuffer[length] = srcbuffer[length];
+		}
+
+		desbuffer[length] = 0;
+
+		return desbuffer;
+	}
+
+	static _int Compare(const CharType* string1, const CharType* string2, _boolean ignorecase) {
+		static const CharType cEmptyString[1] = {0};
+
+		if (string1 == _null)
+			string1 = cEmptyString;
+		if (string2 == _null)
+			string2 = cEmptyString;
+
+		for (_dword i = 0;; i++) {
+			_dword code1 = GetCompareCode(string1[i], ignorecase);
+			_dword code2 = GetCompareCode(string2[i], ignorecase);
+			if (code1 != code2)
+				return code1 < code2 ? -1 : 1;
+
+			if (code1 == 0)
+				return 0;
+		}
+	}
+
+	static _boolean CompareWildcard(const CharType* string, const CharType* matchstring, _boolean ignorecase) {
+		static const CharType cEmptyString[1] = {0};
+
+		if (string == _null)
+			string = cEmptyString;
+		if (matchstring == _null)
+			matchstring = cEmptyString;
+
+		// Backtrack to the last '*' on mismatch, the '*' meets one more character each time
+		const CharType* star = _null;
+		const CharType* resume = _null;
+		while (*string != 0) {
+			if (*matchstring == '*') {
+				star = ++matchstring;
+				resume = string;
+			} else if (*matchstring == '?' || (*matchstring != 0 && GetCompareCode(*matchstring, ignorecase) == GetCompareCode(*string, ignorecase))) {
+				string++;
+				matchstring++;
+			} else if (star != _null) {
+				matchstring = star;
+				string = ++resume;
+			} else {
+				return _false;
+			}
+		}
+
+		while (*matchstring == '*')
+			matchstring++;
+
+		return *matchstring == 0;
+	}
+
+	static CharType* Lowercase(CharType* string, _dword number) {
+		if (string == _null)
+			return _null;
+
+		for (_dword i = 0; i < number && string[i] != 0; i++)
+			string[i] = (CharType)GetLowercase(GetCode(string[i]));
+
+		return string;
+	}
+
+	static CharType* Uppercase(CharType* string, _dword number) {
+		if (string == _null)
+			return _null;
+
+		for (_dword i = 0; i < number && string[i] != 0; i++)
+			string[i] = (CharType)GetUppercase(GetCode(string[i]));
+
+		return string;
+	}
+
+	//!	Convert the integer in magnitude, the sign is written only if it's negative.
+	static CharType* ConvertInteger(_qword value, _boolean negative, _dword radix, CharType* string, _dword length) {
+		if (string == _null || length == 0)
+			return _null;
+
+		string[0] = 0;
+
+		if (radix < 2 || radix > 36)
+			return _null;
+
+		// The digits are in reverse order, 64 binary digits and the sign at most
+		_chara digits[66];
+		_dword number = 0;
+		do {
+			_dword digit = (_dword)(value % radix);
+			digits[number++] = (_chara)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+			value /= radix;
+		} while (value != 0);
+
+		if (negative)
+			digits[number++] = '-';
+
+		if (number >= length)
+			return _null;
+
+		for (_dword i = 0; i < number; i++)
+			string[i] = (CharType)digits[number - 1 - i];
+
+		string[number] = 0;
+
+		return string;
+	}
+
+	static CharType* ConvertDouble(_double value, CharType* string, _dword length, _dword precision) {
+		if (string == _null || length == 0)
+			return _null;
+
+		// The largest double takes 309 digits before the decimal point
+		_chara buffer[512];
+		_int number = ::snprintf(buffer, sizeof(buffer), "%.*f", (_int)MIN(precision, (_dword)64), value);
+		if (number < 0 || (_dword)number >= length) {
+			string[0] = 0;
+			return _null;
+		}
+
+		for (_int i = 0; i <= number; i++)
+			string[i] = (CharType)buffer[i];
+
+		return string;
+	}
+
+	//!	Get the ANSI string of number to parse by libc, the UNICODE string is narrowed until the first non-ASCII character.
+	static const _chara* GetNumberString(const CharType* string, _chara* buffer, _dword size) {
+		if (sizeof(CharType) == 1)
+			return (const _chara*)string;
+
+		_dword length = 0;
+		for (; length + 1 < size && string[length] != 0 && GetCode(string[length]) < 0x80; length++)
+			buffer[length] = (_chara)string[length];
+
+		buffer[length] = 0;
+
+		return buffer;
+	}
+
+	static _boolean ConvertToBool(const CharType* string) {
+		if (string == _null)
+			return _false;
+
+		static const CharType cTrue[] = {'t', 'r', 'u', 'e', 0};
+		if (Compare(string, cTrue, _true) == 0)
+			return _true;
+
+		_chara buffer[128];
+		return ::strtoll(GetNumberString(string, buffer, sizeof(buffer)), _null, 0) != 0;
+	}
+
+	static _large ConvertToLarge(const CharType* string, _dword radix) {
+		if (string == _null)
+			return 0;
+
+		_chara buffer[128];
+		return ::strtoll(GetNumberString(string, buffer, sizeof(buffer)), _null, radix);
+	}
+
+	static _qword ConvertToQword(const CharType* string, _dword radix) {
+		if (string == _null)
+			return 0;
+
+		_chara buffer[128];
+		return ::strtoull(GetNumberString(string, buffer, sizeof(buffer)), _null, radix);
+	}
+
+	static _double ConvertToDouble(const CharType* string) {
+		if (string == _null)
+			return 0.0;
+
+		_chara buffer[512];
+		return ::strtod(GetNumberString(string, buffer, sizeof(buffer)), _null);
+	}
+};
+
+/**
+ * @brief The writer of formatted string, it's truncated by the buffer but the length is counted as a whole.
+ */
+template <typename CharType>
+class linuxStringWriter {
+private:
+	CharType* mBuffer;
+	_dword mSize;
+	_dword mLength;
+
+public:
+	linuxStringWriter(CharType* buffer, _dword size) : mBuffer(buffer), mSize(buffer != _null ? size : 0), mLength(0) {
+	}
+
+public:
+	_void Write(_dword code) {
+		if (mLength + 1 < mSize)
+			mBuffer[mLength] = (CharType)code;
+
+		mLength++;
+	}
+
+	_void Write(_dword code, _dword number) {
+		for (_dword i = 0; i < number; i++)
+			Write(code);
+	}
+
+	_void Write(const CharType* string, _dword number) {
+		for (_dword i = 0; i < number; i++)
+			Write(linuxString<CharType>::GetCode(string[i]));
+	}
+
+	//!	Write the padded string.
+	_void Write(const CharType* string, _dword number, _int width, _boolean left) {
+		_dword padding = width > 0 && (_dword)width > number ? (_dword)width - number : 0;
+
+		if (!left)
+			Write(' ', padding);
+
+		Write(string, number);
+
+		if (left)
+			Write(' ', padding);
+	}
+
+	//!	Terminate the string.
+	_dword Finish() {
+		if (mSize != 0)
+			mBuffer[mLength < mSize ? mLength : mSize - 1] = 0;
+
+		return mLength;
+	}
+};
+
+/**
+ * @brief The length modifiers of format.
+ */
+enum class linuxFormatModifier {
+	None,
+	Char,
+	Short,
+	Long,
+	LongLong,
+	LongDouble,
+	Size,
+	IntMax,
+	PtrDiff,
+};
+
+/**
+ * @brief Write the string argument of format, the precision limits the characters of argument.
+ */
+template <typename CharType>
+static _void WriteFormatString(linuxStringWriter<CharType>& writer, const CharType* string, _int precision, _int width, _boolean left) {
+	_dword number = 0;
+	while ((precision < 0 || number < (_dword)precision) && string[number] != 0)
+		number++;
+
+	writer.Write(string, number, width, left);
+}
+
+template <typename CharType, typename SourceType>
+static _void WriteFormatString(linuxStringWriter<CharType>& writer, const SourceType* string, _int precision, _int width, _boolean left) {
+	_dword number = 0;
+	while ((precision < 0 || number < (_dword)precision) && string[number] != 0)
+		number++;
+
+	// The UTF-16 character takes 3 bytes in UTF-8 at most, and the UTF-8 byte takes 1 character in UTF-16 at most
+	_dword size = sizeof(CharType) == 1 ? number * 3 + 1 : number + 1;
+
+	CharType local[256];
+	CharType* buffer = size <= E3D_ARRAY_NUMBER(local) ? local : (CharType*)Platform::HeapAlloc(size * sizeof(CharType));
+	if (buffer == _null)
+		return;
+
+	writer.Write(buffer, ConvertString(buffer, size, string, number), width, left);
+
+	if (buffer != local)
+		Platform::HeapFree(buffer);
+}
+
+/**
+ * @brief Write the number argument of format by libc.
+ */
+template <typename CharType, typename ValueType>
+static _void WriteFormatNumber(linuxStringWriter<CharType>& writer, const _chara* spec, ValueType value) {
+	_chara local[128];
+	_int length = ::snprintf(local, sizeof(local), spec, value);
+	if (length < 0)
+		return;
+
+	_chara* string = local;
+	if ((_dword)length >= sizeof(local)) {
+		string = (_chara*)Platform::HeapAlloc(length + 1);
+		if (string == _null)
+			return;
+
+		::snprintf(string, length + 1, spec, value);
+	}
+
+	for (_int i = 0; i < length; i++)
+		writer.Write((_byte)string[i]);
+
+	if (string != local)
+		Platform::HeapFree(string);
+}
+
+/**
+ * @brief Format the string as the win32 CRT, the '%s' and '%c' take the character type of format, '%hs' and '%hc'
+ * take ANSI, '%ls', '%lc', '%S' and '%C' take the other type. The '%n' is not supported.
+ * @return _dword The length of formatted string, it's not truncated by the buffer.
+ */
+template <typename CharType>
+static _dword FormatString(CharType* buffer, _dword size, const CharType* format, _va_list arguments) {
+	linuxStringWriter<CharType> writer(buffer, size);
+	if (format == _null)
+		return writer.Finish();
+
+	const CharType* read = format;
+	while (*read != 0) {
+		if (*read != '%') {
+			writer.Write(linuxString<CharType>::GetCode(*read++));
+			continue;
+		}
+
+		const CharType* start = read++;
+
+		// The flags
+		_chara flags[8];
+		_dword flag_number = 0;
+		_boolean left = _false;
+		while (*read == '-' || *read == '+' || *read == ' ' || *read == '#' || *read == '0') {
+			if (*read == '-')
+				left = _true;
+
+			if (flag_number + 1 < E3D_ARRAY_NUMBER(flags))
+				flags[flag_number++] = (_chara)*read;
+
+			read++;
+		}
+
+		// The width, the negative one from arguments is left-justified
+		_int width = -1;
+		if (*read == '*') {
+			width = va_arg(arguments, _int);
+			if (width < 0) {
+				width = width == INT_MIN ? INT_MAX : -width;
+				left = _true;
+
+				if (flag_number + 1 < E3D_ARRAY_NUMBER(flags))
+					flags[flag_number++] = '-';
+			}
+
+			read++;
+		} else {
+			for (; *read >= '0' && *read <= '9'; read++)
+				width = MIN((width < 0 ? 0 : width) * 10 + (*read - '0'), 1000000);
+		}
+
+		flags[flag_number] = 0;
+
+		// The precision, the negative one from arguments is omitted
+		_int precision = -1;
+		if (*read == '.') {
+			read++;
+
+			if (*read == '*') {
+				precision = va_arg(arguments, _int);
+				read++;
+			} else {
+				precision = 0;
+				for (; *read >= '0' && *read <= '9'; read++)
+					precision = MIN(precision * 10 + (*read - '0'), 1000000);
+			}
+		}
+
+		// The length modifier, the win32 ones included
+		linuxFormatModifier modifier = linuxFormatModifier::None;
+		if (*read == 'h') {
+			modifier = read[1] == 'h' ? linuxFormatModifier::Char : linuxFormatModifier::Short;
+			read += read[1] == 'h' ? 2 : 1;
+		} else if (*read == 'l') {
+			modifier = read[1] == 'l' ? linuxFormatModifier::LongLong : linuxFormatModifier::Long;
+			read += read[1] == 'l' ? 2 : 1;
+		} else if (*read == 'w') {
+			modifier = linuxFormatModifier::Long;
+			read++;
+		} else if (*read == 'q') {
+			modifier = linuxFormatModifier::LongLong;
+			read++;
+		} else if (*read == 'L') {
+			modifier = linuxFormatModifier::LongDouble;
+			read++;
+		} else if (*read == 'z') {
+			modifier = linuxFormatModifier::Size;
+			read++;
+		} else if (*read == 'j') {
+			modifier = linuxFormatModifier::IntMax;
+			read++;
+		} else if (*read == 't') {
+			modifier = linuxFormatModifier::PtrDiff;
+			read++;
+		} else if (*read == 'I') {
+			if (read[1] == '6' && read[2] == '4') {
+				modifier = linuxFormatModifier::LongLong;
+				read += 3;
+			} else if (read[1] == '3' && read[2] == '2') {
+				read += 3;
+			} else {
+				modifier = linuxFormatModifier::Size;
+				read++;
+			}
+		}
+
+		CharType conversion = *read;
+		if (conversion == 0) {
+			// Write the incomplete spec as it is
+			writer.Write(start, (_dword)(read - start));
+			break;
+		}
+
+		read++;
+
+		// The integers are passed to libc in 64-bits, the sizes are truncated first
+		_chara spec[64];
+		_chara precision_spec[16] = {0};
+		if (precision >= 0)
+			::snprintf(precision_spec, sizeof(precision_spec), ".%d", precision);
+
+		_chara width_spec[16] = {0};
+		if (width >= 0)
+			::snprintf(width_spec, sizeof(width_spec), "%d", width);
+
+		// The 's' and 'c' take the character type of format, the 'S' and 'C' take the other one
+		_boolean wide = sizeof(CharType) == 2;
+		if (conversion == 'S' || conversion == 'C')
+			wide = !wide;
+		if (modifier == linuxFormatModifier::Short)
+			wide = _false;
+		else if (modifier == linuxFormatModifier::Long)
+			wide = _true;
+
+		switch (conversion) {
+			case 'd':
+			case 'i': {
+				_large value = 0;
+				switch (modifier) {
+					case linuxFormatModifier::Char: value = (signed char)va_arg(arguments, _int); break;
+					case linuxFormatModifier::Short: value = (short)va_arg(arguments, _int); break;
+					case linuxFormatModifier::Long: value = va_arg(arguments, long); break;
+					case linuxFormatModifier::LongLong: value = va_arg(arguments, long long); break;
+					case linuxFormatModifier::Size: value = va_arg(arguments, ssize_t); break;
+					case linuxFormatModifier::IntMax: value = va_arg(arguments, intmax_t); break;
+					case linuxFormatModifier::PtrDiff: value = va_arg(arguments, ptrdiff_t); break;
+					default: value = va_arg(arguments, _int); break;
+				}
+
+				::snprintf(spec, sizeof(spec), "%%%s%s%slld", flags, width_spec, precision_spec);
+				WriteFormatNumber(writer, spec, (long long)value);
+			} break;
+
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X': {
+				_qword value = 0;
+				switch (modifier) {
+					case linuxFormatModifier::Char: value = (unsigned char)va_arg(arguments, _int); break;
+					case linuxFormatModifier::Short: value = (unsigned short)va_arg(arguments, _int); break;
+					case linuxFormatModifier::Long: value = va_arg(arguments, unsigned long); break;
+					case linuxFormatModifier::LongLong: value = va_arg(arguments, unsigned long long); break;
+					case linuxFormatModifier::Size: value = va_arg(arguments, size_t); break;
+					case linuxFormatModifier::IntMax: value = va_arg(arguments, uintmax_t); break;
+					case linuxFormatModifier::PtrDiff: value = (_qword)va_arg(arguments, ptrdiff_t); break;
+					default: value = va_arg(arguments, _dword); break;
+				}
+
+				::snprintf(spec, sizeof(spec), "%%%s%s%sll%c", flags, width_spec, precision_spec, (_chara)conversion);
+				WriteFormatNumber(writer, spec, (unsigned long long)value);
+			} break;
+
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A': {
+				if (modifier == linuxFormatModifier::LongDouble) {
+					::snprintf(spec, sizeof(spec), "%%%s%s%sL%c", flags, width_spec, precision_spec, (_chara)conversion);
+					WriteFormatNumber(writer, spec, va_arg(arguments, long double));
+				} else {
+					::snprintf(spec, sizeof(spec), "%%%s%s%s%c", flags, width_spec, precision_spec, (_chara)conversion);
+					WriteFormatNumber(writer, spec, va_arg(arguments, _double));
+				}
+			} break;
+
+			case 'p': {
+				::snprintf(spec, sizeof(spec), "%%%s%sp", flags, width_spec);
+				WriteFormatNumber(writer, spec, va_arg(arguments, _void*));
+			} break;
+
+			case 'c':
+			case 'C': {
+				_int code = va_arg(arguments, _int);
+				if (wide) {
+					const _charw string[2] = {(_charw)code, 0};
+					WriteFormatString(writer, string, -1, width, left);
+				} else {
+					const _chara string[2] = {(_chara)code, 0};
+					WriteFormatString(writer, string, -1, width, left);
+				}
+			} break;
+
+			case 's':
+			case 'S': {
+				static const _chara cNullString[] = "(null)";
+
+				_void* string = va_arg(arguments, _void*);
+				if (string == _null)
+					WriteFormatString(writer, cNullString, precision, width, left);
+				else if (wide)
+					WriteFormatString(writer, (const _charw*)string, precision, width, left);
+				else
+					WriteFormatString(writer, (const _chara*)string, precision, width, left);
+			} break;
+
+			case 'n': {
+				// Skip it as the win32 CRT does by default
+				va_arg(arguments, _void*);
+			} break;
+
+			case '%': {
+				writer.Write('%');
+			} break;
+
+			default: {
+				// Write the unknown spec as it is
+				writer.Write(start, (_dword)(read - start));
+			} break;
+		}
+	}
+
+	return writer.Finish();
+}
+
+#pragma endregion
+
+#pragma region "Kernel"
+
+_boolean Platform::Initialize() {
+	sMainThreadID = GetCurrentThreadID();
+
+	// The broken socket should not kill the whole process
+	::signal(SIGPIPE, SIG_IGN);
+
+	return _true;
+}
+
+_void Platform::Finalize() {
+}
+
+#pragma endregion
+
+#pragma region "Critical Section"
+
+_handle Platform::CreateCriticalSection() {
+	linuxCriticalSection* critical_section = new linuxCriticalSection;
+	critical_section->mState = 0;
+	critical_section->mRecursionCount = 0;
+	critical_section->mOwnerThreadID = 0;
+	critical_section->mSpinCount = 0;
+	critical_section->mMaxSpinCount = IsSpinEnabled() ? cDefaultCriticalSectionSpinCount : 0;
+	E3D_INIT(critical_section->mContention);
+
+	return critical_section;
+}
+
+_void Platform::DeleteCriticalSection(_handle object) {
+	linuxCriticalSection* critical_section = (linuxCriticalSection*)object;
+	if (critical_section == _null)
+		return;
+
+	E3D_ASSERT(critical_section->mState == 0);
+	delete critical_section;
+}
+
+_void Platform::EnterCriticalSection(_handle object) {
+	linuxCriticalSection* critical_section = (linuxCriticalSection*)object;
+	E3D_ASSERT(critical_section != _null);
+
+	// Only the owner thread could see its own ID here
+	_thread_id threadid = GetCurrentThreadID();
+	if (__atomic_load_n(&critical_section->mOwnerThreadID, __ATOMIC_RELAXED) == threadid) {
+		critical_section->mRecursionCount++;
+		return;
+	}
+
+	// The fast path, nobody owns it
+	_dword state = 0;
+	if (!__atomic_compare_exchange_n(&critical_section->mState, &state, 1, _false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		_dword spin_count = __atomic_load_n(&critical_section->mSpinCount, __ATOMIC_RELAXED);
+		_dword spin_limit = MIN(__atomic_load_n(&critical_section->mMaxSpinCount, __ATOMIC_RELAXED), spin_count * 2 + 10);
+		_dword spin_number = 0;
+		_dword sleep_number = 0;
+		_qword sleep_time = 0;
+
+		// Spin while the owner is running, test before CAS to avoid bouncing the cache line
+		_boolean acquired = _false;
+		while (!acquired && spin_number < spin_limit) {
+			spin_number++;
+			CPU_PAUSE();
+
+			state = 0;
+			acquired = __atomic_load_n(&critical_section->mState, __ATOMIC_RELAXED) == 0 && __atomic_compare_exchange_n(&critical_section->mState, &state, 1, _false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+		}
+
+		if (!acquired) {
+			// Mark it as contended and sleep until the owner leaves
+			state = __atomic_exchange_n(&critical_section->mState, 2, __ATOMIC_ACQUIRE);
+
+			while (state != 0) {
+				_qword tickcount = linuxHelper::GetMonotonicNanoseconds();
+				linuxFutex::Wait(&critical_section->mState, 2, _null);
+				sleep_time += linuxHelper::GetMonotonicNanoseconds() - tickcount;
+				sleep_number++;
+
+				state = __atomic_exchange_n(&critical_section->mState, 2, __ATOMIC_ACQUIRE);
+			}
+		}
+
+		// Move the spin count towards the recent spins, the failed spin pushes it to the limit
+		if (spin_limit != 0)
+			__atomic_store_n(&critical_section->mSpinCount, (_dword)((_int)spin_count + ((_int)spin_number - (_int)spin_count) / 8), __ATOMIC_RELAXED);
+
+		LockContentionData& contention = critical_section->mContention;
+		IncreaseCounter(contention.mContendedNumber, 1);
+		IncreaseCounter(contention.mSpinNumber, spin_number);
+		IncreaseCounter(contention.mSleepNumber, sleep_number);
+		IncreaseCounter(contention.mSleepTime, sleep_time);
+
+		if (acquired)
+			IncreaseCounter(contention.mSpinAcquiredNumber, 1);
+	}
+
+	__atomic_store_n(&critical_section->mOwnerThreadID, threadid, __ATOMIC_RELAXED);
+	critical_section->mRecursionCount = 1;
+
+	IncreaseCounter(critical_section->mContention.mAcquiredNumber, 1);
+}
+
+_void Platform::LeaveCriticalSection(_handle object) {
+	linuxCriticalSection* critical_section = (linuxCriticalSection*)object;
+	E3D_ASSERT(critical_section != _null);
+	E3D_ASSERT(critical_section->mOwnerThreadID == GetCurrentThreadID());
+
+	if (--critical_section->mRecursionCount != 0)
+		return;
+
+	__atomic_store_n(&critical_section->mOwnerThreadID, 0, __ATOMIC_RELAXED);
+
+	// Wake one waiter only if someone is sleeping on it
+	if (__atomic_fetch_sub(&critical_section->mState, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n(&critical_section->mState, 0, __ATOMIC_RELEASE);
+		linuxFutex::Wake(&critical_section->mState, 1);
+	}
+}
+
+_void Platform::SetCriticalSectionSpinCount(_handle object, _dword spincount) {
+	linuxCriticalSection* critical_section = (linuxCriticalSection*)object;
+	E3D_ASSERT(critical_section != _null);
+
+	// The spinning is useless on single processor
+	__atomic_store_n(&critical_section->mMaxSpinCount, IsSpinEnabled() ? spincount : 0, __ATOMIC_RELAXED);
+}
+
+_boolean Platform::GetCriticalSectionContention(_handle object, LockContentionData& data) {
+	linuxCriticalSection* critical_section = (linuxCriticalSection*)object;
+	if (critical_section == _null)
+		return _false;
+
+	// The counters could be updated by the owner at the same time, it's fine for statistics
+	const LockContentionData& contention = critical_section->mContention;
+	data.mAcquiredNumber = __atomic_load_n(&contention.mAcquiredNumber, __ATOMIC_RELAXED);
+	data.mContendedNumber = __atomic_load_n(&contention.mContendedNumber, __ATOMIC_RELAXED);
+	data.mSpinAcquiredNumber = __atomic_load_n(&contention.mSpinAcquiredNumber, __ATOMIC_RELAXED);
+	data.mSpinNumber = __atomic_load_n(&contention.mSpinNumber, __ATOMIC_RELAXED);
+	data.mSleepNumber = __atomic_load_n(&contention.mSleepNumber, __ATOMIC_RELAXED);
+	data.mSleepTime = __atomic_load_n(&contention.mSleepTime, __ATOMIC_RELAXED);
+	data.mSpinCount = __atomic_load_n(&critical_section->mSpinCount, __ATOMIC_RELAXED);
+
+	return _true;
+}
+
+_void Platform::ResetCriticalSectionContention(_handle object) {
+	linuxCriticalSection* critical_section = (linuxCriticalSection*)object;
+	E3D_ASSERT(critical_section != _null);
+
+	// Only the owner could update the counters
+	EnterCriticalSection(critical_section);
+	E3D_INIT(critical_section->mContention);
+	LeaveCriticalSection(critical_section);
+}
+
+#pragma endregion
+
+#pragma region "Read Write Lock"
+
+_handle Platform::CreateReadWriteLock() {
+	// The slots are assigned to the threads in order of first use (see GetReaderSlotIndex()), not to the processors,
+	// so the thread leaves the slot it entered even if it migrates. Size it by the processors to spread the concurrent
+	// readers, the slot number must be power of 2
+	_dword slot_number = 1;
+	while (slot_number < GetProcessorNumber() && slot_number < cMaxReadWriteLockSlotNumber)
+		slot_number <<= 1;
+
+	_void* slots = _null;
+	if (::posix_memalign(&slots, E3D_CACHE_LINE_SIZE, slot_number * sizeof(linuxReadWriteLockSlot)) != 0)
+		return _null;
+
+	::memset(slots, 0, slot_number * sizeof(linuxReadWriteLockSlot));
+
+	linuxReadWriteLock* lock = new linuxReadWriteLock;
+	lock->mWriterNumber = 0;
+	lock->mReaderWaiterNumber = 0;
+	lock->mSlotMask = slot_number - 1;
+	lock->mWriterLocker = CreateCriticalSection();
+	lock->mSlots = (linuxReadWriteLockSlot*)slots;
+
+	return lock;
+}
+
+_void Platform::DeleteReadWriteLock(_handle object) {
+	linuxReadWriteLock* lock = (linuxReadWriteLock*)object;
+	if (lock == _null)
+		return;
+
+	E3D_ASSERT(lock->mWriterNumber == 0);
+
+	DeleteCriticalSection(lock->mWriterLocker);
+	::free(lock->mSlots);
+	delete lock;
+}
+
+_void Platform::EnterReadLock(_handle object) {
+	linuxReadWriteLock* lock = (linuxReadWriteLock*)object;
+	E3D_ASSERT(lock != _null);
+
+	_dword* reader_number = &lock->mSlots[GetReaderSlotIndex() & lock->mSlotMask].mReaderNumber;
+
+	while (!TryEnterReadSlot(lock, reader_number)) {
+		_dword writer_number = __atomic_load_n(&lock->mWriterNumber, __ATOMIC_ACQUIRE);
+		if (writer_number == 0)
+			continue;
+
+		// Sleep until all writers leave, the waiter number must be visible before the futex checks the writers
+		__atomic_add_fetch(&lock->mReaderWaiterNumber, 1, __ATOMIC_SEQ_CST);
+		linuxFutex::Wait(&lock->mWriterNumber, writer_number, _null);
+		__atomic_sub_fetch(&lock->mReaderWaiterNumber, 1, __ATOMIC_RELAXED);
+	}
+}
+
+_boolean Platform::TryEnterReadLock(_handle object) {
+	linuxReadWriteLock* lock = (linuxReadWriteLock*)object;
+	E3D_ASSERT(lock != _null);
+
+	return TryEnterReadSlot(lock, &lock->mSlots[GetReaderSlotIndex() & lock->mSlotMask].mReaderNumber);
+}
+
+_void Platform::LeaveReadLock(_handle object) {
+	linuxReadWriteLock* lock = (linuxReadWriteLock*)object;
+	E3D_ASSERT(lock != _null);
+
+	LeaveReadSlot(lock, &lock->mSlots[GetReaderSlotIndex() & lock->mSlotMask].mReaderNumber);
+}
+
+_void Platform::EnterWriteLock(_handle object) {
+	linuxReadWriteLock* lock = (linuxReadWriteLock*)object;
+	E3D_ASSERT(lock != _null);
+
+	// Block the new readers first, then wait for the other writers
+	__atomic_add_fetch(&lock->mWriterNumber, 1, __ATOMIC_SEQ_CST);
+	EnterCriticalSection(lock->mWriterLocker);
+
+	// Wait for all readers to drain, the new readers back off
+	for (_dword i = 0; i <= lock->mSlotMask; i++) {
+		_dword* reader_number = &lock->mSlots[i].mReaderNumber;
+
+		_dword number;
+		while ((number = __atomic_load_n(reader_number, __ATOMIC_SEQ_CST)) != 0)
+			linuxFutex::Wait(reader_number, number, _null);
+	}
+}
+
+_void Platform::LeaveWriteLock(_handle object) {
+	linuxReadWriteLock* lock = (linuxReadWriteLock*)object;
+	E3D_ASSERT(lock != _null);
+
+	LeaveCriticalSection(lock->mWriterLocker);
+
+	// The last writer lets the readers in
+	if (__atomic_sub_fetch(&lock->mWriterNumber, 1, __ATOMIC_SEQ_CST) == 0 && __atomic_load_n(&lock->mReaderWaiterNumber, __ATOMIC_SEQ_CST) != 0)
+		linuxFutex::Wake(&lock->mWriterNumber, -1);
+}
+
+#pragma endregion
+
+#pragma region "Condition Variable"
+
+_handle Platform::CreateConditionVariable() {
+	linuxConditionVariable* condition_variable = new linuxConditionVariable;
+	condition_variable->mSequence = 0;
+	condition_variable->mWaiterNumber = 0;
+
+	return condition_variable;
+}
+
+_void Platform::DeleteConditionVariable(_handle object) {
+	linuxConditionVariable* condition_variable = (linuxConditionVariable*)object;
+	if (condition_variable == _null)
+		return;
+
+	E3D_ASSERT(condition_variable->mWaiterNumber == 0);
+	delete condition_variable;
+}
+
+_boolean Platform::SleepConditionVariable(_handle object, _handle critical_section, _qword nanoseconds) {
+	linuxConditionVariable* condition_variable = (linuxConditionVariable*)object;
+	linuxCriticalSection* locker = (linuxCriticalSection*)critical_section;
+	E3D_ASSERT(condition_variable != _null && locker != _null);
+	E3D_ASSERT(locker->mOwnerThreadID == GetCurrentThreadID());
+
+	// Take the sequence before releasing the locker, so the wake after it changes the sequence and the futex returns at once
+	_dword sequence = __atomic_load_n(&condition_variable->mSequence, __ATOMIC_ACQUIRE);
+	__atomic_add_fetch(&condition_variable->mWaiterNumber, 1, __ATOMIC_SEQ_CST);
+
+	// Release the locker completely even if it's entered recursively
+	_dword recursion_count = locker->mRecursionCount;
+	locker->mRecursionCount = 1;
+	LeaveCriticalSection(locker);
+
+	timespec timeout;
+	timespec* timeout_pointer = _null;
+	_boolean woken = _false;
+	if (GetRemainingTimeout(GetDeadline(nanoseconds), timeout, timeout_pointer))
+		woken = linuxFutex::Wait(&condition_variable->mSequence, sequence, timeout_pointer);
+
+	__atomic_sub_fetch(&condition_variable->mWaiterNumber, 1, __ATOMIC_RELAXED);
+
+	EnterCriticalSection(locker);
+	locker->mRecursionCount = recursion_count;
+
+	return woken;
+}
+
+_void Platform::WakeConditionVariable(_handle object) {
+	linuxConditionVariable* condition_variable = (linuxConditionVariable*)object;
+	E3D_ASSERT(condition_variable != _null);
+
+	// The sequence must be changed before checking waiters, see SleepConditionVariable()
+	__atomic_add_fetch(&condition_variable->mSequence, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&condition_variable->mWaiterNumber, __ATOMIC_SEQ_CST) != 0)
+		linuxFutex::Wake(&condition_variable->mSequence, 1);
+}
+
+_void Platform::WakeAllConditionVariable(_handle object) {
+	linuxConditionVariable* condition_variable = (linuxConditionVariable*)object;
+	E3D_ASSERT(condition_variable != _null);
+
+	__atomic_add_fetch(&condition_variable->mSequence, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&condition_variable->mWaiterNumber, __ATOMIC_SEQ_CST) != 0)
+		linuxFutex::Wake(&condition_variable->mSequence, -1);
+}
+
+#pragma endregion
+
+#pragma region "Wait On Address"
+
+_boolean Platform::WaitOnAddress(_dword* address, _dword compare, _qword nanoseconds) {
+	E3D_ASSERT(address != _null);
+
+	if (__atomic_load_n(address, __ATOMIC_ACQUIRE) != compare)
+		return _true;
+
+	timespec timeout;
+	timespec* timeout_pointer = _null;
+	if (!GetRemainingTimeout(GetDeadline(nanoseconds), timeout, timeout_pointer))
+		return _false;
+
+	return linuxFutex::Wait(address, compare, timeout_pointer);
+}
+
+_void Platform::WakeByAddressSingle(_dword* address) {
+	linuxFutex::Wake(address, 1);
+}
+
+_void Platform::WakeByAddressAll(_dword* address) {
+	linuxFutex::Wake(address, -1);
+}
+
+#pragma endregion
+
+#pragma region "Single Object"
+
+_boolean Platform::WaitForSingleObject(_handle object, _dword milliseconds) {
+	return WaitForSingleObjectNanoseconds(object, MillisecondsToNanoseconds(milliseconds));
+}
+
+_boolean Platform::WaitForSingleObjectNanoseconds(_handle object, _qword nanoseconds) {
+	linuxObject* kernel_object = (linuxObject*)object;
+	if (kernel_object == _null)
+		return _false;
+
+	switch (kernel_object->mType) {
+		case linuxObjectType::Event:
+			return WaitEvent((linuxEvent*)kernel_object, nanoseconds);
+
+		case linuxObjectType::Thread:
+			// The adopted thread is not signaled, it's only valid in the thread itself
+			if (((linuxThread*)kernel_object)->mAdopted)
+				return _false;
+
+			return WaitWhileEqual(&((linuxThread*)kernel_object)->mFinished, 0, nanoseconds);
+
+		default:
+			break;
+	}
+
+	return _false;
+}
+
+_handle Platform::CloneEvent(_handle object) {
+	linuxEvent* event = (linuxEvent*)object;
+	if (event == _null)
+		return _null;
+
+	__atomic_add_fetch(&event->mRefCount, 1, __ATOMIC_RELAXED);
+
+	return event;
+}
+
+_handle Platform::CreateEvent(_boolean manualReset, _boolean initialState) {
+	linuxEvent* event = new linuxEvent;
+	event->mType = linuxObjectType::Event;
+	event->mState = initialState ? 1 : 0;
+	event->mManualReset = manualReset ? 1 : 0;
+	event->mRefCount = 1;
+	event->mWaiterNumber = 0;
+
+	return event;
+}
+
+_void Platform::CloseEvent(_handle handle) {
+	linuxEvent* event = (linuxEvent*)handle;
+	if (event == _null)
+		return;
+
+	if (__atomic_sub_fetch(&event->mRefCount, 1, __ATOMIC_ACQ_REL) == 0)
+		delete event;
+}
+
+_boolean Platform::SetEvent(_handle object) {
+	linuxEvent* event = (linuxEvent*)object;
+	if (event == _null)
+		return _false;
+
+	// Skip the system call if it has been signaled already
+	if (__atomic_exchange_n(&event->mState, 1, __ATOMIC_SEQ_CST) == 1)
+		return _true;
+
+	// Skip the system call if nobody is sleeping on it, the spinning waiters will see the state soon
+	if (__atomic_load_n(&event->mWaiterNumber, __ATOMIC_SEQ_CST) != 0)
+		linuxFutex::Wake(&event->mState, event->mManualReset ? (_dword)-1 : 1);
+
+	return _true;
+}
+
+_boolean Platform::ResetEvent(_handle object) {
+	linuxEvent* event = (linuxEvent*)object;
+	if (event == _null)
+		return _false;
+
+	__atomic_store_n(&event->mState, 0, __ATOMIC_RELEASE);
+
+	return _true;
+}
+
+#pragma endregion
+
+#pragma region "Thread"
+
+_void Platform::Sleep(_dword milliseconds) {
+	timespec time;
+	time.tv_sec = milliseconds / 1000;
+	time.tv_nsec = (milliseconds % 1000) * 1000000L;
+
+	while (::nanosleep(&time, &time) == -1 && errno == EINTR)
+		;
+}
+
+#pragma endregion
+
+#pragma region "Endian"
+
+_boolean Platform::IsLittleEndian() {
+	return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+}
+
+_boolean Platform::IsBigEndian() {
+	return __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+}
+
+Endian Platform::GetEndianType() {
+	return IsLittleEndian() ? Endian::Little : Endian::Big;
+}
+
+#pragma endregion
+
+#pragma region "CPU"
+
+_float Platform::GetCurrentCPUUsage() {
+	_chara buffer[512];
+	if (linuxHelper::ReadTextFile("/proc/stat", buffer, sizeof(buffer)) == (_dword)-1)
+		return 0.0f;
+
+	unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+	if (::sscanf(buffer, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) < 4)
+		return 0.0f;
+
+	_qword busy_time = user + nice + system + irq + softirq + steal;
+	_qword total_time = busy_time + idle + iowait;
+
+	pthread_mutex_lock(&sCPUUsageLocker);
+	{
+		// Keep the last usage if the sample interval is too short
+		if (total_time > sLastCPUTotalTime && busy_time >= sLastCPUBusyTime) {
+			sLastCPUUsage = E3D_RATIO_D(busy_time - sLastCPUBusyTime, total_time - sLastCPUTotalTime) * 100.0;
+			sLastCPUBusyTime = busy_time;
+			sLastCPUTotalTime = total_time;
+		}
+	}
+	_float usage = sLastCPUUsage;
+	pthread_mutex_unlock(&sCPUUsageLocker);
+
+	return usage;
+}
+
+const CPUTopology& Platform::GetCPUTopology() {
+	::pthread_once(&sCPUTopologyOnce, DiscoverCPUTopology);
+
+	return sCPUTopology;
+}
+
+_boolean Platform::GetNodeCPUSet(_dword node, CPUSet& cpuset) {
+	const CPUTopology& topology = GetCPUTopology();
+	if (node >= topology.mNodeNumber)
+		return _false;
+
+	cpuset.Clear();
+	for (_dword cpu = 0; cpu < CPUSet::cMaxCPUNumber; cpu++) {
+		if (topology.mOnlineCPUs.Contains(cpu) && topology.mCPUs[cpu].mNode == node)
+			cpuset.Add(cpu);
+	}
+
+	return _true;
+}
+
+_dword Platform::GetCurrentProcessorIndex() {
+	_int cpu = ::sched_getcpu();
+
+	return cpu >= 0 ? (_dword)cpu : 0;
+}
+
+_dword Platform::GetCurrentNode() {
+	unsigned int cpu = 0, node = 0;
+	if (::syscall(SYS_getcpu, &cpu, &node, _null) != 0)
+		return 0;
+
+	return node;
+}
+
+_boolean Platform::SetThreadAffinity(_handle thread, const CPUSet& cpuset) {
+	cpu_set_t system_cpuset;
+	ToSystemCPUSet(cpuset, system_cpuset);
+
+	return ::pthread_setaffinity_np(HandleToThread(thread)->mThread, sizeof(system_cpuset), &system_cpuset) == 0;
+}
+
+_boolean Platform::GetThreadAffinity(_handle thread, CPUSet& cpuset) {
+	cpu_set_t system_cpuset;
+	if (::pthread_getaffinity_np(HandleToThread(thread)->mThread, sizeof(system_cpuset), &system_cpuset) != 0)
+		return _false;
+
+	FromSystemCPUSet(system_cpuset, cpuset);
+	return _true;
+}
+
+_boolean Platform::SetProcessAffinity(_handle process, const CPUSet& cpuset) {
+	cpu_set_t system_cpuset;
+	ToSystemCPUSet(cpuset, system_cpuset);
+
+	return ::sched_setaffinity(HandleToProcessID(process), sizeof(system_cpuset), &system_cpuset) == 0;
+}
+
+_boolean Platform::GetProcessAffinity(_handle process, CPUSet& cpuset) {
+	cpu_set_t system_cpuset;
+	if (::sched_getaffinity(HandleToProcessID(process), sizeof(system_cpuset), &system_cpuset) != 0)
+		return _false;
+
+	FromSystemCPUSet(system_cpuset, cpuset);
+	return _true;
+}
+
+#pragma endregion
+
+#pragma region "Memory"
+
+_chara* Platform::HeapAllocStr(const _chara* string, _handle heap) {
+	if (string == _null)
+		return _null;
+
+	_dword size = (StringLength(string) + 1) * sizeof(_chara);
+
+	_chara* buffer = (_chara*)HeapAlloc(size, heap);
+	if (buffer != _null)
+		E3D_MEM_CPY(buffer, string, size);
+
+	return buffer;
+}
+
+_charw* Platform::HeapAllocStr(const _charw* string, _handle heap) {
+	if (string == _null)
+		return _null;
+
+	_dword size = (StringLength(string) + 1) * sizeof(_charw);
+
+	_charw* buffer = (_charw*)HeapAlloc(size, heap);
+	if (buffer != _null)
+		E3D_MEM_CPY(buffer, string, size);
+
+	return buffer;
+}
+
+_void* Platform::HeapAlloc(_qword size, _handle heap) {
+	return AllocHeapBlock(size, heap, MemoryTags::GetThreadTag());
+}
+
+_void* Platform::HeapReAlloc(_void* pointer, _qword size, _handle heap) {
+	// The new block goes through the allocators as usual, so it could be sampled or placed in the slabs
+	if (pointer == _null)
+		return HeapAlloc(size, heap);
+
+	if (size == 0) {
+		HeapFree(pointer, heap);
+		return _null;
+	}
+
+	if (size > (_qword)(size_t)-1)
+		return _null;
+
+	// Dispatch to the owner in the same order as HeapFree(), the block keeps its tag
+	// The guarded block is moved to the heap, it could be sampled again
+	if (GuardedHeap::IsGuarded(pointer))
+		return MoveHeapBlock(pointer, GuardedHeap::GetSize(pointer), size, heap, GuardedHeap::GetTag(pointer));
+
+	// The slab block is kept if it's large enough, otherwise it's moved to the block of new size class (or a large block)
+	_dword small_size = SmallAllocator::GetSize(pointer);
+	if (small_size != 0) {
+		if (size <= small_size)
+			return pointer;
+
+		return MoveHeapBlock(pointer, small_size, size, heap, SmallAllocator::GetTag(pointer));
+	}
+
+	// The large block and the system heap block are resized in place if possible, the growth is checked by the budget first
+	LargeHeapBlock* block = GetLargeHeapBlock(pointer);
+	SystemHeapBlock* system_block = block == _null ? GetSystemHeapBlock(pointer) : _null;
+
+	MemoryTag tag = block != _null ? block->mTag : system_block->mTag;
+	_qword old_size = block != _null ? block->mSize : GetSystemHeapBlockSize(system_block);
+	if (size > old_size && !MemoryTags::OnAlloc(tag, size - old_size))
+		return _null;
+
+	// Remove the sample before the address could be reused by the other threads
+	AllocationSampler::OnFree(pointer);
+
+	_void* new_pointer = block != _null ? ReAllocLargeHeapBlock(block, size) : ReAllocSystemHeapBlock(system_block, size);
+	if (new_pointer == _null) {
+		if (size > old_size)
+			MemoryTags::OnFree(tag, size - old_size);
+
+		AllocationSampler::OnAlloc(pointer, old_size);
+		return _null;
+	}
+
+	// The usable size could be larger than required
+	_qword new_size = GetHeapBlockSize(new_pointer);
+	if (new_size > MAX(size, old_size))
+		MemoryTags::OnAlloc(tag, new_size - MAX(size, old_size));
+	else if (new_size < MAX(size, old_size))
+		MemoryTags::OnFree(tag, MAX(size, old_size) - new_size);
+
+	AllocationSampler::OnAlloc(new_pointer, size);
+
+	return new_pointer;
+}
+
+_void Platform::HeapFree(_void* pointer, _handle heap) {
+	if (pointer == _null)
+		return;
+
+	AllocationSampler::OnFree(pointer);
+
+	MemoryTag tag = MemoryTag::Default;
+	_qword size = GetHeapBlockSize(pointer, &tag);
+
+	// The double free or the invalid free of guarded block is reported and not accounted
+	if (GuardedHeap::IsGuarded(pointer)) {
+		if (GuardedHeap::Free(pointer))
+			MemoryTags::OnFree(tag, size);
+
+		return;
+	}
+
+	MemoryTags::OnFree(tag, size);
+	ReleaseHeapBlock(pointer);
+}
+
+_void* Platform::HeapAllocAligned(_qword size, _dword alignment, _handle heap) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0 || size > (_qword)(size_t)-1)
+		return _null;
+
+	// All heap blocks are aligned to 16 bytes, and the large blocks are aligned to 64 bytes
+	if (alignment <= SmallAllocator::cSizeClassGranularity || (alignment <= cLargeHeapBlockHeaderSize && (size >= cLargeHeapBlockThreshold || heap == &sVirtualHeap)))
+		return HeapAlloc(size, heap);
+
+	MemoryTag tag = MemoryTags::GetThreadTag();
+
+	// The guarded pages are aligned to the page size
+	_void* pointer = _null;
+	if (alignment <= GetPageSize() && GuardedHeap::ShouldSample(size) && (pointer = GuardedHeap::Alloc(size, alignment)) != _null) {
+		GuardedHeap::SetTag(pointer, tag);
+		return ChargeHeapBlock(pointer, size, tag);
+	}
+
+	// The over-aligned block comes from the system heap, the header takes one alignment before the block
+	return ChargeHeapBlock(AllocSystemHeapBlock(size, alignment, tag), size, tag);
+}
+
+_void* Platform::HeapReAllocAligned(_void* pointer, _qword size, _dword alignment, _handle heap) {
+	if (pointer == _null)
+		return HeapAllocAligned(size, alignment, heap);
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		return _null;
+
+	// The reallocation of heap keeps the alignment of 16 bytes, and the large blocks keep 64 bytes
+	if (alignment <= SmallAllocator::cSizeClassGranularity || (alignment <= cLargeHeapBlockHeaderSize && GetLargeHeapBlock(pointer) != _null))
+		return HeapReAlloc(pointer, size, heap);
+
+	if (size == 0) {
+		HeapFreeAligned(pointer, heap);
+		return _null;
+	}
+
+	// Keep the block if it's aligned and large enough
+	MemoryTag tag = MemoryTag::Default;
+	_qword old_size = GetHeapBlockSize(pointer, &tag);
+	if (size <= old_size && ((_uintptr_t)pointer & (alignment - 1)) == 0)
+		return pointer;
+
+	// The new block keeps the tag
+	MemoryTag previous_tag = MemoryTags::SetThreadTag(tag);
+	_void* new_pointer = HeapAllocAligned(size, alignment, heap);
+	MemoryTags::SetThreadTag(previous_tag);
+
+	if (new_pointer == _null)
+		return _null;
+
+	E3D_MEM_CPY(new_pointer, pointer, MIN(old_size, size));
+	HeapFreeAligned(pointer, heap);
+
+	return new_pointer;
+}
+
+_void Platform::HeapFreeAligned(_void* pointer, _handle heap) {
+	// The aligned blocks come from the same heaps, they could be identified by the address
+	HeapFree(pointer, heap);
+}
+
+MemoryTag Platform::GetHeapBlockTag(const _void* pointer) {
+	MemoryTag tag = MemoryTag::Default;
+	GetHeapBlockSize((_void*)pointer, &tag);
+
+	return tag;
+}
+
+_handle Platform::GetGlobalHeap() {
+	return &sGlobalHeap;
+}
+
+_handle Platform::GetVirtualHeap() {
+	return &sVirtualHeap;
+}
+
+_void* Platform::AllocOnNode(_qword size, _dword node) {
+	if (size == 0)
+		return _null;
+
+	_void* pointer = ::mmap(_null, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (pointer == MAP_FAILED)
+		return _null;
+
+	if (node == (_dword)-1)
+		node = GetCurrentNode();
+
+	// The pages are not touched yet, so the policy decides where they are placed, the failure is fine on non-NUMA system
+	_qword mask = 0;
+	if (BuildNodeMask(node, mask))
+		::syscall(SYS_mbind, pointer, (size_t)size, cMemoryPolicyPreferred, &mask, cMaxNodeNumber + 1, 0);
+
+	return pointer;
+}
+
+_void Platform::FreeOnNode(_void* pointer, _qword size) {
+	if (pointer != _null)
+		::munmap(pointer, (size_t)size);
+}
+
+_boolean Platform::SetPreferredNode(_dword node) {
+	if (node == (_dword)-1)
+		return ::syscall(SYS_set_mempolicy, cMemoryPolicyDefault, _null, 0) == 0;
+
+	_qword mask = 0;
+	if (!BuildNodeMask(node, mask))
+		return _false;
+
+	return ::syscall(SYS_set_mempolicy, cMemoryPolicyPreferred, &mask, cMaxNodeNumber + 1) == 0;
+}
+
+_dword Platform::GetPageSize() {
+	static _dword page_size = (_dword)::sysconf(_SC_PAGESIZE);
+	return page_size;
+}
+
+_dword Platform::GetLargePageSize() {
+	if (sLargePageSize != 0)
+		return sLargePageSize;
+
+	// The line is like "Hugepagesize:       2048 kB"
+	_dword large_page_size = (_dword)cLargeHeapBlockAlignment;
+
+	_chara buffer[4096];
+	if (linuxHelper::ReadTextFile("/proc/meminfo", buffer, sizeof(buffer)) != (_dword)-1) {
+		const _chara* line = ::strstr(buffer, "Hugepagesize:");
+		_dword kilobytes = 0;
+		if (line != _null && ::sscanf(line, "Hugepagesize: %u kB", &kilobytes) == 1 && kilobytes != 0)
+			large_page_size = kilobytes * 1024;
+	}
+
+	sLargePageSize = large_page_size;
+	return large_page_size;
+}
+
+_void* Platform::ReserveVirtualMemory(_qword size, _qword alignment) {
+	if (size == 0 || (alignment & (alignment - 1)) != 0)
+		return _null;
+
+	// The reserved pages are not accessible and not counted as committed memory
+	return MapAlignedPages(size, alignment, PROT_NONE, MAP_NORESERVE);
+}
+
+_boolean Platform::CommitVirtualMemory(_void* pointer, _qword size) {
+	if (pointer == _null || size == 0)
+		return _false;
+
+	return ::mprotect(pointer, (size_t)RoundUpSize(size, GetPageSize()), PROT_READ | PROT_WRITE) == 0;
+}
+
+_boolean Platform::DecommitVirtualMemory(_void* pointer, _qword size) {
+	if (pointer == _null || size == 0)
+		return _false;
+
+	size = RoundUpSize(size, GetPageSize());
+
+	// The physical pages are dropped, they're zero filled if committed again
+	if (::madvise(pointer, (size_t)size, MADV_DONTNEED) != 0)
+		return _false;
+
+	return ::mprotect(pointer, (size_t)size, PROT_NONE) == 0;
+}
+
+_void Platform::ReleaseVirtualMemory(_void* pointer, _qword size) {
+	if (pointer != _null && size != 0)
+		::munmap(pointer, (size_t)RoundUpSize(size, GetPageSize()));
+}
+
+_boolean Platform::AdviseVirtualMemory(_void* pointer, _qword size, VirtualMemoryAdvice advice) {
+	if (pointer == _null || size == 0)
+		return _false;
+
+	_int flag = 0;
+	switch (advice) {
+		case VirtualMemoryAdvice::Normal: flag = MADV_NORMAL; break;
+		case VirtualMemoryAdvice::Sequential: flag = MADV_SEQUENTIAL; break;
+		case VirtualMemoryAdvice::Random: flag = MADV_RANDOM; break;
+		case VirtualMemoryAdvice::WillNeed: flag = MADV_WILLNEED; break;
+		case VirtualMemoryAdvice::DontNeed: flag = MADV_DONTNEED; break;
+#ifdef MADV_HUGEPAGE
+		case VirtualMemoryAdvice::HugePage: flag = MADV_HUGEPAGE; break;
+		case VirtualMemoryAdvice::NoHugePage: flag = MADV_NOHUGEPAGE; break;
+#endif
+		default:
+			return _false;
+	}
+
+	return ::madvise(pointer, (size_t)RoundUpSize(size, GetPageSize()), flag) == 0;
+}
+
+_void* Platform::AllocLargePages(_qword size, _boolean explicit_pages) {
+	if (size == 0)
+		return _null;
+
+	_qword large_page_size = GetLargePageSize();
+	size = RoundUpSize(size, large_page_size);
+
+	// The explicit huge pages are available only if the system reserved them
+#ifdef MAP_HUGETLB
+	if (explicit_pages) {
+		_void* pointer = ::mmap(_null, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (pointer != MAP_FAILED)
+			return pointer;
+	}
+#endif
+
+	// The transparent huge pages need the range aligned to large page
+	_void* pointer = MapAlignedPages(size, large_page_size, PROT_READ | PROT_WRITE, 0);
+	if (pointer != _null)
+		AdviseVirtualMemory(pointer, size, VirtualMemoryAdvice::HugePage);
+
+	return pointer;
+}
+
+_void Platform::FreeLargePages(_void* pointer, _qword size) {
+	if (pointer != _null && size != 0)
+		::munmap(pointer, (size_t)RoundUpSize(size, GetLargePageSize()));
+}
+
+#pragma endregion
+
+#pragma region "Device"
+
+_boolean Platform::IsKeyDown(_dword key) {
+	// There is no keyboard in headless linux servers
+	return _false;
+}
+
+_boolean Platform::GetCursorPos(_handle window_handle, PointI& pos) {
+	return _false;
+}
+
+_boolean Platform::GetSoundCardName(_charw* name, _dword number) {
+	_chara buffer[256];
+	if (linuxHelper::ReadTextFile("/proc/asound/card0/id", buffer, sizeof(buffer)) == (_dword)-1)
+		return _false;
+
+	// Remove the tail of new line
+	_chara* newline = ::strchr(buffer, '\n');
+	if (newline != _null)
+		*newline = 0;
+
+	return linuxHelper::CopyPath(name, number, buffer);
+}
+
+#pragma endregion
+
+#pragma region "Process/Thread or DLL"
+
+_void Platform::RestartCurrentProcess() {
+	_chara cmdline[4096];
+	_dword size = linuxHelper::ReadTextFile("/proc/self/cmdline", cmdline, sizeof(cmdline));
+	if (size == (_dword)-1 || size == 0)
+		return;
+
+	// The arguments are separated by '\0'
+	_chara* arguments[256];
+	_dword number = 0;
+	for (_dword i = 0; i < size && number < E3D_ARRAY_NUMBER(arguments) - 1; i += (_dword)::strlen(cmdline + i) + 1)
+		arguments[number++] = cmdline + i;
+	arguments[number] = _null;
+
+	::execv("/proc/self/exe", arguments);
+}
+
+_void Platform::KillCurrentProcess() {
+	::kill(::getpid(), SIGKILL);
+}
+
+_handle Platform::CreateNamedPipe(const _charw* name, _dword maxnumber, _dword outbuffersize, _dword inbuffersize, _dword timeout) {
+	// The windows named pipe has no equivalent on linux
+	return _null;
+}
+
+_boolean Platform::ConnectNamedPipe(_handle handle) {
+	return _false;
+}
+
+_void Platform::DisconnectNamedPipe(_handle handle) {
+}
+
+_boolean Platform::WaitNamedPipe(const _charw* name, _dword timeout) {
+	return _false;
+}
+
+_boolean Platform::PeekNamedPipe(_handle handle, _void* buffer, _dword size, _dword* bytesread, _dword* total_bytes_avail, _dword* bytes_left) {
+	return _false;
+}
+
+_boolean Platform::GetModuleFileName(_handle dllmodule, _charw* name, _dword length) {
+	_chara path[PATH_MAX];
+
+	if (dllmodule != _null) {
+		// Locate the shared object by any of its symbols
+		Dl_info info;
+		if (::dladdr(dllmodule, &info) == 0 || info.dli_fname == _null)
+			return _false;
+
+		return linuxHelper::CopyPath(name, length, info.dli_fname);
+	}
+
+	ssize_t size = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (size == -1)
+		return _false;
+
+	path[size] = 0;
+	return linuxHelper::CopyPath(name, length, path);
+}
+
+_handle Platform::GetModuleHandleA(const _chara* modulename) {
+	// Do not load it, only find the loaded module
+	return ::dlopen(modulename, RTLD_LAZY | RTLD_NOLOAD);
+}
+
+_handle Platform::GetModuleHandleW(const _charw* modulename) {
+	if (modulename == _null)
+		return GetModuleHandleA(_null);
+
+	return GetModuleHandleA(linuxPath(modulename));
+}
+
+_boolean Platform::SetProcessAffinityMask(_handle processhandle, _dword mask) {
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	for (_dword i = 0; i < 32; i++) {
+		if (mask & (1u << i))
+			CPU_SET(i, &cpuset);
+	}
+
+	return ::sched_setaffinity(HandleToProcessID(processhandle), sizeof(cpuset), &cpuset) == 0;
+}
+
+_boolean Platform::SetThreadAffinityMask(_handle threadhandle, _dword mask, _dword* prevmask) {
+	linuxThread* thread = HandleToThread(threadhandle);
+
+	cpu_set_t cpuset;
+	if (prevmask != _null) {
+		if (::pthread_getaffinity_np(thread->mThread, sizeof(cpuset), &cpuset) != 0)
+			return _false;
+
+		*prevmask = 0;
+		for (_dword i = 0; i < 32; i++) {
+			if (CPU_ISSET(i, &cpuset))
+				*prevmask |= 1u << i;
+		}
+	}
+
+	CPU_ZERO(&cpuset);
+	for (_dword i = 0; i < 32; i++) {
+		if (mask & (1u << i))
+			CPU_SET(i, &cpuset);
+	}
+
+	return ::pthread_setaffinity_np(thread->mThread, sizeof(cpuset), &cpuset) == 0;
+}
+
+_boolean Platform::GetProcessAffinityMask(_handle processhandle, _dword& mask, _dword* systemmask) {
+	cpu_set_t cpuset;
+	if (::sched_getaffinity(HandleToProcessID(processhandle), sizeof(cpuset), &cpuset) != 0)
+		return _false;
+
+	mask = 0;
+	for (_dword i = 0; i < 32; i++) {
+		if (CPU_ISSET(i, &cpuset))
+			mask |= 1u << i;
+	}
+
+	if (systemmask != _null) {
+		_long number = ::sysconf(_SC_NPROCESSORS_CONF);
+		*systemmask = number >= 32 ? 0xFFFFFFFF : (1u << number) - 1;
+	}
+
+	return _true;
+}
+
+_dword Platform::GetProcessID(_handle processhandle) {
+	return (_dword)HandleToProcessID(processhandle);
+}
+
+_handle Platform::GetProcessHandle(_dword processid) {
+	return (_handle)(_uintptr_t)processid;
+}
+
+_thread_id Platform::GetMainThreadID() {
+	return sMainThreadID;
+}
+
+_boolean Platform::IsMainThread() {
+	return GetCurrentThreadID() == sMainThreadID;
+}
+
+_dword Platform::GetCurrentProcessID() {
+	return (_dword)::getpid();
+}
+
+_thread_id Platform::GetCurrentThreadID() {
+	if (sCurrentThreadID == 0)
+		sCurrentThreadID = (_thread_id)::syscall(SYS_gettid);
+
+	return sCurrentThreadID;
+}
+
+_handle Platform::GetCurrentProcessHandle() {
+	return (_handle)(_uintptr_t)::getpid();
+}
+
+_handle Platform::GetCurrentThreadHandle() {
+	// Adopt the thread what is not created by us, it works like the pseudo handle of windows, so it's owned by the thread
+	// and released at thread exit
+	if (sCurrentThread == _null) {
+		linuxThread* thread = new linuxThread;
+		thread->mType = linuxObjectType::Thread;
+		thread->mThread = ::pthread_self();
+		thread->mThreadID = GetCurrentThreadID();
+		thread->mRefCount = 1;
+		thread->mStarted = 1;
+		thread->mFinished = 0;
+		thread->mSuspended = 0;
+		thread->mAdopted = 1;
+		thread->mRetCode = _null;
+		thread->mFuncPointer = _null;
+		thread->mParameter = _null;
+
+		sCurrentThread = thread;
+		Platform::SetTLSValue(GetAdoptedThreadSlot(), thread);
+	}
+
+	return sCurrentThread;
+}
+
+_boolean Platform::SetThreadName(_thread_id threadid, const _chara* name) {
+	if (name == _null)
+		return _false;
+
+	_chara filename[64];
+	::snprintf(filename, sizeof(filename), "/proc/self/task/%llu/comm", (unsigned long long)threadid);
+
+	_int fd = ::open(filename, O_WRONLY | O_CLOEXEC);
+	if (fd == -1)
+		return _false;
+
+	// The thread name is limited to 16 characters including the terminating '\0'
+	ssize_t size = ::write(fd, name, MIN(::strlen(name), (size_t)15));
+	::close(fd);
+
+	return size != -1;
+}
+
+_boolean Platform::SetThreadName(_thread_id threadid, const _charw* name) {
+	if (name == _null)
+		return _false;
+
+	return SetThreadName(threadid, (const _chara*)linuxPath(name));
+}
+
+_boolean Platform::SuspendThread(_handle thread) {
+	// POSIX threads could not be suspended by others, only the creation suspending is supported
+	return _false;
+}
+
+_boolean Platform::ResumeThread(_handle thread) {
+	linuxThread* thread_object = HandleToThread(thread);
+
+	if (__atomic_exchange_n(&thread_object->mSuspended, 0, __ATOMIC_RELEASE) != 0)
+		linuxFutex::Wake(&thread_object->mSuspended, 1);
+
+	return _true;
+}
+
+_boolean Platform::GetThreadTimes(_handle thread, _qword* creationtime, _qword* exittime, _qword* kerneltime, _qword* usertime) {
+	linuxThread* thread_object = HandleToThread(thread);
+
+	_qword user_ticks = 0, kernel_ticks = 0, start_ticks = 0;
+	if (!ReadThreadStat(thread_object->mThreadID, user_ticks, kernel_ticks, start_ticks))
+		return _false;
+
+	// Convert the clock ticks to 100-nanosecond intervals
+	_qword ticks_per_second = (_qword)::sysconf(_SC_CLK_TCK);
+	if (kerneltime != _null)
+		*kerneltime = kernel_ticks * 10000000ull / ticks_per_second;
+	if (usertime != _null)
+		*usertime = user_ticks * 10000000ull / ticks_per_second;
+	if (exittime != _null)
+		*exittime = 0;
+
+	if (creationtime != _null) {
+		// The start time is since boot, so convert it to file time by the boot time
+		timespec realtime, boottime;
+		::clock_gettime(CLOCK_REALTIME, &realtime);
+		::clock_gettime(CLOCK_BOOTTIME, &boottime);
+
+		_qword boot_filetime = linuxHelper::TimespecToFileTime(realtime) - ((_qword)boottime.tv_sec * 10000000ull + (_qword)boottime.tv_nsec / 100);
+		*creationtime = boot_filetime + start_ticks * 10000000ull / ticks_per_second;
+	}
+
+	return _true;
+}
+
+_dword Platform::GetProcessThreadIDs(_thread_id* threadids, _dword number) {
+	if (threadids == _null)
+		return 0;
+
+	DIR* dir = ::opendir("/proc/self/task");
+	if (dir == _null)
+		return 0;
+
+	_dword thread_number = 0;
+	while (thread_number < number) {
+		dirent* entry = ::readdir(dir);
+		if (entry == _null)
+			break;
+
+		// Skip '.' and '..'
+		_chara* end = _null;
+		_thread_id threadid = (_thread_id)::strtoull(entry->d_name, &end, 10);
+		if (end == entry->d_name || *end != 0)
+			continue;
+
+		threadids[thread_number++] = threadid;
+	}
+
+	::closedir(dir);
+
+	return thread_number;
+}
+
+_boolean Platform::GetThreadSchedulingData(_thread_id threadid, ThreadSchedulingData& data) {
+	_qword user_ticks = 0, kernel_ticks = 0, start_ticks = 0;
+	if (!ReadThreadStat(threadid, user_ticks, kernel_ticks, start_ticks))
+		return _false;
+
+	E3D_INIT(data);
+	data.mThreadID = threadid;
+
+	// Convert the clock ticks to nanoseconds
+	_qword ticks_per_second = (_qword)::sysconf(_SC_CLK_TCK);
+	data.mUserTime = user_ticks * 1000000000ull / ticks_per_second;
+	data.mKernelTime = kernel_ticks * 1000000000ull / ticks_per_second;
+
+	// The optional data is 0 if the kernel does not provide it
+	ReadThreadSchedStat(threadid, data.mRunQueueWaitTime);
+	ReadThreadContextSwitches(threadid, data.mVoluntarySwitchNumber, data.mInvoluntarySwitchNumber);
+
+	_chara filename[64];
+	::snprintf(filename, sizeof(filename), "/proc/self/task/%llu/comm", (unsigned long long)threadid);
+
+	if (linuxHelper::ReadTextFile(filename, data.mName, sizeof(data.mName)) != (_dword)-1) {
+		// Remove the trailing line break
+		_chara* end = ::strchr(data.mName, '\n');
+		if (end != _null)
+			*end = 0;
+	}
+
+	return _true;
+}
+
+_float Platform::GetThreadCPUUsage(_handle thread, _dword timenow, _qword& last_thread_time, _qword& last_sample_time, _qword& last_sample_delta) {
+	_qword kerneltime = 0, usertime = 0;
+	if (!GetThreadTimes(thread, _null, _null, &kerneltime, &usertime))
+		return 0.0f;
+
+	_qword thread_time = kerneltime + usertime;
+
+	// The first sample
+	if (last_sample_time == 0) {
+		last_thread_time = thread_time;
+		last_sample_time = timenow;
+		last_sample_delta = 0;
+		return 0.0f;
+	}
+
+	// The clock tick of '/proc' is 10ms, so keep the last usage in short interval
+	_qword sample_delta = (_qword)(timenow - (_dword)last_sample_time) * 10000ull;
+	if (sample_delta >= 100 * 10000ull) {
+		last_sample_delta = (thread_time - last_thread_time) * 10000ull / sample_delta;
+		last_thread_time = thread_time;
+		last_sample_time = timenow;
+	}
+
+	// The delta is stored in 0.01 percent
+	return MIN((_float)last_sample_delta / 100.0f, 100.0f);
+}
+
+_boolean Platform::QueueUserAPC(_handle thread, OnAPCProc funcpointer, _void* parameter) {
+	// There is no APC on linux
+	return _false;
+}
+
+_handle Platform::CreateThread(OnThreadStartRoutine funcpointer, _dword priority, _void* parameter, _boolean suspend, _thread_id* threadid) {
+	if (funcpointer == _null)
+		return _null;
+
+	// One reference for the handle and one for the running thread
+	linuxThread* thread = new linuxThread;
+	thread->mType = linuxObjectType::Thread;
+	thread->mThreadID = 0;
+	thread->mRefCount = 2;
+	thread->mStarted = 0;
+	thread->mFinished = 0;
+	thread->mSuspended = suspend ? 1 : 0;
+	thread->mAdopted = 0;
+	thread->mRetCode = _null;
+	thread->mFuncPointer = funcpointer;
+	thread->mParameter = parameter;
+
+	// The linux threads keep the default SCHED_OTHER policy, the real-time priority needs privilege
+	pthread_attr_t attr;
+	::pthread_attr_init(&attr);
+	::pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	_int ret = ::pthread_create(&thread->mThread, &attr, OnThreadStart, thread);
+	::pthread_attr_destroy(&attr);
+
+	if (ret != 0) {
+		delete thread;
+		return _null;
+	}
+
+	// Wait for the thread ID
+	while (__atomic_load_n(&thread->mStarted, __ATOMIC_ACQUIRE) == 0)
+		linuxFutex::Wait(&thread->mStarted, 0, _null);
+
+	if (threadid != _null)
+		*threadid = thread->mThreadID;
+
+	return thread;
+}
+
+_void Platform::CloseThread(_handle thread) {
+	linuxThread* thread_object = (linuxThread*)thread;
+	if (thread_object == _null || thread_object->mAdopted)
+		return;
+
+	ReleaseThread(thread_object);
+}
+
+_boolean Platform::GetExitCodeThread(_handle thread, _dword& exit_code) {
+	linuxThread* thread_object = HandleToThread(thread);
+	if (__atomic_load_n(&thread_object->mFinished, __ATOMIC_ACQUIRE) == 0)
+		return _false;
+
+	exit_code = (_dword)(_uintptr_t)thread_object->mRetCode;
+
+	return _true;
+}
+
+_boolean Platform::IsThreadAlive(_handle thread) {
+	linuxThread* thread_object = HandleToThread(thread);
+
+	return __atomic_load_n(&thread_object->mFinished, __ATOMIC_ACQUIRE) == 0;
+}
+
+_void Platform::KillThread(_handle thread) {
+	linuxThread* thread_object = HandleToThread(thread);
+	if (thread_object->mAdopted)
+		return;
+
+	// The cleanup routine will mark it as finished
+	::pthread_cancel(thread_object->mThread);
+}
+
+_boolean Platform::WaitThread(_handle thread, _dword* ret_code) {
+	linuxThread* thread_object = HandleToThread(thread);
+	if (thread_object->mAdopted)
+		return _false;
+
+	WaitWhileEqual(&thread_object->mFinished, 0, (_qword)-1);
+
+	if (ret_code != _null)
+		*ret_code = (_dword)(_uintptr_t)thread_object->mRetCode;
+
+	return _true;
+}
+
+_handle Platform::LoadLibrary(const _chara* filename) {
+	return ::dlopen(filename, RTLD_NOW | RTLD_LOCAL);
+}
+
+_handle Platform::LoadLibrary(const _charw* filename) {
+	return LoadLibrary((const _chara*)linuxPath(filename));
+}
+
+_boolean Platform::FreeLibrary(_handle module) {
+	if (module == _null)
+		return _false;
+
+	return ::dlclose(module) == 0;
+}
+
+_void* Platform::GetProcAddress(_handle module, const _chara* procname) {
+	return ::dlsym(module != _null ? module : RTLD_DEFAULT, procname);
+}
+
+_void Platform::ExitProcess(_dword exitcode) {
+	::exit((_int)exitcode);
+}
+
+_boolean Platform::TerminateProcess(_handle processhandle, _dword exitcode) {
+	return ::kill(HandleToProcessID(processhandle), SIGKILL) == 0;
+}
+
+_boolean Platform::DebugActiveProcessStop(_dword process_id) {
+	return _false;
+}
+
+_boolean Platform::IsProcessAlive(_handle processhandle) {
+	pid_t pid = HandleToProcessID(processhandle);
+
+	// Reap it if it's our zombie child
+	_int status = 0;
+	if (::waitpid(pid, &status, WNOHANG) == pid)
+		return _false;
+
+	return ::kill(pid, 0) == 0 || errno == EPERM;
+}
+
+_boolean Platform::CreateProcess(const _chara* modulename, const _chara* cmdline, _dword creationflags, const _chara* workdir, _handle* processhandle, _handle* threadhandle) {
+	if (modulename == _null)
+		return _false;
+
+	// Split the arguments before forking, the command line is never passed to the shell
+	_dword length = cmdline != _null ? StringLength(cmdline) : 0;
+	_dword max_number = length / 2 + 2;
+
+	_chara* arguments = (_chara*)HeapAlloc(length + 1);
+	_chara** argv = (_chara**)HeapAlloc((max_number + 1) * sizeof(_chara*));
+	if (arguments == _null || argv == _null) {
+		HeapFree(arguments);
+		HeapFree(argv);
+		return _false;
+	}
+
+	E3D_MEM_CPY(arguments, cmdline != _null ? cmdline : "", length + 1);
+
+	argv[0] = (_chara*)modulename;
+	argv[1 + SplitCommandLine(arguments, argv + 1, max_number - 1)] = _null;
+
+	pid_t pid = ::fork();
+	if (pid == 0) {
+		if (workdir != _null && workdir[0] != 0 && ::chdir(workdir) != 0)
+			::_exit(EXIT_FAILURE);
+
+		::execvp(modulename, argv);
+		::_exit(EXIT_FAILURE);
+	}
+
+	HeapFree(arguments);
+	HeapFree(argv);
+
+	if (pid == -1)
+		return _false;
+
+	if (processhandle != _null)
+		*processhandle = GetProcessHandle((_dword)pid);
+	if (threadhandle != _null)
+		*threadhandle = _null;
+
+	return _true;
+}
+
+_boolean Platform::CreateProcess(const _charw* modulename, const _charw* cmdline, _dword creationflags, const _charw* workdir, _handle* processhandle, _handle* threadhandle) {
+	if (modulename == _null)
+		return _false;
+
+	linuxPath modulename_utf8(modulename);
+	linuxPath cmdline_utf8(cmdline);
+	linuxPath workdir_utf8(workdir);
+
+	return CreateProcess(modulename_utf8, cmdline_utf8, creationflags, workdir != _null ? (const _chara*)workdir_utf8 : _null, processhandle, threadhandle);
+}
+
+_boolean Platform::ReadProcessMemory(_handle processhandle, const _void* baseaddress, _void* buffer, _dword size, _dword* bytesread) {
+	iovec local_iov = {buffer, size};
+	iovec remote_iov = {(_void*)baseaddress, size};
+
+	ssize_t bytes = ::process_vm_readv(HandleToProcessID(processhandle), &local_iov, 1, &remote_iov, 1, 0);
+	if (bytes == -1)
+		return _false;
+
+	if (bytesread != _null)
+		*bytesread = (_dword)bytes;
+
+	return _true;
+}
+
+_boolean Platform::HasProcess(const _charw* name) {
+	if (name == _null)
+		return _false;
+
+	linuxPath process_name(name);
+
+	DIR* dir = ::opendir("/proc");
+	if (dir == _null)
+		return _false;
+
+	_boolean found = _false;
+	while (dirent* entry = ::readdir(dir)) {
+		if (entry->d_name[0] < '0' || entry->d_name[0] > '9')
+			continue;
+
+		_chara filename[64];
+		::snprintf(filename, sizeof(filename), "/proc/%s/comm", entry->d_name);
+
+		_chara comm[256];
+		if (linuxHelper::ReadTextFile(filename, comm, sizeof(comm)) == (_dword)-1)
+			continue;
+
+		_chara* newline = ::strchr(comm, '\n');
+		if (newline != _null)
+			*newline = 0;
+
+		if (::strcmp(comm, process_name) == 0) {
+			found = _true;
+			break;
+		}
+	}
+
+	::closedir(dir);
+
+	return found;
+}
+
+#pragma endregion
+
+#pragma region "Language"
+
+_boolean Platform::IsVowelInThai(_charw code) {
+	return (code >= 0x0E30 && code <= 0x0E3A) || (code >= 0x0E40 && code <= 0x0E45) || code == 0x0E47;
+}
+
+_boolean Platform::IsUpperVowelInThai(_charw code) {
+	return code == 0x0E31 || (code >= 0x0E34 && code <= 0x0E37) || code == 0x0E47 || code == 0x0E4D;
+}
+
+_boolean Platform::IsDownVowelInThai(_charw code) {
+	return code >= 0x0E38 && code <= 0x0E3A;
+}
+
+_boolean Platform::IsToneInThai(_charw code) {
+	return code >= 0x0E48 && code <= 0x0E4B;
+}
+
+#pragma endregion
+
+#pragma region "Converter"
+
+// The negative number is signed only in decimal, the other radixes take it as unsigned as the win32 CRT does
+
+_chara* Platform::ConvertLongToString(_int value, _dword radix, _chara* string, _dword length) {
+	_boolean negative = radix == 10 && value < 0;
+	return linuxString<_chara>::ConvertInteger(negative ? 0 - (_qword)(_large)value : (_dword)value, negative, radix, string, length);
+}
+
+_chara* Platform::ConvertDwordToString(_dword value, _dword radix, _chara* string, _dword length) {
+	return linuxString<_chara>::ConvertInteger(value, _false, radix, string, length);
+}
+
+_chara* Platform::ConvertLargeToString(_large value, _dword radix, _chara* string, _dword length) {
+	_boolean negative = radix == 10 && value < 0;
+	return linuxString<_chara>::ConvertInteger(negative ? 0 - (_qword)value : (_qword)value, negative, radix, string, length);
+}
+
+_chara* Platform::ConvertQwordToString(_qword value, _dword radix, _chara* string, _dword length) {
+	return linuxString<_chara>::ConvertInteger(value, _false, radix, string, length);
+}
+
+_chara* Platform::ConvertFloatToString(_float value, _chara* string, _dword length, _dword precision) {
+	return linuxString<_chara>::ConvertDouble(value, string, length, precision);
+}
+
+_chara* Platform::ConvertDoubleToString(_double value, _chara* string, _dword length, _dword precision) {
+	return linuxString<_chara>::ConvertDouble(value, string, length, precision);
+}
+
+_charw* Platform::ConvertLongToString(_int value, _dword radix, _charw* string, _dword length) {
+	_boolean negative = radix == 10 && value < 0;
+	return linuxString<_charw>::ConvertInteger(negative ? 0 - (_qword)(_large)value : (_dword)value, negative, radix, string, length);
+}
+
+_charw* Platform::ConvertDwordToString(_dword value, _dword radix, _charw* string, _dword length) {
+	return linuxString<_charw>::ConvertInteger(value, _false, radix, string, length);
+}
+
+_charw* Platform::ConvertLargeToString(_large value, _dword radix, _charw* string, _dword length) {
+	_boolean negative = radix == 10 && value < 0;
+	return linuxString<_charw>::ConvertInteger(negative ? 0 - (_qword)value : (_qword)value, negative, radix, string, length);
+}
+
+_charw* Platform::ConvertQwordToString(_qword value, _dword radix, _charw* string, _dword length) {
+	return linuxString<_charw>::ConvertInteger(value, _false, radix, string, length);
+}
+
+_charw* Platform::ConvertFloatToString(_float value, _charw* string, _dword length, _dword precision) {
+	return linuxString<_charw>::ConvertDouble(value, string, length, precision);
+}
+
+_charw* Platform::ConvertDoubleToString(_double value, _charw* string, _dword length, _dword precision) {
+	return linuxString<_charw>::ConvertDouble(value, string, length, precision);
+}
+
+_boolean Platform::ConvertStringToBool(const _chara* string) {
+	return linuxString<_chara>::ConvertToBool(string);
+}
+
+_int Platform::ConvertStringToLong(const _chara* string, _dword radix) {
+	return (_int)linuxString<_chara>::ConvertToLarge(string, radix);
+}
+
+_dword Platform::ConvertStringToDword(const _chara* string, _dword radix) {
+	return (_dword)linuxString<_chara>::ConvertToQword(string, radix);
+}
+
+_large Platform::ConvertStringToLarge(const _chara* string, _dword radix) {
+	return linuxString<_chara>::ConvertToLarge(string, radix);
+}
+
+_qword Platform::ConvertStringToQword(const _chara* string, _dword radix) {
+	return linuxString<_chara>::ConvertToQword(string, radix);
+}
+
+_float Platform::ConvertStringToFloat(const _chara* string) {
+	return (_float)linuxString<_chara>::ConvertToDouble(string);
+}
+
+_double Platform::ConvertStringToDouble(const _chara* string) {
+	return linuxString<_chara>::ConvertToDouble(string);
+}
+
+_boolean Platform::ConvertStringToBool(const _charw* string) {
+	return linuxString<_charw>::ConvertToBool(string);
+}
+
+_int Platform::ConvertStringToLong(const _charw* string, _dword radix) {
+	return (_int)linuxString<_charw>::ConvertToLarge(string, radix);
+}
+
+_dword Platform::ConvertStringToDword(const _charw* string, _dword radix) {
+	return (_dword)linuxString<_charw>::ConvertToQword(string, radix);
+}
+
+_large Platform::ConvertStringToLarge(const _charw* string, _dword radix) {
+	return linuxString<_charw>::ConvertToLarge(string, radix);
+}
+
+_qword Platform::ConvertStringToQword(const _charw* string, _dword radix) {
+	return linuxString<_charw>::ConvertToQword(string, radix);
+}
+
+_float Platform::ConvertStringToFloat(const _charw* string) {
+	return (_float)linuxString<_charw>::ConvertToDouble(string);
+}
+
+_double Platform::ConvertStringToDouble(const _charw* string) {
+	return linuxString<_charw>::ConvertToDouble(string);
+}
+
+#pragma endregion
+
+#pragma region "String"
+
+_dword Platform::StringLength(const _chara* string) {
+	if (string == _null)
+		return 0;
+
+	return (_dword)::strlen(string);
+}
+
+_dword Platform::StringLength(const _charw* string) {
+	if (string == _null)
+		return 0;
+
+	// The wchar_t is 16-bits by -fshort-wchar, so the wcslen() of libc could not be used
+	_dword length = 0;
+	while (string[length] != 0)
+		length++;
+
+	return length;
+}
+
+_boolean Platform::IsBlank(const _chara* string) {
+	return linuxString<_chara>::IsBlank(string);
+}
+
+_boolean Platform::IsBlank(const _charw* string) {
+	return linuxString<_charw>::IsBlank(string);
+}
+
+_boolean Platform::IsFullpath(const _chara* path) {
+	return linuxString<_chara>::IsFullpath(path);
+}
+
+_boolean Platform::IsFullpath(const _charw* path) {
+	return linuxString<_charw>::IsFullpath(path);
+}
+
+_chara* Platform::TrimStringLeft(_chara* string, _dword& stringlength, _chara character, _boolean ignorecase) {
+	return linuxString<_chara>::TrimLeft(string, stringlength, &character, 1, ignorecase);
+}
+
+_charw* Platform::TrimStringLeft(_charw* string, _dword& stringlength, _charw character, _boolean ignorecase) {
+	return linuxString<_charw>::TrimLeft(string, stringlength, &character, 1, ignorecase);
+}
+
+_chara* Platform::TrimStringRight(_chara* string, _dword& stringlength, _chara character, _boolean ignorecase) {
+	return linuxString<_chara>::TrimRight(string, stringlength, &character, 1, ignorecase);
+}
+
+_charw* Platform::TrimStringRight(_charw* string, _dword& stringlength, _charw character, _boolean ignorecase) {
+	return linuxString<_charw>::TrimRight(string, stringlength, &character, 1, ignorecase);
+}
+
+_chara* Platform::TrimStringBoth(_chara* string, _dword& stringlength, _chara character, _boolean ignorecase) {
+	return linuxString<_chara>::TrimBoth(string, stringlength, &character, 1, ignorecase);
+}
+
+_charw* Platform::TrimStringBoth(_charw* string, _dword& stringlength, _charw character, _boolean ignorecase) {
+	return linuxString<_charw>::TrimBoth(string, stringlength, &character, 1, ignorecase);
+}
+
+_chara* Platform::TrimStringLeft(_chara* string, _dword& stringlength, const _chara* charset, _boolean ignorecase) {
+	return linuxString<_chara>::TrimLeft(string, stringlength, charset, StringLength(charset), ignorecase);
+}
+
+_charw* Platform::TrimStringLeft(_charw* string, _dword& stringlength, const _charw* charset, _boolean ignorecase) {
+	return linuxString<_charw>::TrimLeft(string, stringlength, charset, StringLength(charset), ignorecase);
+}
+
+_chara* Platform::TrimStringRight(_chara* string, _dword& stringlength, const _chara* charset, _boolean ignorecase) {
+	return linuxString<_chara>::TrimRight(string, stringlength, charset, StringLength(charset), ignorecase);
+}
+
+_charw* Platform::TrimStringRight(_charw* string, _dword& stringlength, const _charw* charset, _boolean ignorecase) {
+	return linuxString<_charw>::TrimRight(string, stringlength, charset, StringLength(charset), ignorecase);
+}
+
+_chara* Platform::TrimStringBoth(_chara* string, _dword& stringlength, const _chara* charset, _boolean ignorecase) {
+	return linuxString<_chara>::TrimBoth(string, stringlength, charset, StringLength(charset), ignorecase);
+}
+
+_charw* Platform::TrimStringBoth(_charw* string, _dword& stringlength, const _charw* charset, _boolean ignorecase) {
+	return linuxString<_charw>::TrimBoth(string, stringlength, charset, StringLength(charset), ignorecase);
+}
+
+_dword Platform::SearchL2R(const _chara* string, _chara character, _boolean ignorecase) {
+	return linuxString<_chara>::SearchL2R(string, character, ignorecase);
+}
+
+_dword Platform::SearchL2R(const _charw* string, _charw character, _boolean ignorecase) {
+	return linuxString<_charw>::SearchL2R(string, character, ignorecase);
+}
+
+_dword Platform::SearchR2L(const _chara* string, _chara character, _boolean ignorecase) {
+	return linuxString<_chara>::SearchR2L(string, character, ignorecase);
+}
+
+_dword Platform::SearchR2L(const _charw* string, _charw character, _boolean ignorecase) {
+	return linuxString<_charw>::SearchR2L(string, character, ignorecase);
+}
+
+_dword Platform::SearchL2R(const _chara* string, const _chara* substring, _boolean ignorecase, _dword* endindex) {
+	return linuxString<_chara>::SearchL2R(string, substring, ignorecase, endindex);
+}
+
+_dword Platform::SearchL2R(const _charw* string, const _charw* substring, _boolean ignorecase, _dword* endindex) {
+	return linuxString<_charw>::SearchL2R(string, substring, ignorecase, endindex);
+}
+
+_dword Platform::SearchR2L(const _chara* string, const _chara* substring, _boolean ignorecase, _dword* startindex) {
+	return linuxString<_chara>::SearchR2L(string, substring, ignorecase, startindex);
+}
+
+_dword Platform::SearchR2L(const _charw* string, const _charw* substring, _boolean ignorecase, _dword* startindex) {
+	return linuxString<_charw>::SearchR2L(string, substring, ignorecase, startindex);
+}
+
+_chara* Platform::CopyString(_chara* desbuffer, const _chara* srcbuffer, _dword number) {
+	return linuxString<_chara>::Copy(desbuffer, srcbuffer, number);
+}
+
+_charw* Platform::CopyString(_charw* desbuffer, const _charw* srcbuffer, _dword number) {
+	return linuxString<_charw>::Copy(desbuffer, srcbuffer, number);
+}
+
+_chara* Platform::AppendString(_chara* desbuffer, const _chara* srcbuffer) {
+	if (desbuffer == _null)
+		return _null;
+
+	linuxString<_chara>::Copy(desbuffer + StringLength(desbuffer), srcbuffer, -1);
+
+	return desbuffer;
+}
+
+_charw* Platform::AppendString(_charw* desbuffer, const _charw* srcbuffer) {
+	if (desbuffer == _null)
+		return _null;
+
+	linuxString<_charw>::Copy(desbuffer + StringLength(desbuffer), srcbuffer, -1);
+
+	return desbuffer;
+}
+
+_int Platform::CompareString(const _chara* string1, const _chara* string2, _boolean ignorecase) {
+	return linuxString<_chara>::Compare(string1, string2, ignorecase);
+}
+
+_int Platform::CompareString(const _charw* string1, const _charw* string2, _boolean ignorecase) {
+	return linuxString<_charw>::Compare(string1, string2, ignorecase);
+}
+
+_int Platform::CompareCase(_chara c1, _chara c2, _boolean ignorecase) {
+	_dword code1 = linuxString<_chara>::GetCompareCode(c1, ignorecase);
+	_dword code2 = linuxString<_chara>::GetCompareCode(c2, ignorecase);
+
+	return code1 == code2 ? 0 : (code1 < code2 ? -1 : 1);
+}
+
+_int Platform::CompareCase(_charw c1, _charw c2, _boolean ignorecase) {
+	_dword code1 = linuxString<_charw>::GetCompareCode(c1, ignorecase);
+	_dword code2 = linuxString<_charw>::GetCompareCode(c2, ignorecase);
+
+	return code1 == code2 ? 0 : (code1 < code2 ? -1 : 1);
+}
+
+_boolean Platform::CompareWildcard(const _chara* string, const _chara* matchstring, _boolean ignorecase) {
+	return linuxString<_chara>::CompareWildcard(string, matchstring, ignorecase);
+}
+
+_boolean Platform::CompareWildcard(const _charw* string, const _charw* matchstring, _boolean ignorecase) {
+	return linuxString<_charw>::CompareWildcard(string, matchstring, ignorecase);
+}
+
+_chara* Platform::LowercaseString(_chara* string, _dword number) {
+	return linuxString<_chara>::Lowercase(string, number);
+}
+
+_chara* Platform::UppercaseString(_chara* string, _dword number) {
+	return linuxString<_chara>::Uppercase(string, number);
+}
+
+_charw* Platform::LowercaseString(_charw* string, _dword number) {
+	return linuxString<_charw>::Lowercase(string, number);
+}
+
+_charw* Platform::UppercaseString(_charw* string, _dword number) {
+	return linuxString<_charw>::Uppercase(string, number);
+}
+
+_boolean Platform::IsUtf8String(const _chara* buffer, _dword size) {
+	if (buffer == _null)
+		return _false;
+
+	if (size == (_dword)-1)
+		size = StringLength(buffer);
+
+	const _byte* source = (const _byte*)buffer;
+	for (_dword i = 0; i < size;) {
+		_dword code = 0;
+		i += DecodeUtf8(source + i, size - i, code);
+		if (code == (_dword)-1)
+			return _false;
+	}
+
+	return _true;
+}
+
+// The ANSI code page of linux is UTF-8
+
+_dword Platform::AnsiToUtf16(_charw* buffer, _dword size, const _chara* string, _dword number) {
+	return Utf8ToUtf16(buffer, size, string, number);
+}
+
+_dword Platform::Utf16ToAnsi(_chara* buffer, _dword size, const _charw* string, _dword number) {
+	return Utf16ToUtf8(buffer, size, string, number);
+}
+
+_dword Platform::Utf8ToUtf16(_charw* buffer, _dword size, const _chara* string, _dword number) {
+	if (buffer == _null || size == 0)
+		return 0;
+
+	buffer[0] = 0;
+
+	if (string == _null)
+		return 0;
+
+	if (number == (_dword)-1)
+		number = StringLength(string);
+
+	const _byte* source = (const _byte*)string;
+	_dword length = 0;
+	for (_dword i = 0; i < number;) {
+		// The invalid sequence is replaced with U+FFFD
+		_dword code = 0;
+		i += DecodeUtf8(source + i, number - i, code);
+		if (code == (_dword)-1)
+			code = 0xFFFD;
+
+		// Keep the last one for '\0' and do not split the surrogate pair
+		_dword units = code >= 0x10000 ? 2 : 1;
+		if (length + units >= size) {
+			buffer[length] = 0;
+			return size;
+		}
+
+		if (units == 2) {
+			code -= 0x10000;
+			buffer[length++] = (_charw)(0xD800 + (code >> 10));
+			buffer[length++] = (_charw)(0xDC00 + (code & 0x3FF));
+		} else {
+			buffer[length++] = (_charw)code;
+		}
+	}
+
+	buffer[length] = 0;
+
+	return length;
+}
+
+_dword Platform::Utf16ToUtf8(_chara* buffer, _dword size, const _charw* string, _dword number) {
+	if (buffer == _null || size == 0)
+		return 0;
+
+	buffer[0] = 0;
+
+	if (string == _null)
+		return 0;
+
+	if (number == (_dword)-1)
+		number = StringLength(string);
+
+	_byte* target = (_byte*)buffer;
+	_dword length = 0;
+	for (_dword i = 0; i < number; i++) {
+		_dword code = (_word)string[i];
+
+		// Combine the surrogate pair, the unpaired surrogate is replaced with U+FFFD
+		if (code >= 0xD800 && code <= 0xDBFF && i + 1 < number && (_word)string[i + 1] >= 0xDC00 && (_word)string[i + 1] <= 0xDFFF)
+			code = 0x10000 + ((code - 0xD800) << 10) + ((_word)string[++i] - 0xDC00);
+		else if (code >= 0xD800 && code <= 0xDFFF)
+			code = 0xFFFD;
+
+		// Keep the last one for '\0' and do not split the sequence
+		_dword bytes = code < 0x80 ? 1 : (code < 0x800 ? 2 : (code < 0x10000 ? 3 : 4));
+		if (length + bytes >= size) {
+			buffer[length] = 0;
+			return size;
+		}
+
+		switch (bytes) {
+			case 1:
+				target[length++] = (_byte)code;
+				break;
+
+			case 2:
+				target[length++] = (_byte)(0xC0 | (code >> 6));
+				target[length++] = (_byte)(0x80 | (code & 0x3F));
+				break;
+
+			case 3:
+				target[length++] = (_byte)(0xE0 | (code >> 12));
+				target[length++] = (_byte)(0x80 | ((code >> 6) & 0x3F));
+				target[length++] = (_byte)(0x80 | (code & 0x3F));
+				break;
+
+			default:
+				target[length++] = (_byte)(0xF0 | (code >> 18));
+				target[length++] = (_byte)(0x80 | ((code >> 12) & 0x3F));
+				target[length++] = (_byte)(0x80 | ((code >> 6) & 0x3F));
+				target[length++] = (_byte)(0x80 | (code & 0x3F));
+				break;
+		}
+	}
+
+	buffer[length] = 0;
+
+	return length;
+}
+
+_chara* Platform::FormatStringByArguments(_chara* buffer, _dword size, const _chara* format, ...) {
+	BEGIN_VA_LIST(args, format);
+	FormatString(buffer, size, format, args);
+	END_VA_LIST(args);
+
+	return buffer;
+}
+
+_charw* Platform::FormatStringByArguments(_charw* buffer, _dword size, const _charw* format, ...) {
+	BEGIN_VA_LIST(args, format);
+	FormatString(buffer, size, format, args);
+	END_VA_LIST(args);
+
+	return buffer;
+}
+
+_chara* Platform::FormatStringByVAList(_chara* buffer, _dword size, const _chara* format, _va_list arguments) {
+	FormatString(buffer, size, format, arguments);
+
+	return buffer;
+}
+
+_charw* Platform::FormatStringByVAList(_charw* buffer, _dword size, const _charw* format, _va_list arguments) {
+	FormatString(buffer, size, format, arguments);
+
+	return buffer;
+}
+
+_dword Platform::GetFormatStringLength(const _chara* format, _va_list arguments) {
+	return FormatString((_chara*)_null, 0, format, arguments);
+}
+
+_dword Platform::GetFormatStringLength(const _charw* format, _va_list arguments) {
+	return FormatString((_charw*)_null, 0, format, arguments);
+}
+
+#pragma endregion
+
+#pragma region "Time"
+
+_dword Platform::GetCurrentTickCount() {
+	return (_dword)(linuxHelper::GetMonotonicNanoseconds() / 1000000ull);
+}
+
+_qword Platform::GetCurrentCycleCount() {
+	return linuxHelper::GetMonotonicNanoseconds();
+}
+
+_qword Platform::GetSystemCycleFrequency() {
+	// The cycle count is the monotonic clock in nanoseconds
+	return 1000000000ull;
+}
+
+_float Platform::GetElapseTime(_qword cyclecount1, _qword cyclecount2) {
+	return GetElapseTime(cyclecount1, cyclecount2, GetSystemCycleFrequency());
+}
+
+_float Platform::GetElapseTime(_qword cyclecount1, _qword cyclecount2, _qword cyclefrequency) {
+	if (cyclefrequency == 0)
+		return 0.0f;
+
+	return (_float)(E3D_RATIO_D(cyclecount2 - cyclecount1, cyclefrequency) * 1000.0);
+}
+
+static _void TmToCalendarTime(const tm& time, _dword milliseconds, CalendarTime& calendar_time) {
+	calendar_time.mYear = (_word)(time.tm_year + 1900);
+	calendar_time.mMonth = (_word)(time.tm_mon + 1);
+	calendar_time.mDayOfWeek = (_word)time.tm_wday;
+	calendar_time.mDay = (_word)time.tm_mday;
+	calendar_time.mHour = (_word)time.tm_hour;
+	calendar_time.mMinute = (_word)time.tm_min;
+	calendar_time.mSecond = (_word)time.tm_sec;
+	calendar_time.mMilliseconds = (_word)milliseconds;
+}
+
+static _void CalendarTimeToTm(const CalendarTime& calendar_time, tm& time) {
+	E3D_INIT(time);
+	time.tm_year = calendar_time.mYear - 1900;
+	time.tm_mon = calendar_time.mMonth - 1;
+	time.tm_wday = calendar_time.mDayOfWeek;
+	time.tm_mday = calendar_time.mDay;
+	time.tm_hour = calendar_time.mHour;
+	time.tm_min = calendar_time.mMinute;
+	time.tm_sec = calendar_time.mSecond;
+	time.tm_isdst = -1;
+}
+
+_boolean Platform::GetLocalTime(CalendarTime& time) {
+	timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	tm local_time;
+	if (::localtime_r(&now.tv_sec, &local_time) == _null)
+		return _false;
+
+	TmToCalendarTime(local_time, (_dword)(now.tv_nsec / 1000000L), time);
+
+	return _true;
+}
+
+_boolean Platform::GetLocalTime(_time_t time, CalendarTime& calendar_time) {
+	tm local_time;
+	if (::localtime_r(&time, &local_time) == _null)
+		return _false;
+
+	TmToCalendarTime(local_time, 0, calendar_time);
+
+	return _true;
+}
+
+_time_t Platform::GetLocalTime() {
+	_time_t now = ::time(_null);
+
+	tm local_time;
+	if (::localtime_r(&now, &local_time) == _null)
+		return now;
+
+	return now + local_time.tm_gmtoff;
+}
+
+_boolean Platform::GetSystemTime(CalendarTime& time) {
+	timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	tm system_time;
+	if (::gmtime_r(&now.tv_sec, &system_time) == _null)
+		return _false;
+
+	TmToCalendarTime(system_time, (_dword)(now.tv_nsec / 1000000L), time);
+
+	return _true;
+}
+
+_boolean Platform::GetSystemTime(_time_t time, CalendarTime& calendar_time) {
+	tm system_time;
+	if (::gmtime_r(&time, &system_time) == _null)
+		return _false;
+
+	TmToCalendarTime(system_time, 0, calendar_time);
+
+	return _true;
+}
+
+_time_t Platform::GetSystemTime() {
+	return ::time(_null);
+}
+
+_time_t Platform::MakeTime(const CalendarTime& calendar_time) {
+	tm time;
+	CalendarTimeToTm(calendar_time, time);
+
+	return ::mktime(&time);
+}
+
+_time_t Platform::MakeTimeM(const CalendarTime& calendar_time) {
+	return MakeTime(calendar_time) * 1000 + calendar_time.mMilliseconds;
+}
+
+_boolean Platform::SystemTimeToFileTime(FileTime& filetime, const CalendarTime& systemtime) {
+	tm time;
+	CalendarTimeToTm(systemtime, time);
+
+	timespec spec;
+	spec.tv_sec = ::timegm(&time);
+	spec.tv_nsec = (long)systemtime.mMilliseconds * 1000000L;
+	if (spec.tv_sec == (time_t)-1)
+		return _false;
+
+	_qword value = linuxHelper::TimespecToFileTime(spec);
+	filetime.mLowDateTime = E3D_LODWORD(value);
+	filetime.mHighDateTime = E3D_HIDWORD(value);
+
+	return _true;
+}
+
+_boolean Platform::FileTimeToSystemTime(CalendarTime& systemtime, const FileTime& filetime) {
+	timespec spec = linuxHelper::FileTimeToTimespec(E3D_MAKEQWORD(filetime.mLowDateTime, filetime.mHighDateTime));
+
+	tm time;
+	if (::gmtime_r(&spec.tv_sec, &time) == _null)
+		return _false;
+
+	TmToCalendarTime(time, (_dword)(spec.tv_nsec / 1000000L), systemtime);
+
+	return _true;
+}
+
+_boolean Platform::FileTimeToLocalFileTime(FileTime& localfiletime, const FileTime& filetime) {
+	_qword value = E3D_MAKEQWORD(filetime.mLowDateTime, filetime.mHighDateTime);
+	timespec spec = linuxHelper::FileTimeToTimespec(value);
+
+	tm local_time;
+	if (::localtime_r(&spec.tv_sec, &local_time) == _null)
+		return _false;
+
+	value += (_large)local_time.tm_gmtoff * 10000000ll;
+	localfiletime.mLowDateTime = E3D_LODWORD(value);
+	localfiletime.mHighDateTime = E3D_HIDWORD(value);
+
+	return _true;
+}
+
+_boolean Platform::LocalFileTimeToFileTime(FileTime& filetime, const FileTime& localfiletime) {
+	_qword value = E3D_MAKEQWORD(localfiletime.mLowDateTime, localfiletime.mHighDateTime);
+	timespec spec = linuxHelper::FileTimeToTimespec(value);
+
+	tm local_time;
+	if (::localtime_r(&spec.tv_sec, &local_time) == _null)
+		return _false;
+
+	value -= (_large)local_time.tm_gmtoff * 10000000ll;
+	filetime.mLowDateTime = E3D_LODWORD(value);
+	filetime.mHighDateTime = E3D_HIDWORD(value);
+
+	return _true;
+}
+
+#pragma endregion
+
+#pragma region "Debugging"
+
+_void Platform::AssertReport(const _charw* error, const _charw* filename, _dword linenumber) {
+	::fprintf(stderr, "%s(%u): %s\n", (const _chara*)linuxPath(filename), linenumber, (const _chara*)linuxPath(error));
+
+	if (IsDebuggerPresent())
+		DebuggerBreak();
+}
+
+_void Platform::OutputDebugString(const _chara* string) {
+	if (string != _null)
+		::fputs(string, stderr);
+}
+
+_void Platform::OutputDebugStringInLine(const _chara* string) {
+	OutputDebugString(string);
+	::fputc('\n', stderr);
+}
+
+_void Platform::OutputDebugString(const _charw* string) {
+	if (string != _null)
+		OutputDebugString((const _chara*)linuxPath(string));
+}
+
+_void Platform::OutputDebugStringInLine(const _charw* string) {
+	OutputDebugString(string);
+	::fputc('\n', stderr);
+}
+
+_boolean Platform::IsDebuggerPresent() {
+	_chara buffer[2048];
+	if (linuxHelper::ReadTextFile("/proc/self/status", buffer, sizeof(buffer)) == (_dword)-1)
+		return _false;
+
+	const _chara* tracer = ::strstr(buffer, "TracerPid:");
+	if (tracer == _null)
+		return _false;
+
+	return ::atoi(tracer + sizeof("TracerPid:") - 1) != 0;
+}
+
+_void Platform::DebuggerBreak() {
+	::raise(SIGTRAP);
+}
+
+_void Platform::WaitForAttach(_dword time) {
+	_dword tickcount = GetCurrentTickCount();
+
+	while (!IsDebuggerPresent() && GetCurrentTickCount() - tickcount < time)
+		Sleep(100);
+}
+
+_dword Platform::CaptureCallStack(_void** frames, _dword number, _dword skip) {
+	if (frames == _null || number == 0)
+		return 0;
+
+	// Skip this function as well
+	_void* buffer[128];
+	_int frame_number = ::backtrace(buffer, (_int)MIN(number + skip + 1, (_dword)E3D_ARRAY_NUMBER(buffer)));
+	if (frame_number <= (_int)(skip + 1))
+		return 0;
+
+	_dword captured_number = MIN((_dword)frame_number - skip - 1, number);
+	E3D_MEM_CPY(frames, buffer + skip + 1, captured_number * sizeof(_void*));
+
+	return captured_number;
+}
+
+_boolean Platform::GetSymbolName(const _void* address, _chara* name, _dword length) {
+	if (name == _null || length == 0)
+		return _false;
+
+	Dl_info info;
+	if (::dladdr(address, &info) == 0 || info.dli_fname == _null)
+		return _false;
+
+	// Only the file name of module
+	const _chara* module_name = ::strrchr(info.dli_fname, '/');
+	module_name = module_name != _null ? module_name + 1 : info.dli_fname;
+
+	if (info.dli_sname != _null)
+		::snprintf(name, length, "%s!%s+0x%zx", module_name, info.dli_sname, (size_t)((const _byte*)address - (const _byte*)info.dli_saddr));
+	else
+		::snprintf(name, length, "%s+0x%zx", module_name, (size_t)((const _byte*)address - (const _byte*)info.dli_fbase));
+
+	return _true;
+}
+
+_boolean Platform::SetMemoryFaultHandler(OnMemoryFaultProc func) {
+	sMemoryFaultFunc = func;
+
+	if (func == _null || sMemoryFaultHandlerInstalled)
+		return _true;
+
+	// The handler runs on the alternate stack if the thread has one, so the stack overflow could be handled as well
+	struct sigaction action;
+	E3D_INIT(action);
+	action.sa_sigaction = OnMemoryFaultSignal;
+	action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+	::sigemptyset(&action.sa_mask);
+
+	if (::sigaction(SIGSEGV, &action, &sPreviousSegvAction) != 0)
+		return _false;
+
+	if (::sigaction(SIGBUS, &action, &sPreviousBusAction) != 0) {
+		::sigaction(SIGSEGV, &sPreviousSegvAction, _null);
+		return _false;
+	}
+
+	sMemoryFaultHandlerInstalled = _true;
+	return _true;
+}
+
+#pragma endregion
+
+#pragma region "Environment"
+
+_boolean Platform::GetSystemPath(_charw* path, _dword length) {
+	return linuxHelper::CopyPath(path, length, "/usr/lib");
+}
+
+_boolean Platform::GetSystemFontPath(_charw* path, _dword length) {
+	return linuxHelper::CopyPath(path, length, "/usr/share/fonts");
+}
+
+_boolean Platform::GetSystemTempPath(_charw* path, _dword length) {
+	const _chara* temp_path = ::getenv("TMPDIR");
+	if (temp_path == _null || temp_path[0] == 0)
+		temp_path = "/tmp";
+
+	return linuxHelper::CopyPath(path, length, temp_path);
+}
+
+_boolean Platform::SetEnvironment(const _charw* name, const _charw* value) {
+	if (name == _null)
+		return _false;
+
+	linuxPath name_utf8(name);
+
+	if (value == _null)
+		return ::unsetenv(name_utf8) == 0;
+
+	return ::setenv(name_utf8, linuxPath(value), 1) == 0;
+}
+
+_boolean Platform::SetEnvironment(const _charw* name, _dword value) {
+	if (name == _null)
+		return _false;
+
+	_chara buffer[32];
+	::snprintf(buffer, sizeof(buffer), "%u", value);
+
+	return ::setenv(linuxPath(name), buffer, 1) == 0;
+}
+
+_boolean Platform::SetEnvironment(const _charw* name, _void* value) {
+	if (name == _null)
+		return _false;
+
+	_chara buffer[32];
+	::snprintf(buffer, sizeof(buffer), "%llx", (unsigned long long)(_uintptr_t)value);
+
+	return ::setenv(linuxPath(name), buffer, 1) == 0;
+}
+
+_boolean Platform::GetEnvironment(const _charw* name, _charw* value, _dword length) {
+	if (name == _null)
+		return _false;
+
+	const _chara* string = ::getenv(linuxPath(name));
+	if (string == _null)
+		return _false;
+
+	return linuxHelper::CopyPath(value, length, string);
+}
+
+_boolean Platform::GetEnvironment(const _charw* name, _dword& value) {
+	if (name == _null)
+		return _false;
+
+	const _chara* string = ::getenv(linuxPath(name));
+	if (string == _null)
+		return _false;
+
+	value = (_dword)::strtoul(string, _null, 10);
+
+	return _true;
+}
+
+_boolean Platform::GetEnvironment(const _charw* name, _void*& value) {
+	if (name == _null)
+		return _false;
+
+	const _chara* string = ::getenv(linuxPath(name));
+	if (string == _null)
+		return _false;
+
+	value = (_void*)(_uintptr_t)::strtoull(string, _null, 16);
+
+	return _true;
+}
+
+#pragma endregion
+
+#pragma region "Resource"
+
+// The resources are embedded in windows PE files only
+
+_handle Platform::FindResource(_handle module, const _charw* name, const _charw* type) {
+	return _null;
+}
+
+_handle Platform::LoadResource(_handle module, _handle resinfo) {
+	return _null;
+}
+
+_void Platform::FreeResource(_handle module, _handle resinfo) {
+}
+
+const _byte* Platform::LockResource(_handle resdata) {
+	return _null;
+}
+
+_dword Platform::SizeOfResource(_handle module, _handle resinfo) {
+	return 0;
+}
+
+_boolean Platform::EnumResourceNames(_handle module, const _charw* type, OnEnumResNameProc funcpointer, _void* parameter) {
+	return _false;
+}
+
+#pragma endregion
+
+#pragma region "Version"
+
+// The version information is embedded in windows PE files only
+
+_dword Platform::GetFileVersionInfoSize(const _charw* filename) {
+	return 0;
+}
+
+_boolean Platform::GetFileVersionInfo(const _charw* filename, _dword buffersize, _void* bufferdata) {
+	return _false;
+}
+
+_boolean Platform::VerQueryBuffer(_void* block, const _charw* subblock, _void*& bufferdata, _dword& buffersize) {
+	return _false;
+}
+
+#pragma endregion
+
+#pragma region "Console"
+
+_chara Platform::GetAChar() {
+	return (_chara)::getchar();
+}
+
+_charw Platform::GetWChar() {
+	// The wide character functions of libc are not available with 16-bits 'wchar_t'
+	return (_charw)::getchar();
+}
+
+_void Platform::WriteConsole(const _chara* string) {
+	if (string != _null)
+		::fputs(string, stdout);
+}
+
+_void Platform::WriteConsole(const _charw* string) {
+	if (string != _null)
+		WriteConsole((const _chara*)linuxPath(string));
+}
+
+#pragma endregion
+
+} // namespace E3D
@@ -0,0 +1,452 @@
+/**
+ * @file linuxSocket.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The network implementation for linux.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "PlatformPCH.h"
+
+#include "os/linux/linuxHelper.h"
+
+namespace E3D {
+
+#pragma region "Internal variables and functions"
+
+/**
+ * @brief The socket poller, the event file descriptor wakes up the waiting thread.
+ */
+struct linuxSocketPoller {
+	_int mEpollFD;
+	_int mWakeFD;
+	//!	The next poller in the list.
+	linuxSocketPoller* mNext;
+};
+
+// The pollers, the closed socket is removed from all of them, see CloseSocket()
+static Atomic<_dword> sPollerLocker;
+static linuxSocketPoller* sPollers = _null;
+
+/**
+ * @brief Lock the list of pollers.
+ */
+static _void LockPollers() {
+	while (_true) {
+		_dword unlocked = 0;
+		if (sPollerLocker.CompareExchangeWeak(unlocked, 1, MemoryOrder::Acquire))
+			return;
+
+		CPU_PAUSE();
+	}
+}
+
+/**
+ * @brief Unlock the list of pollers.
+ */
+static _void UnlockPollers() {
+	sPollerLocker.Store(0, MemoryOrder::Release);
+}
+
+static _int TranslateFamilies(DomainFamilyType families) {
+	return families == DomainFamilyType::INET6 ? AF_INET6 : AF_INET;
+}
+
+static _int TranslateSocketType(SocketType type) {
+	switch (type) {
+		case SocketType::Stream:
+			return SOCK_STREAM;
+		case SocketType::Dgram:
+			return SOCK_DGRAM;
+		case SocketType::Raw:
+			return SOCK_RAW;
+		case SocketType::SeqPacket:
+			return SOCK_SEQPACKET;
+		default:
+			break;
+	}
+
+	return SOCK_STREAM;
+}
+
+static _boolean SetBlockMode(_socket handle, _boolean block_mode) {
+	_int flags = ::fcntl(handle, F_GETFL, 0);
+	if (flags == -1)
+		return _false;
+
+	flags = block_mode ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+
+	return ::fcntl(handle, F_SETFL, flags) == 0;
+}
+
+static _int GetPendingError(_socket handle) {
+	_int error = 0;
+	socklen_t size = sizeof(error);
+	if (::getsockopt(handle, SOL_SOCKET, SO_ERROR, &error, &size) != 0)
+		return errno;
+
+	return error;
+}
+
+static _dword GetTimeOutOption(_socket handle, _int option) {
+	timeval time;
+	socklen_t size = sizeof(time);
+	if (::getsockopt(handle, SOL_SOCKET, option, &time, &size) != 0)
+		return 0;
+
+	return E3D_TIME_TO_DWORD(time);
+}
+
+static _boolean SetTimeOutOption(_socket handle, _int option, _dword milliseconds) {
+	timeval time;
+	E3D_VALUE_TO_TIME(time, milliseconds);
+
+	return ::setsockopt(handle, SOL_SOCKET, option, &time, sizeof(time)) == 0;
+}
+
+#pragma endregion
+
+#pragma region "Network"
+
+_dword Platform::GetURLIPAddress(const _chara* url_address) {
+	if (url_address == _null)
+		return 0;
+
+	addrinfo hints;
+	E3D_INIT(hints);
+	hints.ai_family = AF_INET;
+
+	addrinfo* result = _null;
+	if (::getaddrinfo(url_address, _null, &hints, &result) != 0 || result == _null)
+		return 0;
+
+	_dword address = ((sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+	::freeaddrinfo(result);
+
+	return address;
+}
+
+DomainFamilyType Platform::GetFamilyType(_dword port, const _chara* url_address) {
+	if (url_address == _null)
+		return DomainFamilyType::INET;
+
+	_chara service[16];
+	::snprintf(service, sizeof(service), "%u", port);
+
+	addrinfo hints;
+	E3D_INIT(hints);
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* result = _null;
+	if (::getaddrinfo(url_address, service, &hints, &result) != 0 || result == _null)
+		return DomainFamilyType::INET;
+
+	DomainFamilyType type = result->ai_family == AF_INET6 ? DomainFamilyType::INET6 : DomainFamilyType::INET;
+	::freeaddrinfo(result);
+
+	return type;
+}
+
+_socket Platform::CreateSocket(DomainFamilyType families, SocketType type, _boolean block_mode) {
+	_socket handle = ::socket(TranslateFamilies(families), TranslateSocketType(type) | SOCK_CLOEXEC, 0);
+	if (handle == -1)
+		return INVALID_SOCKET;
+
+	if (!block_mode && !SetBlockMode(handle, _false)) {
+		::close(handle);
+		return INVALID_SOCKET;
+	}
+
+	return handle;
+}
+
+_socket Platform::CreateListenedSocket(DomainFamilyType families, SocketType type, _boolean block_mode, _dword port, _dword max_connection_number) {
+	_socket handle = CreateSocket(families, type, block_mode);
+	if (handle == INVALID_SOCKET)
+		return INVALID_SOCKET;
+
+	// Allow to restart the server immediately
+	_int reuse = 1;
+	::setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	_int ret = -1;
+	if (families == DomainFamilyType::INET6) {
+		sockaddr_in6 address;
+		E3D_INIT(address);
+		address.sin6_family = AF_INET6;
+		address.sin6_addr = in6addr_any;
+		address.sin6_port = htons((_word)port);
+		ret = ::bind(handle, (const sockaddr*)&address, sizeof(address));
+	} else {
+		sockaddr_in address;
+		E3D_INIT(address);
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons((_word)port);
+		ret = ::bind(handle, (const sockaddr*)&address, sizeof(address));
+	}
+
+	if (ret != 0 || (type == SocketType::Stream && ::listen(handle, (_int)max_connection_number) != 0)) {
+		::close(handle);
+		return INVALID_SOCKET;
+	}
+
+	return handle;
+}
+
+_void Platform::CloseSocket(_socket handle) {
+	if (handle == INVALID_SOCKET)
+		return;
+
+	// The epoll watches the file description rather than the descriptor, it keeps the socket if it's duplicated (or
+	// inherited by the child process) and reports it with the user data which could be freed already
+	LockPollers();
+	for (linuxSocketPoller* poller = sPollers; poller != _null; poller = poller->mNext)
+		::epoll_ctl(poller->mEpollFD, EPOLL_CTL_DEL, handle, _null);
+	UnlockPollers();
+
+	::shutdown(handle, SHUT_RDWR);
+	::close(handle);
+}
+
+_dword Platform::GetSocketRecvTimeOutOption(_socket handle) {
+	return GetTimeOutOption(handle, SO_RCVTIMEO);
+}
+
+_boolean Platform::SetSocketRecvTimeOutOption(_socket handle, _dword time) {
+	return SetTimeOutOption(handle, SO_RCVTIMEO, time);
+}
+
+_dword Platform::GetSocketSendTimeOutOption(_socket handle) {
+	return GetTimeOutOption(handle, SO_SNDTIMEO);
+}
+
+_boolean Platform::SetSocketSendTimeOutOption(_socket handle, _dword time) {
+	return SetTimeOutOption(handle, SO_SNDTIMEO, time);
+}
+
+_dword Platform::GetLastSocketErrorID(_socket handle) {
+	// Use the global error number if there is no pending error on socket
+	_int error = handle != INVALID_SOCKET ? GetPendingError(handle) : 0;
+	if (error == 0)
+		return (_dword)errno;
+
+	return (_dword)error;
+}
+
+_socket Platform::AcceptSocket(_socket handle) {
+	_socket client = ::accept4(handle, _null, _null, SOCK_CLOEXEC);
+	if (client == -1)
+		return INVALID_SOCKET;
+
+	// Keep the same block mode as the listened socket
+	_int flags = ::fcntl(handle, F_GETFL, 0);
+	if (flags != -1 && (flags & O_NONBLOCK))
+		SetBlockMode(client, _false);
+
+	return client;
+}
+
+_boolean Platform::ConnectSocket(_socket handle, const _chara* remote_address, _dword port, OnIsBreakConnectingProc func, _void* userdata) {
+	if (handle == INVALID_SOCKET || remote_address == _null)
+		return _false;
+
+	_chara service[16];
+	::snprintf(service, sizeof(service), "%u", port);
+
+	addrinfo hints;
+	E3D_INIT(hints);
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* result = _null;
+	if (::getaddrinfo(remote_address, service, &hints, &result) != 0 || result == _null)
+		return _false;
+
+	// Connect in non-block mode, so we can break it by callback function
+	_int flags = ::fcntl(handle, F_GETFL, 0);
+	SetBlockMode(handle, _false);
+
+	_boolean connected = _false;
+	if (::connect(handle, result->ai_addr, result->ai_addrlen) == 0) {
+		connected = _true;
+	} else if (errno == EINPROGRESS) {
+		_dword tickcount = GetCurrentTickCount();
+
+		while (_true) {
+			pollfd poll_fd;
+			poll_fd.fd = handle;
+			poll_fd.events = POLLOUT;
+			poll_fd.revents = 0;
+
+			_int ret = ::poll(&poll_fd, 1, 100);
+			if (ret > 0) {
+				connected = GetPendingError(handle) == 0;
+				break;
+			}
+
+			if (ret == -1 && errno != EINTR)
+				break;
+
+			if (func != _null && func(GetCurrentTickCount() - tickcount, userdata))
+				break;
+		}
+	}
+
+	::freeaddrinfo(result);
+
+	// Restore the block mode
+	if (flags != -1)
+		::fcntl(handle, F_SETFL, flags);
+
+	return connected;
+}
+
+_dword Platform::ReadSocket(_socket handle, _void* buffer, _dword size) {
+	ssize_t bytes = ::recv(handle, buffer, size, 0);
+	if (bytes == -1) {
+		// No data in non-block mode
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+			return 0;
+
+		return -1;
+	}
+
+	gPerformanceData.mSocketReadBytes.Add(bytes);
+
+	// Zero indicates the connection has been closed gracefully
+	return (_dword)bytes;
+}
+
+_dword Platform::WriteSocket(_socket handle, const _void* buffer, _dword size) {
+	ssize_t bytes = ::send(handle, buffer, size, MSG_NOSIGNAL);
+	if (bytes == -1) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+			return 0;
+
+		return -1;
+	}
+
+	gPerformanceData.mSocketWriteBytes.Add(bytes);
+
+	return (_dword)bytes;
+}
+
+_handle Platform::CreateSocketPoller() {
+	_int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd == -1)
+		return _null;
+
+	_int wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wake_fd == -1) {
+		::close(epoll_fd);
+		return _null;
+	}
+
+	linuxSocketPoller* poller = new linuxSocketPoller;
+	poller->mEpollFD = epoll_fd;
+	poller->mWakeFD = wake_fd;
+
+	// The wake up event is reported with the poller itself
+	epoll_event event;
+	E3D_INIT(event);
+	event.events = EPOLLIN;
+	event.data.ptr = poller;
+	::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+	LockPollers();
+	poller->mNext = sPollers;
+	sPollers = poller;
+	UnlockPollers();
+
+	return poller;
+}
+
+_void Platform::CloseSocketPoller(_handle poller) {
+	linuxSocketPoller* socket_poller = (linuxSocketPoller*)poller;
+	if (socket_poller == _null)
+		return;
+
+	LockPollers();
+	for (linuxSocketPoller** link = &sPollers; *link != _null; link = &(*link)->mNext) {
+		if (*link == socket_poller) {
+			*link = socket_poller->mNext;
+			break;
+		}
+	}
+	UnlockPollers();
+
+	::close(socket_poller->mWakeFD);
+	::close(socket_poller->mEpollFD);
+	delete socket_poller;
+}
+
+_boolean Platform::WatchSocketReadable(_handle poller, _socket handle, _void* userdata) {
+	linuxSocketPoller* socket_poller = (linuxSocketPoller*)poller;
+	if (socket_poller == _null || handle == INVALID_SOCKET)
+		return _false;
+
+	epoll_event event;
+	E3D_INIT(event);
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.ptr = userdata;
+
+	// Re-arm the one-shot socket, or add it at the first time
+	if (::epoll_ctl(socket_poller->mEpollFD, EPOLL_CTL_MOD, handle, &event) == 0)
+		return _true;
+
+	return errno == ENOENT && ::epoll_ctl(socket_poller->mEpollFD, EPOLL_CTL_ADD, handle, &event) == 0;
+}
+
+_void Platform::UnwatchSocket(_handle poller, _socket handle) {
+	linuxSocketPoller* socket_poller = (linuxSocketPoller*)poller;
+	if (socket_poller == _null || handle == INVALID_SOCKET)
+		return;
+
+	::epoll_ctl(socket_poller->mEpollFD, EPOLL_CTL_DEL, handle, _null);
+}
+
+_dword Platform::WaitSocketPoller(_handle poller, _void** userdatas, _dword number, _dword milliseconds) {
+	linuxSocketPoller* socket_poller = (linuxSocketPoller*)poller;
+	if (socket_poller == _null || userdatas == _null || number == 0)
+		return 0;
+
+	epoll_event events[64];
+	_int ret = ::epoll_wait(socket_poller->mEpollFD, events, (_int)MIN(number, (_dword)E3D_ARRAY_NUMBER(events)), milliseconds == (_dword)-1 ? -1 : (_int)MIN(milliseconds, (_dword)INT_MAX));
+	if (ret <= 0)
+		return 0;
+
+	_dword count = 0;
+	for (_int i = 0; i < ret; i++) {
+		// Consume the wake up event
+		if (events[i].data.ptr == socket_poller) {
+			_qword value = 0;
+			while (::read(socket_poller->mWakeFD, &value, sizeof(value)) == sizeof(value))
+				;
+
+			continue;
+		}
+
+		userdatas[count++] = events[i].data.ptr;
+	}
+
+	return count;
+}
+
+_void Platform::WakeSocketPoller(_handle poller) {
+	linuxSocketPoller* socket_poller = (linuxSocketPoller*)poller;
+	if (socket_poller == _null)
+		return;
+
+	_qword value = 1;
+	while (::write(socket_poller->mWakeFD, &value, sizeof(value)) == -1 && errno == EINTR)
+		;
+}
+
+#pragma endregion
+
+} // namespace E3D
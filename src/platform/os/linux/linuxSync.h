@@ -0,0 +1,158 @@
+/**
+ * @file linuxSync.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The futex-backed kernel objects for linux platform.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+namespace E3D {
+
+/**
+ * @brief The kernel object type, every waitable handle begins with it.
+ * 
+ */
+enum class linuxObjectType : _dword {
+	Event,
+	Thread,
+};
+
+/**
+ * @brief The waitable kernel object.
+ * 
+ */
+struct linuxObject {
+	linuxObjectType mType;
+};
+
+/**
+ * @brief The recursive critical section, the futex word is 0 (unlocked), 1 (locked) or 2 (locked with waiters).
+ * The contended thread spins for a while before sleeping, the spin count adapts to the recent successful spins.
+ * The statistics are only updated by the owner thread, so they don't need any atomic read-modify-write.
+ * 
+ */
+struct linuxCriticalSection {
+	_dword mState;
+	_dword mRecursionCount;
+	_thread_id mOwnerThreadID;
+	_dword mSpinCount;
+	_dword mMaxSpinCount;
+	LockContentionData mContention;
+};
+
+/**
+ * @brief The reader counter of read-write lock, every slot owns a cache line.
+ * 
+ */
+struct CACHE_ALIGNED linuxReadWriteLockSlot {
+	_dword mReaderNumber;
+};
+
+/**
+ * @brief The writer-preferring read-write lock, the readers are counted on the slot of their own thread.
+ * The futex word 'mWriterNumber' is the number of writers owning or waiting for it, any writer blocks the new readers.
+ * The writers are serialized by the critical section.
+ * 
+ */
+struct linuxReadWriteLock {
+	_dword mWriterNumber;
+	_dword mReaderWaiterNumber;
+	_dword mSlotMask;
+	_handle mWriterLocker;
+	linuxReadWriteLockSlot* mSlots;
+};
+
+/**
+ * @brief The condition variable, the futex word 'mSequence' is increased by every wake, so the waiter never misses it.
+ * The 'mWaiterNumber' tracks the sleeping threads, so the wake skips the system call when nobody waits.
+ * 
+ */
+struct linuxConditionVariable {
+	_dword mSequence;
+	_dword mWaiterNumber;
+};
+
+/**
+ * @brief The manual/auto-reset event, the futex word is 0 (nonsignaled) or 1 (signaled).
+ * The 'mWaiterNumber' tracks the sleeping threads, so the signal skips the system call when nobody waits.
+ * 
+ */
+struct linuxEvent : public linuxObject {
+	_dword mState;
+	_dword mManualReset;
+	_dword mRefCount;
+	_dword mWaiterNumber;
+};
+
+/**
+ * @brief The thread, the futex word of 'mFinished' is set to 1 when the start routine returns.
+ * 
+ */
+struct linuxThread : public linuxObject {
+	pthread_t mThread;
+	_thread_id mThreadID;
+	_dword mRefCount;
+	_dword mStarted;
+	_dword mFinished;
+	_dword mSuspended;
+	_dword mAdopted;
+	_thread_ret mRetCode;
+	Platform::OnThreadStartRoutine mFuncPointer;
+	_void* mParameter;
+};
+
+/**
+ * @brief The futex helper.
+ * 
+ */
+class linuxFutex {
+public:
+	/**
+	 * @brief Build the relative timeout from milliseconds.
+	 * 
+	 * @param [in] milliseconds The time-out interval, -1 indicates infinite.
+	 * @param [out] timeout The relative timeout.
+	 * @return timespec* The timeout to pass to futex, null indicates infinite.
+	 */
+	static timespec* BuildTimeout(_dword milliseconds, timespec& timeout) {
+		if (milliseconds == (_dword)-1)
+			return _null;
+
+		timeout.tv_sec = milliseconds / 1000;
+		timeout.tv_nsec = (milliseconds % 1000) * 1000000L;
+		return &timeout;
+	}
+
+	/**
+	 * @brief Sleep while the futex word equals to the expected value.
+	 * 
+	 * @param [in] address The futex word.
+	 * @param [in] value The expected value.
+	 * @param [in] timeout The relative timeout, null indicates infinite.
+	 * @return _boolean False indicates timed out, true indicates woken up (maybe spuriously).
+	 */
+	static _boolean Wait(_dword* address, _dword value, const timespec* timeout) {
+		if (::syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, value, timeout, _null, 0) == -1 && errno == ETIMEDOUT)
+			return _false;
+
+		return _true;
+	}
+
+	/**
+	 * @brief Wake the waiters of the futex word.
+	 * 
+	 * @param [in] address The futex word.
+	 * @param [in] number The maximum number of waiters to wake.
+	 * @return _void
+	 */
+	static _void Wake(_dword* address, _dword number) {
+		::syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, (_int)MIN(number, (_dword)INT_MAX), _null, _null, 0);
+	}
+};
+
+} // namespace E3D
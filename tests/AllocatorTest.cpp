@@ -0,0 +1,194 @@
+/**
+ * @file AllocatorTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The stress test of platform heap, the blocks are freed by other threads and checked for overlaps.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+// The number of threads
+static const _dword cThreadNumber = 6;
+// The number of operations per thread
+static const _dword cOperationNumber = 50000;
+// The number of blocks kept by every thread
+static const _dword cLocalBlockNumber = 128;
+// The maximum size of large block, 1 in 256 blocks is large
+static const _dword cMaxLargeSize = 256 * 1024;
+// The tag of test, the live bytes must return to where they start
+static const MemoryTag cTestTag = MemoryTag::Physx;
+
+/**
+ * @brief The block, its bytes are filled with the pattern of its serial number.
+ */
+struct TestBlock {
+	_byte* mPointer;
+	_qword mSize;
+	_dword mSerial;
+};
+
+// The blocks sent to the other threads to free
+static MPMCQueue<TestBlock>* sSharedBlocks = _null;
+// The serial number of blocks
+static Atomic<_dword> sSerial;
+
+static _byte GetPattern(_dword serial, _qword offset) {
+	return (_byte)(serial * 131 + offset * 7);
+}
+
+/**
+ * @brief Fill the block with its pattern, the overlapped blocks overwrite each other.
+ */
+static _void FillBlock(const TestBlock& block, _qword offset) {
+	for (_qword i = offset; i < block.mSize; i++)
+		block.mPointer[i] = GetPattern(block.mSerial, i);
+}
+
+/**
+ * @brief Check the pattern of block.
+ */
+static _void CheckBlock(const TestBlock& block, _qword size) {
+	for (_qword i = 0; i < size; i++)
+		TEST_CHECK(block.mPointer[i] == GetPattern(block.mSerial, i));
+}
+
+static _void FreeBlock(TestBlock& block) {
+	CheckBlock(block, block.mSize);
+
+	Platform::HeapFree(block.mPointer);
+	block.mPointer = _null;
+}
+
+static _qword GetRandomSize(_dword& seed) {
+	_dword random = TestHelper::Random(seed);
+
+	// Most blocks are small, so the slabs and the thread caches are stressed
+	if ((random & 0xFF) == 0)
+		return random % cMaxLargeSize + 1;
+
+	return random % (SmallAllocator::cMaxSmallSize * 2) + 1;
+}
+
+static _void OnAllocatorThread(_dword index, _void* parameter) {
+	UNUSED_VAR(parameter);
+
+	MemoryTagScope scope(cTestTag);
+
+	_dword seed = 0x9E3779B9u + index * 7919;
+	TestBlock blocks[cLocalBlockNumber];
+	E3D_INIT_ARRAY(blocks);
+
+	for (_dword i = 0; i < cOperationNumber; i++) {
+		TestBlock& block = blocks[TestHelper::Random(seed) % cLocalBlockNumber];
+
+		// Free the block of other thread
+		TestBlock shared_block;
+		if ((i & 3) == 0 && sSharedBlocks->Dequeue(shared_block))
+			FreeBlock(shared_block);
+
+		if (block.mPointer == _null) {
+			block.mSize = GetRandomSize(seed);
+			block.mSerial = sSerial.Increase(MemoryOrder::Relaxed);
+			block.mPointer = (_byte*)Platform::HeapAlloc(block.mSize);
+			TEST_CHECK(block.mPointer != _null);
+
+			FillBlock(block, 0);
+			continue;
+		}
+
+		switch (TestHelper::Random(seed) % 3) {
+			// Send it to the other threads, or free it if the queue is full
+			case 0:
+				if (!sSharedBlocks->Enqueue(block))
+					FreeBlock(block);
+
+				block.mPointer = _null;
+				break;
+
+			// Resize it, the content must be kept
+			case 1: {
+				_qword size = GetRandomSize(seed);
+				block.mPointer = (_byte*)Platform::HeapReAlloc(block.mPointer, size);
+				TEST_CHECK(block.mPointer != _null);
+
+				CheckBlock(block, MIN(block.mSize, size));
+
+				_qword old_size = block.mSize;
+				block.mSize = size;
+				if (size > old_size)
+					FillBlock(block, old_size);
+			} break;
+
+			default:
+				FreeBlock(block);
+				break;
+		}
+	}
+
+	for (_dword i = 0; i < cLocalBlockNumber; i++) {
+		if (blocks[i].mPointer != _null)
+			FreeBlock(blocks[i]);
+	}
+}
+
+static _qword GetLiveBytes(MemoryTag tag) {
+	MemoryTagSnapshot snapshot;
+	MemoryTags::GetSnapshot(snapshot);
+
+	return snapshot.mTags[(_dword)tag].mLiveBytes;
+}
+
+/**
+ * @brief Allocate, resize and free the blocks in threads, a part of them are freed by the other threads.
+ */
+static _void TestHeap() {
+	_qword live_bytes = GetLiveBytes(cTestTag);
+
+	sSharedBlocks = new MPMCQueue<TestBlock>(1024);
+	TestHelper::RunThreads(cThreadNumber, OnAllocatorThread, _null);
+
+	TestBlock block;
+	while (sSharedBlocks->Dequeue(block))
+		FreeBlock(block);
+
+	delete sSharedBlocks;
+	sSharedBlocks = _null;
+
+	// The blocks are charged to the tag when allocated and released when freed, by any thread
+	TEST_CHECK(GetLiveBytes(cTestTag) == live_bytes);
+}
+
+/**
+ * @brief The aligned blocks must keep their alignment when resized.
+ */
+static _void TestAlignedHeap() {
+	_byte* pointer = _null;
+	for (_dword alignment = 16; alignment <= 4096; alignment *= 2) {
+		for (_qword size = 1; size <= 64 * 1024; size = size * 3 + 1) {
+			pointer = (_byte*)Platform::HeapReAllocAligned(pointer, size, alignment);
+			TEST_CHECK(pointer != _null);
+			TEST_CHECK(((_uintptr_t)pointer & (alignment - 1)) == 0);
+
+			E3D_MEM_SET(pointer, 0xCD, (size_t)size);
+		}
+	}
+
+	Platform::HeapFreeAligned(pointer);
+}
+
+#pragma endregion
+
+int main() {
+	TestHeap();
+	TestAlignedHeap();
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file FrameArenaTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The test of linear arenas and frame arenas.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include <new>
+#include <vector>
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+// The number of allocations per round
+static const _dword cAllocNumber = 4096;
+// The number of threads and frames
+static const _dword cThreadNumber = 8;
+static const _dword cFrameNumber = 64;
+// The tag of test, the live bytes must return to where they start
+static const MemoryTag cTestTag = MemoryTag::Storage;
+
+/**
+ * @brief The allocation.
+ */
+struct TestAllocation {
+	_byte* mPointer;
+	_dword mSize;
+};
+
+static TestAllocation sAllocations[cAllocNumber];
+
+/**
+ * @brief Allocate the blocks and fill them with their index.
+ */
+static _void AllocBlocks(LinearArena& arena, _dword seed) {
+	for (_dword i = 0; i < cAllocNumber; i++) {
+		_dword size = TestHelper::Random(seed) % 300 + 1;
+		_dword alignment = 1 << (TestHelper::Random(seed) % 8);
+
+		_byte* pointer = (_byte*)arena.Alloc(size, alignment);
+		TEST_CHECK(pointer != _null);
+		TEST_CHECK(((_uintptr_t)pointer & (alignment - 1)) == 0);
+
+		E3D_MEM_SET(pointer, (_byte)i, size);
+		sAllocations[i].mPointer = pointer;
+		sAllocations[i].mSize = size;
+	}
+}
+
+/**
+ * @brief Check the blocks, the overlapped blocks overwrite each other.
+ */
+static _void CheckBlocks(_dword number) {
+	for (_dword i = 0; i < number; i++) {
+		for (_dword j = 0; j < sAllocations[i].mSize; j++)
+			TEST_CHECK(sAllocations[i].mPointer[j] == (_byte)i);
+	}
+}
+
+/**
+ * @brief The object which uses the frame arena in its thread_local destructor, after the releaser of other objects.
+ */
+struct LateFrameArenaUser {
+	~LateFrameArenaUser() {
+		E3D_MEM_SET(FrameArena::Alloc(64 * 1024), 0, 64 * 1024);
+	}
+};
+
+static _void OnFrameArenaThread(_dword index, _void* parameter) {
+	UNUSED_VAR(parameter);
+
+	// It's not restored, so the arenas released at thread exit are charged to it as well
+	MemoryTags::SetThreadTag(cTestTag);
+
+	static thread_local LateFrameArenaUser late_user;
+	UNUSED_VAR(late_user);
+
+	for (_dword i = 0; i < cFrameNumber; i++) {
+		_byte* pointer = (_byte*)FrameArena::Alloc(1000 + index);
+		E3D_MEM_SET(pointer, (_byte)index, 1000 + index);
+
+		for (_dword j = 0; j < 1000 + index; j++)
+			TEST_CHECK(pointer[j] == (_byte)index);
+	}
+}
+
+static _qword GetLiveBytes(MemoryTag tag) {
+	MemoryTagSnapshot snapshot;
+	MemoryTags::GetSnapshot(snapshot);
+
+	return snapshot.mTags[(_dword)tag].mLiveBytes;
+}
+
+/**
+ * @brief The blocks must not overlap, and the rewinding and resetting must reuse the blocks.
+ */
+static _void TestLinearArena() {
+	LinearArena arena(16 * 1024);
+
+	AllocBlocks(arena, 0x9E3779B9u);
+	CheckBlocks(cAllocNumber);
+
+	// The memory after the marker is reused
+	LinearArenaMarker marker = arena.GetMarker();
+	{
+		LinearArenaScope scope(arena);
+		TEST_CHECK(arena.Alloc(8 * 1024) != _null);
+	}
+	TEST_CHECK(arena.GetMarker().mCursor == marker.mCursor);
+
+	_qword capacity = arena.GetCapacity();
+
+	// The same allocations fit in the kept blocks
+	arena.Reset();
+	AllocBlocks(arena, 0x9E3779B9u);
+	CheckBlocks(cAllocNumber);
+	TEST_CHECK(arena.GetCapacity() == capacity);
+
+	// The block larger than the block size takes a block of its own
+	_byte* large = (_byte*)arena.Alloc(100 * 1024, 4096);
+	TEST_CHECK(large != _null);
+	TEST_CHECK(((_uintptr_t)large & 4095) == 0);
+	E3D_MEM_SET(large, 0xFF, 100 * 1024);
+	CheckBlocks(cAllocNumber);
+
+	arena.Clear();
+	TEST_CHECK(arena.GetCapacity() == 0);
+
+	// The STL allocator throws when the arena fails, the size of array must not overflow
+	TEST_CHECK(arena.AllocArray<_qword>((_qword)-1 / 4) == _null);
+	TEST_CHECK(arena.Alloc((_qword)-1 - 8, 64) == _null);
+
+	_boolean thrown = _false;
+	try {
+		ArenaAllocator<_qword>(arena).allocate((size_t)-1 / 4);
+	} catch (const std::bad_alloc&) {
+		thrown = _true;
+	}
+	TEST_CHECK(thrown);
+
+	std::vector<_dword, ArenaAllocator<_dword>> numbers{ArenaAllocator<_dword>(arena)};
+	for (_dword i = 0; i < cAllocNumber; i++)
+		numbers.push_back(i);
+	for (_dword i = 0; i < cAllocNumber; i++)
+		TEST_CHECK(numbers[i] == i);
+}
+
+/**
+ * @brief The memory of last frame must be kept, and the arenas of exited threads must be released.
+ */
+static _void TestFrameArena() {
+	_byte* last_frame = _null;
+	for (_dword i = 0; i < cFrameNumber; i++) {
+		_byte* pointer = (_byte*)FrameArena::Alloc(4096);
+		E3D_MEM_SET(pointer, (_byte)i, 4096);
+
+		if (last_frame != _null) {
+			for (_dword j = 0; j < 4096; j++)
+				TEST_CHECK(last_frame[j] == (_byte)(i - 1));
+		}
+
+		last_frame = pointer;
+		FrameArena::NextFrame();
+	}
+
+	_qword live_bytes = GetLiveBytes(cTestTag);
+
+	for (_dword i = 0; i < 4; i++)
+		TestHelper::RunThreads(cThreadNumber, OnFrameArenaThread, _null);
+
+	// The thread is signaled before its thread_local destructors, so wait for them
+	for (_dword i = 0; i < 5000 && GetLiveBytes(cTestTag) != live_bytes; i++)
+		Platform::Sleep(1);
+
+	TEST_CHECK(GetLiveBytes(cTestTag) == live_bytes);
+}
+
+#pragma endregion
+
+int main() {
+	TestLinearArena();
+	TestFrameArena();
+
+	return 0;
+}
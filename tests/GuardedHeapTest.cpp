@@ -0,0 +1,199 @@
+/**
+ * @file GuardedHeapTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The test of guarded heap.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+// The number of threads and operations per thread
+static const _dword cThreadNumber = 8;
+static const _dword cOperationNumber = 20000;
+// The number of live blocks per thread
+static const _dword cLiveNumber = 64;
+// The maximum size of block, it fits in the guarded page
+static const _dword cMaxSize = 1024;
+
+// The exit code of forked child is the error + this
+static const _int cExitCodeBase = 100;
+
+// The reported errors
+static Atomic<_dword> sErrorNumbers[(_dword)GuardedHeapError::InvalidFree + 1];
+// True indicates the error exits the forked child
+static _boolean sExitOnError = _false;
+// The number of guarded blocks allocated by heap
+static Atomic<_dword> sGuardedNumber;
+
+static _void OnError(const GuardedHeapErrorData& error, _void* parameter) {
+	UNUSED_VAR(parameter);
+
+	if (sExitOnError)
+		::_exit(cExitCodeBase + (_int)error.mError);
+
+	sErrorNumbers[(_dword)error.mError].Increase(MemoryOrder::Relaxed);
+}
+
+static _dword GetErrorNumber(GuardedHeapError error) {
+	return sErrorNumbers[(_dword)error].Load(MemoryOrder::Relaxed);
+}
+
+/**
+ * @brief The block.
+ */
+struct TestBlock {
+	_byte* mPointer;
+	_dword mSize;
+};
+
+static _void CheckBlock(const TestBlock& block) {
+	for (_dword i = 0; i < block.mSize; i++)
+		TEST_CHECK(block.mPointer[i] == (_byte)block.mSize);
+}
+
+static _void OnHeapThread(_dword index, _void* parameter) {
+	UNUSED_VAR(parameter);
+
+	_dword seed = 0x9E3779B9u * (index + 1);
+
+	TestBlock blocks[cLiveNumber];
+	E3D_INIT_ARRAY(blocks);
+
+	for (_dword i = 0; i < cOperationNumber; i++) {
+		TestBlock& block = blocks[TestHelper::Random(seed) % cLiveNumber];
+
+		if (block.mPointer != _null) {
+			CheckBlock(block);
+			Platform::HeapFree(block.mPointer);
+		}
+
+		block.mSize = TestHelper::Random(seed) % cMaxSize + 1;
+		block.mPointer = (_byte*)Platform::HeapAlloc(block.mSize);
+		TEST_CHECK(block.mPointer != _null);
+
+		if (GuardedHeap::IsGuarded(block.mPointer)) {
+			TEST_CHECK(GuardedHeap::GetSize(block.mPointer) == block.mSize);
+			sGuardedNumber.Increase(MemoryOrder::Relaxed);
+		}
+
+		E3D_MEM_SET(block.mPointer, (_byte)block.mSize, block.mSize);
+	}
+
+	for (_dword i = 0; i < cLiveNumber; i++) {
+		if (blocks[i].mPointer != _null) {
+			CheckBlock(blocks[i]);
+			Platform::HeapFree(blocks[i].mPointer);
+		}
+	}
+}
+
+/**
+ * @brief Run the faulting access in the forked child, it must be reported as the error.
+ */
+static _void CheckFault(_void (*func)(), GuardedHeapError error) {
+	pid_t pid = ::fork();
+	TEST_CHECK(pid >= 0);
+
+	if (pid == 0) {
+		sExitOnError = _true;
+		func();
+
+		// It's not caught
+		::_exit(0);
+	}
+
+	_int status = 0;
+	TEST_CHECK(::waitpid(pid, &status, 0) == pid);
+	TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == cExitCodeBase + (_int)error);
+}
+
+static _void OnOverflow() {
+	volatile _byte* pointer = (volatile _byte*)GuardedHeap::Alloc(100);
+	TEST_CHECK(pointer != _null);
+
+	// The next page is always the guard page
+	pointer[Platform::GetPageSize()] = 0;
+}
+
+static _void OnUseAfterFree() {
+	volatile _byte* pointer = (volatile _byte*)GuardedHeap::Alloc(100);
+	TEST_CHECK(pointer != _null);
+	TEST_CHECK(GuardedHeap::Free((_void*)pointer));
+
+	pointer[0] = 0;
+}
+
+/**
+ * @brief The invalid frees are reported and rejected.
+ */
+static _void TestFree() {
+	_byte* pointer = (_byte*)GuardedHeap::Alloc(100, 8);
+	TEST_CHECK(pointer != _null);
+	TEST_CHECK(GuardedHeap::IsGuarded(pointer));
+	TEST_CHECK(((_uintptr_t)pointer & 7) == 0);
+	TEST_CHECK(GuardedHeap::GetSize(pointer) == 100);
+
+	GuardedHeap::SetTag(pointer, MemoryTag::Network);
+	TEST_CHECK(GuardedHeap::GetTag(pointer) == MemoryTag::Network);
+
+	TEST_CHECK(!GuardedHeap::Free(pointer + 1));
+	TEST_CHECK(GetErrorNumber(GuardedHeapError::InvalidFree) == 1);
+
+	TEST_CHECK(GuardedHeap::Free(pointer));
+	TEST_CHECK(!GuardedHeap::Free(pointer));
+	TEST_CHECK(GetErrorNumber(GuardedHeapError::DoubleFree) == 1);
+
+	_byte local = 0;
+	TEST_CHECK(!GuardedHeap::IsGuarded(&local));
+	TEST_CHECK(!GuardedHeap::Free(&local));
+}
+
+/**
+ * @brief The heap allocations are sampled to the guarded heap while the threads use them.
+ */
+static _void TestHeap() {
+	_dword error_number = 0;
+	for (_dword i = 0; i < sizeof(sErrorNumbers) / sizeof(sErrorNumbers[0]); i++)
+		error_number += sErrorNumbers[i].Load(MemoryOrder::Relaxed);
+
+	TestHelper::RunThreads(cThreadNumber, OnHeapThread, _null);
+
+	TEST_CHECK(sGuardedNumber.Load(MemoryOrder::Relaxed) != 0);
+
+	for (_dword i = 0; i < sizeof(sErrorNumbers) / sizeof(sErrorNumbers[0]); i++)
+		error_number -= sErrorNumbers[i].Load(MemoryOrder::Relaxed);
+	TEST_CHECK(error_number == 0);
+}
+
+#pragma endregion
+
+int main() {
+	GuardedHeap::SetErrorCallback(OnError, _null);
+
+	// The small pool is full sometimes, so the heap falls back as well
+	TEST_CHECK(GuardedHeap::Start(64, 16));
+	TEST_CHECK(GuardedHeap::IsStarted());
+
+	TestFree();
+
+	CheckFault(OnOverflow, GuardedHeapError::BufferOverflow);
+	CheckFault(OnUseAfterFree, GuardedHeapError::UseAfterFree);
+
+	TestHeap();
+
+	GuardedHeap::Stop();
+	TEST_CHECK(!GuardedHeap::IsStarted());
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file JobSystemTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The stress test of job system, the nested jobs go through the work-stealing deques.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+// The number of workers
+static const _dword cWorkerNumber = 4;
+// The depth of job tree, every job spawns 2 children
+static const _dword cTreeDepth = 12;
+// The number of rounds
+static const _dword cRoundNumber = 200;
+
+/**
+ * @brief The node of job tree.
+ */
+struct TreeJobData {
+	JobCounter* mCounter;
+	Atomic<_dword>* mLeafNumber;
+	_dword mDepth;
+};
+
+// The nodes, the children of node i are 2i+1 and 2i+2
+static TreeJobData sTreeNodes[(1 << (cTreeDepth + 1)) - 1];
+
+/**
+ * @brief Spawn the children from the worker, so they're pushed to its deque and stolen by the others.
+ */
+static _void OnTreeJob(_void* parameter) {
+	TreeJobData* node = (TreeJobData*)parameter;
+	if (node->mDepth == cTreeDepth) {
+		node->mLeafNumber->Increase(MemoryOrder::Relaxed);
+		return;
+	}
+
+	_dword index = (_dword)(node - sTreeNodes);
+	for (_dword i = 1; i <= 2; i++) {
+		TreeJobData* child = &sTreeNodes[index * 2 + i];
+		child->mCounter = node->mCounter;
+		child->mLeafNumber = node->mLeafNumber;
+		child->mDepth = node->mDepth + 1;
+
+		JobSystem::Run(OnTreeJob, child, node->mCounter);
+	}
+}
+
+/**
+ * @brief The job which checks its dependency has finished.
+ */
+struct ChainJobData {
+	Atomic<_dword>* mStep;
+	_dword mExpectedStep;
+	Atomic<_dword>* mErrorNumber;
+};
+
+static _void OnChainJob(_void* parameter) {
+	ChainJobData* data = (ChainJobData*)parameter;
+
+	// The step is increased by the last job, so it's seen only if the dependency works
+	if (data->mStep->Load(MemoryOrder::Acquire) != data->mExpectedStep)
+		data->mErrorNumber->Increase(MemoryOrder::Relaxed);
+
+	data->mStep->Increase(MemoryOrder::Release);
+}
+
+/**
+ * @brief Run the job trees, every leaf must run exactly once.
+ */
+static _void TestJobTree() {
+	for (_dword round = 0; round < cRoundNumber; round++) {
+		JobCounter counter;
+		Atomic<_dword> leaf_number(0);
+
+		TreeJobData& root = sTreeNodes[0];
+		root.mCounter = &counter;
+		root.mLeafNumber = &leaf_number;
+		root.mDepth = 0;
+
+		JobSystem::Run(OnTreeJob, &root, &counter);
+		JobSystem::Wait(counter);
+
+		TEST_CHECK(counter.IsDone());
+		TEST_CHECK(leaf_number.Load(MemoryOrder::Relaxed) == 1u << cTreeDepth);
+	}
+}
+
+/**
+ * @brief Run the chains of jobs, every job depends on the counter of the previous one.
+ */
+static _void TestJobDependency() {
+	static const _dword cChainLength = 64;
+
+	for (_dword round = 0; round < cRoundNumber; round++) {
+		JobCounter counters[cChainLength];
+		ChainJobData datas[cChainLength];
+		Atomic<_dword> step(0);
+		Atomic<_dword> error_number(0);
+
+		for (_dword i = 0; i < cChainLength; i++) {
+			datas[i].mStep = &step;
+			datas[i].mExpectedStep = i;
+			datas[i].mErrorNumber = &error_number;
+
+			JobSystem::Run(OnChainJob, &datas[i], &counters[i], i != 0 ? &counters[i - 1] : _null);
+		}
+
+		JobSystem::Wait(counters[cChainLength - 1]);
+
+		// The earlier counters are done already, wait for them to leave their lockers before destroying them
+		for (_dword i = 0; i < cChainLength; i++)
+			JobSystem::Wait(counters[i]);
+
+		TEST_CHECK(step.Load(MemoryOrder::Acquire) == cChainLength);
+		TEST_CHECK(error_number.Load(MemoryOrder::Relaxed) == 0);
+	}
+}
+
+#pragma endregion
+
+int main() {
+	TEST_CHECK(JobSystem::Initialize(cWorkerNumber));
+	TEST_CHECK(JobSystem::GetWorkerNumber() == cWorkerNumber);
+
+	TestJobTree();
+	TestJobDependency();
+
+	JobSystem::Finalize();
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file LockFreeQueueTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The stress test of lock-free queues.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+// The small capacity makes the positions wrap many times
+static const _dword cQueueCapacity = 64;
+// The number of elements per producer
+static const _dword cElementNumber = 200000;
+// The number of producers and consumers of MPMC queue
+static const _dword cProducerNumber = 4;
+static const _dword cConsumerNumber = 4;
+// The maximum number of elements per batch
+static const _dword cMaxBatchNumber = 8;
+
+/**
+ * @brief Wait when the queue is full or empty, it gives up the processor so the other side could run on a single core.
+ */
+static _void Backoff(_dword& round) {
+	if (++round < 64) {
+		CPU_PAUSE();
+		return;
+	}
+
+	round = 0;
+	Platform::Sleep(0);
+}
+
+static SPSCQueue<_dword>* sSPSCQueue = _null;
+
+static _void OnSPSCThread(_dword index, _void* parameter) {
+	UNUSED_VAR(parameter);
+
+	_dword seed = 0x9E3779B9u;
+	_dword round = 0;
+
+	if (index == 0) {
+		// The producer sends the sequence, in batches from time to time
+		for (_dword value = 0; value < cElementNumber;) {
+			// MIN() evaluates the arguments twice
+			_dword batch[cMaxBatchNumber];
+			_dword number = TestHelper::Random(seed) % cMaxBatchNumber + 1;
+			number = MIN(number, cElementNumber - value);
+			for (_dword i = 0; i < number; i++)
+				batch[i] = value + i;
+
+			_dword enqueued = number == 1 ? (sSPSCQueue->Enqueue(batch[0]) ? 1 : 0) : sSPSCQueue->EnqueueBatch(batch, number);
+			if (enqueued == 0)
+				Backoff(round);
+
+			value += enqueued;
+		}
+	} else {
+		// The consumer must see the same sequence
+		for (_dword expected = 0; expected < cElementNumber;) {
+			_dword batch[cMaxBatchNumber];
+			_dword number = TestHelper::Random(seed) % cMaxBatchNumber + 1;
+
+			_dword dequeued = number == 1 ? (sSPSCQueue->Dequeue(batch[0]) ? 1 : 0) : sSPSCQueue->DequeueBatch(batch, number);
+			if (dequeued == 0)
+				Backoff(round);
+
+			for (_dword i = 0; i < dequeued; i++)
+				TEST_CHECK(batch[i] == expected++);
+		}
+	}
+}
+
+/**
+ * @brief The shared data of MPMC test.
+ */
+struct MPMCTestData {
+	MPMCQueue<_dword> mQueue;
+	//!	The number of times every element is received.
+	Atomic<_byte>* mReceived;
+	Atomic<_dword> mReceivedNumber;
+
+	MPMCTestData() : mQueue(cQueueCapacity), mReceived(_null), mReceivedNumber(0) {
+	}
+};
+
+static _void OnMPMCThread(_dword index, _void* parameter) {
+	MPMCTestData* data = (MPMCTestData*)parameter;
+	_dword seed = 0x9E3779B9u + index;
+	_dword round = 0;
+
+	// The element is the producer index and its sequence
+	if (index < cProducerNumber) {
+		for (_dword sequence = 0; sequence < cElementNumber;) {
+			_dword batch[cMaxBatchNumber];
+			_dword number = TestHelper::Random(seed) % cMaxBatchNumber + 1;
+			number = MIN(number, cElementNumber - sequence);
+			for (_dword i = 0; i < number; i++)
+				batch[i] = index * cElementNumber + sequence + i;
+
+			_dword enqueued = data->mQueue.EnqueueBatch(batch, number);
+			if (enqueued == 0)
+				Backoff(round);
+
+			sequence += enqueued;
+		}
+
+		return;
+	}
+
+	// Every consumer sees the elements of a producer in order
+	_dword last_sequences[cProducerNumber];
+	for (_dword i = 0; i < cProducerNumber; i++)
+		last_sequences[i] = (_dword)-1;
+
+	while (data->mReceivedNumber.Load(MemoryOrder::Relaxed) < cProducerNumber * cElementNumber) {
+		_dword batch[cMaxBatchNumber];
+		_dword number = TestHelper::Random(seed) % cMaxBatchNumber + 1;
+
+		_dword dequeued = data->mQueue.DequeueBatch(batch, number);
+		if (dequeued == 0) {
+			Backoff(round);
+			continue;
+		}
+
+		for (_dword i = 0; i < dequeued; i++) {
+			TEST_CHECK(batch[i] < cProducerNumber * cElementNumber);
+
+			_dword producer = batch[i] / cElementNumber;
+			_dword sequence = batch[i] % cElementNumber;
+			TEST_CHECK(last_sequences[producer] == (_dword)-1 || last_sequences[producer] < sequence);
+			last_sequences[producer] = sequence;
+
+			TEST_CHECK(data->mReceived[batch[i]].FetchAdd(1, MemoryOrder::Relaxed) == 0);
+		}
+
+		data->mReceivedNumber.FetchAdd(dequeued, MemoryOrder::Relaxed);
+	}
+}
+
+/**
+ * @brief One producer and one consumer, the elements must arrive in order.
+ */
+static _void TestSPSCQueue() {
+	SPSCQueue<_dword> queue(cQueueCapacity);
+	TEST_CHECK(queue.GetCapacity() == cQueueCapacity);
+
+	sSPSCQueue = &queue;
+	TestHelper::RunThreads(2, OnSPSCThread, _null);
+	sSPSCQueue = _null;
+
+	_dword element = 0;
+	TEST_CHECK(queue.GetNumber() == 0);
+	TEST_CHECK(!queue.Dequeue(element));
+}
+
+/**
+ * @brief Many producers and consumers, every element must arrive exactly once.
+ */
+static _void TestMPMCQueue() {
+	MPMCTestData data;
+	data.mReceived = new Atomic<_byte>[cProducerNumber * cElementNumber];
+
+	TestHelper::RunThreads(cProducerNumber + cConsumerNumber, OnMPMCThread, &data);
+
+	TEST_CHECK(data.mReceivedNumber.Load(MemoryOrder::Relaxed) == cProducerNumber * cElementNumber);
+	for (_dword i = 0; i < cProducerNumber * cElementNumber; i++)
+		TEST_CHECK(data.mReceived[i].Load(MemoryOrder::Relaxed) == 1);
+
+	_dword element = 0;
+	TEST_CHECK(data.mQueue.GetNumber() == 0);
+	TEST_CHECK(!data.mQueue.Dequeue(element));
+
+	delete[] data.mReceived;
+}
+
+#pragma endregion
+
+int main() {
+	TestSPSCQueue();
+	TestMPMCQueue();
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file PlatformStringTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The test of platform string functions.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+/**
+ * @brief Format the string by the arguments.
+ */
+static _dword GetFormatLength(const _charw* format, ...) {
+	BEGIN_VA_LIST(args, format);
+	_dword length = Platform::GetFormatStringLength(format, args);
+	END_VA_LIST(args);
+
+	return length;
+}
+
+static _void TestConverter() {
+	_chara string[64];
+	TEST_CHECK(Platform::CompareString(Platform::ConvertLongToString(-123, 10, string, 64), "-123") == 0);
+	TEST_CHECK(Platform::CompareString(Platform::ConvertLongToString(-1, 16, string, 64), "ffffffff") == 0);
+	TEST_CHECK(Platform::CompareString(Platform::ConvertLargeToString(-9223372036854775807ll - 1, 10, string, 64), "-9223372036854775808") == 0);
+	TEST_CHECK(Platform::CompareString(Platform::ConvertQwordToString(255, 2, string, 64), "11111111") == 0);
+	TEST_CHECK(Platform::CompareString(Platform::ConvertDoubleToString(1.5, string, 64, 2), "1.50") == 0);
+
+	// The buffer is too small
+	TEST_CHECK(Platform::ConvertDwordToString(12345, 10, string, 5) == _null);
+	TEST_CHECK(string[0] == 0);
+
+	_charw wide_string[64];
+	TEST_CHECK(Platform::CompareString(Platform::ConvertDwordToString(0xBEEF, 16, wide_string, 64), L"beef") == 0);
+	TEST_CHECK(Platform::CompareString(Platform::ConvertFloatToString(0.25f, wide_string, 64, 3), L"0.250") == 0);
+
+	TEST_CHECK(Platform::ConvertStringToBool("TRUE"));
+	TEST_CHECK(Platform::ConvertStringToBool(L"1"));
+	TEST_CHECK(!Platform::ConvertStringToBool("false"));
+	TEST_CHECK(Platform::ConvertStringToLong(" -42", 10) == -42);
+	TEST_CHECK(Platform::ConvertStringToDword(L"ff", 16) == 0xFF);
+	TEST_CHECK(Platform::ConvertStringToLarge(L"-9000000000", 10) == -9000000000ll);
+	TEST_CHECK(Platform::ConvertStringToQword("18446744073709551615", 10) == 18446744073709551615ull);
+	TEST_CHECK(Platform::ConvertStringToDouble(L"2.5") == 2.5);
+}
+
+static _void TestString() {
+	TEST_CHECK(Platform::IsBlank(" \t\r\n"));
+	TEST_CHECK(!Platform::IsBlank(L" a "));
+	TEST_CHECK(Platform::IsFullpath("/usr/lib"));
+	TEST_CHECK(Platform::IsFullpath(L"C:\\Windows"));
+	TEST_CHECK(!Platform::IsFullpath("data/file"));
+
+	_chara string[64];
+	Platform::CopyString(string, "xxHelloxX");
+	_dword length = -1;
+	_chara* trimmed = Platform::TrimStringBoth(string, length, 'x', _true);
+	TEST_CHECK(length == 5);
+	TEST_CHECK(Platform::CompareString(trimmed, "Hello") == 0);
+
+	_charw wide_string[64];
+	Platform::CopyString(wide_string, L" \tWorld \n");
+	length = Platform::StringLength(wide_string);
+	_charw* wide_trimmed = Platform::TrimStringBoth(wide_string, length, L" \t\n");
+	TEST_CHECK(length == 5);
+	TEST_CHECK(Platform::CompareString(wide_trimmed, L"World") == 0);
+
+	TEST_CHECK(Platform::SearchL2R("abcabc", 'c') == 2);
+	TEST_CHECK(Platform::SearchR2L(L"abcabc", L'C', _true) == 5);
+	TEST_CHECK(Platform::SearchL2R("abc", 'd') == (_dword)-1);
+
+	_dword index = 0;
+	TEST_CHECK(Platform::SearchL2R("one two two", "TWO", _true, &index) == 4);
+	TEST_CHECK(index == 7);
+	TEST_CHECK(Platform::SearchR2L(L"one two two", L"two", _false, &index) == 8);
+	TEST_CHECK(index == 8);
+	TEST_CHECK(Platform::SearchL2R("one", "one two") == (_dword)-1);
+
+	Platform::CopyString(string, "Hello", 3);
+	TEST_CHECK(Platform::CompareString(string, "Hel") == 0);
+	Platform::AppendString(string, "lo");
+	TEST_CHECK(Platform::CompareString(string, "Hello") == 0);
+
+	TEST_CHECK(Platform::CompareString("abc", "abd") < 0);
+	TEST_CHECK(Platform::CompareString(L"ABC", L"abc", _true) == 0);
+	TEST_CHECK(Platform::CompareString(L"\x00C9t\x00E9", L"\x00E9t\x00C9", _true) == 0);
+	TEST_CHECK(Platform::CompareString("ab", "abc") < 0);
+	TEST_CHECK(Platform::CompareCase('a', 'B', _true) < 0);
+
+	// The UTF-8 bytes are compared unsigned
+	TEST_CHECK(Platform::CompareString("\xC3\xA9", "z") > 0);
+
+	TEST_CHECK(Platform::CompareWildcard("Hello", "He??o"));
+	TEST_CHECK(Platform::CompareWildcard("Hello", "H*o"));
+	TEST_CHECK(Platform::CompareWildcard(L"Hello", L"*hello", _true));
+	TEST_CHECK(Platform::CompareWildcard("abcbcd", "a*bcd"));
+	TEST_CHECK(!Platform::CompareWildcard("Hello", "H*x"));
+	TEST_CHECK(!Platform::CompareWildcard("Hello", "Hell"));
+
+	Platform::CopyString(wide_string, L"Mixed \x00C0\x00E0");
+	TEST_CHECK(Platform::CompareString(Platform::UppercaseString(wide_string), L"MIXED \x00C0\x00C0") == 0);
+	TEST_CHECK(Platform::CompareString(Platform::LowercaseString(wide_string, 3), L"mixED \x00C0\x00C0") == 0);
+
+	TEST_CHECK(Platform::IsUtf8String("\xE4\xB8\xAD\xE6\x96\x87"));
+	TEST_CHECK(!Platform::IsUtf8String("\xC0\xAF"));
+	TEST_CHECK(!Platform::IsUtf8String("\xE4\xB8"));
+
+	TEST_CHECK(Platform::AnsiToUtf16(wide_string, 64, "\xE4\xB8\xAD") == 1);
+	TEST_CHECK(wide_string[0] == 0x4E2D);
+	TEST_CHECK(Platform::Utf16ToAnsi(string, 64, wide_string) == 3);
+
+	TEST_CHECK(Platform::IsToneInThai(0x0E48));
+	TEST_CHECK(Platform::IsUpperVowelInThai(0x0E34));
+	TEST_CHECK(Platform::IsDownVowelInThai(0x0E38));
+	TEST_CHECK(Platform::IsVowelInThai(0x0E40));
+	TEST_CHECK(!Platform::IsVowelInThai(0x0E01));
+}
+
+static _void TestFormat() {
+	_chara string[64];
+	Platform::FormatStringBuffer(string, 64, "%d|%5.2f|%-4s|%x|%lld", -7, 3.14159, "ab", 255u, 1ll << 40);
+	TEST_CHECK(Platform::CompareString(string, "-7| 3.14|ab  |ff|1099511627776") == 0);
+
+	// The wide string argument is converted to UTF-8
+	Platform::FormatStringBuffer(string, 64, "%ls|%S|%c", L"\x4E2D", L"ab", 'z');
+	TEST_CHECK(Platform::CompareString(string, "\xE4\xB8\xAD|ab|z") == 0);
+
+	// The string is truncated by the buffer
+	Platform::FormatStringBuffer(string, 4, "%s", "abcdef");
+	TEST_CHECK(Platform::CompareString(string, "abc") == 0);
+
+	_charw wide_string[64];
+	Platform::FormatStringBuffer(wide_string, 64, L"%s=%hs,%*d,%.3s,%%,%c", L"key", "\xE4\xB8\xAD", 4, 42, L"abcdef", L'w');
+	TEST_CHECK(Platform::CompareString(wide_string, L"key=\x4E2D,  42,abc,%,w") == 0);
+
+	Platform::FormatStringBuffer(wide_string, 64, L"%I64u|%zu|%08.3f|%s", 18446744073709551615ull, (size_t)5, -1.5, (const _charw*)_null);
+	TEST_CHECK(Platform::CompareString(wide_string, L"18446744073709551615|5|-001.500|(null)") == 0);
+
+	TEST_CHECK(GetFormatLength(L"%s-%d", L"abc", 12345) == 9);
+}
+
+#pragma endregion
+
+int main() {
+	TestConverter();
+	TestString();
+	TestFormat();
+
+	return 0;
+}
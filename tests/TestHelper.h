@@ -0,0 +1,105 @@
+/**
+ * @file TestHelper.h
+ * @author zopenge (zopenge@126.com)
+ * @brief The helpers of platform tests.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PlatformPCH.h"
+
+//!	Check the condition, the test exits with failure at the first failed check.
+#define TEST_CHECK(x)                                                                \
+	do {                                                                             \
+		if (!(x)) {                                                                  \
+			::fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #x); \
+			::exit(1);                                                               \
+		}                                                                            \
+	} while (0)
+
+namespace E3D {
+
+/**
+ * @brief The helpers of tests.
+ * 
+ */
+class TestHelper {
+public:
+	//!	The maximum number of threads.
+	static const _dword cMaxThreadNumber = 64;
+
+	//!	The thread function, it takes the thread index and the user defined parameter.
+	typedef _void (*OnThreadProc)(_dword index, _void* parameter);
+
+private:
+	//!	The data of thread.
+	struct ThreadData {
+		OnThreadProc mFunc;
+		_void* mParameter;
+		_dword mIndex;
+	};
+
+	static _thread_ret OnThread(_void* parameter) {
+		ThreadData* data = (ThreadData*)parameter;
+		data->mFunc(data->mIndex, data->mParameter);
+
+		return 0;
+	}
+
+public:
+	/**
+	 * @brief Run the function in threads, the threads are started together and joined before returning.
+	 * 
+	 * @param [in] number The number of threads.
+	 * @param [in] func The thread function.
+	 * @param [in] parameter The user defined parameter.
+	 * @return _void 
+	 */
+	static _void RunThreads(_dword number, OnThreadProc func, _void* parameter) {
+		TEST_CHECK(number <= cMaxThreadNumber);
+
+		ThreadData datas[cMaxThreadNumber];
+		_handle threads[cMaxThreadNumber];
+		for (_dword i = 0; i < number; i++) {
+			datas[i].mFunc = func;
+			datas[i].mParameter = parameter;
+			datas[i].mIndex = i;
+
+			_thread_id threadid = 0;
+			threads[i] = Platform::CreateThread(OnThread, 0, &datas[i], _true, &threadid);
+			TEST_CHECK(threads[i] != _null);
+		}
+
+		for (_dword i = 0; i < number; i++)
+			Platform::ResumeThread(threads[i]);
+
+		for (_dword i = 0; i < number; i++) {
+			Platform::WaitForSingleObject(threads[i], -1);
+			Platform::CloseThread(threads[i]);
+		}
+	}
+
+	/**
+	 * @brief Get the pseudo random number, it's xorshift so the threads could have their own sequences.
+	 * 
+	 * @param [in, out] seed The seed, it must not be 0.
+	 * @return _dword The random number.
+	 */
+	static _dword Random(_dword& seed) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		return seed;
+	}
+};
+
+} // namespace E3D
@@ -0,0 +1,98 @@
+/**
+ * @file ThreadSamplerTest.cpp
+ * @author zopenge (zopenge@126.com)
+ * @brief The stress test of thread sampler, the readers must never see a torn snapshot.
+ * @version 0.1
+ * @date 2021-06-26
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "TestHelper.h"
+
+using namespace E3D;
+
+#pragma region "Internal variables and functions"
+
+// The test duration in milliseconds
+static const _dword cDuration = 2000;
+// The number of threads, the first ones sample, the last one creates the short-lived threads, the others read
+static const _dword cSamplerNumber = 2;
+static const _dword cReaderNumber = 3;
+
+// The test end time
+static _dword sEndTime = 0;
+// The number of snapshots read
+static Atomic<_dword> sReadNumber;
+
+static _thread_ret OnShortLivedThread(_void* parameter) {
+	UNUSED_VAR(parameter);
+
+	return 0;
+}
+
+/**
+ * @brief Check the snapshot, the mixed snapshots would break the order of threads.
+ */
+static _void CheckSnapshot(const ThreadCPUSnapshot& snapshot) {
+	TEST_CHECK(snapshot.mThreadNumber <= ThreadCPUSnapshot::cMaxThreadNumber);
+
+	for (_dword i = 0; i < snapshot.mThreadNumber; i++) {
+		const ThreadCPUData& data = snapshot.mThreads[i];
+		TEST_CHECK(i == 0 || snapshot.mThreads[i - 1].mTotal.mThreadID < data.mTotal.mThreadID);
+		TEST_CHECK(data.mUserUsage >= 0.0f && data.mUserUsage <= 100.0f);
+		TEST_CHECK(data.mKernelUsage >= 0.0f && data.mKernelUsage <= 100.0f);
+		TEST_CHECK(data.mRunQueueWaitRatio >= 0.0f && data.mRunQueueWaitRatio <= 100.0f);
+	}
+}
+
+static _void OnTestThread(_dword index, _void* parameter) {
+	UNUSED_VAR(parameter);
+
+	// The snapshot is too large for the stack of thread
+	ThreadCPUSnapshot* snapshot = new ThreadCPUSnapshot;
+	_thread_id threadid = Platform::GetCurrentThreadID();
+
+	while ((_int)(Platform::GetCurrentTickCount() - sEndTime) < 0) {
+		if (index < cSamplerNumber) {
+			// Only one of them samples at the same time
+			ThreadSampler::Sample();
+		} else if (index < cSamplerNumber + cReaderNumber) {
+			if (ThreadSampler::GetSnapshot(*snapshot)) {
+				CheckSnapshot(*snapshot);
+				sReadNumber.Increase(MemoryOrder::Relaxed);
+			}
+
+			ThreadCPUData data;
+			if (ThreadSampler::GetThreadCPUData(threadid, data))
+				TEST_CHECK(data.mTotal.mThreadID == threadid);
+		} else {
+			// The thread list changes between the samples
+			_thread_id short_lived_threadid = 0;
+			_handle thread = Platform::CreateThread(OnShortLivedThread, 0, _null, _false, &short_lived_threadid);
+			TEST_CHECK(thread != _null);
+
+			Platform::WaitForSingleObject(thread, -1);
+			Platform::CloseThread(thread);
+		}
+	}
+
+	delete snapshot;
+}
+
+#pragma endregion
+
+int main() {
+	// The background sampler runs as well
+	TEST_CHECK(ThreadSampler::Initialize(1));
+
+	sEndTime = Platform::GetCurrentTickCount() + cDuration;
+	TestHelper::RunThreads(cSamplerNumber + cReaderNumber + 1, OnTestThread, _null);
+
+	ThreadSampler::Finalize();
+
+	TEST_CHECK(sReadNumber.Load(MemoryOrder::Relaxed) != 0);
+
+	return 0;
+}